@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+
+"""
+Convert a PX4 event trace (recorded with the 'trace' command) into the
+Chrome/Perfetto trace JSON format, or compute end-to-end latencies between
+two topics along the causal chain of publications and WorkItems.
+
+Causality: a publication is caused by the WorkItem running on the publishing
+thread, a WorkItem schedule by the last publication on the scheduling thread
+(the schedule happens in the publication's callbacks) and a WorkItem run by
+the latest schedule of the item before the run started.
+
+Examples:
+    Tools/px4trace.py trace.px4t -o trace.json   # open in https://ui.perfetto.dev
+    Tools/px4trace.py trace.px4t --latency sensor_gyro actuator_outputs
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import struct
+import sys
+
+PUBLISH = 1
+SCHEDULE = 2
+RUN_START = 3
+RUN_END = 4
+
+NAME_NONE = 0xffff
+
+
+class Event(object):
+    __slots__ = ['event', 'instance', 'thread', 'name', 'timestamp']
+
+    def __init__(self, event, instance, thread, name, timestamp):
+        self.event = event
+        self.instance = instance
+        self.thread = thread
+        self.name = name
+        self.timestamp = timestamp
+
+
+def read_trace(path):
+    """ returns (thread names, events sorted by time, number of lost events) """
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data[:8] != b'PX4TRACE':
+        raise ValueError('%s is not a PX4 trace file' % path)
+
+    version, = struct.unpack_from('<I', data, 8)
+
+    if version != 1:
+        raise ValueError('unsupported trace version %i' % version)
+
+    threads = {}
+    names = {}
+    events = []
+    lost = 0
+    offset = 12
+
+    while offset < len(data):
+        kind = data[offset:offset + 1]
+        offset += 1
+
+        try:
+            if kind == b'T':
+                thread, raw_name = struct.unpack_from('<H16s', data, offset)
+                offset += 18
+                threads[thread] = raw_name.split(b'\0', 1)[0].decode('utf-8', 'replace')
+
+            elif kind == b'N':
+                name_id, length = struct.unpack_from('<HB', data, offset)
+                offset += 3
+                names[name_id] = data[offset:offset + length].decode('utf-8', 'replace')
+                offset += length
+
+            elif kind == b'E':
+                event, instance, thread, name_id, timestamp = struct.unpack_from('<BBHHQ', data, offset)
+                offset += 14
+                name = names.get(name_id, '?') if name_id != NAME_NONE else '?'
+                events.append(Event(event, instance, thread, name, timestamp))
+
+            elif kind == b'L':
+                count, = struct.unpack_from('<I', data, offset)
+                offset += 4
+                lost += count
+
+            else:
+                raise ValueError('corrupt trace at offset %i' % (offset - 1))
+
+        except struct.error:
+            # truncated file (e.g. PX4 was killed while tracing)
+            break
+
+    # file order is the ring order, timestamps of concurrent threads can interleave
+    events.sort(key=lambda e: e.timestamp)
+
+    return threads, events, lost
+
+
+def topic_name(event):
+    if event.instance > 0:
+        return '%s:%i' % (event.name, event.instance)
+
+    return event.name
+
+
+def to_chrome_json(threads, events):
+    trace = []
+    pid = 1
+
+    for thread, name in sorted(threads.items()):
+        trace.append({'ph': 'M', 'name': 'thread_name', 'pid': pid, 'tid': thread, 'args': {'name': name}})
+
+    flow_id = 0
+    pending_flow = {} # WorkItem -> id of the flow started by its latest schedule
+    open_runs = {} # thread -> number of open run slices
+
+    for e in events:
+        ts = e.timestamp
+
+        if e.event == PUBLISH:
+            trace.append({'ph': 'X', 'name': topic_name(e), 'cat': 'publish', 'pid': pid, 'tid': e.thread,
+                          'ts': ts, 'dur': 0})
+
+        elif e.event == SCHEDULE:
+            flow_id += 1
+            trace.append({'ph': 'X', 'name': 'schedule ' + e.name, 'cat': 'schedule', 'pid': pid, 'tid': e.thread,
+                          'ts': ts, 'dur': 0})
+            trace.append({'ph': 's', 'name': 'wakeup', 'cat': 'schedule', 'id': flow_id, 'pid': pid,
+                          'tid': e.thread, 'ts': ts})
+            pending_flow[e.name] = flow_id
+
+        elif e.event == RUN_START:
+            trace.append({'ph': 'B', 'name': e.name, 'cat': 'run', 'pid': pid, 'tid': e.thread, 'ts': ts})
+            open_runs[e.thread] = open_runs.get(e.thread, 0) + 1
+
+            if e.name in pending_flow:
+                trace.append({'ph': 'f', 'bp': 'e', 'name': 'wakeup', 'cat': 'schedule',
+                              'id': pending_flow.pop(e.name), 'pid': pid, 'tid': e.thread, 'ts': ts})
+
+        elif e.event == RUN_END:
+            # the trace can start in the middle of a run
+            if open_runs.get(e.thread, 0) > 0:
+                trace.append({'ph': 'E', 'pid': pid, 'tid': e.thread, 'ts': ts})
+                open_runs[e.thread] -= 1
+
+    return {'traceEvents': trace}
+
+
+def matches(event, topic):
+    if ':' in topic:
+        return topic_name(event) == topic
+
+    return event.name == topic
+
+
+def latencies(events, source, destination):
+    """
+    For every publication of destination that causally depends on a publication
+    of source, the time since the (latest) source publication in us.
+    """
+    run_origin = {} # thread -> source timestamp the current run depends on
+    publish_origin = {} # thread -> source timestamp of the last publication on the thread
+    schedule_origin = {} # WorkItem -> source timestamp of its latest schedule
+    samples = []
+
+    for e in events:
+        if e.event == PUBLISH:
+            if matches(e, source):
+                origin = e.timestamp
+
+            else:
+                origin = run_origin.get(e.thread)
+
+            publish_origin[e.thread] = origin
+
+            if origin is not None and matches(e, destination):
+                samples.append(e.timestamp - origin)
+
+        elif e.event == SCHEDULE:
+            schedule_origin[e.name] = publish_origin.get(e.thread)
+
+        elif e.event == RUN_START:
+            run_origin[e.thread] = schedule_origin.pop(e.name, None)
+            publish_origin[e.thread] = None
+
+        elif e.event == RUN_END:
+            run_origin[e.thread] = None
+            publish_origin[e.thread] = None
+
+    return samples
+
+
+def percentile(sorted_samples, q):
+    index = min(len(sorted_samples) - 1, max(0, int(q * len(sorted_samples) + 0.5) - 1))
+    return sorted_samples[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a PX4 event trace to Chrome/Perfetto JSON')
+    parser.add_argument('trace', help='trace file recorded with the trace command')
+    parser.add_argument('-o', '--output', help='output JSON file (default: <trace>.json)')
+    parser.add_argument('--latency', nargs=2, metavar=('SOURCE', 'DESTINATION'),
+                        help='print the end-to-end latency from SOURCE to DESTINATION topic publications '
+                        '(topic or topic:instance) instead of converting')
+    args = parser.parse_args()
+
+    threads, events, lost = read_trace(args.trace)
+
+    if lost > 0:
+        print('warning: %i events were lost while tracing' % lost, file=sys.stderr)
+
+    if args.latency:
+        samples = sorted(latencies(events, args.latency[0], args.latency[1]))
+
+        if not samples:
+            print('no causal chain from %s to %s found' % (args.latency[0], args.latency[1]))
+            return 1
+
+        print('%s -> %s: %i samples' % (args.latency[0], args.latency[1], len(samples)))
+        print('  min %i us, mean %.1f us, p50 %i us, p99 %i us, max %i us' % (
+            samples[0], float(sum(samples)) / len(samples), percentile(samples, 0.5),
+            percentile(samples, 0.99), samples[-1]))
+        return 0
+
+    output = args.output if args.output else args.trace + '.json'
+
+    with open(output, 'w') as f:
+        json.dump(to_chrome_json(threads, events), f)
+
+    print('%i events from %i threads written to %s' % (len(events), len(threads), output))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
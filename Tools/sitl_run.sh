@@ -85,6 +85,11 @@ for file in "$@"; do
 done
 
 export PX4_SIM_MODEL=${model}
+export PX4_SIMULATOR=${program}
+
+if [ "$program" == "shm_standin" ]; then
+	export PX4_SIM_TRANSPORT=shm
+fi
 
 SIM_PID=0
 
@@ -176,6 +181,10 @@ elif [ "$program" == "flightgear" ] && [ -z "$no_sim" ]; then
 	"${src_path}/Tools/flightgear_bridge/FG_run.py" "models/"${model}".json" 0
 	"${build_path}/build_flightgear_bridge/flightgear_bridge" 0 `./get_FGbridge_params.py "models/"${model}".json"` &
 	FG_BRIDGE_PID=$!
+elif [ "$program" == "shm_standin" ] && [ -z "$no_sim" ]; then
+	# stand-in simulator, prints the achieved lockstep steps/s
+	"${build_path}/bin/sim_shm_standin" &
+	SIM_PID=$!
 elif [ "$program" == "jsbsim" ] && [ -z "$no_sim" ]; then
 	source "$src_path/Tools/setup_jsbsim.bash" "${src_path}" "${build_path}" ${model}
 	if [[ -n "$HEADLESS" ]]; then
@@ -241,6 +250,8 @@ elif [ "$program" == "gazebo" ]; then
 elif [ "$program" == "flightgear" ]; then
 	kill $FG_BRIDGE_PID
 	kill -9 `cat /tmp/px4fgfspid_0`
+elif [ "$program" == "shm_standin" ]; then
+	kill $SIM_PID
 elif [ "$program" == "jsbsim" ]; then
 	kill $JSBSIM_PID
 	kill $FGFS_PID
@@ -53,7 +53,7 @@ px4_add_board(
 		replay
 		rover_pos_control
 		sensors
-		#sih
+		sih
 		simulator
 		temperature_compensation
 		uuv_att_control
@@ -81,6 +81,7 @@ px4_add_board(
 		tests # tests and test runner
 		#top
 		topic_listener
+		trace
 		tune_control
 		uorb
 		ver
@@ -0,0 +1,10 @@
+# SITL default configuration plus the shared memory uORB bridge (muorb_shm)
+include(${CMAKE_CURRENT_LIST_DIR}/default.cmake)
+
+# uORB communicator for muorb_shm
+add_definitions(-DORB_COMMUNICATOR)
+
+set(PX4_BOARD_LABEL "shm" CACHE STRING "PX4 board label" FORCE)
+set(PX4_CONFIG "${PX4_BOARD_VENDOR}_${PX4_BOARD_MODEL}_${PX4_BOARD_LABEL}" CACHE STRING "PX4 config" FORCE)
+
+list(APPEND config_module_list modules/muorb/shm)
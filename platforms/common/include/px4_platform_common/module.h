@@ -44,6 +44,7 @@
 #include <px4_platform_common/atomic.h>
 #include <px4_platform_common/time.h>
 #include <px4_platform_common/log.h>
+#include <px4_platform_common/namespace.h>
 #include <px4_platform_common/tasks.h>
 #include <systemlib/px4_macros.h>
 
@@ -59,6 +60,53 @@
  */
 extern pthread_mutex_t px4_modules_mutex;
 
+namespace px4
+{
+
+/**
+ * @class ModuleObject
+ *      Module instance pointer with one slot per vehicle namespace, so the same module
+ *      can run once in each namespace. Accessors use the namespace of the calling thread.
+ */
+template<class T>
+class ModuleObject
+{
+public:
+	T *load() const { return _objects[namespace_id()].load(); }
+	void store(T *object) { _objects[namespace_id()].store(object); }
+
+private:
+	px4::atomic<T *> _objects[NAMESPACES_MAX] {};
+};
+
+/**
+ * @class ModuleTaskId
+ *      Module task handle with one slot per vehicle namespace (see ModuleObject).
+ */
+class ModuleTaskId
+{
+public:
+	constexpr ModuleTaskId()
+	{
+		for (int &task_id : _task_ids) {
+			task_id = -1;
+		}
+	}
+
+	operator int() const { return _task_ids[namespace_id()]; }
+
+	ModuleTaskId &operator=(int task_id)
+	{
+		_task_ids[namespace_id()] = task_id;
+		return *this;
+	}
+
+private:
+	int _task_ids[NAMESPACES_MAX] {};
+};
+
+} // namespace px4
+
 /**
  * @class ModuleBase
  *      Base class for modules, implementing common functionality,
@@ -390,12 +438,12 @@ protected:
 
 	/**
 	 * @var _object Instance if the module is running.
-	 * @note There will be one instance for each template type.
+	 * @note There will be one instance for each template type and vehicle namespace.
 	 */
-	static px4::atomic<T *> _object;
+	static px4::ModuleObject<T> _object;
 
 	/** @var _task_id The task handle: -1 = invalid, otherwise task is assumed to be running. */
-	static int _task_id;
+	static px4::ModuleTaskId _task_id;
 
 	/** @var task_id_is_work_queue Value to indicate if the task runs on the work queue. */
 	static constexpr const int task_id_is_work_queue = -2;
@@ -422,10 +470,10 @@ private:
 };
 
 template<class T>
-px4::atomic<T *> ModuleBase<T>::_object{nullptr};
+px4::ModuleObject<T> ModuleBase<T>::_object;
 
 template<class T>
-int ModuleBase<T>::_task_id = -1;
+px4::ModuleTaskId ModuleBase<T>::_task_id;
 
 
 #endif /* __cplusplus */
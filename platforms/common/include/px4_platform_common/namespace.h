@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file namespace.h
+ *
+ * Per-thread vehicle namespace used to host several vehicles in one process.
+ *
+ * Every thread carries a namespace id (0 by default). uORB resolves topics in the
+ * DeviceMaster of the calling thread's namespace, tasks inherit the namespace of
+ * the thread that spawned them and WorkItems run in the namespace they were
+ * created in, independent of the (shared) work queue thread executing them.
+ *
+ * ModuleBase keeps one instance and task id per namespace, so a module can be
+ * started once in every namespace. Parameters, dataman and module state kept outside
+ * of ModuleBase (globals, instance arrays such as ekf2's) are still process-global,
+ * so a second complete vehicle stack cannot run in another namespace yet.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+# define PX4_NAMESPACES_MAX 16
+#else
+# define PX4_NAMESPACES_MAX 1
+#endif
+
+namespace px4
+{
+
+static constexpr uint8_t NAMESPACES_MAX = PX4_NAMESPACES_MAX;
+
+#if PX4_NAMESPACES_MAX > 1
+
+namespace detail
+{
+inline uint8_t &namespace_storage()
+{
+	static thread_local uint8_t ns = 0;
+	return ns;
+}
+} // namespace detail
+
+/**
+ * Get the namespace of the calling thread.
+ */
+inline uint8_t namespace_id() { return detail::namespace_storage(); }
+
+/**
+ * Switch the calling thread to another namespace.
+ * @return false if the namespace id is out of range
+ */
+inline bool namespace_set(uint8_t ns)
+{
+	if (ns >= NAMESPACES_MAX) {
+		return false;
+	}
+
+	detail::namespace_storage() = ns;
+	return true;
+}
+
+#else
+
+inline uint8_t namespace_id() { return 0; }
+inline bool namespace_set(uint8_t ns) { return ns == 0; }
+
+#endif // PX4_NAMESPACES_MAX > 1
+
+} // namespace px4
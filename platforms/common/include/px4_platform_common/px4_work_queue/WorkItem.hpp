@@ -39,6 +39,8 @@
 #include <containers/IntrusiveQueue.hpp>
 #include <containers/IntrusiveSortedList.hpp>
 #include <px4_platform_common/defines.h>
+#include <px4_platform_common/namespace.h>
+#include <px4_platform_common/trace.h>
 #include <drivers/drv_hrt.h>
 #include <lib/mathlib/mathlib.h>
 #include <lib/perf/perf_counter.h>
@@ -66,6 +68,7 @@ public:
 	inline void ScheduleNow()
 	{
 		if (_wq != nullptr) {
+			px4::trace::record(px4::trace::Event::Schedule, _item_name);
 			_wq->Add(this);
 		}
 	}
@@ -108,7 +111,7 @@ protected:
 		}
 	}
 
-	friend void WorkQueue::Run();
+	friend class WorkQueue; // runs the item (WorkQueue::ProcessQueuedWork())
 	virtual void Run() = 0;
 
 	/**
@@ -134,6 +137,8 @@ private:
 
 	WorkQueue	*_wq{nullptr};
 
+	const uint8_t	_namespace{px4::namespace_id()}; // namespace of the creating thread, restored for every Run()
+
 };
 
 } // namespace px4
@@ -47,6 +47,7 @@ namespace px4
 {
 
 class WorkItem;
+class WorkerPool;
 
 class WorkQueue : public IntrusiveSortedListNode<WorkQueue *>
 {
@@ -54,6 +55,19 @@ public:
 	explicit WorkQueue(const wq_config_t &wq_config);
 	WorkQueue() = delete;
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+	/**
+	 * Pooled WorkQueue without a dedicated thread, executed by the WorkerPool.
+	 */
+	WorkQueue(const wq_config_t &wq_config, WorkerPool *pool);
+
+	/**
+	 * Process all queued work (called by a pool worker).
+	 * @return true if the WorkQueue was stopped and can be deleted
+	 */
+	bool RunPooled();
+#endif // PX4_WQ_POOL_SUPPORTED
+
 	~WorkQueue();
 
 	const wq_config_t &get_config() const { return _config; }
@@ -82,6 +96,12 @@ private:
 
 	inline void SignalWorkerThread();
 
+	/**
+	 * Run all queued WorkItems. Must be called with the work lock held, which is temporarily
+	 * released while a WorkItem runs.
+	 */
+	void ProcessQueuedWork();
+
 #ifdef __PX4_NUTTX
 	// In NuttX work can be enqueued from an ISR
 	void work_lock() { _flags = enter_critical_section(); }
@@ -104,6 +124,11 @@ private:
 	int _lockstep_component {-1};
 #endif // ENABLE_LOCKSTEP_SCHEDULER
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+	WorkerPool			*_pool {nullptr};
+	bool				_pool_scheduled{false}; // protected by work_lock()
+#endif // PX4_WQ_POOL_SUPPORTED
+
 };
 
 } // namespace px4
@@ -35,6 +35,11 @@
 
 #include <stdint.h>
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+// WorkQueues can optionally be run by a fixed thread pool instead of one thread each (see PX4_WQ_POOL_THREADS)
+# define PX4_WQ_POOL_SUPPORTED
+#endif
+
 namespace px4
 {
 
@@ -51,6 +56,10 @@ namespace wq_configurations
 static constexpr wq_config_t rate_ctrl{"wq:rate_ctrl", 1888, 0}; // PX4 inner loop highest priority
 static constexpr wq_config_t ctrl_alloc{"wq:ctrl_alloc", 9500, 0}; // PX4 control allocation, same priority as rate_ctrl
 
+// sensor FIFO processing (lib/drivers/fifo_pipeline), shared by all SPI buses: same priority as the highest
+// bus queue, so that a batch is never held back by transfers on another bus
+static constexpr wq_config_t imu_process{"wq:imu_process", 2336, -1};
+
 static constexpr wq_config_t SPI0{"wq:SPI0", 2336, -1};
 static constexpr wq_config_t SPI1{"wq:SPI1", 2336, -2};
 static constexpr wq_config_t SPI2{"wq:SPI2", 2336, -3};
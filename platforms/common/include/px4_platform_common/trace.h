@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.h
+ *
+ * System-wide event trace of uORB publications and WorkItem scheduling.
+ *
+ * While tracing is active, every publication, WorkItem::ScheduleNow() and WorkItem
+ * Run() start/end is recorded with its hrt timestamp and thread into a lock-free
+ * ring, which a background thread streams to a binary file. Tools/px4trace.py
+ * converts the file into Chrome/Perfetto trace JSON and computes end-to-end
+ * latencies along the causal chain (publish -> schedule -> run -> publish ...).
+ *
+ * When tracing is off, a hook costs a single relaxed load.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+# define PX4_TRACE_SUPPORTED
+#endif
+
+#if defined(PX4_TRACE_SUPPORTED)
+#include <atomic>
+#endif
+
+namespace px4
+{
+namespace trace
+{
+
+enum class Event : uint8_t {
+	Publish  = 1, // name: topic, instance: topic instance
+	Schedule = 2, // name: WorkItem
+	RunStart = 3, // name: WorkItem
+	RunEnd   = 4, // name: WorkItem
+};
+
+#if defined(PX4_TRACE_SUPPORTED)
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+void record(Event event, const char *name, uint8_t instance);
+} // namespace detail
+
+/**
+ * Record an event if tracing is active.
+ * @param name must stay valid for the lifetime of the process (topic and WorkItem names are static)
+ */
+inline void record(Event event, const char *name, uint8_t instance = 0)
+{
+	if (detail::enabled.load(std::memory_order_relaxed)) {
+		detail::record(event, name, instance);
+	}
+}
+
+/**
+ * Start tracing into a file.
+ * @param ring_size number of buffered events, rounded up to a power of 2. Only
+ *                  used the first time, the ring is kept for the process lifetime.
+ */
+bool start(const char *path, uint32_t ring_size);
+
+/**
+ * Stop tracing and close the file.
+ */
+void stop();
+
+void print_status();
+
+#else
+
+inline void record(Event, const char *, uint8_t = 0) {}
+
+#endif // PX4_TRACE_SUPPORTED
+
+} // namespace trace
+} // namespace px4
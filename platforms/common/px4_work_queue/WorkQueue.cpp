@@ -34,10 +34,15 @@
 #include <px4_platform_common/px4_work_queue/WorkQueue.hpp>
 #include <px4_platform_common/px4_work_queue/WorkItem.hpp>
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+#include "WorkerPool.hpp"
+#endif // PX4_WQ_POOL_SUPPORTED
+
 #include <string.h>
 
 #include <px4_platform_common/tasks.h>
 #include <px4_platform_common/time.h>
+#include <px4_platform_common/trace.h>
 #include <drivers/drv_hrt.h>
 
 namespace px4
@@ -61,6 +66,19 @@ WorkQueue::WorkQueue(const wq_config_t &config) :
 	px4_sem_setprotocol(&_process_lock, SEM_PRIO_NONE);
 }
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+WorkQueue::WorkQueue(const wq_config_t &config, WorkerPool *pool) :
+	_config(config),
+	_pool(pool)
+{
+	// no thread to name, the WorkQueue is run by the pool workers
+	px4_sem_init(&_qlock, 0, 1);
+
+	px4_sem_init(&_process_lock, 0, 0);
+	px4_sem_setprotocol(&_process_lock, SEM_PRIO_NONE);
+}
+#endif // PX4_WQ_POOL_SUPPORTED
+
 WorkQueue::~WorkQueue()
 {
 	work_lock();
@@ -116,6 +134,18 @@ void WorkQueue::Add(WorkItem *item)
 #endif // ENABLE_LOCKSTEP_SCHEDULER
 
 	_q.push(item);
+
+#if defined(PX4_WQ_POOL_SUPPORTED)
+
+	if (_pool != nullptr) {
+		// pooled: scheduling state is protected by the work lock
+		SignalWorkerThread();
+		work_unlock();
+		return;
+	}
+
+#endif // PX4_WQ_POOL_SUPPORTED
+
 	work_unlock();
 
 	SignalWorkerThread();
@@ -123,6 +153,20 @@ void WorkQueue::Add(WorkItem *item)
 
 void WorkQueue::SignalWorkerThread()
 {
+#if defined(PX4_WQ_POOL_SUPPORTED)
+
+	if (_pool != nullptr) {
+		// submit to the pool at most once, so a single worker at a time runs this queue (keeps the item order)
+		if (!_pool_scheduled) {
+			_pool_scheduled = true;
+			_pool->Submit(this);
+		}
+
+		return;
+	}
+
+#endif // PX4_WQ_POOL_SUPPORTED
+
 	int sem_val;
 
 	if (px4_sem_getvalue(&_process_lock, &sem_val) == 0 && sem_val <= 0) {
@@ -148,6 +192,29 @@ void WorkQueue::Clear()
 	work_unlock();
 }
 
+void WorkQueue::ProcessQueuedWork()
+{
+	// process queued work
+	while (!_q.empty()) {
+		WorkItem *work = _q.pop();
+
+		work_unlock(); // unlock work queue to run (item may requeue itself)
+		px4::namespace_set(work->_namespace);
+		work->RunPreamble();
+		const char *item_name = work->ItemName();
+		px4::trace::record(px4::trace::Event::RunStart, item_name);
+		work->Run();
+		// Note: after Run() we cannot access work anymore, as it might have been deleted
+		px4::trace::record(px4::trace::Event::RunEnd, item_name);
+		work_lock(); // re-lock
+	}
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	px4_lockstep_unregister_component(_lockstep_component);
+	_lockstep_component = -1;
+#endif // ENABLE_LOCKSTEP_SCHEDULER
+}
+
 void WorkQueue::Run()
 {
 	while (!should_exit()) {
@@ -156,31 +223,35 @@ void WorkQueue::Run()
 
 		work_lock();
 
-		// process queued work
-		while (!_q.empty()) {
-			WorkItem *work = _q.pop();
+		ProcessQueuedWork();
 
-			work_unlock(); // unlock work queue to run (item may requeue itself)
-			work->RunPreamble();
-			work->Run();
-			// Note: after Run() we cannot access work anymore, as it might have been deleted
-			work_lock(); // re-lock
-		}
+		work_unlock();
+	}
 
-#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	PX4_DEBUG("%s: exiting", _config.name);
+}
 
-		if (_q.empty()) {
-			px4_lockstep_unregister_component(_lockstep_component);
-			_lockstep_component = -1;
-		}
+#if defined(PX4_WQ_POOL_SUPPORTED)
+bool WorkQueue::RunPooled()
+{
+	work_lock();
 
-#endif // ENABLE_LOCKSTEP_SCHEDULER
+	ProcessQueuedWork();
 
-		work_unlock();
+	// queue is empty, the next Add() submits it to the pool again
+	_pool_scheduled = false;
+
+	const bool stopped = should_exit();
+
+	work_unlock();
+
+	if (stopped) {
+		PX4_DEBUG("%s: exiting", _config.name);
 	}
 
-	PX4_DEBUG("%s: exiting", _config.name);
+	return stopped;
 }
+#endif // PX4_WQ_POOL_SUPPORTED
 
 void WorkQueue::print_status(bool last)
 {
@@ -46,8 +46,11 @@
 #include <lib/mathlib/mathlib.h>
 
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "WorkerPool.hpp"
+
 using namespace time_literals;
 
 namespace px4
@@ -61,6 +64,18 @@ static BlockingQueue<const wq_config_t *, 1> *_wq_manager_create_queue{nullptr};
 
 static px4::atomic_bool _wq_manager_should_exit{true};
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+// optional worker pool running all work queues (nullptr: one thread per work queue)
+static WorkerPool *_wq_manager_pool{nullptr};
+
+static void
+WorkQueuePooledExit(WorkQueue *wq)
+{
+	_wq_manager_wqs_list->remove(wq);
+	delete wq;
+}
+#endif // PX4_WQ_POOL_SUPPORTED
+
 
 static WorkQueue *
 FindWorkQueueByName(const char *name)
@@ -241,10 +256,43 @@ WorkQueueManagerRun(int, char **)
 	_wq_manager_wqs_list = new BlockingList<WorkQueue *>();
 	_wq_manager_create_queue = new BlockingQueue<const wq_config_t *, 1>();
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+	// PX4_WQ_POOL_THREADS=<n>: run all work queues on a shared pool of n threads
+	const char *pool_threads = getenv("PX4_WQ_POOL_THREADS");
+
+	if ((pool_threads != nullptr) && (atoi(pool_threads) > 0)) {
+		_wq_manager_pool = new WorkerPool(WorkQueuePooledExit);
+
+		if ((_wq_manager_pool == nullptr) || !_wq_manager_pool->Start(atoi(pool_threads))) {
+			PX4_ERR("worker pool start failed, using one thread per work queue");
+			delete _wq_manager_pool;
+			_wq_manager_pool = nullptr;
+		}
+	}
+
+#endif // PX4_WQ_POOL_SUPPORTED
+
 	while (!_wq_manager_should_exit.load()) {
 		// create new work queues as needed
 		const wq_config_t *wq = _wq_manager_create_queue->pop();
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+
+		if ((wq != nullptr) && (_wq_manager_pool != nullptr)) {
+			WorkQueue *pooled_wq = new WorkQueue(*wq, _wq_manager_pool);
+
+			if (pooled_wq != nullptr) {
+				_wq_manager_wqs_list->add(pooled_wq);
+
+			} else {
+				PX4_ERR("failed to create %s", wq->name);
+			}
+
+			continue;
+		}
+
+#endif // PX4_WQ_POOL_SUPPORTED
+
 		if (wq != nullptr) {
 			// create new work queue
 
@@ -319,6 +367,11 @@ WorkQueueManagerRun(int, char **)
 		}
 	}
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+	delete _wq_manager_pool;
+	_wq_manager_pool = nullptr;
+#endif // PX4_WQ_POOL_SUPPORTED
+
 	return 0;
 }
 
@@ -427,6 +480,15 @@ WorkQueueManagerStatus()
 			wq->print_status(last_wq);
 		}
 
+#if defined(PX4_WQ_POOL_SUPPORTED)
+
+		if (_wq_manager_pool != nullptr) {
+			PX4_INFO_RAW("\n");
+			_wq_manager_pool->print_status();
+		}
+
+#endif // PX4_WQ_POOL_SUPPORTED
+
 	} else {
 		PX4_INFO("not running");
 	}
@@ -0,0 +1,261 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "WorkerPool.hpp"
+
+#if defined(PX4_WQ_POOL_SUPPORTED)
+
+#include <px4_platform_common/px4_work_queue/WorkQueue.hpp>
+
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/posix.h>
+#include <lib/mathlib/mathlib.h>
+
+#include <inttypes.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace px4
+{
+
+thread_local WorkerPool::Worker *WorkerPool::_current_worker{nullptr};
+
+WorkerPool::WorkerPool(void (*exit_cb)(WorkQueue *wq)) :
+	_exit_cb(exit_cb)
+{
+	px4_sem_init(&_work_available, 0, 0);
+	px4_sem_setprotocol(&_work_available, SEM_PRIO_NONE);
+}
+
+WorkerPool::~WorkerPool()
+{
+	Stop();
+	px4_sem_destroy(&_work_available);
+}
+
+bool WorkerPool::Start(int num_workers)
+{
+	num_workers = math::constrain(num_workers, 1, MAX_WORKERS);
+
+	// the workers run every WorkQueue, so size their stack for the largest configuration
+	const unsigned int page_size = sysconf(_SC_PAGESIZE);
+	const size_t stacksize_adj = math::max((size_t)PTHREAD_STACK_MIN,
+				     (size_t)PX4_STACK_ADJUSTED(wq_configurations::ctrl_alloc.stacksize));
+	const size_t stacksize = (stacksize_adj + page_size - (stacksize_adj % page_size));
+
+	for (int i = 0; i < num_workers; i++) {
+		Worker &worker = _workers[i];
+		worker.pool = this;
+		worker.index = i;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setstacksize(&attr, stacksize);
+
+		int ret_create = pthread_create(&worker.thread, &attr, WorkerTrampoline, &worker);
+		pthread_attr_destroy(&attr);
+
+		if (ret_create != 0) {
+			PX4_ERR("failed to create pool worker %d (%i): %s", i, ret_create, strerror(ret_create));
+			break;
+		}
+
+		// the workers already running read it, a new one is considered once it was created
+		_num_workers.fetch_add(1);
+	}
+
+	PX4_DEBUG("started %d pool workers, stack: %zu bytes", _num_workers.load(), stacksize);
+
+	return _num_workers.load() > 0;
+}
+
+void WorkerPool::Stop()
+{
+	const int num_workers = _num_workers.load();
+
+	if (num_workers == 0) {
+		return;
+	}
+
+	_should_exit.store(true);
+
+	for (int i = 0; i < num_workers; i++) {
+		px4_sem_post(&_work_available);
+	}
+
+	for (int i = 0; i < num_workers; i++) {
+		pthread_join(_workers[i].thread, nullptr);
+	}
+
+	_num_workers.store(0);
+}
+
+void WorkerPool::Submit(WorkQueue *wq)
+{
+	// keep work submitted from a worker on that worker, everything else is distributed round robin
+	int index = (_current_worker != nullptr && _current_worker->pool == this) ? _current_worker->index : -1;
+
+	if (index < 0) {
+		index = (unsigned)_next_worker.fetch_add(1) % _num_workers.load();
+	}
+
+	Worker &worker = _workers[index];
+	const int8_t priority = wq->get_config().relative_priority;
+
+	pthread_mutex_lock(&worker.mutex);
+
+	// insert behind all queued WorkQueues of the same or higher priority
+	auto it = worker.queue.begin();
+
+	while ((it != worker.queue.end()) && ((*it)->get_config().relative_priority >= priority)) {
+		++it;
+	}
+
+	worker.queue.insert(it, wq);
+	UpdateTopPriority(worker);
+	pthread_mutex_unlock(&worker.mutex);
+
+	px4_sem_post(&_work_available);
+}
+
+void WorkerPool::UpdateTopPriority(Worker &worker)
+{
+	worker.top_priority.store(worker.queue.empty() ? NONE : worker.queue.front()->get_config().relative_priority);
+}
+
+WorkQueue *WorkerPool::Pop(Worker &worker)
+{
+	while (true) {
+		// pick the run queue with the highest priority WorkQueue, the own one on a tie
+		Worker *source = &worker;
+		int priority = worker.top_priority.load();
+		const int num_workers = _num_workers.load();
+
+		for (int i = 1; i < num_workers; i++) {
+			Worker &victim = _workers[(worker.index + i) % num_workers];
+			const int victim_priority = victim.top_priority.load();
+
+			if (victim_priority > priority) {
+				source = &victim;
+				priority = victim_priority;
+			}
+		}
+
+		if (priority == NONE) {
+			return nullptr;
+		}
+
+		WorkQueue *wq = nullptr;
+
+		pthread_mutex_lock(&source->mutex);
+
+		if (!source->queue.empty()) {
+			wq = source->queue.front();
+			source->queue.pop_front();
+			UpdateTopPriority(*source);
+		}
+
+		pthread_mutex_unlock(&source->mutex);
+
+		if (wq != nullptr) {
+			if (source != &worker) {
+				worker.steals++;
+			}
+
+			return wq;
+		}
+
+		// taken by another worker in the meantime, look again
+	}
+}
+
+void *WorkerPool::WorkerTrampoline(void *context)
+{
+	Worker *worker = static_cast<Worker *>(context);
+
+	char name[16];
+	snprintf(name, sizeof(name), "wq:pool%d", worker->index);
+#ifdef __PX4_DARWIN
+	pthread_setname_np(name);
+#else
+	pthread_setname_np(pthread_self(), name);
+#endif
+
+	_current_worker = worker;
+	worker->pool->WorkerRun(*worker);
+
+	return nullptr;
+}
+
+void WorkerPool::WorkerRun(Worker &worker)
+{
+	while (!_should_exit.load()) {
+		WorkQueue *wq = Pop(worker);
+
+		if (wq == nullptr) {
+			// loop as the wait may be interrupted by a signal
+			do {} while (px4_sem_wait(&_work_available) != 0);
+
+			continue;
+		}
+
+		worker.runs++;
+
+		if (wq->RunPooled() && _exit_cb) {
+			_exit_cb(wq);
+		}
+	}
+}
+
+void WorkerPool::print_status()
+{
+	const int num_workers = _num_workers.load();
+
+	PX4_INFO_RAW("Worker pool: %d threads\n", num_workers);
+
+	for (int i = 0; i < num_workers; i++) {
+		Worker &worker = _workers[i];
+
+		pthread_mutex_lock(&worker.mutex);
+		const size_t queued = worker.queue.size();
+		pthread_mutex_unlock(&worker.mutex);
+
+		PX4_INFO_RAW("  wq:pool%-2d runs: %8" PRIu64 " steals: %8" PRIu64 " queued: %zu\n",
+			     i, worker.runs, worker.steals, queued);
+	}
+}
+
+} // namespace px4
+
+#endif // PX4_WQ_POOL_SUPPORTED
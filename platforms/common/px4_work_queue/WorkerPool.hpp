@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file WorkerPool.hpp
+ *
+ * Optional POSIX backend for the WorkQueueManager: instead of one thread per
+ * WorkQueue, all WorkQueues are executed by a fixed pool of worker threads.
+ *
+ * A WorkQueue is submitted to the pool when it gets work and is held by at most
+ * one worker at a time, so the ordering of WorkItems within a WorkQueue is
+ * unchanged.
+ *
+ * Every worker has its own run queue, ordered by the relative priority of the
+ * WorkQueues (FIFO within the same priority). Work submitted from a worker stays
+ * on that worker, everything else is distributed round robin. A free worker takes
+ * the highest priority WorkQueue that is ready, from its own run queue or stolen
+ * from another worker (its own on a tie), so e.g. wq:rate_ctrl is picked before
+ * wq:lp_default even if it was queued behind a busy worker.
+ *
+ * A WorkItem that is already running is not preempted though: if all workers are
+ * busy, a high priority WorkQueue waits until one of them finishes its current
+ * queue. The pool is therefore meant for SITL throughput (e.g. many simulated
+ * vehicles or faster than realtime lockstep), not for real-time targets.
+ */
+
+#pragma once
+
+#include <px4_platform_common/px4_work_queue/WorkQueueManager.hpp>
+
+#if defined(PX4_WQ_POOL_SUPPORTED)
+
+#include <px4_platform_common/atomic.h>
+#include <px4_platform_common/sem.h>
+
+#include <deque>
+#include <limits.h>
+#include <pthread.h>
+
+namespace px4
+{
+
+class WorkerPool
+{
+public:
+	static constexpr int MAX_WORKERS = 32;
+
+	/**
+	 * @param exit_cb called from a worker thread once a WorkQueue was stopped (has no WorkItems left)
+	 */
+	explicit WorkerPool(void (*exit_cb)(WorkQueue *wq));
+	~WorkerPool();
+
+	/**
+	 * Start the worker threads.
+	 * @param num_workers number of threads, clipped to [1, MAX_WORKERS]
+	 */
+	bool Start(int num_workers);
+	void Stop();
+
+	/**
+	 * Queue a WorkQueue for execution. The caller must ensure a WorkQueue is not submitted again
+	 * before it has been run (see WorkQueue::Add()).
+	 */
+	void Submit(WorkQueue *wq);
+
+	int num_workers() const { return _num_workers.load(); }
+
+	void print_status();
+
+private:
+
+	struct Worker {
+		WorkerPool *pool{nullptr};
+		int index{0};
+		pthread_t thread{};
+
+		pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+		std::deque<WorkQueue *> queue{}; // ordered by descending relative priority, protected by mutex
+		px4::atomic<int> top_priority{NONE}; // priority of the first queued WorkQueue, read without the mutex
+
+		uint64_t runs{0};
+		uint64_t steals{0};
+	};
+
+	static constexpr int NONE = INT_MIN;
+
+	static void *WorkerTrampoline(void *context);
+	void WorkerRun(Worker &worker);
+
+	/**
+	 * Take the highest priority ready WorkQueue, stealing it from another worker if needed.
+	 * @return nullptr if none is ready
+	 */
+	WorkQueue *Pop(Worker &worker);
+
+	static void UpdateTopPriority(Worker &worker);
+
+	static thread_local Worker *_current_worker;
+
+	Worker _workers[MAX_WORKERS] {};
+	px4::atomic<int> _num_workers{0};
+
+	px4_sem_t _work_available;
+	px4::atomic_bool _should_exit{false};
+	px4::atomic<int> _next_worker{0};
+
+	void (*_exit_cb)(WorkQueue *wq) {nullptr};
+};
+
+} // namespace px4
+
+#endif // PX4_WQ_POOL_SUPPORTED
@@ -33,6 +33,7 @@
 
 #pragma once
 
+#include <drivers/drv_hrt.h>
 #include <px4_platform_common/app.h>
 #include <px4_platform_common/px4_work_queue/WorkItem.hpp>
 #include <string.h>
@@ -54,4 +55,7 @@ private:
 	void Run() override;
 
 	int _iter{0};
+
+	hrt_abstime _time_first_run{0};
+	hrt_abstime _time_last_run{0};
 };
@@ -69,7 +69,12 @@ int uorb_start(void)
 int uorb_status(void)
 {
 	if (g_dev != nullptr) {
-		g_dev->printStatistics();
+		// report the topics of the caller's namespace
+		uORB::DeviceMaster *device_master = uORB::Manager::get_instance()->get_device_master();
+
+		if (device_master != nullptr) {
+			device_master->printStatistics();
+		}
 
 	} else {
 		PX4_INFO("uorb is not running");
@@ -81,7 +86,12 @@ int uorb_status(void)
 int uorb_top(char **topic_filter, int num_filters)
 {
 	if (g_dev != nullptr) {
-		g_dev->showTop(topic_filter, num_filters);
+		// report the topics of the caller's namespace
+		uORB::DeviceMaster *device_master = uORB::Manager::get_instance()->get_device_master();
+
+		if (device_master != nullptr) {
+			device_master->showTop(topic_filter, num_filters);
+		}
 
 	} else {
 		PX4_INFO("uorb is not running");
@@ -38,6 +38,8 @@
 
 #include "SubscriptionCallback.hpp"
 
+#include <px4_platform_common/trace.h>
+
 #ifdef ORB_COMMUNICATOR
 #include "uORBCommunicator.hpp"
 #endif /* ORB_COMMUNICATOR */
@@ -253,6 +255,9 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 
 	memcpy(_data + (_meta->o_size * (generation % _queue_size)), buffer, _meta->o_size);
 
+	// before the callbacks, so the trace shows the publication as cause of the scheduled WorkItems
+	px4::trace::record(px4::trace::Event::Publish, _meta->o_name, _instance);
+
 	// callbacks
 	for (auto item : _callbacks) {
 		item->call();
@@ -50,6 +50,22 @@ bool uORB::Manager::initialize()
 {
 	if (_Instance == nullptr) {
 		_Instance = new uORB::Manager();
+
+		if (_Instance == nullptr) {
+			return false;
+		}
+
+		// create the DeviceMasters of all namespaces up front, so that looking them up
+		// later is lock-free and threads entering a new namespace cannot race on creation
+		for (DeviceMaster *&device_master : _Instance->_device_master) {
+			device_master = new DeviceMaster();
+
+			if (device_master == nullptr) {
+				PX4_ERR("Failed to allocate DeviceMaster");
+				terminate();
+				return false;
+			}
+		}
 	}
 
 	return _Instance != nullptr;
@@ -86,21 +102,14 @@ uORB::Manager::Manager()
 
 uORB::Manager::~Manager()
 {
-	delete _device_master;
+	for (DeviceMaster *device_master : _device_master) {
+		delete device_master;
+	}
 }
 
 uORB::DeviceMaster *uORB::Manager::get_device_master()
 {
-	if (!_device_master) {
-		_device_master = new DeviceMaster();
-
-		if (_device_master == nullptr) {
-			PX4_ERR("Failed to allocate DeviceMaster");
-			errno = ENOMEM;
-		}
-	}
-
-	return _device_master;
+	return _device_master[px4::namespace_id()];
 }
 
 int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
@@ -112,8 +121,10 @@ int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 		return ret;
 	}
 
-	if (get_device_master()) {
-		uORB::DeviceNode *node = _device_master->getDeviceNode(meta, instance);
+	DeviceMaster *device_master = get_device_master();
+
+	if (device_master) {
+		uORB::DeviceNode *node = device_master->getDeviceNode(meta, instance);
 
 		if (node != nullptr) {
 			if (node->is_advertised()) {
@@ -359,8 +370,10 @@ int uORB::Manager::node_open(const struct orb_metadata *meta, bool advertiser, i
 
 		ret = PX4_ERROR;
 
-		if (get_device_master()) {
-			ret = _device_master->advertise(meta, advertiser, instance);
+		DeviceMaster *device_master = get_device_master();
+
+		if (device_master) {
+			ret = device_master->advertise(meta, advertiser, instance);
 		}
 
 		/* it's OK if it already exists */
@@ -37,6 +37,8 @@
 #include "uORBCommon.hpp"
 #include "uORBDeviceMaster.hpp"
 
+#include <px4_platform_common/namespace.h>
+
 #include <stdint.h>
 
 #ifdef __PX4_NUTTX
@@ -89,10 +91,8 @@ public:
 	static uORB::Manager *get_instance() { return _Instance; }
 
 	/**
-	 * Get the DeviceMaster. If it does not exist,
-	 * it will be created and initialized.
-	 * Note: the first call to this is not thread-safe.
-	 * @return nullptr if initialization failed (and errno will be set)
+	 * Get the DeviceMaster of the calling thread's namespace (see px4_platform_common/namespace.h).
+	 * The DeviceMasters of all namespaces are created in initialize().
 	 */
 	uORB::DeviceMaster *get_device_master();
 
@@ -379,7 +379,7 @@ private: // data members
 	ORBSet _remote_topics;
 #endif /* ORB_COMMUNICATOR */
 
-	DeviceMaster *_device_master{nullptr};
+	DeviceMaster *_device_master[px4::NAMESPACES_MAX] {};
 
 private: //class methods
 	Manager();
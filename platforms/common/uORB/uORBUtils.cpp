@@ -32,9 +32,22 @@
  ****************************************************************************/
 
 #include "uORBUtils.hpp"
+#include <px4_platform_common/namespace.h>
 #include <stdio.h>
 #include <errno.h>
 
+// topics of namespace 0 keep the plain /obj/<topic><instance> path
+static int node_mkpath_ns(char *buf, const char *name, unsigned index)
+{
+	const uint8_t ns = px4::namespace_id();
+
+	if (ns == 0) {
+		return snprintf(buf, uORB::orb_maxpath, "/%s/%s%d", "obj", name, index);
+	}
+
+	return snprintf(buf, uORB::orb_maxpath, "/%s/ns%d/%s%d", "obj", ns, name, index);
+}
+
 int uORB::Utils::node_mkpath(char *buf, const struct orb_metadata *meta, int *instance)
 {
 	unsigned len;
@@ -45,7 +58,7 @@ int uORB::Utils::node_mkpath(char *buf, const struct orb_metadata *meta, int *in
 		index = *instance;
 	}
 
-	len = snprintf(buf, orb_maxpath, "/%s/%s%d", "obj", meta->o_name, index);
+	len = node_mkpath_ns(buf, meta->o_name, index);
 
 	if (len >= orb_maxpath) {
 		return -ENAMETOOLONG;
@@ -62,7 +75,7 @@ int uORB::Utils::node_mkpath(char *buf, const char *orbMsgName)
 
 	unsigned index = 0;
 
-	len = snprintf(buf, orb_maxpath, "/%s/%s%d", "obj", orbMsgName, index);
+	len = node_mkpath_ns(buf, orbMsgName, index);
 
 	if (len >= orb_maxpath) {
 		return -ENAMETOOLONG;
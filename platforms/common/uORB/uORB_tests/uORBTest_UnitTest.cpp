@@ -34,6 +34,7 @@
 #include "uORBTest_UnitTest.hpp"
 #include "../uORBCommon.hpp"
 #include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/namespace.h>
 #include <px4_platform_common/time.h>
 #include <stdio.h>
 #include <errno.h>
@@ -164,6 +165,12 @@ int uORBTest::UnitTest::test()
 		return ret;
 	}
 
+	ret = test_namespace();
+
+	if (ret != OK) {
+		return ret;
+	}
+
 	ret = test_SubscriptionMulti();
 
 	if (ret != OK) {
@@ -320,6 +327,65 @@ int uORBTest::UnitTest::test_single()
 	return test_note("PASS single-topic test");
 }
 
+int uORBTest::UnitTest::test_namespace()
+{
+	if (px4::NAMESPACES_MAX < 2) {
+		return test_note("SKIP namespace test (single namespace)");
+	}
+
+	test_note("try namespace isolation");
+
+	orb_test_s t{};
+	t.val = 10;
+	orb_advert_t ptopic0 = orb_advertise(ORB_ID(orb_test), &t);
+
+	if (ptopic0 == nullptr) {
+		return test_fail("advertise (ns 0) failed: %d", errno);
+	}
+
+	px4::namespace_set(1);
+
+	if (orb_exists(ORB_ID(orb_test), 0) == PX4_OK) {
+		px4::namespace_set(0);
+		return test_fail("topic of ns 0 visible in ns 1");
+	}
+
+	t.val = 11;
+	orb_advert_t ptopic1 = orb_advertise(ORB_ID(orb_test), &t);
+	int sfd1 = orb_subscribe(ORB_ID(orb_test));
+
+	px4::namespace_set(0);
+
+	if (ptopic1 == nullptr || sfd1 < 0) {
+		return test_fail("advertise/subscribe (ns 1) failed: %d", errno);
+	}
+
+	int sfd0 = orb_subscribe(ORB_ID(orb_test));
+
+	if (sfd0 < 0) {
+		return test_fail("subscribe (ns 0) failed: %d", errno);
+	}
+
+	orb_test_s u{};
+
+	if (PX4_OK != orb_copy(ORB_ID(orb_test), sfd0, &u) || u.val != 10) {
+		return test_fail("ns 0 mismatch: %d expected 10", u.val);
+	}
+
+	if (PX4_OK != orb_copy(ORB_ID(orb_test), sfd1, &u) || u.val != 11) {
+		return test_fail("ns 1 mismatch: %d expected 11", u.val);
+	}
+
+	orb_unsubscribe(sfd0);
+	orb_unsubscribe(sfd1);
+
+	if (orb_unadvertise(ptopic0) != PX4_OK || orb_unadvertise(ptopic1) != PX4_OK) {
+		return test_fail("orb_unadvertise failed");
+	}
+
+	return test_note("PASS namespace test");
+}
+
 int uORBTest::UnitTest::test_multi()
 {
 	/* this routine tests the multi-topic support */
@@ -135,6 +135,7 @@ function(px4_posix_generate_alias)
 		ARGN ${ARGN})
 
 	set(alias_string)
+	set(batch_alias_string)
 	foreach(module ${MODULE_LIST})
 		foreach(property MAIN STACK PRIORITY)
 			get_target_property(${property} ${module} ${property})
@@ -144,11 +145,14 @@ function(px4_posix_generate_alias)
 		endforeach()
 		if (MAIN)
 			set(alias_string
-				"${alias_string}alias ${MAIN}='${PREFIX}${MAIN} --instance $px4_instance'\n"
+				"${alias_string}	alias ${MAIN}='${PREFIX}${MAIN} --instance $px4_instance'\n"
+			)
+			set(batch_alias_string
+				"${batch_alias_string}	alias ${MAIN}='_px4_batch ${MAIN}'\n"
 			)
 		endif()
 	endforeach()
-	configure_file(${PX4_SOURCE_DIR}/platforms/posix/src/px4/common/px4-alias.sh_in ${OUT})
+	configure_file(${PX4_SOURCE_DIR}/platforms/posix/src/px4/common/px4-alias.sh_in ${OUT} @ONLY)
 endfunction()
 
 
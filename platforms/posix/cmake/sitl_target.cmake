@@ -89,6 +89,8 @@ set(viewers
 	none
 	jmavsim
 	gazebo
+	sih
+	shm_standin
 )
 
 set(debuggers
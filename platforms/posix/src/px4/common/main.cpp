@@ -124,6 +124,7 @@ int main(int argc, char **argv)
 {
 	bool is_client = false;
 	bool pxh_off = false;
+	bool batch_startup = true;
 
 	/* Symlinks point to all commands that can be used as a client with a prefix. */
 	const char prefix[] = PX4_SHELL_COMMAND_PREFIX;
@@ -206,7 +207,7 @@ int main(int argc, char **argv)
 		int ch;
 		const char *myoptarg = nullptr;
 
-		while ((ch = px4_getopt(argc, argv, "hdt:s:i:w:", &myoptind, &myoptarg)) != EOF) {
+		while ((ch = px4_getopt(argc, argv, "hdnt:s:i:w:", &myoptind, &myoptarg)) != EOF) {
 			switch (ch) {
 			case 'h':
 				print_usage();
@@ -216,6 +217,10 @@ int main(int argc, char **argv)
 				pxh_off = true;
 				break;
 
+			case 'n':
+				batch_startup = false;
+				break;
+
 			case 't':
 				test_data_path = myoptarg;
 				break;
@@ -302,8 +307,24 @@ int main(int argc, char **argv)
 		px4::init_once();
 		px4::init(argc, argv, "px4");
 
+		// Let px4-alias.sh run the commands of the startup script in-process,
+		// instead of spawning a px4-<module> client process for each of them.
+		if (batch_startup && server.start_batch() == 0) {
+			setenv("PX4_BATCH_CMD", px4_daemon::get_batch_cmd_path(instance).c_str(), 1);
+			setenv("PX4_BATCH_RET", px4_daemon::get_batch_ret_path(instance).c_str(), 1);
+
+		} else {
+			batch_startup = false;
+		}
+
 		ret = run_startup_script(commands_file, absolute_binary_path, instance);
 
+		if (batch_startup) {
+			server.stop_batch();
+			unsetenv("PX4_BATCH_CMD");
+			unsetenv("PX4_BATCH_RET");
+		}
+
 		if (ret != 0) {
 			return PX4_ERROR;
 		}
@@ -534,10 +555,18 @@ int run_startup_script(const std::string &commands_file, const std::string &abso
 	int ret = 0;
 
 	if (!shell_command.empty()) {
+		// wall clock, the lockstep time only starts with the simulator
+		struct timespec start_ts;
+		system_clock_gettime(CLOCK_MONOTONIC, &start_ts);
+
 		ret = system(shell_command.c_str());
 
+		struct timespec end_ts;
+		system_clock_gettime(CLOCK_MONOTONIC, &end_ts);
+		const long elapsed_ms = (end_ts.tv_sec - start_ts.tv_sec) * 1000 + (end_ts.tv_nsec - start_ts.tv_nsec) / 1000000;
+
 		if (ret == 0) {
-			PX4_INFO("Startup script returned successfully");
+			PX4_INFO("Startup script returned successfully (%li ms)", elapsed_ms);
 
 		} else {
 			PX4_ERR("Startup script returned with return value: %d", ret);
@@ -562,7 +591,7 @@ void print_usage()
 {
 	printf("Usage for Server/daemon process: \n");
 	printf("\n");
-	printf("    px4 [-h|-d] [-s <startup_file>] [-t <test_data_directory>] [<rootfs_directory>] [-i <instance>] [-w <working_directory>]\n");
+	printf("    px4 [-h|-d|-n] [-s <startup_file>] [-t <test_data_directory>] [<rootfs_directory>] [-i <instance>] [-w <working_directory>]\n");
 	printf("\n");
 	printf("    -s <startup_file>      shell script to be used as startup (default=etc/init.d/rcS)\n");
 	printf("    <rootfs_directory>     directory where startup files and mixers are located,\n");
@@ -571,6 +600,8 @@ void print_usage()
 	printf("    -w <working_directory> directory to change to\n");
 	printf("    -h                     help/usage information\n");
 	printf("    -d                     daemon mode, don't start pxh shell\n");
+	printf("    -n                     run each startup script command in a separate client process\n");
+	printf("                           (default: run them in-process through the batch FIFOs)\n");
 	printf("\n");
 	printf("Usage for client: \n");
 	printf("\n");
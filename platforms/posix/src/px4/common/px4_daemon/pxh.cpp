@@ -44,6 +44,9 @@
 #include <sstream>
 #include <vector>
 #include <stdio.h>
+#include <stdlib.h>
+
+#include <px4_platform_common/namespace.h>
 
 #include "pxh.h"
 
@@ -73,10 +76,6 @@ int Pxh::process_line(const std::string &line, bool silently_fail)
 		return 0;
 	}
 
-	if (_apps.empty()) {
-		init_app_map(_apps);
-	}
-
 	std::stringstream line_stream(line);
 	std::string word;
 	std::vector<std::string> words;
@@ -86,10 +85,19 @@ int Pxh::process_line(const std::string &line, bool silently_fail)
 		words.push_back(word);
 	}
 
+	return process_words(words, silently_fail);
+}
+
+int Pxh::process_words(const std::vector<std::string> &words, bool silently_fail)
+{
 	if (words.empty()) {
 		return 0;
 	}
 
+	if (_apps.empty()) {
+		init_app_map(_apps);
+	}
+
 	const std::string &command(words.front());
 
 	if (_apps.find(command) != _apps.end()) {
@@ -119,6 +127,24 @@ int Pxh::process_line(const std::string &line, bool silently_fail)
 		list_builtins(_apps);
 		return 0;
 
+	} else if (command == "ns") {
+		// run a command in another vehicle namespace: ns <id> <command> [args...]
+		const int ns = (words.size() > 2) ? atoi(words[1].c_str()) : -1;
+
+		if (ns < 0 || ns >= px4::NAMESPACES_MAX) {
+			printf("usage: ns <0-%d> <command> [args...]\n", px4::NAMESPACES_MAX - 1);
+			return -1;
+		}
+
+		// pass the remaining words on as they are instead of joining and splitting them again
+		const std::vector<std::string> ns_words(words.begin() + 2, words.end());
+
+		const uint8_t prev_ns = px4::namespace_id();
+		px4::namespace_set(ns);
+		int retval = process_words(ns_words, silently_fail);
+		px4::namespace_set(prev_ns);
+		return retval;
+
 	} else if (command.length() == 0 || command[0] == '#') {
 		// Do nothing
 		return 0;
@@ -66,6 +66,13 @@ public:
 	 * @return 0 if successful. */
 	static int process_line(const std::string &line, bool silently_fail);
 
+	/**
+	 * Run one command that is already split into words (e.g. argv).
+	 *
+	 * @param silently_fail: don't make a fuss on failure
+	 * @return 0 if successful. */
+	static int process_words(const std::vector<std::string> &words, bool silently_fail);
+
 	/**
 	 * Run the pxh shell. This will only return if stop() is called.
 	 */
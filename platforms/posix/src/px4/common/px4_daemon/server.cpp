@@ -41,6 +41,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <string>
@@ -103,6 +104,12 @@ Server::start()
 		return -1;
 	}
 
+	// Created before any thread that might use it (server and batch thread).
+	if (pthread_key_create(&_key, _pthread_key_destructor) != 0) {
+		PX4_ERR("failed to create pthread key");
+		return -1;
+	}
+
 	if (0 != pthread_create(&_server_main_pthread,
 				nullptr,
 				_server_main_trampoline,
@@ -129,13 +136,6 @@ void Server::_pthread_key_destructor(void *arg)
 void
 Server::_server_main()
 {
-	int ret = pthread_key_create(&_key, _pthread_key_destructor);
-
-	if (ret != 0) {
-		PX4_ERR("failed to create pthread key");
-		return;
-	}
-
 	// The list of file descriptors to watch.
 	std::vector<pollfd> poll_fds;
 
@@ -179,7 +179,7 @@ Server::_server_main()
 
 				// Start a new thread to handle the client.
 				pthread_t *thread = &_fd_to_thread[client];
-				ret = pthread_create(thread, nullptr, Server::_handle_client, thread_stdout);
+				int ret = pthread_create(thread, nullptr, Server::_handle_client, thread_stdout);
 
 				if (ret != 0) {
 					PX4_ERR("could not start pthread (%i)", ret);
@@ -227,6 +227,120 @@ Server::_server_main()
 	close(_fd);
 }
 
+int
+Server::start_batch()
+{
+	const std::string cmd_path = get_batch_cmd_path(_instance_id);
+	const std::string ret_path = get_batch_ret_path(_instance_id);
+
+	// Delete FIFOs in case they exist already.
+	unlink(cmd_path.c_str());
+	unlink(ret_path.c_str());
+
+	if (mkfifo(cmd_path.c_str(), 0600) != 0 || mkfifo(ret_path.c_str(), 0600) != 0) {
+		PX4_ERR("error creating batch FIFOs: %s", strerror(errno));
+		unlink(cmd_path.c_str());
+		return -1;
+	}
+
+	if (0 != pthread_create(&_batch_pthread,
+				nullptr,
+				_batch_main_trampoline,
+				this)) {
+		PX4_ERR("error creating batch thread");
+		unlink(cmd_path.c_str());
+		unlink(ret_path.c_str());
+		return -1;
+	}
+
+	pthread_detach(_batch_pthread);
+
+	return 0;
+}
+
+void *
+Server::_batch_main_trampoline(void *self)
+{
+	((Server *)self)->_batch_main();
+	return nullptr;
+}
+
+void
+Server::_batch_main()
+{
+	const std::string cmd_path = get_batch_cmd_path(_instance_id);
+	const std::string ret_path = get_batch_ret_path(_instance_id);
+
+	// Blocks until the script opens its end (or stop_batch() releases us).
+	FILE *in = fopen(cmd_path.c_str(), "r");
+
+	// Opening read-write does not block on a FIFO, the script opens its read end right after.
+	// The FIFOs are removed by stop_batch() once the script returned.
+	FILE *out = in ? fopen(ret_path.c_str(), "r+") : nullptr;
+
+	if (in == nullptr || out == nullptr) {
+		PX4_ERR("error opening batch FIFOs: %s", strerror(errno));
+
+		if (in) {
+			fclose(in);
+		}
+
+		return;
+	}
+
+	CmdThreadSpecificData *thread_data_ptr = new CmdThreadSpecificData;
+	thread_data_ptr->thread_stdout = out;
+	thread_data_ptr->is_atty = false;
+	(void)pthread_setspecific(_key, (void *)thread_data_ptr);
+
+	// Each command is its argument count followed by the arguments, all NUL-terminated.
+	// The arguments are passed on as they are, without joining and splitting them again.
+	char *field = nullptr;
+	size_t field_size = 0;
+	std::vector<std::string> args;
+
+	while (getdelim(&field, &field_size, '\0', in) > 0) {
+		const int argc = atoi(field);
+		args.clear();
+
+		while ((int)args.size() < argc && getdelim(&field, &field_size, '\0', in) > 0) {
+			args.emplace_back(field);
+		}
+
+		if ((int)args.size() < argc) {
+			break;
+		}
+
+		int retval = Pxh::process_words(args, true);
+
+		// The output is not necessarily terminated by a newline, the marker can follow on the same line.
+		fprintf(out, "\004%u\n", (uint8_t)retval);
+		fflush(out);
+	}
+
+	free(field);
+
+	thread_data_ptr->thread_stdout = nullptr;
+	fclose(out);
+	fclose(in);
+}
+
+void
+Server::stop_batch()
+{
+	// If the script never opened the FIFOs, the batch thread is still blocked in
+	// opening its end. Open and close the other end, so that it reads EOF and exits.
+	const std::string cmd_path = get_batch_cmd_path(_instance_id);
+	int fd = open(cmd_path.c_str(), O_WRONLY | O_NONBLOCK);
+
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	unlink(cmd_path.c_str());
+	unlink(get_batch_ret_path(_instance_id).c_str());
+}
+
 void
 *Server::_handle_client(void *arg)
 {
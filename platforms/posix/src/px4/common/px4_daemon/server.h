@@ -39,6 +39,11 @@
  * The server will return the stdout of the executing command, as well as the return
  * value to the client.
  *
+ * For startup scripts the server can additionally serve a FIFO pair (batch mode):
+ * the script writes the argument count and the arguments of each command, all
+ * NUL-terminated, and reads back the command output terminated by "\004<retval>\n". This runs all commands of a script in-process
+ * over a single channel, instead of spawning a client process for each.
+ *
  * There should only every be one server running, therefore the static instance.
  * The Singleton implementation is not complete, but it should be obvious not
  * to instantiate multiple servers.
@@ -75,6 +80,21 @@ public:
 	 */
 	int start();
 
+	/**
+	 * Create the batch FIFOs (see get_batch_cmd_path()) and spawn a thread that
+	 * executes the command lines written to them, one at a time, until the
+	 * writing side closes the FIFO.
+	 *
+	 * @return 0 if started successfully
+	 */
+	int start_batch();
+
+	/**
+	 * Release the batch thread after the startup script returned, in case the
+	 * script did not use the batch FIFOs.
+	 */
+	void stop_batch();
+
 	struct CmdThreadSpecificData {
 		FILE *thread_stdout; // stdout of this thread
 		bool is_atty; // whether file descriptor refers to a terminal
@@ -103,10 +123,14 @@ private:
 		pthread_mutex_unlock(&_mutex);
 	}
 
+	static void *_batch_main_trampoline(void *arg);
+	void _batch_main();
+
 	static void *_handle_client(void *arg);
 	static void _cleanup(int fd);
 
 	pthread_t _server_main_pthread;
+	pthread_t _batch_pthread;
 
 	std::map<int, pthread_t> _fd_to_thread;
 	pthread_mutex_t _mutex; ///< Protects _fd_to_thread.
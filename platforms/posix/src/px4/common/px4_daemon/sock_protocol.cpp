@@ -47,5 +47,15 @@ std::string get_socket_path(int instance_id)
 	return "/tmp/px4-sock-" + std::to_string(instance_id);
 }
 
+std::string get_batch_cmd_path(int instance_id)
+{
+	return "/tmp/px4-batch-cmd-" + std::to_string(instance_id);
+}
+
+std::string get_batch_ret_path(int instance_id)
+{
+	return "/tmp/px4-batch-ret-" + std::to_string(instance_id);
+}
+
 } // namespace px4_daemon
 
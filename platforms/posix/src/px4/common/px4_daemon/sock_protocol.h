@@ -44,5 +44,17 @@ namespace px4_daemon
 
 std::string get_socket_path(int instance_id);
 
+/**
+ * FIFO through which a startup script sends command lines to the server
+ * (see Server::start_batch()).
+ */
+std::string get_batch_cmd_path(int instance_id);
+
+/**
+ * FIFO through which the server returns the output and return value of each
+ * command line.
+ */
+std::string get_batch_ret_path(int instance_id);
+
 } // namespace px4_daemon
 
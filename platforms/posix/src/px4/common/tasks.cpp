@@ -55,6 +55,7 @@
 #include <sys/types.h>
 #include <string>
 
+#include <px4_platform_common/namespace.h>
 #include <px4_platform_common/tasks.h>
 #include <px4_platform_common/posix.h>
 #include <systemlib/err.h>
@@ -75,6 +76,7 @@ static task_entry taskmap[PX4_MAX_TASKS] {};
 typedef struct {
 	px4_main_t entry;
 	char name[16]; //pthread_setname_np is restricted to 16 chars
+	uint8_t ns; // namespace inherited from the spawning thread
 	int argc;
 	char *argv[];
 	// strings are allocated after the struct data
@@ -95,6 +97,8 @@ static void *entry_adapter(void *ptr)
 		PX4_ERR("px4_task_spawn_cmd: failed to set name of thread %d %d\n", rv, errno);
 	}
 
+	px4::namespace_set(data->ns);
+
 	data->entry(data->argc, data->argv);
 	free(ptr);
 	PX4_DEBUG("Before px4_task_exit");
@@ -138,6 +142,7 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 	strncpy(taskdata->name, name, 16);
 	taskdata->name[15] = '\0';
 	taskdata->entry = entry;
+	taskdata->ns = px4::namespace_id();
 	taskdata->argc = argc + 1;
 
 	char *offset = (char *)taskdata + structsize;
@@ -0,0 +1,412 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.cpp
+ *
+ * Event trace ring and file writer (see px4_platform_common/trace.h).
+ *
+ * Writers claim a ring slot with a single fetch_add and mark it complete by storing
+ * its index + 1 into the slot sequence word. The writer thread copies completed
+ * slots, detects slots that were overwritten in the meantime and counts them as
+ * lost. Pointers are resolved only in the writer thread: names are written once
+ * per file and referenced by id from then on.
+ *
+ * File format (little endian):
+ *   "PX4TRACE" uint32 version
+ *   'T' uint16 thread   char[16] name
+ *   'N' uint16 name_id  uint8 length  char[length]
+ *   'E' uint8 event  uint8 instance  uint16 thread  uint16 name_id  uint64 timestamp
+ *   'L' uint32 number of lost events
+ */
+
+#include <px4_platform_common/trace.h>
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/time.h>
+#include <drivers/drv_hrt.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace px4
+{
+namespace trace
+{
+
+namespace detail
+{
+std::atomic<bool> enabled{false};
+} // namespace detail
+
+static constexpr uint32_t VERSION = 1;
+static constexpr uint16_t MAX_THREADS = 256;
+static constexpr uint16_t THREAD_OTHER = MAX_THREADS - 1; // shared by all threads beyond the limit
+static constexpr int NAME_TABLE_SIZE = 1024; // power of 2
+static constexpr uint16_t NAME_NONE = 0xffff;
+static constexpr uint32_t WRITE_INTERVAL_US = 20000;
+
+struct Record {
+	std::atomic<uint32_t> seq;	// index + 1 once complete, 0 while being written
+	uint8_t event;
+	uint8_t instance;
+	uint16_t thread;
+	const char *name;
+	hrt_abstime timestamp;
+};
+
+// the hooks check enabled with a relaxed load, the ring is published separately with
+// release/acquire so that a hook never sees it before it is initialized (mask included)
+static std::atomic<Record *> _ring{nullptr};
+static uint32_t _ring_mask{0}; // constant once _ring is set
+static std::atomic<uint32_t> _head{0};
+
+static std::atomic<uint16_t> _thread_count{0};
+static char _thread_names[MAX_THREADS][16] {};
+static std::atomic<bool> _thread_named[MAX_THREADS] {};
+
+// writer thread state
+static pthread_mutex_t _control_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t _writer_thread;
+static std::atomic<bool> _writer_should_exit{false};
+static FILE *_file{nullptr};
+static char _path[128] {};
+static uint32_t _tail{0};
+static std::atomic<uint64_t> _events_written{0};
+static std::atomic<uint64_t> _events_lost{0};
+static bool _thread_written[MAX_THREADS] {};
+static const char *_name_keys[NAME_TABLE_SIZE] {};
+static uint16_t _name_count{0};
+
+static uint16_t register_thread()
+{
+	const uint16_t id = _thread_count.fetch_add(1, std::memory_order_relaxed);
+
+	if (id >= THREAD_OTHER) {
+		if (!_thread_named[THREAD_OTHER].load(std::memory_order_acquire)) {
+			strncpy(_thread_names[THREAD_OTHER], "other", sizeof(_thread_names[THREAD_OTHER]));
+			_thread_named[THREAD_OTHER].store(true, std::memory_order_release);
+		}
+
+		return THREAD_OTHER;
+	}
+
+	char *name = _thread_names[id];
+
+	if (pthread_getname_np(pthread_self(), name, sizeof(_thread_names[id])) != 0 || name[0] == '\0') {
+		snprintf(name, sizeof(_thread_names[id]), "thread %u", id);
+	}
+
+	_thread_named[id].store(true, std::memory_order_release);
+	return id;
+}
+
+void detail::record(Event event, const char *name, uint8_t instance)
+{
+	static thread_local uint16_t thread = MAX_THREADS;
+
+	if (thread == MAX_THREADS) {
+		thread = register_thread();
+	}
+
+	Record *ring = _ring.load(std::memory_order_acquire);
+
+	if (ring == nullptr) {
+		return;
+	}
+
+	const hrt_abstime now = hrt_absolute_time();
+	const uint32_t index = _head.fetch_add(1, std::memory_order_relaxed);
+	Record &record = ring[index & _ring_mask];
+
+	record.seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	record.event = (uint8_t)event;
+	record.instance = instance;
+	record.thread = thread;
+	record.name = name;
+	record.timestamp = now;
+
+	record.seq.store(index + 1, std::memory_order_release);
+}
+
+static void write_thread(uint16_t thread)
+{
+	if (_thread_written[thread] || !_thread_named[thread].load(std::memory_order_acquire)) {
+		return;
+	}
+
+	fputc('T', _file);
+	fwrite(&thread, sizeof(thread), 1, _file);
+	fwrite(_thread_names[thread], sizeof(_thread_names[thread]), 1, _file);
+	_thread_written[thread] = true;
+}
+
+static uint16_t name_id(const char *name)
+{
+	// open addressing on the pointer, names are static strings
+	uint32_t slot = (uint32_t)(((uintptr_t)name >> 3) * 2654435761u) & (NAME_TABLE_SIZE - 1);
+
+	for (int i = 0; i < NAME_TABLE_SIZE; i++) {
+		if (_name_keys[slot] == name) {
+			return (uint16_t)slot;
+		}
+
+		if (_name_keys[slot] == nullptr) {
+			if (_name_count >= NAME_TABLE_SIZE * 3 / 4) {
+				break;
+			}
+
+			_name_keys[slot] = name;
+			_name_count++;
+
+			const size_t length = strnlen(name, 255);
+			const uint16_t id = (uint16_t)slot;
+			const uint8_t length8 = (uint8_t)length;
+			fputc('N', _file);
+			fwrite(&id, sizeof(id), 1, _file);
+			fwrite(&length8, sizeof(length8), 1, _file);
+			fwrite(name, length, 1, _file);
+			return id;
+		}
+
+		slot = (slot + 1) & (NAME_TABLE_SIZE - 1);
+	}
+
+	return NAME_NONE;
+}
+
+static void write_lost(uint32_t lost)
+{
+	if (lost > 0) {
+		fputc('L', _file);
+		fwrite(&lost, sizeof(lost), 1, _file);
+		_events_lost.fetch_add(lost, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Write all completed events to the file.
+ * @param flush stop at the head, do not wait for events still being written
+ */
+static void write_events(bool flush)
+{
+	const uint32_t head = _head.load(std::memory_order_acquire);
+	const uint32_t capacity = _ring_mask + 1;
+	uint32_t lost = 0;
+
+	if (head - _tail > capacity) {
+		// the writers lapped the ring
+		lost += head - _tail - capacity;
+		_tail = head - capacity;
+	}
+
+	while (_tail != head) {
+		Record &record = _ring.load(std::memory_order_relaxed)[_tail & _ring_mask];
+		const uint32_t seq = record.seq.load(std::memory_order_acquire);
+
+		if (seq != _tail + 1) {
+			if ((int32_t)(seq - (_tail + 1)) > 0 || flush) {
+				// overwritten by a later lap (or never completed when flushing)
+				lost++;
+				_tail++;
+				continue;
+			}
+
+			// still being written, continue from here next time
+			break;
+		}
+
+		const uint8_t event = record.event;
+		const uint8_t instance = record.instance;
+		const uint16_t thread = record.thread;
+		const char *name = record.name;
+		const hrt_abstime timestamp = record.timestamp;
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (record.seq.load(std::memory_order_relaxed) != seq) {
+			lost++;
+			_tail++;
+			continue;
+		}
+
+		write_thread(thread);
+		const uint16_t id = name_id(name);
+
+		fputc('E', _file);
+		fwrite(&event, sizeof(event), 1, _file);
+		fwrite(&instance, sizeof(instance), 1, _file);
+		fwrite(&thread, sizeof(thread), 1, _file);
+		fwrite(&id, sizeof(id), 1, _file);
+		fwrite(&timestamp, sizeof(timestamp), 1, _file);
+
+		_events_written.fetch_add(1, std::memory_order_relaxed);
+		_tail++;
+	}
+
+	write_lost(lost);
+}
+
+static void *writer_main(void *)
+{
+#ifdef __PX4_DARWIN
+	pthread_setname_np("trace_writer");
+#else
+	pthread_setname_np(pthread_self(), "trace_writer");
+#endif
+
+	while (!_writer_should_exit.load()) {
+		write_events(false);
+		// real time, the writer must not take part in lockstep
+		system_usleep(WRITE_INTERVAL_US);
+	}
+
+	return nullptr;
+}
+
+bool start(const char *path, uint32_t ring_size)
+{
+	pthread_mutex_lock(&_control_mutex);
+
+	if (_file != nullptr) {
+		PX4_WARN("already tracing to %s", _path);
+		pthread_mutex_unlock(&_control_mutex);
+		return false;
+	}
+
+	if (_ring.load(std::memory_order_relaxed) == nullptr) {
+		uint32_t capacity = 1024;
+
+		while (capacity < ring_size && capacity < (1u << 24)) {
+			capacity <<= 1;
+		}
+
+		Record *ring = new Record[capacity] {};
+
+		if (ring == nullptr) {
+			PX4_ERR("alloc failed");
+			pthread_mutex_unlock(&_control_mutex);
+			return false;
+		}
+
+		_ring_mask = capacity - 1;
+		_ring.store(ring, std::memory_order_release);
+
+	} else if (ring_size > _ring_mask + 1) {
+		PX4_WARN("ring already allocated with %u events", (unsigned)(_ring_mask + 1));
+	}
+
+	_file = fopen(path, "wb");
+
+	if (_file == nullptr) {
+		PX4_ERR("failed to open %s", path);
+		pthread_mutex_unlock(&_control_mutex);
+		return false;
+	}
+
+	strncpy(_path, path, sizeof(_path) - 1);
+	fwrite("PX4TRACE", 8, 1, _file);
+	fwrite(&VERSION, sizeof(VERSION), 1, _file);
+
+	// each file is self-contained
+	memset(_thread_written, 0, sizeof(_thread_written));
+	memset(_name_keys, 0, sizeof(_name_keys));
+	_name_count = 0;
+	_events_written.store(0);
+	_events_lost.store(0);
+	_tail = _head.load();
+
+	_writer_should_exit.store(false);
+
+	if (pthread_create(&_writer_thread, nullptr, writer_main, nullptr) != 0) {
+		PX4_ERR("failed to start writer thread");
+		fclose(_file);
+		_file = nullptr;
+		pthread_mutex_unlock(&_control_mutex);
+		return false;
+	}
+
+	detail::enabled.store(true);
+	PX4_INFO("tracing to %s (%u events buffered)", _path, (unsigned)(_ring_mask + 1));
+
+	pthread_mutex_unlock(&_control_mutex);
+	return true;
+}
+
+void stop()
+{
+	pthread_mutex_lock(&_control_mutex);
+
+	if (_file == nullptr) {
+		pthread_mutex_unlock(&_control_mutex);
+		return;
+	}
+
+	detail::enabled.store(false);
+
+	_writer_should_exit.store(true);
+	pthread_join(_writer_thread, nullptr);
+
+	// give writers that saw tracing enabled the chance to finish their record
+	system_usleep(1000);
+	write_events(true);
+
+	fclose(_file);
+	_file = nullptr;
+
+	PX4_INFO("stopped tracing to %s: %llu events, %llu lost", _path,
+		 (unsigned long long)_events_written.load(), (unsigned long long)_events_lost.load());
+
+	pthread_mutex_unlock(&_control_mutex);
+}
+
+void print_status()
+{
+	pthread_mutex_lock(&_control_mutex);
+
+	if (_file != nullptr) {
+		PX4_INFO("tracing to %s, ring %u events", _path, (unsigned)(_ring_mask + 1));
+		PX4_INFO("events written: %llu, lost: %llu", (unsigned long long)_events_written.load(),
+			 (unsigned long long)_events_lost.load());
+
+	} else {
+		PX4_INFO("not tracing");
+	}
+
+	pthread_mutex_unlock(&_control_mutex);
+}
+
+} // namespace trace
+} // namespace px4
@@ -61,6 +61,7 @@ ICM20602::~ICM20602()
 	perf_free(_bad_transfer_perf);
 	perf_free(_fifo_empty_perf);
 	perf_free(_fifo_overflow_perf);
+	perf_free(_fifo_transfer_perf);
 	perf_free(_fifo_reset_perf);
 	perf_free(_drdy_missed_perf);
 }
@@ -79,6 +80,7 @@ int ICM20602::init()
 
 bool ICM20602::Reset()
 {
+	_fifo_pipeline.flush();
 	_state = STATE::RESET;
 	DataReadyInterruptDisable();
 	ScheduleClear();
@@ -89,6 +91,7 @@ bool ICM20602::Reset()
 void ICM20602::exit_and_cleanup()
 {
 	DataReadyInterruptDisable();
+	_fifo_pipeline.flush();
 	I2CSPIDriverBase::exit_and_cleanup();
 }
 
@@ -102,8 +105,11 @@ void ICM20602::print_status()
 	perf_print_counter(_bad_transfer_perf);
 	perf_print_counter(_fifo_empty_perf);
 	perf_print_counter(_fifo_overflow_perf);
+	perf_print_counter(_fifo_transfer_perf);
 	perf_print_counter(_fifo_reset_perf);
 	perf_print_counter(_drdy_missed_perf);
+
+	_fifo_pipeline.print_status();
 }
 
 int ICM20602::probe()
@@ -214,6 +220,12 @@ void ICM20602::RunImpl()
 				ScheduleDelayed(_fifo_empty_interval_us * 2);
 			}
 
+			if (_fifo_read_skipped) {
+				// the last cycle left its samples in the FIFO, use the FIFO count to drain all of them
+				_fifo_read_skipped = false;
+				samples = 0;
+			}
+
 			if (samples == 0) {
 				// check current FIFO count
 				const uint16_t fifo_count = FIFOReadCount();
@@ -250,6 +262,9 @@ void ICM20602::RunImpl()
 				}
 			}
 
+			// batches rejected by the processing stage count as failures as well
+			_failure_count += _fifo_pipeline.process_failures();
+
 			if (!success) {
 				_failure_count++;
 
@@ -335,6 +350,8 @@ void ICM20602::ConfigureGyro()
 
 void ICM20602::ConfigureSampleRate(int sample_rate)
 {
+	_fifo_pipeline.flush();
+
 	// round down to nearest FIFO sample dt * SAMPLES_PER_TRANSFER
 	const float min_interval = FIFO_SAMPLE_DT * SAMPLES_PER_TRANSFER;
 	_fifo_empty_interval_us = math::max(roundf((1e6f / (float)sample_rate) / min_interval) * min_interval, min_interval);
@@ -369,6 +386,8 @@ void ICM20602::ConfigureFIFOWatermark(uint8_t samples)
 
 bool ICM20602::Configure()
 {
+	_fifo_pipeline.flush();
+
 	// first set and clear all configured register bits
 	for (const auto &reg_cfg : _register_cfg) {
 		RegisterSetAndClearBits(reg_cfg.reg, reg_cfg.set_bits, reg_cfg.clear_bits);
@@ -483,19 +502,32 @@ uint16_t ICM20602::FIFOReadCount()
 
 bool ICM20602::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 {
-	FIFOTransferBuffer buffer{};
+	FIFOTransferBuffer *buffer = _fifo_pipeline.acquire();
+
+	if (buffer == nullptr) {
+		// previous batches are still being processed, leave the samples in the FIFO for the next cycle
+		_fifo_read_skipped = true;
+		return false;
+	}
+
 	const size_t transfer_size = math::min(samples * sizeof(FIFO::DATA) + 3, FIFO::SIZE);
 
-	if (transfer((uint8_t *)&buffer, (uint8_t *)&buffer, transfer_size) != PX4_OK) {
+	perf_begin(_fifo_transfer_perf);
+	const int ret = transfer((uint8_t *)buffer, (uint8_t *)buffer, transfer_size);
+	perf_end(_fifo_transfer_perf);
+
+	if (ret != PX4_OK) {
 		perf_count(_bad_transfer_perf);
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
-	const uint16_t fifo_count_bytes = combine(buffer.FIFO_COUNTH, buffer.FIFO_COUNTL);
+	const uint16_t fifo_count_bytes = combine(buffer->FIFO_COUNTH, buffer->FIFO_COUNTL);
 
 	if (fifo_count_bytes >= FIFO::SIZE) {
 		perf_count(_fifo_overflow_perf);
 		FIFOReset();
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
@@ -503,19 +535,30 @@ bool ICM20602::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 
 	if (fifo_count_samples == 0) {
 		perf_count(_fifo_empty_perf);
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
 	const uint8_t valid_samples = math::min(samples, fifo_count_samples);
 
 	if (valid_samples > 0) {
-		// use raw temperature to first validate FIFO transfer
-		if (ProcessTemperature(buffer.f, valid_samples)) {
-			ProcessGyro(timestamp_sample, buffer.f, valid_samples);
+		// convert and publish on the processing work queue while the bus is free for the next transfer
+		_fifo_pipeline.submit(buffer, timestamp_sample, valid_samples);
+		return true;
+	}
 
-			if (ProcessAccel(timestamp_sample, buffer.f, valid_samples)) {
-				return true;
-			}
+	_fifo_pipeline.release(buffer);
+	return false;
+}
+
+bool ICM20602::FIFOProcess(const FIFOTransferBuffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples)
+{
+	// use raw temperature to first validate FIFO transfer
+	if (ProcessTemperature(buffer.f, samples)) {
+		ProcessGyro(timestamp_sample, buffer.f, samples);
+
+		if (ProcessAccel(timestamp_sample, buffer.f, samples)) {
+			return true;
 		}
 	}
 
@@ -524,6 +567,7 @@ bool ICM20602::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 
 void ICM20602::FIFOReset()
 {
+	_fifo_pipeline.flush();
 	perf_count(_fifo_reset_perf);
 
 	// FIFO_EN: disable FIFO
@@ -61,6 +61,7 @@ ICM42605::~ICM42605()
 	perf_free(_bad_transfer_perf);
 	perf_free(_fifo_empty_perf);
 	perf_free(_fifo_overflow_perf);
+	perf_free(_fifo_transfer_perf);
 	perf_free(_fifo_reset_perf);
 	perf_free(_drdy_missed_perf);
 }
@@ -79,6 +80,7 @@ int ICM42605::init()
 
 bool ICM42605::Reset()
 {
+	_fifo_pipeline.flush();
 	_state = STATE::RESET;
 	DataReadyInterruptDisable();
 	ScheduleClear();
@@ -89,6 +91,7 @@ bool ICM42605::Reset()
 void ICM42605::exit_and_cleanup()
 {
 	DataReadyInterruptDisable();
+	_fifo_pipeline.flush();
 	I2CSPIDriverBase::exit_and_cleanup();
 }
 
@@ -102,8 +105,11 @@ void ICM42605::print_status()
 	perf_print_counter(_bad_transfer_perf);
 	perf_print_counter(_fifo_empty_perf);
 	perf_print_counter(_fifo_overflow_perf);
+	perf_print_counter(_fifo_transfer_perf);
 	perf_print_counter(_fifo_reset_perf);
 	perf_print_counter(_drdy_missed_perf);
+
+	_fifo_pipeline.print_status();
 }
 
 int ICM42605::probe()
@@ -206,6 +212,12 @@ void ICM42605::RunImpl()
 				ScheduleDelayed(_fifo_empty_interval_us * 2);
 			}
 
+			if (_fifo_read_skipped) {
+				// the last cycle left its samples in the FIFO, use the FIFO count to drain all of them
+				_fifo_read_skipped = false;
+				samples = 0;
+			}
+
 			if (samples == 0) {
 				// check current FIFO count
 				const uint16_t fifo_count = FIFOReadCount();
@@ -242,6 +254,9 @@ void ICM42605::RunImpl()
 				}
 			}
 
+			// batches rejected by the processing stage count as failures as well
+			_failure_count += _fifo_pipeline.process_failures();
+
 			if (!success) {
 				_failure_count++;
 
@@ -339,6 +354,8 @@ void ICM42605::ConfigureGyro()
 
 void ICM42605::ConfigureSampleRate(int sample_rate)
 {
+	_fifo_pipeline.flush();
+
 	// round down to nearest FIFO sample dt
 	const float min_interval = FIFO_SAMPLE_DT;
 	_fifo_empty_interval_us = math::max(roundf((1e6f / (float)sample_rate) / min_interval) * min_interval, min_interval);
@@ -383,6 +400,8 @@ void ICM42605::SelectRegisterBank(enum REG_BANK_SEL_BIT bank)
 
 bool ICM42605::Configure()
 {
+	_fifo_pipeline.flush();
+
 	// first set and clear all configured register bits
 	for (const auto &reg_cfg : _register_bank0_cfg) {
 		RegisterSetAndClearBits(reg_cfg.reg, reg_cfg.set_bits, reg_cfg.clear_bits);
@@ -504,26 +523,40 @@ uint16_t ICM42605::FIFOReadCount()
 
 bool ICM42605::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 {
-	FIFOTransferBuffer buffer{};
+	FIFOTransferBuffer *buffer = _fifo_pipeline.acquire();
+
+	if (buffer == nullptr) {
+		// previous batches are still being processed, leave the samples in the FIFO for the next cycle
+		_fifo_read_skipped = true;
+		return false;
+	}
+
 	const size_t transfer_size = math::min(samples * sizeof(FIFO::DATA) + 4, FIFO::SIZE);
 	SelectRegisterBank(REG_BANK_SEL_BIT::USER_BANK_0);
 
-	if (transfer((uint8_t *)&buffer, (uint8_t *)&buffer, transfer_size) != PX4_OK) {
+	perf_begin(_fifo_transfer_perf);
+	const int ret = transfer((uint8_t *)buffer, (uint8_t *)buffer, transfer_size);
+	perf_end(_fifo_transfer_perf);
+
+	if (ret != PX4_OK) {
 		perf_count(_bad_transfer_perf);
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
-	if (buffer.INT_STATUS & INT_STATUS_BIT::FIFO_FULL_INT) {
+	if (buffer->INT_STATUS & INT_STATUS_BIT::FIFO_FULL_INT) {
 		perf_count(_fifo_overflow_perf);
 		FIFOReset();
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
-	const uint16_t fifo_count_bytes = combine(buffer.FIFO_COUNTH, buffer.FIFO_COUNTL);
+	const uint16_t fifo_count_bytes = combine(buffer->FIFO_COUNTH, buffer->FIFO_COUNTL);
 
 	if (fifo_count_bytes >= FIFO::SIZE) {
 		perf_count(_fifo_overflow_perf);
 		FIFOReset();
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
@@ -531,6 +564,7 @@ bool ICM42605::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 
 	if (fifo_count_samples == 0) {
 		perf_count(_fifo_empty_perf);
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
@@ -541,7 +575,7 @@ bool ICM42605::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 		bool valid = true;
 
 		// With FIFO_ACCEL_EN and FIFO_GYRO_EN header should be 8’b_0110_10xx
-		const uint8_t FIFO_HEADER = buffer.f[i].FIFO_Header;
+		const uint8_t FIFO_HEADER = buffer->f[i].FIFO_Header;
 
 		if (FIFO_HEADER & FIFO::FIFO_HEADER_BIT::HEADER_MSG) {
 			// FIFO sample empty if HEADER_MSG set
@@ -566,16 +600,25 @@ bool ICM42605::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 	}
 
 	if (valid_samples > 0) {
-		ProcessGyro(timestamp_sample, buffer.f, valid_samples);
-		ProcessAccel(timestamp_sample, buffer.f, valid_samples);
+		// convert and publish on the processing work queue while the bus is free for the next transfer
+		_fifo_pipeline.submit(buffer, timestamp_sample, valid_samples);
 		return true;
 	}
 
+	_fifo_pipeline.release(buffer);
 	return false;
 }
 
+bool ICM42605::FIFOProcess(const FIFOTransferBuffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples)
+{
+	ProcessGyro(timestamp_sample, buffer.f, samples);
+	ProcessAccel(timestamp_sample, buffer.f, samples);
+	return true;
+}
+
 void ICM42605::FIFOReset()
 {
+	_fifo_pipeline.flush();
 	perf_count(_fifo_reset_perf);
 
 	// SIGNAL_PATH_RESET: FIFO flush
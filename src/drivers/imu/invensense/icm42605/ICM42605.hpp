@@ -45,6 +45,7 @@
 #include <drivers/drv_hrt.h>
 #include <lib/drivers/accelerometer/PX4Accelerometer.hpp>
 #include <lib/drivers/device/spi.h>
+#include <lib/drivers/fifo_pipeline/FIFOPipeline.hpp>
 #include <lib/drivers/gyroscope/PX4Gyroscope.hpp>
 #include <lib/ecl/geo/geo.h>
 #include <lib/perf/perf_counter.h>
@@ -124,6 +125,7 @@ private:
 
 	uint16_t FIFOReadCount();
 	bool FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples);
+	bool FIFOProcess(const FIFOTransferBuffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples);
 	void FIFOReset();
 
 	void ProcessAccel(const hrt_abstime &timestamp_sample, const FIFO::DATA fifo[], const uint8_t samples);
@@ -139,9 +141,13 @@ private:
 	perf_counter_t _bad_transfer_perf{perf_alloc(PC_COUNT, MODULE_NAME": bad transfer")};
 	perf_counter_t _fifo_empty_perf{perf_alloc(PC_COUNT, MODULE_NAME": FIFO empty")};
 	perf_counter_t _fifo_overflow_perf{perf_alloc(PC_COUNT, MODULE_NAME": FIFO overflow")};
+	perf_counter_t _fifo_transfer_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": FIFO transfer")};
 	perf_counter_t _fifo_reset_perf{perf_alloc(PC_COUNT, MODULE_NAME": FIFO reset")};
 	perf_counter_t _drdy_missed_perf{nullptr};
 
+	// double buffered FIFO transfers, converted and published on the processing work queue
+	FIFOPipeline<FIFOTransferBuffer, ICM42605> _fifo_pipeline{this, &ICM42605::FIFOProcess, MODULE_NAME": FIFO processing", MODULE_NAME": FIFO handoff"};
+
 	hrt_abstime _reset_timestamp{0};
 	hrt_abstime _last_config_check_timestamp{0};
 	hrt_abstime _temperature_update_timestamp{0};
@@ -151,6 +157,7 @@ private:
 
 	px4::atomic<uint32_t> _drdy_fifo_read_samples{0};
 	bool _data_ready_interrupt_enabled{false};
+	bool _fifo_read_skipped{false}; // the FIFO pipeline was full, samples were left in the FIFO
 
 	enum class STATE : uint8_t {
 		RESET,
@@ -61,6 +61,7 @@ ICM42688P::~ICM42688P()
 	perf_free(_bad_transfer_perf);
 	perf_free(_fifo_empty_perf);
 	perf_free(_fifo_overflow_perf);
+	perf_free(_fifo_transfer_perf);
 	perf_free(_fifo_reset_perf);
 	perf_free(_drdy_missed_perf);
 }
@@ -79,6 +80,7 @@ int ICM42688P::init()
 
 bool ICM42688P::Reset()
 {
+	_fifo_pipeline.flush();
 	_state = STATE::RESET;
 	DataReadyInterruptDisable();
 	ScheduleClear();
@@ -89,6 +91,7 @@ bool ICM42688P::Reset()
 void ICM42688P::exit_and_cleanup()
 {
 	DataReadyInterruptDisable();
+	_fifo_pipeline.flush();
 	I2CSPIDriverBase::exit_and_cleanup();
 }
 
@@ -102,8 +105,11 @@ void ICM42688P::print_status()
 	perf_print_counter(_bad_transfer_perf);
 	perf_print_counter(_fifo_empty_perf);
 	perf_print_counter(_fifo_overflow_perf);
+	perf_print_counter(_fifo_transfer_perf);
 	perf_print_counter(_fifo_reset_perf);
 	perf_print_counter(_drdy_missed_perf);
+
+	_fifo_pipeline.print_status();
 }
 
 int ICM42688P::probe()
@@ -206,6 +212,12 @@ void ICM42688P::RunImpl()
 				ScheduleDelayed(_fifo_empty_interval_us * 2);
 			}
 
+			if (_fifo_read_skipped) {
+				// the last cycle left its samples in the FIFO, use the FIFO count to drain all of them
+				_fifo_read_skipped = false;
+				samples = 0;
+			}
+
 			if (samples == 0) {
 				// check current FIFO count
 				const uint16_t fifo_count = FIFOReadCount();
@@ -231,6 +243,7 @@ void ICM42688P::RunImpl()
 			}
 
 			bool success = false;
+			_register_check_read = false;
 
 			if (samples >= 1) {
 				if (FIFORead(now, samples)) {
@@ -242,6 +255,9 @@ void ICM42688P::RunImpl()
 				}
 			}
 
+			// batches rejected by the processing stage count as failures as well
+			_failure_count += _fifo_pipeline.process_failures();
+
 			if (!success) {
 				_failure_count++;
 
@@ -252,10 +268,23 @@ void ICM42688P::RunImpl()
 				}
 			}
 
+			if (!_register_check_read) {
+				// no FIFO transfer this cycle, read the configuration registers on their own
+				TransferSegment segments[REGISTER_CHECK_SEGMENTS];
+				const unsigned count = RegisterCheckPrepare(segments);
+				_register_check_read = (transfer_batch(segments, count) == PX4_OK);
+
+				if (!_register_check_read) {
+					perf_count(_bad_transfer_perf);
+					_register_bank_unknown = true; // force selecting it again
+				}
+			}
+
 			// check configuration registers periodically or immediately following any failure
-			if (RegisterCheck(_register_bank0_cfg[_checked_register_bank0])
-			    && RegisterCheck(_register_bank1_cfg[_checked_register_bank1])
-			    && RegisterCheck(_register_bank2_cfg[_checked_register_bank2])
+			if (_register_check_read
+			    && RegisterCheck(_register_bank0_cfg[_checked_register_bank0], _register_check_transfer.bank0[1])
+			    && RegisterCheck(_register_bank1_cfg[_checked_register_bank1], _register_check_transfer.bank1[1])
+			    && RegisterCheck(_register_bank2_cfg[_checked_register_bank2], _register_check_transfer.bank2[1])
 			   ) {
 				_last_config_check_timestamp = now;
 				_checked_register_bank0 = (_checked_register_bank0 + 1) % size_register_bank0_cfg;
@@ -275,6 +304,8 @@ void ICM42688P::RunImpl()
 
 void ICM42688P::ConfigureSampleRate(int sample_rate)
 {
+	_fifo_pipeline.flush();
+
 	// round down to nearest FIFO sample dt
 	const float min_interval = FIFO_SAMPLE_DT;
 	_fifo_empty_interval_us = math::max(roundf((1e6f / (float)sample_rate) / min_interval) * min_interval, min_interval);
@@ -306,7 +337,7 @@ void ICM42688P::ConfigureFIFOWatermark(uint8_t samples)
 
 void ICM42688P::SelectRegisterBank(enum REG_BANK_SEL_BIT bank)
 {
-	if (bank != _last_register_bank) {
+	if (bank != _last_register_bank || _register_bank_unknown) {
 		// select BANK_0
 		uint8_t cmd_bank_sel[2] {};
 		cmd_bank_sel[0] = static_cast<uint8_t>(Register::BANK_0::REG_BANK_SEL);
@@ -314,11 +345,14 @@ void ICM42688P::SelectRegisterBank(enum REG_BANK_SEL_BIT bank)
 		transfer(cmd_bank_sel, cmd_bank_sel, sizeof(cmd_bank_sel));
 
 		_last_register_bank = bank;
+		_register_bank_unknown = false;
 	}
 }
 
 bool ICM42688P::Configure()
 {
+	_fifo_pipeline.flush();
+
 	// first set and clear all configured register bits
 	for (const auto &reg_cfg : _register_bank0_cfg) {
 		RegisterSetAndClearBits(reg_cfg.reg, reg_cfg.set_bits, reg_cfg.clear_bits);
@@ -398,9 +432,13 @@ bool ICM42688P::DataReadyInterruptDisable()
 template <typename T>
 bool ICM42688P::RegisterCheck(const T &reg_cfg)
 {
-	bool success = true;
+	return RegisterCheck(reg_cfg, RegisterRead(reg_cfg.reg));
+}
 
-	const uint8_t reg_value = RegisterRead(reg_cfg.reg);
+template <typename T>
+bool ICM42688P::RegisterCheck(const T &reg_cfg, uint8_t reg_value)
+{
+	bool success = true;
 
 	if (reg_cfg.set_bits && ((reg_value & reg_cfg.set_bits) != reg_cfg.set_bits)) {
 		PX4_DEBUG("0x%02hhX: 0x%02hhX (0x%02hhX not set)", (uint8_t)reg_cfg.reg, reg_value, reg_cfg.set_bits);
@@ -415,6 +453,36 @@ bool ICM42688P::RegisterCheck(const T &reg_cfg)
 	return success;
 }
 
+unsigned ICM42688P::RegisterCheckPrepare(TransferSegment segments[])
+{
+	// read one configuration register of every bank, starting and ending in bank 0
+	RegisterCheckTransfer &t = _register_check_transfer;
+
+	t.bank0[0] = static_cast<uint8_t>(_register_bank0_cfg[_checked_register_bank0].reg) | DIR_READ;
+	t.bank0[1] = 0;
+	t.select_bank1[0] = static_cast<uint8_t>(Register::BANK_0::REG_BANK_SEL);
+	t.select_bank1[1] = REG_BANK_SEL_BIT::USER_BANK_1;
+	t.bank1[0] = static_cast<uint8_t>(_register_bank1_cfg[_checked_register_bank1].reg) | DIR_READ;
+	t.bank1[1] = 0;
+	t.select_bank2[0] = static_cast<uint8_t>(Register::BANK_0::REG_BANK_SEL);
+	t.select_bank2[1] = REG_BANK_SEL_BIT::USER_BANK_2;
+	t.bank2[0] = static_cast<uint8_t>(_register_bank2_cfg[_checked_register_bank2].reg) | DIR_READ;
+	t.bank2[1] = 0;
+	t.select_bank0[0] = static_cast<uint8_t>(Register::BANK_0::REG_BANK_SEL);
+	t.select_bank0[1] = REG_BANK_SEL_BIT::USER_BANK_0;
+
+	SelectRegisterBank(REG_BANK_SEL_BIT::USER_BANK_0);
+
+	segments[0] = {t.bank0, t.bank0, sizeof(t.bank0)};
+	segments[1] = {t.select_bank1, t.select_bank1, sizeof(t.select_bank1)};
+	segments[2] = {t.bank1, t.bank1, sizeof(t.bank1)};
+	segments[3] = {t.select_bank2, t.select_bank2, sizeof(t.select_bank2)};
+	segments[4] = {t.bank2, t.bank2, sizeof(t.bank2)};
+	segments[5] = {t.select_bank0, t.select_bank0, sizeof(t.select_bank0)};
+
+	return REGISTER_CHECK_SEGMENTS;
+}
+
 template <typename T>
 uint8_t ICM42688P::RegisterRead(T reg)
 {
@@ -462,26 +530,47 @@ uint16_t ICM42688P::FIFOReadCount()
 
 bool ICM42688P::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 {
-	FIFOTransferBuffer buffer{};
+	FIFOTransferBuffer *buffer = _fifo_pipeline.acquire();
+
+	if (buffer == nullptr) {
+		// previous batches are still being processed, leave the samples in the FIFO for the next cycle
+		_fifo_read_skipped = true;
+		return false;
+	}
+
 	const size_t transfer_size = math::min(samples * sizeof(FIFO::DATA) + 4, FIFO::SIZE);
-	SelectRegisterBank(REG_BANK_SEL_BIT::USER_BANK_0);
 
-	if (transfer((uint8_t *)&buffer, (uint8_t *)&buffer, transfer_size) != PX4_OK) {
+	// read the FIFO and the configuration registers checked this cycle in a single bus transaction
+	TransferSegment segments[1 + REGISTER_CHECK_SEGMENTS];
+	segments[0] = {(uint8_t *)buffer, (uint8_t *)buffer, (unsigned)transfer_size};
+	const unsigned count = 1 + RegisterCheckPrepare(&segments[1]);
+
+	perf_begin(_fifo_transfer_perf);
+	const int ret = transfer_batch(segments, count);
+	perf_end(_fifo_transfer_perf);
+
+	if (ret != PX4_OK) {
 		perf_count(_bad_transfer_perf);
+		_register_bank_unknown = true; // force selecting it again
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
-	if (buffer.INT_STATUS & INT_STATUS_BIT::FIFO_FULL_INT) {
+	_register_check_read = true;
+
+	if (buffer->INT_STATUS & INT_STATUS_BIT::FIFO_FULL_INT) {
 		perf_count(_fifo_overflow_perf);
 		FIFOReset();
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
-	const uint16_t fifo_count_bytes = combine(buffer.FIFO_COUNTH, buffer.FIFO_COUNTL);
+	const uint16_t fifo_count_bytes = combine(buffer->FIFO_COUNTH, buffer->FIFO_COUNTL);
 
 	if (fifo_count_bytes >= FIFO::SIZE) {
 		perf_count(_fifo_overflow_perf);
 		FIFOReset();
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
@@ -489,6 +578,7 @@ bool ICM42688P::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 
 	if (fifo_count_samples == 0) {
 		perf_count(_fifo_empty_perf);
+		_fifo_pipeline.release(buffer);
 		return false;
 	}
 
@@ -499,7 +589,7 @@ bool ICM42688P::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 		bool valid = true;
 
 		// With FIFO_ACCEL_EN and FIFO_GYRO_EN header should be 8’b_0110_10xx
-		const uint8_t FIFO_HEADER = buffer.f[i].FIFO_Header;
+		const uint8_t FIFO_HEADER = buffer->f[i].FIFO_Header;
 
 		if (FIFO_HEADER & FIFO::FIFO_HEADER_BIT::HEADER_MSG) {
 			// FIFO sample empty if HEADER_MSG set
@@ -536,11 +626,21 @@ bool ICM42688P::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 	}
 
 	if (valid_samples > 0) {
-		if (ProcessTemperature(buffer.f, valid_samples)) {
-			ProcessGyro(timestamp_sample, buffer.f, valid_samples);
-			ProcessAccel(timestamp_sample, buffer.f, valid_samples);
-			return true;
-		}
+		// convert and publish on the processing work queue while the bus is free for the next transfer
+		_fifo_pipeline.submit(buffer, timestamp_sample, valid_samples);
+		return true;
+	}
+
+	_fifo_pipeline.release(buffer);
+	return false;
+}
+
+bool ICM42688P::FIFOProcess(const FIFOTransferBuffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples)
+{
+	if (ProcessTemperature(buffer.f, samples)) {
+		ProcessGyro(timestamp_sample, buffer.f, samples);
+		ProcessAccel(timestamp_sample, buffer.f, samples);
+		return true;
 	}
 
 	return false;
@@ -548,6 +648,7 @@ bool ICM42688P::FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples)
 
 void ICM42688P::FIFOReset()
 {
+	_fifo_pipeline.flush();
 	perf_count(_fifo_reset_perf);
 
 	// SIGNAL_PATH_RESET: FIFO flush
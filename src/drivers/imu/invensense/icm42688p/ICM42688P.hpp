@@ -45,6 +45,7 @@
 #include <drivers/drv_hrt.h>
 #include <lib/drivers/accelerometer/PX4Accelerometer.hpp>
 #include <lib/drivers/device/spi.h>
+#include <lib/drivers/fifo_pipeline/FIFOPipeline.hpp>
 #include <lib/drivers/gyroscope/PX4Gyroscope.hpp>
 #include <lib/ecl/geo/geo.h>
 #include <lib/perf/perf_counter.h>
@@ -128,14 +129,18 @@ private:
 	bool DataReadyInterruptDisable();
 
 	template <typename T> bool RegisterCheck(const T &reg_cfg);
+	template <typename T> bool RegisterCheck(const T &reg_cfg, uint8_t reg_value);
 	template <typename T> uint8_t RegisterRead(T reg);
 	template <typename T> void RegisterWrite(T reg, uint8_t value);
 	template <typename T> void RegisterSetAndClearBits(T reg, uint8_t setbits, uint8_t clearbits);
 	template <typename T> void RegisterSetBits(T reg, uint8_t setbits) { RegisterSetAndClearBits(reg, setbits, 0); }
 	template <typename T> void RegisterClearBits(T reg, uint8_t clearbits) { RegisterSetAndClearBits(reg, 0, clearbits); }
 
+	unsigned RegisterCheckPrepare(TransferSegment segments[]);
+
 	uint16_t FIFOReadCount();
 	bool FIFORead(const hrt_abstime &timestamp_sample, uint8_t samples);
+	bool FIFOProcess(const FIFOTransferBuffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples);
 	void FIFOReset();
 
 	void ProcessAccel(const hrt_abstime &timestamp_sample, const FIFO::DATA fifo[], const uint8_t samples);
@@ -151,18 +156,37 @@ private:
 	perf_counter_t _bad_transfer_perf{perf_alloc(PC_COUNT, MODULE_NAME": bad transfer")};
 	perf_counter_t _fifo_empty_perf{perf_alloc(PC_COUNT, MODULE_NAME": FIFO empty")};
 	perf_counter_t _fifo_overflow_perf{perf_alloc(PC_COUNT, MODULE_NAME": FIFO overflow")};
+	perf_counter_t _fifo_transfer_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": FIFO transfer")};
 	perf_counter_t _fifo_reset_perf{perf_alloc(PC_COUNT, MODULE_NAME": FIFO reset")};
 	perf_counter_t _drdy_missed_perf{nullptr};
 
+	// double buffered FIFO transfers, converted and published on the processing work queue
+	FIFOPipeline<FIFOTransferBuffer, ICM42688P> _fifo_pipeline{this, &ICM42688P::FIFOProcess, MODULE_NAME": FIFO processing", MODULE_NAME": FIFO handoff"};
+
 	hrt_abstime _reset_timestamp{0};
 	hrt_abstime _last_config_check_timestamp{0};
 	hrt_abstime _temperature_update_timestamp{0};
 	int _failure_count{0};
 
 	enum REG_BANK_SEL_BIT _last_register_bank {REG_BANK_SEL_BIT::USER_BANK_0};
+	bool _register_bank_unknown{false}; // a failed batch transfer may have stopped in any bank
+
+	// configuration registers checked every cycle, read back together with the FIFO
+	struct RegisterCheckTransfer {
+		uint8_t bank0[2];
+		uint8_t select_bank1[2];
+		uint8_t bank1[2];
+		uint8_t select_bank2[2];
+		uint8_t bank2[2];
+		uint8_t select_bank0[2];
+	} _register_check_transfer{};
+	static constexpr unsigned REGISTER_CHECK_SEGMENTS{6};
+	static_assert(1 + REGISTER_CHECK_SEGMENTS <= TRANSFER_BATCH_MAX, "FIFO and register check transfer too long");
+	bool _register_check_read{false};
 
 	px4::atomic<uint32_t> _drdy_fifo_read_samples{0};
 	bool _data_ready_interrupt_enabled{false};
+	bool _fifo_read_skipped{false}; // the FIFO pipeline was full, samples were left in the FIFO
 
 	enum class STATE : uint8_t {
 		RESET,
@@ -86,6 +86,10 @@ CollisionPrevention::CollisionPrevention(ModuleParams *parent) :
 		_data_maxranges[i] = 0;
 		_data_fov[i] = 0;
 		_obstacle_map_body_frame.distances[i] = UINT16_MAX;
+
+		const float angle = math::radians((float)i * INTERNAL_MAP_INCREMENT_DEG + _obstacle_map_body_frame.angle_offset);
+		_bin_dir_cos[i] = cosf(angle);
+		_bin_dir_sin[i] = sinf(angle);
 	}
 }
 
@@ -114,51 +118,36 @@ bool CollisionPrevention::is_active()
 void
 CollisionPrevention::_addObstacleSensorData(const obstacle_distance_s &obstacle, const matrix::Quatf &vehicle_attitude)
 {
-	int msg_index = 0;
-	float vehicle_orientation_deg = math::degrees(Eulerf(vehicle_attitude).psi());
-	float increment_factor = 1.f / obstacle.increment;
+	float vehicle_orientation_deg = 0.f;
 
 	if (obstacle.frame == obstacle.MAV_FRAME_GLOBAL || obstacle.frame == obstacle.MAV_FRAME_LOCAL_NED) {
-		// Obstacle message arrives in local_origin frame (north aligned)
-		// corresponding data index (convert to world frame and shift by msg offset)
-		for (int i = 0; i < INTERNAL_MAP_USED_BINS; i++) {
-			float bin_angle_deg = (float)i * INTERNAL_MAP_INCREMENT_DEG + _obstacle_map_body_frame.angle_offset;
-			msg_index = ceil(wrap_360(vehicle_orientation_deg + bin_angle_deg - obstacle.angle_offset) * increment_factor);
-
-			//add all data points inside to FOV
-			if (obstacle.distances[msg_index] != UINT16_MAX) {
-				if (_enterData(i, obstacle.max_distance * 0.01f, obstacle.distances[msg_index] * 0.01f)) {
-					_obstacle_map_body_frame.distances[i] = obstacle.distances[msg_index];
-					_data_timestamps[i] = _obstacle_map_body_frame.timestamp;
-					_data_maxranges[i] = obstacle.max_distance;
-					_data_fov[i] = 1;
-				}
-			}
-		}
+		// Obstacle message arrives in local_origin frame (north aligned),
+		// convert to world frame before shifting by the msg offset
+		vehicle_orientation_deg = math::degrees(Eulerf(vehicle_attitude).psi());
+
+	} else if (obstacle.frame != obstacle.MAV_FRAME_BODY_FRD) {
+		mavlink_log_critical(&_mavlink_log_pub, "Obstacle message received in unsupported frame %.0f\n",
+				     (double)obstacle.frame);
+		return;
+	}
 
-	} else if (obstacle.frame == obstacle.MAV_FRAME_BODY_FRD) {
-		// Obstacle message arrives in body frame (front aligned)
+	const float increment_factor = 1.f / obstacle.increment;
+
+	for (int i = 0; i < INTERNAL_MAP_USED_BINS; i++) {
 		// corresponding data index (shift by msg offset)
-		for (int i = 0; i < INTERNAL_MAP_USED_BINS; i++) {
-			float bin_angle_deg = (float)i * INTERNAL_MAP_INCREMENT_DEG +
-					      _obstacle_map_body_frame.angle_offset;
-			msg_index = ceil(wrap_360(bin_angle_deg - obstacle.angle_offset) * increment_factor);
-
-			//add all data points inside to FOV
-			if (obstacle.distances[msg_index] != UINT16_MAX) {
-
-				if (_enterData(i, obstacle.max_distance * 0.01f, obstacle.distances[msg_index] * 0.01f)) {
-					_obstacle_map_body_frame.distances[i] = obstacle.distances[msg_index];
-					_data_timestamps[i] = _obstacle_map_body_frame.timestamp;
-					_data_maxranges[i] = obstacle.max_distance;
-					_data_fov[i] = 1;
-				}
+		const float bin_angle_deg = (float)i * INTERNAL_MAP_INCREMENT_DEG + _obstacle_map_body_frame.angle_offset;
+		const int msg_index = ceil(wrap_360(vehicle_orientation_deg + bin_angle_deg - obstacle.angle_offset) *
+					   increment_factor);
+
+		//add all data points inside to FOV
+		if (obstacle.distances[msg_index] != UINT16_MAX) {
+			if (_enterData(i, obstacle.max_distance * 0.01f, obstacle.distances[msg_index] * 0.01f)) {
+				_obstacle_map_body_frame.distances[i] = obstacle.distances[msg_index];
+				_data_timestamps[i] = _obstacle_map_body_frame.timestamp;
+				_data_maxranges[i] = obstacle.max_distance;
+				_data_fov[i] = 1;
 			}
 		}
-
-	} else {
-		mavlink_log_critical(&_mavlink_log_pub, "Obstacle message received in unsupported frame %.0f\n",
-				     (double)obstacle.frame);
 	}
 }
 
@@ -416,6 +405,10 @@ CollisionPrevention::_calculateConstrainedSetpoint(Vector2f &setpoint, const Vec
 			// change setpoint direction slightly (max by _param_cp_guide_ang degrees) to help guide through narrow gaps
 			_adaptSetpointDirection(setpoint_dir, sp_index, vehicle_yaw_angle_rad);
 
+			// rotation from body to local frame, the bin directions are precomputed in body frame
+			const float yaw_cos = cosf(vehicle_yaw_angle_rad);
+			const float yaw_sin = sinf(vehicle_yaw_angle_rad);
+
 			// limit speed for safe flight
 			for (int i = 0; i < INTERNAL_MAP_USED_BINS; i++) { // disregard unused bins at the end of the message
 
@@ -426,16 +419,6 @@ CollisionPrevention::_calculateConstrainedSetpoint(Vector2f &setpoint, const Vec
 					_obstacle_map_body_frame.distances[i] = UINT16_MAX;
 				}
 
-				const float distance = _obstacle_map_body_frame.distances[i] * 0.01f; // convert to meters
-				const float max_range = _data_maxranges[i] * 0.01f; // convert to meters
-				float angle = math::radians((float)i * INTERNAL_MAP_INCREMENT_DEG + _obstacle_map_body_frame.angle_offset);
-
-				// convert from body to local frame in the range [0, 2*pi]
-				angle = wrap_2pi(vehicle_yaw_angle_rad + angle);
-
-				// get direction of current bin
-				const Vector2f bin_direction = {cosf(angle), sinf(angle)};
-
 				//count number of bins in the field of valid_new
 				if (_obstacle_map_body_frame.distances[i] < UINT16_MAX) {
 					num_fov_bins ++;
@@ -444,6 +427,14 @@ CollisionPrevention::_calculateConstrainedSetpoint(Vector2f &setpoint, const Vec
 				if (_obstacle_map_body_frame.distances[i] > _obstacle_map_body_frame.min_distance
 				    && _obstacle_map_body_frame.distances[i] < UINT16_MAX) {
 
+					const float distance = _obstacle_map_body_frame.distances[i] * 0.01f; // convert to meters
+					const float max_range = _data_maxranges[i] * 0.01f; // convert to meters
+
+					// get direction of current bin in local frame
+					const Vector2f bin_direction = {yaw_cos * _bin_dir_cos[i] - yaw_sin * _bin_dir_sin[i],
+									yaw_sin * _bin_dir_cos[i] + yaw_cos * _bin_dir_sin[i]
+								       };
+
 					if (setpoint_dir.dot(bin_direction) > 0) {
 						// calculate max allowed velocity with a P-controller (same gain as in the position controller)
 						const float curr_vel_parallel = math::max(0.f, curr_vel.dot(bin_direction));
@@ -1206,3 +1206,102 @@ TEST_F(CollisionPreventionTest, enterData)
 	EXPECT_TRUE(cp.test_enterData(8, 30.f, 1.5f)); //longer range, reading in range
 	EXPECT_TRUE(cp.test_enterData(8, 30.f, 31.f)); //longer range, reading out of range
 }
+
+TEST_F(CollisionPreventionTest, constrainedSetpointRotatedVehicle)
+{
+	// GIVEN: a vehicle yawed by 90 degrees (facing east) with an obstacle in front of it
+	TestCollisionPrevention cp;
+	float max_speed = 3.f;
+	matrix::Vector2f curr_pos(0, 0);
+	matrix::Vector2f curr_vel(0, 0);
+	vehicle_attitude_s attitude{};
+	attitude.timestamp = hrt_absolute_time();
+	matrix::Quatf q(matrix::Eulerf(0.f, 0.f, M_PI_2_F));
+	q.copyTo(attitude.q);
+
+	param_t param = param_handle(px4::params::CP_DIST);
+	float value = 10; // try to keep 10m distance
+	param_set(param, &value);
+	cp.paramsChanged();
+
+	obstacle_distance_s message{};
+	message.frame = message.MAV_FRAME_BODY_FRD;
+	message.min_distance = 100;
+	message.max_distance = 10000;
+	message.angle_offset = 0;
+	message.timestamp = hrt_absolute_time();
+	int distances_array_size = sizeof(message.distances) / sizeof(message.distances[0]);
+	message.increment = 360 / distances_array_size;
+
+	for (int i = 0; i < distances_array_size; i++) {
+		// obstacle in the front 30 degrees of the vehicle
+		message.distances[i] = (i < 3 || i > distances_array_size - 4) ? 101 : 10001;
+	}
+
+	// WHEN: we run the setpoint modification towards west and towards east
+	orb_advert_t obstacle_distance_pub = orb_advertise(ORB_ID(obstacle_distance), &message);
+	orb_advert_t vehicle_attitude_pub = orb_advertise(ORB_ID(vehicle_attitude), &attitude);
+	matrix::Vector2f setpoint_west(0, -3);
+	matrix::Vector2f setpoint_east(0, 3);
+	cp.modifySetpoint(setpoint_west, max_speed, curr_pos, curr_vel);
+	cp.modifySetpoint(setpoint_east, max_speed, curr_pos, curr_vel);
+	orb_unadvertise(obstacle_distance_pub);
+	orb_unadvertise(vehicle_attitude_pub);
+
+	// THEN: only the setpoint towards the obstacle (east in local frame) is cut down
+	EXPECT_FLOAT_EQ(3.f, setpoint_west.norm());
+	EXPECT_FLOAT_EQ(0.f, setpoint_east.norm());
+}
+
+TEST_F(CollisionPreventionTest, modifySetpointRepeatable)
+{
+	// GIVEN: a populated obstacle map with the vehicle at an arbitrary heading
+	TestCollisionPrevention cp;
+	float max_speed = 5.f;
+	matrix::Vector2f curr_pos(0, 0);
+	matrix::Vector2f curr_vel(1, 1);
+	vehicle_attitude_s attitude{};
+	attitude.timestamp = hrt_absolute_time();
+	matrix::Quatf q(matrix::Eulerf(0.f, 0.f, 0.7f));
+	q.copyTo(attitude.q);
+
+	param_t param = param_handle(px4::params::CP_DIST);
+	float value = 5;
+	param_set(param, &value);
+	cp.paramsChanged();
+
+	obstacle_distance_s message{};
+	message.frame = message.MAV_FRAME_LOCAL_NED;
+	message.min_distance = 20;
+	message.max_distance = 2000;
+	message.angle_offset = 0;
+	message.timestamp = hrt_absolute_time();
+	int distances_array_size = sizeof(message.distances) / sizeof(message.distances[0]);
+	message.increment = 360 / distances_array_size;
+
+	for (int i = 0; i < distances_array_size; i++) {
+		message.distances[i] = 600 + 10 * (i % 7);
+	}
+
+	orb_advert_t obstacle_distance_pub = orb_advertise(ORB_ID(obstacle_distance), &message);
+	orb_advert_t vehicle_attitude_pub = orb_advertise(ORB_ID(vehicle_attitude), &attitude);
+
+	// WHEN: we run the setpoint modification repeatedly
+	matrix::Vector2f first_setpoint(4, 1);
+	cp.modifySetpoint(first_setpoint, max_speed, curr_pos, curr_vel);
+
+	matrix::Vector2f setpoint;
+
+	for (int i = 0; i < 10; i++) {
+		setpoint = matrix::Vector2f(4, 1);
+		cp.modifySetpoint(setpoint, max_speed, curr_pos, curr_vel);
+	}
+
+	orb_unadvertise(obstacle_distance_pub);
+	orb_unadvertise(vehicle_attitude_pub);
+
+	// THEN: the result is constrained and stable over all iterations
+	EXPECT_LT(setpoint.norm(), matrix::Vector2f(4, 1).norm());
+	EXPECT_FLOAT_EQ(first_setpoint(0), setpoint(0));
+	EXPECT_FLOAT_EQ(first_setpoint(1), setpoint(1));
+}
@@ -35,6 +35,7 @@
 #include "PX4Accelerometer.hpp"
 
 #include <lib/drivers/device/Device.hpp>
+#include <lib/drivers/raw_imu_capture/RawImuCapture.hpp>
 #include <lib/parameters/param.h>
 
 using namespace time_literals;
@@ -115,6 +116,9 @@ void PX4Accelerometer::updateFIFO(sensor_accel_fifo_s &sample)
 	sample.timestamp = hrt_absolute_time();
 	_sensor_fifo_pub.publish(sample);
 
+	// lossless copy for the raw FIFO logging
+	raw_imu_capture::push(_sensor_fifo_pub.get_instance(), sample);
+
 	{
 		// trapezoidal integration (equally spaced, scaled by dt later)
 		const uint8_t N = sample.samples;
@@ -227,4 +227,73 @@ I2C::transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const
 	return ret;
 }
 
+int
+I2C::transfer_batch(const TransferSegment *segments, unsigned count)
+{
+	int ret = PX4_ERROR;
+	unsigned retry_count = 0;
+
+	if (_dev == nullptr) {
+		PX4_ERR("I2C device not opened");
+		return PX4_ERROR;
+	}
+
+	if ((count == 0) || (count > TRANSFER_BATCH_MAX)) {
+		return -EINVAL;
+	}
+
+	i2c_msg_s msgv[2 * TRANSFER_BATCH_MAX] {};
+	unsigned msgs = 0;
+
+	for (unsigned i = 0; i < count; i++) {
+		const TransferSegment &segment = segments[i];
+
+		if ((segment.send_len == 0) && (segment.recv_len == 0)) {
+			return -EINVAL;
+		}
+
+		if (segment.send_len > 0) {
+			msgv[msgs].frequency = _bus_clocks[get_device_bus() - 1];
+			msgv[msgs].addr = get_device_address();
+			msgv[msgs].flags = 0;
+			msgv[msgs].buffer = const_cast<uint8_t *>(segment.send);
+			msgv[msgs].length = segment.send_len;
+			msgs++;
+		}
+
+		if (segment.recv_len > 0) {
+			msgv[msgs].frequency = _bus_clocks[get_device_bus() - 1];
+			msgv[msgs].addr = get_device_address();
+			msgv[msgs].flags = I2C_M_READ;
+			msgv[msgs].buffer = segment.recv;
+			msgv[msgs].length = segment.recv_len;
+			msgs++;
+		}
+	}
+
+	do {
+		DEVICE_DEBUG("transfer batch %u segments, %u messages", count, msgs);
+
+		int ret_transfer = I2C_TRANSFER(_dev, &msgv[0], msgs);
+
+		if (ret_transfer != 0) {
+			DEVICE_DEBUG("I2C transfer failed, result %d", ret_transfer);
+			ret = PX4_ERROR;
+
+		} else {
+			// success
+			ret = PX4_OK;
+			break;
+		}
+
+		/* if we have already retried once, or we are going to give up, then reset the bus */
+		if ((retry_count >= 1) || (retry_count >= _retries)) {
+			I2C_RESET(_dev);
+		}
+
+	} while (retry_count++ < _retries);
+
+	return ret;
+}
+
 } // namespace device
@@ -177,6 +177,63 @@ SPI::_transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	return PX4_OK;
 }
 
+int
+SPI::transfer_batch(const TransferSegment *segments, unsigned count)
+{
+	int result = PX4_OK;
+
+	if ((count == 0) || (count > TRANSFER_BATCH_MAX)) {
+		return -EINVAL;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		if ((segments[i].send == nullptr) && (segments[i].recv == nullptr)) {
+			return -EINVAL;
+		}
+	}
+
+	LockMode mode = up_interrupt_context() ? LOCK_NONE : _locking_mode;
+
+	/* lock the bus as required */
+	switch (mode) {
+	default:
+	case LOCK_PREEMPTION: {
+			irqstate_t state = px4_enter_critical_section();
+			result = _transfer_batch(segments, count);
+			px4_leave_critical_section(state);
+		}
+		break;
+
+	case LOCK_THREADS:
+		SPI_LOCK(_dev, true);
+		result = _transfer_batch(segments, count);
+		SPI_LOCK(_dev, false);
+		break;
+
+	case LOCK_NONE:
+		result = _transfer_batch(segments, count);
+		break;
+	}
+
+	return result;
+}
+
+int
+SPI::_transfer_batch(const TransferSegment *segments, unsigned count)
+{
+	SPI_SETFREQUENCY(_dev, _frequency);
+	SPI_SETMODE(_dev, _mode);
+	SPI_SETBITS(_dev, 8);
+
+	for (unsigned i = 0; i < count; i++) {
+		SPI_SELECT(_dev, _device, true);
+		SPI_EXCHANGE(_dev, segments[i].send, segments[i].recv, segments[i].len);
+		SPI_SELECT(_dev, _device, false);
+	}
+
+	return PX4_OK;
+}
+
 int
 SPI::transferhword(uint16_t *send, uint16_t *recv, unsigned len)
 {
@@ -132,6 +132,32 @@ protected:
 	 */
 	int		transferhword(uint16_t *send, uint16_t *recv, unsigned len);
 
+	/**
+	 * One chip select period of a batched transfer, see transfer_batch().
+	 */
+	struct TransferSegment {
+		uint8_t *send;		/**< bytes to send, or nullptr */
+		uint8_t *recv;		/**< buffer for received bytes, or nullptr */
+		unsigned len;		/**< number of bytes to transfer */
+	};
+
+	static constexpr unsigned TRANSFER_BATCH_MAX{8};
+
+	/**
+	 * Perform several SPI transfers as one bus transaction.
+	 *
+	 * The device is deselected between segments, so every segment behaves
+	 * like a separate transfer() call.
+	 *
+	 * The bus is locked and configured only once for all segments.
+	 *
+	 * @param segments	Segments to transfer.
+	 * @param count		Number of segments, at most TRANSFER_BATCH_MAX.
+	 * @return		OK if all segments were transferred, -errno
+	 *			otherwise.
+	 */
+	int		transfer_batch(const TransferSegment *segments, unsigned count);
+
 	/**
 	 * Set the SPI bus frequency
 	 * This is used to change frequency on the fly. Some sensors
@@ -167,6 +193,8 @@ protected:
 
 	int	_transferhword(uint16_t *send, uint16_t *recv, unsigned len);
 
+	int	_transfer_batch(const TransferSegment *segments, unsigned count);
+
 	bool	external() const override { return px4_spi_bus_external(get_device_bus()); }
 
 };
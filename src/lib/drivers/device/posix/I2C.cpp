@@ -171,6 +171,72 @@ I2C::transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const
 	return ret;
 }
 
+int
+I2C::transfer_batch(const TransferSegment *segments, unsigned count)
+{
+	int ret = PX4_ERROR;
+	unsigned retry_count = 0;
+
+	if (_fd < 0) {
+		PX4_ERR("I2C device not opened");
+		return PX4_ERROR;
+	}
+
+	if ((count == 0) || (count > TRANSFER_BATCH_MAX)) {
+		return -EINVAL;
+	}
+
+	unsigned msgs = 0;
+	struct i2c_msg msgv[2 * TRANSFER_BATCH_MAX] {};
+
+	for (unsigned i = 0; i < count; i++) {
+		const TransferSegment &segment = segments[i];
+
+		if ((segment.send_len == 0) && (segment.recv_len == 0)) {
+			return -EINVAL;
+		}
+
+		if (segment.send_len > 0) {
+			msgv[msgs].addr = get_device_address();
+			msgv[msgs].flags = 0;
+			msgv[msgs].buf = const_cast<uint8_t *>(segment.send);
+			msgv[msgs].len = segment.send_len;
+			msgs++;
+		}
+
+		if (segment.recv_len > 0) {
+			msgv[msgs].addr = get_device_address();
+			msgv[msgs].flags = I2C_M_RD;
+			msgv[msgs].buf = segment.recv;
+			msgv[msgs].len = segment.recv_len;
+			msgs++;
+		}
+	}
+
+	do {
+		DEVICE_DEBUG("transfer batch %u segments, %u messages", count, msgs);
+
+		i2c_rdwr_ioctl_data packets{};
+		packets.msgs  = msgv;
+		packets.nmsgs = msgs;
+
+		int ret_ioctl = ::ioctl(_fd, I2C_RDWR, (unsigned long)&packets);
+
+		if (ret_ioctl == -1) {
+			DEVICE_DEBUG("I2C transfer failed");
+			ret = PX4_ERROR;
+
+		} else {
+			// success
+			ret = PX4_OK;
+			break;
+		}
+
+	} while (retry_count++ < _retries);
+
+	return ret;
+}
+
 } // namespace device
 
 #endif // __PX4_LINUX
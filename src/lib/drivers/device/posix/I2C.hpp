@@ -100,6 +100,34 @@ protected:
 	 */
 	int		transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const unsigned recv_len);
 
+	/**
+	 * One write and/or read of a batched transfer, see transfer_batch().
+	 */
+	struct TransferSegment {
+		const uint8_t *send;	/**< bytes to send */
+		unsigned send_len;	/**< number of bytes to send, or 0 */
+		uint8_t *recv;		/**< buffer for bytes received */
+		unsigned recv_len;	/**< number of bytes to receive, or 0 */
+	};
+
+	static constexpr unsigned TRANSFER_BATCH_MAX{8};
+
+	/**
+	 * Perform several I2C transactions to the device in one go.
+	 *
+	 * Every segment behaves like a transfer() call. At least one of
+	 * send_len and recv_len must be non-zero in every segment.
+	 *
+	 * All segments are submitted with a single I2C_RDWR ioctl, separated by
+	 * repeated start conditions instead of a stop.
+	 *
+	 * @param segments	Segments to transfer.
+	 * @param count		Number of segments, at most TRANSFER_BATCH_MAX.
+	 * @return		OK if the transfer was successful, -errno
+	 *			otherwise.
+	 */
+	int		transfer_batch(const TransferSegment *segments, unsigned count);
+
 	virtual bool	external() const override { return px4_i2c_bus_external(_device_id.devid_s.bus); }
 
 private:
@@ -88,6 +88,14 @@ SPI::init()
 		return PX4_ERROR;
 	}
 
+	// the mode is a setting of the spidev device, set it once instead of before every transfer
+	uint8_t mode = _mode;
+
+	if (::ioctl(_fd, SPI_IOC_WR_MODE, &mode) == -1) {
+		PX4_ERR("can’t set spi mode");
+		return PX4_ERROR;
+	}
+
 	/* call the probe function to check whether the device is present */
 	int ret = probe();
 
@@ -117,14 +125,6 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 		return -EINVAL;
 	}
 
-	// set write mode of SPI
-	int result = ::ioctl(_fd, SPI_IOC_WR_MODE, &_mode);
-
-	if (result == -1) {
-		PX4_ERR("can’t set spi mode");
-		return PX4_ERROR;
-	}
-
 	spi_ioc_transfer spi_transfer{};
 
 	spi_transfer.tx_buf = (uint64_t)send;
@@ -133,7 +133,7 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	spi_transfer.speed_hz = _frequency;
 	spi_transfer.bits_per_word = 8;
 
-	result = ::ioctl(_fd, SPI_IOC_MESSAGE(1), &spi_transfer);
+	int result = ::ioctl(_fd, SPI_IOC_MESSAGE(1), &spi_transfer);
 
 	if (result != (int)len) {
 		PX4_ERR("write failed. Reported %d bytes written (%s)", result, strerror(errno));
@@ -144,22 +144,54 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 }
 
 int
-SPI::transferhword(uint16_t *send, uint16_t *recv, unsigned len)
+SPI::transfer_batch(const TransferSegment *segments, unsigned count)
 {
-	if ((send == nullptr) && (recv == nullptr)) {
+	if ((count == 0) || (count > TRANSFER_BATCH_MAX)) {
 		return -EINVAL;
 	}
 
-	// set write mode of SPI
-	int result = ::ioctl(_fd, SPI_IOC_WR_MODE, &_mode);
+	spi_ioc_transfer spi_transfer[TRANSFER_BATCH_MAX] {};
+	unsigned len = 0;
 
-	if (result == -1) {
-		PX4_ERR("can’t set spi mode");
+	for (unsigned i = 0; i < count; i++) {
+		if ((segments[i].send == nullptr) && (segments[i].recv == nullptr)) {
+			return -EINVAL;
+		}
+
+		spi_transfer[i].tx_buf = (uint64_t)segments[i].send;
+		spi_transfer[i].rx_buf = (uint64_t)segments[i].recv;
+		spi_transfer[i].len = segments[i].len;
+		spi_transfer[i].speed_hz = _frequency;
+		spi_transfer[i].bits_per_word = 8;
+
+		// deselect between segments (on the last segment cs_change would keep the device selected)
+		spi_transfer[i].cs_change = (i + 1 < count);
+
+		len += segments[i].len;
+	}
+
+	// SPI_IOC_MESSAGE(count) with a non-constant count
+	const unsigned long request = _IOC(_IOC_WRITE, SPI_IOC_MAGIC, 0, count * sizeof(spi_ioc_transfer));
+
+	int result = ::ioctl(_fd, request, spi_transfer);
+
+	if (result != (int)len) {
+		PX4_ERR("write failed. Reported %d bytes written (%s)", result, strerror(errno));
 		return PX4_ERROR;
 	}
 
+	return PX4_OK;
+}
+
+int
+SPI::transferhword(uint16_t *send, uint16_t *recv, unsigned len)
+{
+	if ((send == nullptr) && (recv == nullptr)) {
+		return -EINVAL;
+	}
+
 	int bits = 16;
-	result = ::ioctl(_fd, SPI_IOC_WR_BITS_PER_WORD, &bits);
+	int result = ::ioctl(_fd, SPI_IOC_WR_BITS_PER_WORD, &bits);
 
 	if (result == -1) {
 		PX4_ERR("can’t set 16 bit spi mode");
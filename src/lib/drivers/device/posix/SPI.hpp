@@ -145,6 +145,34 @@ protected:
 	 */
 	int		transferhword(uint16_t *send, uint16_t *recv, unsigned len);
 
+	/**
+	 * One chip select period of a batched transfer, see transfer_batch().
+	 */
+	struct TransferSegment {
+		uint8_t *send;		/**< bytes to send, or nullptr */
+		uint8_t *recv;		/**< buffer for received bytes, or nullptr */
+		unsigned len;		/**< number of bytes to transfer */
+	};
+
+	static constexpr unsigned TRANSFER_BATCH_MAX{8};
+
+	/**
+	 * Perform several SPI transfers as one bus transaction.
+	 *
+	 * The device is deselected between segments, so every segment behaves
+	 * like a separate transfer() call.
+	 *
+	 * All segments are submitted with a single SPI_IOC_MESSAGE ioctl, so
+	 * no other device can access the bus in between. This saves a syscall
+	 * and a wakeup of the spi kernel thread per segment.
+	 *
+	 * @param segments	Segments to transfer.
+	 * @param count		Number of segments, at most TRANSFER_BATCH_MAX.
+	 * @return		OK if all segments were transferred, -errno
+	 *			otherwise.
+	 */
+	int		transfer_batch(const TransferSegment *segments, unsigned count);
+
 	/**
 	 * Set the SPI bus frequency
 	 * This is used to change frequency on the fly. Some sensors
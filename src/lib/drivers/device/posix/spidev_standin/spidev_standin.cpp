@@ -0,0 +1,594 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file spidev_standin.cpp
+ *
+ * Stand-in for a Linux spidev device with an emulated ICM-42688-P attached,
+ * used to benchmark the SPI transfers of device::SPI and the IMU drivers on a
+ * Linux host without the sensor. It is preloaded into the PX4 process and
+ * intercepts open(), close() and ioctl() on /dev/spidev*.
+ *
+ * The emulated sensor supports the register banks, soft reset, FIFO flush and
+ * a 16 kHz FIFO of constant 1 g samples, which is enough for the icm42688p
+ * driver to run its normal cycle. Every SPI_IOC_MESSAGE costs a real syscall
+ * plus the wire time of its segments at the requested clock, and the number
+ * of ioctls and segments is reported every 10 s and at exit.
+ *
+ * Usage: LD_PRELOAD=build/<target>/bin/libspidev_standin.so px4 ...
+ *  SPIDEV_STANDIN_PATH        device path prefix to emulate, default /dev/spidev
+ *  SPIDEV_STANDIN_MESSAGE_US  extra latency per SPI_IOC_MESSAGE (controller setup,
+ *                             kernel thread wakeup), default 0
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+namespace
+{
+
+// ICM-42688-P registers and bits (bank 0 unless noted)
+static constexpr uint8_t DIR_READ = 0x80;
+static constexpr uint8_t DEVICE_CONFIG = 0x11;
+static constexpr uint8_t FIFO_CONFIG = 0x16;
+static constexpr uint8_t INT_STATUS = 0x2D;
+static constexpr uint8_t FIFO_COUNTH = 0x2E;
+static constexpr uint8_t FIFO_COUNTL = 0x2F;
+static constexpr uint8_t FIFO_DATA = 0x30;
+static constexpr uint8_t SIGNAL_PATH_RESET = 0x4B;
+static constexpr uint8_t PWR_MGMT0 = 0x4E;
+static constexpr uint8_t WHO_AM_I = 0x75;
+static constexpr uint8_t REG_BANK_SEL = 0x76; // all banks
+
+static constexpr uint8_t WHOAMI = 0x47;
+static constexpr uint8_t SOFT_RESET_CONFIG = 0x01;
+static constexpr uint8_t FIFO_FLUSH = 0x02;
+static constexpr uint8_t RESET_DONE_INT = 0x10;
+static constexpr uint8_t FIFO_FULL_INT = 0x02;
+
+static constexpr unsigned FIFO_PACKET_SIZE = 20;                     // packet 4: accel, gyro, temperature, timestamp
+static constexpr unsigned FIFO_CAPACITY = 2048 / FIFO_PACKET_SIZE;   // packets
+static constexpr unsigned FIFO_RATE_HZ = 16000;
+
+static constexpr unsigned MAX_DEVICES = 8;
+static constexpr uint64_t REPORT_INTERVAL_US = 10000000;
+
+uint64_t monotonic_time_us()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t monotonic_time_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void busy_wait_ns(uint64_t duration_ns)
+{
+	const uint64_t end = monotonic_time_ns() + duration_ns;
+
+	while (monotonic_time_ns() < end) {}
+}
+
+class ICM42688P
+{
+public:
+	ICM42688P() { reset(); }
+
+	void transfer(const uint8_t *send, uint8_t *recv, unsigned len)
+	{
+		if (len == 0) {
+			return;
+		}
+
+		const uint8_t cmd = send ? send[0] : 0;
+		uint8_t reg = cmd & ~DIR_READ;
+
+		if (recv) {
+			recv[0] = 0;
+		}
+
+		if (cmd & DIR_READ) {
+			update_fifo();
+
+			for (unsigned i = 1; i < len; i++) {
+				const uint8_t value = read(reg);
+
+				if (recv) {
+					recv[i] = value;
+				}
+
+				// the FIFO is read through a single address
+				if (!(_bank == 0 && reg == FIFO_DATA)) {
+					reg++;
+				}
+			}
+
+		} else if (send) {
+			for (unsigned i = 1; i < len; i++) {
+				write(reg++, send[i]);
+			}
+		}
+	}
+
+private:
+	void reset()
+	{
+		memset(_registers, 0, sizeof(_registers));
+		_registers[0][WHO_AM_I] = WHOAMI;
+		_registers[0][INT_STATUS] = RESET_DONE_INT;
+		_bank = 0;
+		flush_fifo();
+	}
+
+	void flush_fifo()
+	{
+		_fifo_start_us = monotonic_time_us();
+		_fifo_generated = 0;
+		_fifo_read = 0;
+		_fifo_packet_offset = 0;
+	}
+
+	bool fifo_enabled() const
+	{
+		// FIFO_MODE not bypass, gyro and accel in low noise mode
+		return (_registers[0][FIFO_CONFIG] & 0xC0) && ((_registers[0][PWR_MGMT0] & 0x0F) == 0x0F);
+	}
+
+	void update_fifo()
+	{
+		if (!fifo_enabled()) {
+			flush_fifo();
+			return;
+		}
+
+		const uint64_t produced = (monotonic_time_us() - _fifo_start_us) * FIFO_RATE_HZ / 1000000;
+
+		if (produced - _fifo_read > FIFO_CAPACITY) {
+			// stop-on-full: the sensor drops new samples
+			_registers[0][INT_STATUS] |= FIFO_FULL_INT;
+			_fifo_generated = _fifo_read + FIFO_CAPACITY;
+
+		} else {
+			_fifo_generated = produced;
+		}
+	}
+
+	unsigned fifo_count_bytes() const
+	{
+		return (unsigned)(_fifo_generated - _fifo_read) * FIFO_PACKET_SIZE - _fifo_packet_offset;
+	}
+
+	uint8_t fifo_byte()
+	{
+		if (_fifo_generated == _fifo_read) {
+			// empty FIFO: header with HEADER_MSG set, invalid data
+			return 0x80;
+		}
+
+		const uint64_t index = _fifo_read;
+		const unsigned offset = _fifo_packet_offset;
+
+		if (++_fifo_packet_offset == FIFO_PACKET_SIZE) {
+			_fifo_packet_offset = 0;
+			_fifo_read++;
+		}
+
+		// z up 1 g (8192 LSB/g in 18 bit, left aligned to 20 bit), no rotation, 30 degC
+		static constexpr int32_t accel_z = 8192 * 4;
+		static constexpr int16_t temperature = (int16_t)((30 - 25) * 132.48);
+		const uint16_t timestamp = (uint16_t)(index * 1000000 / FIFO_RATE_HZ);
+
+		switch (offset) {
+		case 0:  return 0x78; // HEADER_ACCEL | HEADER_GYRO | HEADER_20 | timestamp
+
+		case 5:  return (accel_z >> 12) & 0xFF;
+
+		case 6:  return (accel_z >> 4) & 0xFF;
+
+		case 13: return (temperature >> 8) & 0xFF;
+
+		case 14: return temperature & 0xFF;
+
+		case 15: return timestamp >> 8;
+
+		case 16: return timestamp & 0xFF;
+
+		default: return 0;
+		}
+	}
+
+	uint8_t read(uint8_t reg)
+	{
+		if (reg == REG_BANK_SEL) {
+			return _bank << 4;
+		}
+
+		if (_bank == 0) {
+			switch (reg) {
+			case INT_STATUS: {
+					// clear on read
+					const uint8_t value = _registers[0][INT_STATUS];
+					_registers[0][INT_STATUS] = 0;
+					return value;
+				}
+
+			case FIFO_COUNTH:
+				_fifo_count_latched = fifo_count_bytes();
+				return _fifo_count_latched >> 8;
+
+			case FIFO_COUNTL:
+				return _fifo_count_latched & 0xFF;
+
+			case FIFO_DATA:
+				return fifo_byte();
+			}
+		}
+
+		return _registers[_bank][reg & 0x7F];
+	}
+
+	void write(uint8_t reg, uint8_t value)
+	{
+		if (reg == REG_BANK_SEL) {
+			_bank = (value >> 4) & 0x03;
+			return;
+		}
+
+		if (_bank == 0) {
+			if (reg == DEVICE_CONFIG && (value & SOFT_RESET_CONFIG)) {
+				reset();
+				return;
+			}
+
+			if (reg == SIGNAL_PATH_RESET && (value & FIFO_FLUSH)) {
+				flush_fifo();
+				value &= ~FIFO_FLUSH;
+			}
+
+			if (reg == WHO_AM_I || reg == INT_STATUS || reg == FIFO_COUNTH || reg == FIFO_COUNTL || reg == FIFO_DATA) {
+				// read only
+				return;
+			}
+		}
+
+		_registers[_bank][reg & 0x7F] = value;
+	}
+
+	uint8_t _registers[4][128];
+	uint8_t _bank{0};
+
+	uint64_t _fifo_start_us{0};
+	uint64_t _fifo_generated{0}; // packets written into the FIFO since the last flush
+	uint64_t _fifo_read{0};      // packets completely read since the last flush
+	unsigned _fifo_packet_offset{0};
+	unsigned _fifo_count_latched{0};
+};
+
+struct Device {
+	char path[32];
+	ICM42688P sensor;
+};
+
+struct Statistics {
+	uint64_t ioctls;
+	uint64_t messages;
+	uint64_t segments;
+	uint64_t bytes;
+};
+
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+Device *g_devices[MAX_DEVICES] {};
+Device *g_fd_device[1024] {};
+
+Statistics g_stats{};
+Statistics g_stats_reported{};
+uint64_t g_start_us{0};
+uint64_t g_report_us{0};
+
+int (*real_open)(const char *, int, ...) = nullptr;
+int (*real_open64)(const char *, int, ...) = nullptr;
+int (*real_close)(int) = nullptr;
+int (*real_ioctl)(int, unsigned long, ...) = nullptr;
+
+const char *device_prefix()
+{
+	const char *prefix = getenv("SPIDEV_STANDIN_PATH");
+	return prefix ? prefix : "/dev/spidev";
+}
+
+uint64_t message_overhead_ns()
+{
+	const char *overhead = getenv("SPIDEV_STANDIN_MESSAGE_US");
+	return overhead ? strtoull(overhead, nullptr, 10) * 1000 : 0;
+}
+
+void resolve()
+{
+	if (real_ioctl == nullptr) {
+		real_open = (int (*)(const char *, int, ...))dlsym(RTLD_NEXT, "open");
+		real_open64 = (int (*)(const char *, int, ...))dlsym(RTLD_NEXT, "open64");
+		real_close = (int (*)(int))dlsym(RTLD_NEXT, "close");
+		real_ioctl = (int (*)(int, unsigned long, ...))dlsym(RTLD_NEXT, "ioctl");
+	}
+}
+
+void print_statistics(const Statistics &stats, double elapsed_s, const char *label)
+{
+	fprintf(stderr, "spidev_standin %s: %.1f s, %llu ioctls (%.0f/s), %llu messages (%.0f/s) with %llu segments, %llu bytes\n",
+		label, elapsed_s,
+		(unsigned long long)stats.ioctls, stats.ioctls / elapsed_s,
+		(unsigned long long)stats.messages, stats.messages / elapsed_s,
+		(unsigned long long)stats.segments, (unsigned long long)stats.bytes);
+}
+
+// called with g_mutex held
+void report(uint64_t now)
+{
+	if (now - g_report_us < REPORT_INTERVAL_US) {
+		return;
+	}
+
+	Statistics interval{};
+	interval.ioctls = g_stats.ioctls - g_stats_reported.ioctls;
+	interval.messages = g_stats.messages - g_stats_reported.messages;
+	interval.segments = g_stats.segments - g_stats_reported.segments;
+	interval.bytes = g_stats.bytes - g_stats_reported.bytes;
+
+	print_statistics(interval, (now - g_report_us) * 1e-6, "last interval");
+
+	g_stats_reported = g_stats;
+	g_report_us = now;
+}
+
+bool is_emulated(const char *path)
+{
+	const char *prefix = device_prefix();
+	return path && strncmp(path, prefix, strlen(prefix)) == 0;
+}
+
+int open_emulated(const char *path)
+{
+	// a real file descriptor keeps the numbering consistent with the rest of the process
+	int fd = real_open("/dev/null", O_RDWR);
+
+	if (fd < 0 || fd >= (int)(sizeof(g_fd_device) / sizeof(g_fd_device[0]))) {
+		if (fd >= 0) {
+			real_close(fd);
+		}
+
+		errno = EMFILE;
+		return -1;
+	}
+
+	pthread_mutex_lock(&g_mutex);
+
+	Device *device = nullptr;
+
+	for (Device *d : g_devices) {
+		if (d && strcmp(d->path, path) == 0) {
+			device = d;
+			break;
+		}
+	}
+
+	if (device == nullptr) {
+		for (Device *&d : g_devices) {
+			if (d == nullptr) {
+				d = new Device();
+				snprintf(d->path, sizeof(d->path), "%s", path);
+				device = d;
+				break;
+			}
+		}
+	}
+
+	if (g_start_us == 0) {
+		g_start_us = g_report_us = monotonic_time_us();
+	}
+
+	g_fd_device[fd] = device;
+
+	pthread_mutex_unlock(&g_mutex);
+
+	if (device == nullptr) {
+		real_close(fd);
+		errno = ENODEV;
+		return -1;
+	}
+
+	fprintf(stderr, "spidev_standin: emulating ICM-42688-P on %s\n", path);
+	return fd;
+}
+
+int spi_message(Device *device, int fd, const spi_ioc_transfer *transfers, unsigned count)
+{
+	// the syscall a real spidev ioctl costs (fails with ENOTTY on /dev/null)
+	const int errno_saved = errno;
+	real_ioctl(fd, SPI_IOC_RD_MODE, nullptr);
+	errno = errno_saved;
+
+	uint64_t wire_time_ns = message_overhead_ns();
+	int len = 0;
+
+	pthread_mutex_lock(&g_mutex);
+
+	for (unsigned i = 0; i < count; i++) {
+		device->sensor.transfer((const uint8_t *)(uintptr_t)transfers[i].tx_buf, (uint8_t *)(uintptr_t)transfers[i].rx_buf,
+					transfers[i].len);
+
+		const unsigned speed_hz = transfers[i].speed_hz ? transfers[i].speed_hz : 1000000;
+		wire_time_ns += (uint64_t)transfers[i].len * 8 * 1000000000 / speed_hz;
+		len += transfers[i].len;
+	}
+
+	g_stats.messages++;
+	g_stats.segments += count;
+	g_stats.bytes += len;
+
+	pthread_mutex_unlock(&g_mutex);
+
+	// the caller blocks for the duration of the transfer
+	busy_wait_ns(wire_time_ns);
+
+	return len;
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) int open(const char *path, int flags, ...)
+{
+	resolve();
+
+	mode_t mode = 0;
+
+	if (flags & O_CREAT) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	if (is_emulated(path)) {
+		return open_emulated(path);
+	}
+
+	return real_open(path, flags, mode);
+}
+
+__attribute__((visibility("default"))) int open64(const char *path, int flags, ...)
+{
+	resolve();
+
+	mode_t mode = 0;
+
+	if (flags & O_CREAT) {
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+
+	if (is_emulated(path)) {
+		return open_emulated(path);
+	}
+
+	return real_open64(path, flags, mode);
+}
+
+__attribute__((visibility("default"))) int close(int fd)
+{
+	resolve();
+
+	if (fd >= 0 && fd < (int)(sizeof(g_fd_device) / sizeof(g_fd_device[0]))) {
+		pthread_mutex_lock(&g_mutex);
+		g_fd_device[fd] = nullptr;
+		pthread_mutex_unlock(&g_mutex);
+	}
+
+	return real_close(fd);
+}
+
+__attribute__((visibility("default"))) int ioctl(int fd, unsigned long request, ...)
+{
+	resolve();
+
+	va_list args;
+	va_start(args, request);
+	void *arg = va_arg(args, void *);
+	va_end(args);
+
+	Device *device = nullptr;
+
+	if (fd >= 0 && fd < (int)(sizeof(g_fd_device) / sizeof(g_fd_device[0]))) {
+		pthread_mutex_lock(&g_mutex);
+		device = g_fd_device[fd];
+		pthread_mutex_unlock(&g_mutex);
+	}
+
+	if (device == nullptr) {
+		return real_ioctl(fd, request, arg);
+	}
+
+	pthread_mutex_lock(&g_mutex);
+	g_stats.ioctls++;
+	report(monotonic_time_us());
+	pthread_mutex_unlock(&g_mutex);
+
+	if (_IOC_TYPE(request) == SPI_IOC_MAGIC && _IOC_NR(request) == 0 && _IOC_DIR(request) == _IOC_WRITE) {
+		// SPI_IOC_MESSAGE(n)
+		const unsigned count = _IOC_SIZE(request) / sizeof(spi_ioc_transfer);
+
+		if (count == 0 || _IOC_SIZE(request) % sizeof(spi_ioc_transfer) != 0 || arg == nullptr) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		return spi_message(device, fd, static_cast<const spi_ioc_transfer *>(arg), count);
+	}
+
+	if (_IOC_TYPE(request) == SPI_IOC_MAGIC) {
+		// mode, bits per word, speed: accepted, the emulated sensor does not care
+		return 0;
+	}
+
+	errno = ENOTTY;
+	return -1;
+}
+
+} // extern "C"
+
+__attribute__((destructor)) static void spidev_standin_exit()
+{
+	if (g_start_us != 0) {
+		print_statistics(g_stats, (monotonic_time_us() - g_start_us) * 1e-6, "total");
+	}
+}
@@ -160,4 +160,22 @@ I2C::transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const
 	return ret;
 }
 
+int
+I2C::transfer_batch(const TransferSegment *segments, unsigned count)
+{
+	if ((count == 0) || (count > TRANSFER_BATCH_MAX)) {
+		return -EINVAL;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		int ret = transfer(segments[i].send, segments[i].send_len, segments[i].recv, segments[i].recv_len);
+
+		if (ret != PX4_OK) {
+			return ret;
+		}
+	}
+
+	return PX4_OK;
+}
+
 } // namespace device
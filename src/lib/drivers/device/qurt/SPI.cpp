@@ -153,6 +153,24 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	return PX4_OK;
 }
 
+int
+SPI::transfer_batch(const TransferSegment *segments, unsigned count)
+{
+	if ((count == 0) || (count > TRANSFER_BATCH_MAX)) {
+		return -EINVAL;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		int result = transfer(segments[i].send, segments[i].recv, segments[i].len);
+
+		if (result != PX4_OK) {
+			return result;
+		}
+	}
+
+	return PX4_OK;
+}
+
 int
 SPI::transferhword(uint16_t *send, uint16_t *recv, unsigned len)
 {
@@ -130,6 +130,32 @@ protected:
 	 */
 	int		transferhword(uint16_t *send, uint16_t *recv, unsigned len);
 
+	/**
+	 * One chip select period of a batched transfer, see transfer_batch().
+	 */
+	struct TransferSegment {
+		uint8_t *send;		/**< bytes to send, or nullptr */
+		uint8_t *recv;		/**< buffer for received bytes, or nullptr */
+		unsigned len;		/**< number of bytes to transfer */
+	};
+
+	static constexpr unsigned TRANSFER_BATCH_MAX{8};
+
+	/**
+	 * Perform several SPI transfers as one bus transaction.
+	 *
+	 * The device is deselected between segments, so every segment behaves
+	 * like a separate transfer() call.
+	 *
+	 * On QURT the segments are transferred one by one.
+	 *
+	 * @param segments	Segments to transfer.
+	 * @param count		Number of segments, at most TRANSFER_BATCH_MAX.
+	 * @return		OK if all segments were transferred, -errno
+	 *			otherwise.
+	 */
+	int		transfer_batch(const TransferSegment *segments, unsigned count);
+
 	/**
 	 * Set the SPI bus frequency
 	 * This is used to change frequency on the fly. Some sensors
@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "FIFOPipeline.hpp"
+
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/time.h>
+
+FIFOPipelineBase::FIFOPipelineBase(const char *name, const char *handoff_name) :
+	px4::WorkItem(name, px4::wq_configurations::imu_process),
+	_process_perf(perf_alloc(PC_ELAPSED, name)),
+	_handoff_perf(perf_alloc(PC_ELAPSED, handoff_name))
+{
+}
+
+FIFOPipelineBase::~FIFOPipelineBase()
+{
+	perf_free(_process_perf);
+	perf_free(_handoff_perf);
+}
+
+int FIFOPipelineBase::acquire_index()
+{
+	for (int i = 0; i < BUFFERS; i++) {
+		uint32_t expected = FREE;
+
+		if (_slots[i].state.compare_exchange(&expected, FILLING)) {
+			return i;
+		}
+	}
+
+	_full_count++;
+	return -1;
+}
+
+void FIFOPipelineBase::submit_index(int index, const hrt_abstime &timestamp_sample, uint8_t samples)
+{
+	Slot &slot = _slots[index];
+	slot.sequence = _sequence++;
+	slot.timestamp_sample = timestamp_sample;
+	slot.submit_time = hrt_absolute_time();
+	slot.samples = samples;
+
+	// publishes the buffer and slot fields to the processing work queue
+	slot.state.store(READY);
+
+	_scheduled.store(true);
+	ScheduleNow();
+}
+
+void FIFOPipelineBase::release_index(int index)
+{
+	_slots[index].state.store(FREE);
+}
+
+void FIFOPipelineBase::flush()
+{
+	// batches that did not start processing are dropped, Run() claims a batch with a CAS as well
+	for (int i = 0; i < BUFFERS; i++) {
+		uint32_t expected = READY;
+
+		if (_slots[i].state.compare_exchange(&expected, FREE)) {
+			_flushed_count++;
+		}
+	}
+
+	// wait for a scheduled or running Run(), it only finishes the batch it already claimed.
+	// _scheduled is cleared after _running is set, so checking them in this order cannot miss a run.
+	while (_scheduled.load() || _running.load()) {
+		px4_usleep(50);
+	}
+}
+
+void FIFOPipelineBase::Run()
+{
+	_running.store(true);
+	_scheduled.store(false);
+
+	// process every submitted batch oldest first, a run can find more than the one it was scheduled for
+	while (true) {
+		int oldest = -1;
+
+		for (int i = 0; i < BUFFERS; i++) {
+			if ((_slots[i].state.load() == READY)
+			    && ((oldest < 0) || (int32_t)(_slots[i].sequence - _slots[oldest].sequence) < 0)) {
+				oldest = i;
+			}
+		}
+
+		if (oldest < 0) {
+			break;
+		}
+
+		Slot &slot = _slots[oldest];
+		uint32_t expected = READY;
+
+		if (!slot.state.compare_exchange(&expected, PROCESSING)) {
+			// dropped by flush()
+			continue;
+		}
+
+		perf_set_elapsed(_handoff_perf, hrt_elapsed_time(&slot.submit_time));
+		perf_begin(_process_perf);
+
+		if (!process(oldest, slot.timestamp_sample, slot.samples)) {
+			_process_failures.fetch_add(1);
+		}
+
+		perf_end(_process_perf);
+
+		slot.state.store(FREE);
+	}
+
+	// last access, the driver may be destroyed as soon as flush() sees this
+	_running.store(false);
+}
+
+void FIFOPipelineBase::print_status()
+{
+	PX4_INFO("FIFO processing stage busy: %u transfers skipped, %u batches flushed", (unsigned)_full_count,
+		 (unsigned)_flushed_count);
+	perf_print_counter(_process_perf);
+	perf_print_counter(_handoff_perf);
+}
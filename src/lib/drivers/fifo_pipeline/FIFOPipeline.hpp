@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file FIFOPipeline.hpp
+ *
+ * Double buffered processing stage for sensor FIFO drivers.
+ *
+ * The driver transfers the sensor FIFO into one buffer on its bus work queue
+ * and hands it over to a separate work queue that converts and publishes the
+ * data, while the bus work queue continues with the next transfer into the
+ * other buffer. The bus thread is then blocked only for the transfers and can
+ * serve other devices on the bus while a batch is processed.
+ *
+ * If both buffers are still owned by the processing stage the driver skips the
+ * transfer and leaves the samples in the sensor FIFO for the next cycle.
+ *
+ * Two perf counters show the cost of the extra work queue hop: the processing
+ * time and the handoff delay from submit() until the processing starts.
+ *
+ * The driver must flush() the pipeline before it changes anything the processing
+ * depends on (reset, register configuration, ranges, sample rate) and before it
+ * is destroyed, so that no batch is processed concurrently with the change.
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <lib/perf/perf_counter.h>
+#include <px4_platform_common/atomic.h>
+#include <px4_platform_common/px4_work_queue/WorkItem.hpp>
+
+class FIFOPipelineBase : public px4::WorkItem
+{
+public:
+	static constexpr int BUFFERS = 2;
+
+	/**
+	 * @param name		work item name, also used for the processing time perf counter
+	 * @param handoff_name	name of the handoff delay perf counter
+	 */
+	FIFOPipelineBase(const char *name, const char *handoff_name);
+	~FIFOPipelineBase() override;
+
+	/**
+	 * Drop the batches not yet processed and wait until the processing stage is idle (bus work queue).
+	 */
+	void flush();
+
+	/**
+	 * Number of batches the processing stage rejected since the last call
+	 * (e.g. because a plausibility check indicated a transfer error).
+	 */
+	uint32_t process_failures() { return _process_failures.fetch_and(0); }
+
+	void print_status();
+
+protected:
+	/**
+	 * Reserve a free buffer for the next transfer (bus work queue).
+	 * @return buffer index, or -1 if the processing stage owns all buffers
+	 */
+	int acquire_index();
+
+	/**
+	 * Hand a filled buffer over to the processing stage (bus work queue).
+	 */
+	void submit_index(int index, const hrt_abstime &timestamp_sample, uint8_t samples);
+
+	/**
+	 * Return a reserved buffer without processing it, e.g. after a failed transfer (bus work queue).
+	 */
+	void release_index(int index);
+
+	/**
+	 * Convert and publish a batch (processing work queue).
+	 * @return false if the batch was rejected
+	 */
+	virtual bool process(int index, const hrt_abstime &timestamp_sample, uint8_t samples) = 0;
+
+	void Run() override;
+
+private:
+
+	enum State : uint32_t {
+		FREE,       // owned by nobody
+		FILLING,    // owned by the bus work queue
+		READY,      // submitted, waiting for the processing work queue
+		PROCESSING, // owned by the processing work queue
+	};
+
+	struct Slot {
+		px4::atomic<uint32_t> state{FREE};
+		uint32_t sequence{0};
+		hrt_abstime timestamp_sample{0};
+		hrt_abstime submit_time{0};
+		uint8_t samples{0};
+	};
+
+	Slot _slots[BUFFERS] {};
+	uint32_t _sequence{0};
+
+	px4::atomic_bool _scheduled{false}; // submitted, Run() not entered yet
+	px4::atomic_bool _running{false};
+
+	px4::atomic<uint32_t> _process_failures{0};
+	uint32_t _full_count{0};
+	uint32_t _flushed_count{0};
+
+	perf_counter_t _process_perf;
+	perf_counter_t _handoff_perf;
+};
+
+/**
+ * Processing stage owning the transfer buffers of a driver.
+ *
+ * @tparam Buffer transfer buffer type, reset to its default state before every transfer
+ * @tparam Driver driver class, its process callback runs on the processing work queue
+ */
+template <typename Buffer, typename Driver>
+class FIFOPipeline : public FIFOPipelineBase
+{
+public:
+	using ProcessCallback = bool (Driver::*)(const Buffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples);
+
+	FIFOPipeline(Driver *driver, ProcessCallback callback, const char *name, const char *handoff_name) :
+		FIFOPipelineBase(name, handoff_name),
+		_driver(driver),
+		_callback(callback)
+	{}
+
+	/**
+	 * Get a buffer for the next transfer.
+	 * @return nullptr if no buffer is free
+	 */
+	Buffer *acquire()
+	{
+		const int index = acquire_index();
+
+		if (index < 0) {
+			return nullptr;
+		}
+
+		// transfers are in place, restore the command bytes
+		_buffers[index] = Buffer{};
+		return &_buffers[index];
+	}
+
+	void submit(Buffer *buffer, const hrt_abstime &timestamp_sample, uint8_t samples)
+	{
+		submit_index(buffer - _buffers, timestamp_sample, samples);
+	}
+
+	void release(Buffer *buffer) { release_index(buffer - _buffers); }
+
+private:
+	bool process(int index, const hrt_abstime &timestamp_sample, uint8_t samples) override
+	{
+		return (_driver->*_callback)(_buffers[index], timestamp_sample, samples);
+	}
+
+	Driver *const _driver;
+	const ProcessCallback _callback;
+
+	Buffer _buffers[BUFFERS] {};
+};
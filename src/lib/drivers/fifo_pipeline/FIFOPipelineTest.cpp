@@ -0,0 +1,252 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file FIFOPipelineTest.cpp
+ *
+ * The work queue manager is not running in the test, so ScheduleNow() does nothing
+ * and the tests call Run() themselves, from a separate thread where the driver and
+ * the processing stage have to run concurrently.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <px4_platform_common/time.h>
+
+#include "FIFOPipeline.hpp"
+
+namespace
+{
+
+struct TestBuffer {
+	uint32_t value{0};
+};
+
+class TestDriver
+{
+public:
+	bool process(const TestBuffer &buffer, const hrt_abstime &timestamp_sample, uint8_t samples)
+	{
+		entered.store(true);
+
+		while (block.load()) {
+			px4_usleep(100);
+		}
+
+		processed.push_back(buffer.value);
+		return buffer.value != 0;
+	}
+
+	std::vector<uint32_t> processed;
+	std::atomic<bool> entered{false};
+	std::atomic<bool> block{false};
+};
+
+class TestPipeline : public FIFOPipeline<TestBuffer, TestDriver>
+{
+public:
+	explicit TestPipeline(TestDriver *driver) :
+		FIFOPipeline(driver, &TestDriver::process, "FIFOPipelineTest", "FIFOPipelineTest handoff")
+	{}
+
+	void run() { Run(); }
+};
+
+} // namespace
+
+class FIFOPipelineTest : public ::testing::Test
+{
+public:
+	TestDriver _driver;
+	TestPipeline _pipeline{&_driver};
+};
+
+TEST_F(FIFOPipelineTest, processesInSubmitOrder)
+{
+	// GIVEN: both buffers acquired and submitted in reverse order
+	TestBuffer *first = _pipeline.acquire();
+	TestBuffer *second = _pipeline.acquire();
+	ASSERT_NE(first, nullptr);
+	ASSERT_NE(second, nullptr);
+	EXPECT_NE(first, second);
+
+	second->value = 1;
+	_pipeline.submit(second, 100, 1);
+	first->value = 2;
+	_pipeline.submit(first, 200, 1);
+
+	// WHEN: the processing stage runs
+	_pipeline.run();
+
+	// THEN: the batches are processed oldest first and both buffers are free again
+	ASSERT_EQ(_driver.processed.size(), 2u);
+	EXPECT_EQ(_driver.processed[0], 1u);
+	EXPECT_EQ(_driver.processed[1], 2u);
+	EXPECT_EQ(_pipeline.process_failures(), 0u);
+
+	EXPECT_NE(_pipeline.acquire(), nullptr);
+	EXPECT_NE(_pipeline.acquire(), nullptr);
+}
+
+TEST_F(FIFOPipelineTest, skipsTransferWhenFull)
+{
+	// GIVEN: both buffers owned by the processing stage
+	TestBuffer *first = _pipeline.acquire();
+	TestBuffer *second = _pipeline.acquire();
+	first->value = 1;
+	second->value = 2;
+	_pipeline.submit(first, 100, 1);
+	_pipeline.submit(second, 200, 1);
+
+	// THEN: no buffer is available for the next transfer
+	EXPECT_EQ(_pipeline.acquire(), nullptr);
+
+	// AND: one is available again once the batches are processed
+	_pipeline.run();
+	EXPECT_NE(_pipeline.acquire(), nullptr);
+}
+
+TEST_F(FIFOPipelineTest, releaseResetsBuffer)
+{
+	// GIVEN: a buffer released without processing, e.g. after a failed transfer
+	TestBuffer *buffer = _pipeline.acquire();
+	buffer->value = 42;
+	_pipeline.release(buffer);
+
+	// THEN: both buffers can be acquired and are reset to their default state
+	TestBuffer *first = _pipeline.acquire();
+	TestBuffer *second = _pipeline.acquire();
+	ASSERT_NE(first, nullptr);
+	ASSERT_NE(second, nullptr);
+	EXPECT_EQ(first->value, 0u);
+	EXPECT_EQ(second->value, 0u);
+
+	// AND: nothing was processed
+	_pipeline.run();
+	EXPECT_TRUE(_driver.processed.empty());
+}
+
+TEST_F(FIFOPipelineTest, countsProcessFailures)
+{
+	// GIVEN: a batch the driver rejects (value 0) and one it accepts
+	TestBuffer *rejected = _pipeline.acquire();
+	_pipeline.submit(rejected, 100, 1);
+	TestBuffer *accepted = _pipeline.acquire();
+	accepted->value = 1;
+	_pipeline.submit(accepted, 200, 1);
+
+	// WHEN: they are processed
+	_pipeline.run();
+
+	// THEN: the failure is reported once
+	EXPECT_EQ(_pipeline.process_failures(), 1u);
+	EXPECT_EQ(_pipeline.process_failures(), 0u);
+}
+
+TEST_F(FIFOPipelineTest, flushDropsSubmittedBatches)
+{
+	// GIVEN: two submitted batches that did not start processing
+	TestBuffer *first = _pipeline.acquire();
+	TestBuffer *second = _pipeline.acquire();
+	first->value = 1;
+	second->value = 2;
+	_pipeline.submit(first, 100, 1);
+	_pipeline.submit(second, 200, 1);
+
+	// WHEN: the driver flushes the pipeline
+	std::atomic<bool> flushed{false};
+	std::thread flush_thread([&]() {
+		_pipeline.flush();
+		flushed.store(true);
+	});
+
+	// THEN: the batches are dropped right away, a buffer becomes free
+	TestBuffer *buffer = nullptr;
+
+	for (int i = 0; (i < 1000) && (buffer == nullptr); i++) {
+		buffer = _pipeline.acquire();
+		px4_usleep(1000);
+	}
+
+	ASSERT_NE(buffer, nullptr);
+	_pipeline.release(buffer);
+
+	// AND: flush() still waits for the scheduled run
+	px4_usleep(10000);
+	EXPECT_FALSE(flushed.load());
+
+	// AND: returns after the run, which has nothing left to process
+	_pipeline.run();
+	flush_thread.join();
+	EXPECT_TRUE(flushed.load());
+	EXPECT_TRUE(_driver.processed.empty());
+}
+
+TEST_F(FIFOPipelineTest, flushWaitsForRunningBatch)
+{
+	// GIVEN: a batch being processed
+	TestBuffer *buffer = _pipeline.acquire();
+	buffer->value = 1;
+	_pipeline.submit(buffer, 100, 1);
+
+	_driver.block.store(true);
+	std::thread run_thread([&]() { _pipeline.run(); });
+
+	while (!_driver.entered.load()) {
+		px4_usleep(100);
+	}
+
+	// WHEN: the driver flushes the pipeline
+	std::atomic<bool> flushed{false};
+	std::thread flush_thread([&]() {
+		_pipeline.flush();
+		flushed.store(true);
+	});
+
+	// THEN: flush() blocks until the batch is finished
+	px4_usleep(10000);
+	EXPECT_FALSE(flushed.load());
+
+	_driver.block.store(false);
+	run_thread.join();
+	flush_thread.join();
+
+	EXPECT_TRUE(flushed.load());
+	ASSERT_EQ(_driver.processed.size(), 1u);
+	EXPECT_EQ(_driver.processed[0], 1u);
+}
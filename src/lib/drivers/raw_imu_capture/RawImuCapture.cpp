@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "RawImuCapture.hpp"
+
+namespace raw_imu_capture
+{
+
+template<typename Q>
+struct Capture {
+	px4::atomic<Q *> queue{};
+	px4::atomic_bool active{};
+};
+
+static Capture<GyroQueue> gyro_capture[MAX_INSTANCES] {};
+static Capture<AccelQueue> accel_capture[MAX_INSTANCES] {};
+
+template<typename Q>
+static Q *start(Capture<Q> &capture)
+{
+	Q *queue = capture.queue.load();
+
+	if (queue == nullptr) {
+		// never freed, a producer might still hold the pointer
+		queue = new Q();
+
+		if (queue == nullptr) {
+			return nullptr;
+		}
+
+		capture.queue.store(queue);
+	}
+
+	queue->flush();
+	capture.active.store(true);
+	return queue;
+}
+
+template<typename Q, typename T>
+static bool push(Capture<Q> &capture, const T &sample)
+{
+	if (capture.active.load()) {
+		return capture.queue.load()->push(sample);
+	}
+
+	return false;
+}
+
+GyroQueue *start_gyro(uint8_t instance)
+{
+	return (instance < MAX_INSTANCES) ? start(gyro_capture[instance]) : nullptr;
+}
+
+AccelQueue *start_accel(uint8_t instance)
+{
+	return (instance < MAX_INSTANCES) ? start(accel_capture[instance]) : nullptr;
+}
+
+void stop()
+{
+	for (uint8_t i = 0; i < MAX_INSTANCES; i++) {
+		gyro_capture[i].active.store(false);
+		accel_capture[i].active.store(false);
+	}
+}
+
+bool push(uint8_t instance, const sensor_gyro_fifo_s &sample)
+{
+	return (instance < MAX_INSTANCES) && push(gyro_capture[instance], sample);
+}
+
+bool push(uint8_t instance, const sensor_accel_fifo_s &sample)
+{
+	return (instance < MAX_INSTANCES) && push(accel_capture[instance], sample);
+}
+
+} // namespace raw_imu_capture
@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file RawImuCapture.hpp
+ *
+ * Lossless capture of the raw gyro and accel FIFO data for logging.
+ *
+ * The driver pushes every FIFO message into a preallocated queue and the logger
+ * drains the queue in bulk, independent of the uORB queue depth and logger rate.
+ */
+
+#pragma once
+
+#include <px4_platform_common/atomic.h>
+#include <uORB/topics/sensor_accel_fifo.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
+
+namespace raw_imu_capture
+{
+
+/**
+ * Lock-free single producer, single consumer queue with fixed capacity.
+ * The producer never blocks, pushing to a full queue drops the new item and counts it.
+ */
+template<typename T, uint32_t N>
+class SpscQueue
+{
+public:
+	static_assert((N & (N - 1)) == 0, "queue length must be a power of 2");
+
+	using value_type = T;
+
+	/**
+	 * Add an item (producer)
+	 * @return false if the queue is full and the item was dropped
+	 */
+	bool push(const T &item)
+	{
+		const uint32_t head = _head.load();
+
+		if (head - _tail.load() >= N) {
+			_dropped.fetch_add(1);
+			return false;
+		}
+
+		_buffer[head & (N - 1)] = item;
+		_head.store(head + 1);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest item (consumer)
+	 * @return false if the queue is empty
+	 */
+	bool pop(T &item)
+	{
+		const uint32_t tail = _tail.load();
+
+		if (tail == _head.load()) {
+			return false;
+		}
+
+		item = _buffer[tail & (N - 1)];
+		_tail.store(tail + 1);
+		return true;
+	}
+
+	/**
+	 * Discard all queued items and dropped counts (consumer)
+	 */
+	void flush()
+	{
+		_tail.store(_head.load());
+		new_drops();
+	}
+
+	/**
+	 * Number of items dropped since the last call (consumer)
+	 */
+	uint32_t new_drops()
+	{
+		const uint32_t dropped = _dropped.load();
+		const uint32_t new_drops = dropped - _dropped_reported;
+		_dropped_reported = dropped;
+		return new_drops;
+	}
+
+	uint32_t size() const { return _head.load() - _tail.load(); }
+
+	static constexpr uint32_t capacity() { return N; }
+
+private:
+	T _buffer[N] {};
+
+	px4::atomic<uint32_t> _head{};
+	px4::atomic<uint32_t> _tail{};
+	px4::atomic<uint32_t> _dropped{};
+
+	uint32_t _dropped_reported{0};
+};
+
+// queues are only allocated for the captured instances
+static constexpr uint8_t MAX_INSTANCES = 4;
+
+// maximum FIFO publication rate of the drivers
+static constexpr uint32_t MAX_PUBLICATION_RATE_HZ = 2000;
+
+// The logger main loop runs at low priority and can be held off by higher priority tasks.
+// Its writer was measured up to about 70 ms in ready state (see the logger watchdog),
+// the queue covers 100 ms (about 57 kB per queue).
+static constexpr uint32_t MAX_LOGGER_STALL_MS = 100;
+
+static constexpr uint32_t QUEUE_LENGTH = 256;
+static_assert(QUEUE_LENGTH >= MAX_PUBLICATION_RATE_HZ * MAX_LOGGER_STALL_MS / 1000, "queue too short for the logger stall");
+
+using GyroQueue = SpscQueue<sensor_gyro_fifo_s, QUEUE_LENGTH>;
+using AccelQueue = SpscQueue<sensor_accel_fifo_s, QUEUE_LENGTH>;
+
+/**
+ * Pass all queued messages to write() (consumer)
+ * @return number of messages dropped since the last call, the logger counts them as message gaps
+ */
+template<typename Q, typename F>
+uint32_t drain(Q &queue, F write)
+{
+	typename Q::value_type sample;
+
+	while (queue.pop(sample)) {
+		write(sample);
+	}
+
+	return queue.new_drops();
+}
+
+/**
+ * Start capturing a FIFO instance (consumer). The queue is allocated on first use and kept afterwards.
+ * @return the flushed queue, or nullptr if the instance is invalid or allocation failed
+ */
+GyroQueue *start_gyro(uint8_t instance);
+AccelQueue *start_accel(uint8_t instance);
+
+/**
+ * Stop capturing all instances (consumer)
+ */
+void stop();
+
+/**
+ * Queue a FIFO message if the instance is captured (producer)
+ * @return true if queued
+ */
+bool push(uint8_t instance, const sensor_gyro_fifo_s &sample);
+bool push(uint8_t instance, const sensor_accel_fifo_s &sample);
+
+} // namespace raw_imu_capture
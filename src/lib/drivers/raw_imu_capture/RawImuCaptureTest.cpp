@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file RawImuCaptureTest.cpp
+ * Tests for the raw IMU FIFO capture queues.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "RawImuCapture.hpp"
+
+using namespace raw_imu_capture;
+
+static constexpr uint8_t FIFO_SAMPLES = 8;     // samples per FIFO message
+static constexpr uint32_t FIFO_DT_US = 125;    // 8 kHz ODR
+
+static sensor_gyro_fifo_s gyroFifo(uint32_t sequence)
+{
+	sensor_gyro_fifo_s sample{};
+	sample.timestamp_sample = sequence * FIFO_SAMPLES * FIFO_DT_US;
+	sample.dt = FIFO_DT_US;
+	sample.samples = FIFO_SAMPLES;
+
+	for (int i = 0; i < FIFO_SAMPLES; i++) {
+		sample.x[i] = (int16_t)(sequence * FIFO_SAMPLES + i);
+	}
+
+	return sample;
+}
+
+// count the messages missing in a stream of FIFO messages, based on the sample timestamps
+class GapCounter
+{
+public:
+	void check(const sensor_gyro_fifo_s &sample)
+	{
+		if ((_received > 0) && (sample.timestamp_sample != _last_timestamp_sample + FIFO_SAMPLES * FIFO_DT_US)) {
+			_gaps += (sample.timestamp_sample - _last_timestamp_sample) / (FIFO_SAMPLES * FIFO_DT_US) - 1;
+		}
+
+		_last_timestamp_sample = sample.timestamp_sample;
+		_received++;
+	}
+
+	uint32_t gaps() const { return _gaps; }
+	uint32_t received() const { return _received; }
+	uint32_t last_sequence() const { return _last_timestamp_sample / (FIFO_SAMPLES * FIFO_DT_US); }
+
+private:
+	uint64_t _last_timestamp_sample{0};
+	uint32_t _gaps{0};
+	uint32_t _received{0};
+};
+
+TEST(RawImuCaptureTest, QueueOrderAndOverflow)
+{
+	// GIVEN: a queue filled beyond its capacity
+	GyroQueue queue;
+	const uint32_t overflow = 3;
+
+	for (uint32_t n = 0; n < GyroQueue::capacity() + overflow; n++) {
+		EXPECT_EQ(queue.push(gyroFifo(n)), n < GyroQueue::capacity());
+	}
+
+	// THEN: the newest messages are dropped and counted once
+	EXPECT_EQ(queue.size(), GyroQueue::capacity());
+	EXPECT_EQ(queue.new_drops(), overflow);
+	EXPECT_EQ(queue.new_drops(), 0u);
+
+	// AND: the queued messages come out in order
+	sensor_gyro_fifo_s sample;
+
+	for (uint32_t n = 0; n < GyroQueue::capacity(); n++) {
+		ASSERT_TRUE(queue.pop(sample));
+		EXPECT_EQ(sample.x[0], (int16_t)(n * FIFO_SAMPLES));
+	}
+
+	EXPECT_FALSE(queue.pop(sample));
+}
+
+TEST(RawImuCaptureTest, OnlyCapturedInstancesAreQueued)
+{
+	const sensor_gyro_fifo_s sample = gyroFifo(0);
+
+	// GIVEN: no capture started
+	EXPECT_FALSE(push(0, sample));
+
+	// WHEN: the capture of instance 0 starts
+	GyroQueue *queue = start_gyro(0);
+	ASSERT_NE(queue, nullptr);
+
+	// THEN: only instance 0 is queued
+	EXPECT_TRUE(push(0, sample));
+	EXPECT_FALSE(push(1, sample));
+	EXPECT_FALSE(push(0, sensor_accel_fifo_s{}));
+	EXPECT_FALSE(push(MAX_INSTANCES, sample));
+	EXPECT_EQ(start_gyro(MAX_INSTANCES), nullptr);
+
+	// WHEN: the capture stops
+	stop();
+
+	// THEN: nothing is queued anymore, and a restart flushes the old data
+	EXPECT_FALSE(push(0, sample));
+	EXPECT_EQ(queue->size(), 1u);
+	EXPECT_EQ(start_gyro(0), queue);
+	EXPECT_EQ(queue->size(), 0u);
+	stop();
+}
+
+TEST(RawImuCaptureTest, NoGapsAtMaxRate)
+{
+	// GIVEN: FIFO messages published at the maximum rate and a logger draining every 3.5 ms,
+	// stalled for the longest expected time every 10th iteration
+	GyroQueue *queue = start_gyro(0);
+	ASSERT_NE(queue, nullptr);
+
+	GapCounter counter;
+	uint32_t published = 0;
+	uint32_t message_gaps = 0;
+
+	for (int loop = 0; loop < 1000; loop++) {
+		const uint32_t publish_interval_us = 1000000 / MAX_PUBLICATION_RATE_HZ;
+		const uint32_t log_interval_us = (loop % 10 == 9) ? MAX_LOGGER_STALL_MS * 1000 : 3500;
+
+		for (uint32_t t = 0; t < log_interval_us; t += publish_interval_us) {
+			push(0, gyroFifo(published++));
+		}
+
+		// WHEN: the logger drains the queue in bulk
+		message_gaps += drain(*queue, [&counter](const sensor_gyro_fifo_s & sample) { counter.check(sample); });
+	}
+
+	// THEN: every sample is logged and the logger counts no message gaps
+	EXPECT_EQ(counter.received(), published);
+	EXPECT_EQ(counter.gaps(), 0u);
+	EXPECT_EQ(message_gaps, 0u);
+	stop();
+}
+
+TEST(RawImuCaptureTest, LongerStallCountedAsGaps)
+{
+	// GIVEN: a logger stalled for longer than the queue holds
+	GyroQueue *queue = start_gyro(0);
+	ASSERT_NE(queue, nullptr);
+
+	GapCounter counter;
+	const uint32_t overflow = 5;
+	uint32_t published = 0;
+
+	for (uint32_t n = 0; n < QUEUE_LENGTH + overflow; n++) {
+		push(0, gyroFifo(published++));
+	}
+
+	// WHEN: the logger drains the queue, and again after the next message
+	uint32_t message_gaps = drain(*queue, [&counter](const sensor_gyro_fifo_s & sample) { counter.check(sample); });
+	push(0, gyroFifo(published++));
+	message_gaps += drain(*queue, [&counter](const sensor_gyro_fifo_s & sample) { counter.check(sample); });
+
+	// THEN: the logger counts exactly the lost messages as gaps
+	EXPECT_EQ(message_gaps, overflow);
+	EXPECT_EQ(counter.gaps(), overflow);
+	EXPECT_EQ(counter.received() + message_gaps, published);
+	stop();
+}
+
+TEST(RawImuCaptureTest, ConcurrentProducerAndConsumer)
+{
+	// GIVEN: a driver thread publishing as fast as possible
+	GyroQueue *queue = start_gyro(1);
+	ASSERT_NE(queue, nullptr);
+
+	static constexpr uint32_t MESSAGES = 200000;
+
+	std::atomic<bool> producer_done{false};
+
+	std::thread producer([&producer_done]() {
+		for (uint32_t n = 0; n < MESSAGES; n++) {
+			push(1, gyroFifo(n));
+		}
+
+		producer_done = true;
+	});
+
+	// WHEN: the logger drains concurrently
+	GapCounter counter;
+	uint32_t dropped = 0;
+	bool done = false;
+
+	while (!done) {
+		done = producer_done;
+
+		dropped += drain(*queue, [&counter](const sensor_gyro_fifo_s & sample) {
+			// THEN: every message arrives complete and in order
+			EXPECT_EQ(sample.x[FIFO_SAMPLES - 1], (int16_t)(sample.x[0] + FIFO_SAMPLES - 1));
+			counter.check(sample);
+		});
+	}
+
+	producer.join();
+
+	// AND: each message is either received or counted as dropped, with the gaps matching the drops
+	const uint32_t dropped_at_end = MESSAGES - 1 - counter.last_sequence();
+	EXPECT_EQ(counter.received() + dropped, MESSAGES);
+	EXPECT_EQ(counter.gaps() + dropped_at_end, dropped);
+	stop();
+}
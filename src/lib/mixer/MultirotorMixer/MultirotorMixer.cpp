@@ -89,18 +89,43 @@ MultirotorMixer::MultirotorMixer(ControlCallback control_cb, uintptr_t cb_handle
 	Mixer(control_cb, cb_handle),
 	_rotor_count(rotor_count),
 	_rotors(rotors),
-	_outputs_prev(new float[_rotor_count]),
-	_tmp_array(new float[_rotor_count])
+	_rotor_table(new float[2 * AXIS_COUNT * _rotor_count]),
+	_saturation_masks(new uint16_t[3 * _rotor_count]),
+	_can_unsaturate(new bool[AXIS_COUNT * _rotor_count]),
+	_outputs_prev(new float[_rotor_count])
 {
 	for (unsigned i = 0; i < _rotor_count; ++i) {
 		_outputs_prev[i] = -1.f;
+
+		const float rotor_scales[AXIS_COUNT] {
+			_rotors[i].roll_scale,
+			_rotors[i].pitch_scale,
+			_rotors[i].yaw_scale,
+			_rotors[i].thrust_scale
+		};
+
+		for (unsigned axis = 0; axis < AXIS_COUNT; axis++) {
+			_rotor_table[axis * _rotor_count + i] = rotor_scales[axis];
+
+			// If the scale is zero, there's nothing we can do to unsaturate anyway, use a unit divisor to avoid
+			// dividing by zero and mask the rotor out
+			const bool can_unsaturate = (fabsf(rotor_scales[axis]) >= FLT_EPSILON);
+			_can_unsaturate[axis * _rotor_count + i] = can_unsaturate;
+			_rotor_table[(AXIS_COUNT + axis) * _rotor_count + i] = can_unsaturate ? rotor_scales[axis] : 1.f;
+		}
+
+		_saturation_masks[i] = saturation_mask(i, true, false, false);
+		_saturation_masks[_rotor_count + i] = saturation_mask(i, false, true, false);
+		_saturation_masks[2 * _rotor_count + i] = saturation_mask(i, false, false, true);
 	}
 }
 
 MultirotorMixer::~MultirotorMixer()
 {
+	delete[] _rotor_table;
+	delete[] _saturation_masks;
+	delete[] _can_unsaturate;
 	delete[] _outputs_prev;
-	delete[] _tmp_array;
 }
 
 MultirotorMixer *
@@ -147,37 +172,36 @@ MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handl
 }
 
 float
-MultirotorMixer::compute_desaturation_gain(const float *desaturation_vector, const float *outputs,
-		saturation_status &sat_status, float min_output, float max_output) const
+MultirotorMixer::compute_desaturation_gain(Axis axis, const float *outputs, saturation_status &sat_status,
+		float min_output, float max_output) const
 {
+	const float *desaturation_divisor = scale_divisor(axis);
+	const bool *can_unsaturate = &_can_unsaturate[axis * _rotor_count];
+
 	float k_min = 0.f;
 	float k_max = 0.f;
+	bool saturated_low = false;
+	bool saturated_high = false;
 
 	for (unsigned i = 0; i < _rotor_count; i++) {
-		// Avoid division by zero. If desaturation_vector[i] is zero, there's nothing we can do to unsaturate anyway
-		if (fabsf(desaturation_vector[i]) < FLT_EPSILON) {
-			continue;
-		}
-
-		if (outputs[i] < min_output) {
-			float k = (min_output - outputs[i]) / desaturation_vector[i];
-
-			if (k < k_min) { k_min = k; }
-
-			if (k > k_max) { k_max = k; }
+		// at most one of them is non-zero, k is zero if the rotor can not unsaturate
+		const float below_min = math::max(min_output - outputs[i], 0.f);
+		const float above_max = math::min(max_output - outputs[i], 0.f);
+		const float k = can_unsaturate[i] ? (below_min + above_max) / desaturation_divisor[i] : 0.f;
 
-			sat_status.flags.motor_neg = true;
-		}
-
-		if (outputs[i] > max_output) {
-			float k = (max_output - outputs[i]) / desaturation_vector[i];
+		k_min = math::min(k_min, k);
+		k_max = math::max(k_max, k);
 
-			if (k < k_min) { k_min = k; }
+		saturated_low |= (below_min > 0.f) & can_unsaturate[i];
+		saturated_high |= (above_max < 0.f) & can_unsaturate[i];
+	}
 
-			if (k > k_max) { k_max = k; }
+	if (saturated_low) {
+		sat_status.flags.motor_neg = true;
+	}
 
-			sat_status.flags.motor_pos = true;
-		}
+	if (saturated_high) {
+		sat_status.flags.motor_pos = true;
 	}
 
 	// Reduce the saturation as much as possible
@@ -185,12 +209,15 @@ MultirotorMixer::compute_desaturation_gain(const float *desaturation_vector, con
 }
 
 void
-MultirotorMixer::minimize_saturation(const float *desaturation_vector, float *outputs,
-				     saturation_status &sat_status, float min_output, float max_output, bool reduce_only) const
+MultirotorMixer::minimize_saturation(Axis axis, float *outputs, saturation_status &sat_status,
+				     float min_output, float max_output, bool reduce_only) const
 {
-	float k1 = compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output, max_output);
+	const float *desaturation_vector = scale(axis);
+
+	float k1 = compute_desaturation_gain(axis, outputs, sat_status, min_output, max_output);
 
-	if (reduce_only && k1 > 0.f) {
+	if ((reduce_only && k1 > 0.f) || !(fabsf(k1) > 0.f)) {
+		// with a zero gain the outputs are unchanged and so is the second gain
 		return;
 	}
 
@@ -201,29 +228,39 @@ MultirotorMixer::minimize_saturation(const float *desaturation_vector, float *ou
 	// Compute the desaturation gain again based on the updated outputs.
 	// In most cases it will be zero. It won't be if max(outputs) - min(outputs) > max_output - min_output.
 	// In that case adding 0.5 of the gain will equilibrate saturations.
-	float k2 = 0.5f * compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output, max_output);
+	float k2 = 0.5f * compute_desaturation_gain(axis, outputs, sat_status, min_output, max_output);
 
 	for (unsigned i = 0; i < _rotor_count; i++) {
 		outputs[i] += k2 * desaturation_vector[i];
 	}
 }
 
+void
+MultirotorMixer::mix_axes(float roll, float pitch, float yaw, float thrust, float *outputs) const
+{
+	const float *roll_scale = scale(ROLL);
+	const float *pitch_scale = scale(PITCH);
+	const float *yaw_scale = scale(YAW);
+	const float *thrust_scale = scale(THRUST);
+
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		outputs[i] = roll * roll_scale[i] +
+			     pitch * pitch_scale[i] +
+			     yaw * yaw_scale[i] +
+			     thrust * thrust_scale[i];
+	}
+}
+
 void
 MultirotorMixer::mix_airmode_rp(float roll, float pitch, float yaw, float thrust, float *outputs)
 {
 	// Airmode for roll and pitch, but not yaw
 
 	// Mix without yaw
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale +
-			     thrust * _rotors[i].thrust_scale;
-
-		// Thrust will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	mix_axes(roll, pitch, 0.f, thrust, outputs);
 
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	// Thrust will be used to unsaturate if needed
+	minimize_saturation(THRUST, outputs, _saturation_status);
 
 	// Mix yaw independently
 	mix_yaw(yaw, outputs);
@@ -235,25 +272,14 @@ MultirotorMixer::mix_airmode_rpy(float roll, float pitch, float yaw, float thrus
 	// Airmode for roll, pitch and yaw
 
 	// Do full mixing
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale +
-			     yaw * _rotors[i].yaw_scale +
-			     thrust * _rotors[i].thrust_scale;
-
-		// Thrust will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	mix_axes(roll, pitch, yaw, thrust, outputs);
 
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	// Thrust will be used to unsaturate if needed
+	minimize_saturation(THRUST, outputs, _saturation_status);
 
 	// Unsaturate yaw (in case upper and lower bounds are exceeded)
 	// to prioritize roll/pitch over yaw.
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].yaw_scale;
-	}
-
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	minimize_saturation(YAW, outputs, _saturation_status);
 }
 
 void
@@ -262,30 +288,14 @@ MultirotorMixer::mix_airmode_disabled(float roll, float pitch, float yaw, float
 	// Airmode disabled: never allow to increase the thrust to unsaturate a motor
 
 	// Mix without yaw
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] = roll * _rotors[i].roll_scale +
-			     pitch * _rotors[i].pitch_scale +
-			     thrust * _rotors[i].thrust_scale;
+	mix_axes(roll, pitch, 0.f, thrust, outputs);
 
-		// Thrust will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
-
-	// only reduce thrust
-	minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.f, true);
+	// Thrust will be used to unsaturate if needed, only reduce thrust
+	minimize_saturation(THRUST, outputs, _saturation_status, 0.f, 1.f, true);
 
 	// Reduce roll/pitch acceleration if needed to unsaturate
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].roll_scale;
-	}
-
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
-
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].pitch_scale;
-	}
-
-	minimize_saturation(_tmp_array, outputs, _saturation_status);
+	minimize_saturation(ROLL, outputs, _saturation_status);
+	minimize_saturation(PITCH, outputs, _saturation_status);
 
 	// Mix yaw independently
 	mix_yaw(yaw, outputs);
@@ -293,24 +303,19 @@ MultirotorMixer::mix_airmode_disabled(float roll, float pitch, float yaw, float
 
 void MultirotorMixer::mix_yaw(float yaw, float *outputs)
 {
+	const float *yaw_scale = scale(YAW);
+
 	// Add yaw to outputs
 	for (unsigned i = 0; i < _rotor_count; i++) {
-		outputs[i] += yaw * _rotors[i].yaw_scale;
-
-		// Yaw will be used to unsaturate if needed
-		_tmp_array[i] = _rotors[i].yaw_scale;
+		outputs[i] += yaw * yaw_scale[i];
 	}
 
 	// Change yaw acceleration to unsaturate the outputs if needed (do not change roll/pitch),
 	// and allow some yaw response at maximum thrust
-	minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.15f);
-
-	for (unsigned i = 0; i < _rotor_count; i++) {
-		_tmp_array[i] = _rotors[i].thrust_scale;
-	}
+	minimize_saturation(YAW, outputs, _saturation_status, 0.f, 1.15f);
 
 	// reduce thrust only
-	minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.f, true);
+	minimize_saturation(THRUST, outputs, _saturation_status, 0.f, 1.f, true);
 }
 
 unsigned
@@ -347,60 +352,61 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 	// Apply thrust model and scale outputs to range [idle_speed, 1].
 	// At this point the outputs are expected to be in [0, 1], but they can be outside, for example
 	// if a roll command exceeds the motor band limit.
-	for (unsigned i = 0; i < _rotor_count; i++) {
+	if (_thrust_factor > 0.0f) {
 		// Implement simple model for static relationship between applied motor pwm and motor thrust
 		// model: thrust = (1 - _thrust_factor) * PWM + _thrust_factor * PWM^2
-		if (_thrust_factor > 0.0f) {
-			outputs[i] = -(1.0f - _thrust_factor) / (2.0f * _thrust_factor) + sqrtf((1.0f - _thrust_factor) *
-					(1.0f - _thrust_factor) / (4.0f * _thrust_factor * _thrust_factor) + (outputs[i] < 0.0f ? 0.0f : outputs[i] /
-							_thrust_factor));
+		const float offset = -(1.0f - _thrust_factor) / (2.0f * _thrust_factor);
+		const float offset_sq = (1.0f - _thrust_factor) * (1.0f - _thrust_factor) / (4.0f * _thrust_factor * _thrust_factor);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = offset + sqrtf(offset_sq + math::max(outputs[i], 0.0f) / _thrust_factor);
 		}
+	}
 
+	for (unsigned i = 0; i < _rotor_count; i++) {
 		outputs[i] = math::constrain((2.f * outputs[i] - 1.f), -1.f, 1.f);
 	}
 
+	// Check for saturation against static limits.
+	// We only check for low clipping if airmode is disabled (or yaw
+	// clipping if airmode==roll/pitch), since in all other cases thrust will
+	// be reduced or boosted and we can keep the integrators enabled, which
+	// leads to better tracking performance.
+	const bool check_low_roll_pitch = (_airmode == Airmode::disabled);
+	const bool check_low_yaw = (_airmode == Airmode::disabled) || (_airmode == Airmode::roll_pitch);
+
+	// without slew rate limit nothing is clipped
+	const float delta_out_max = (_delta_out_max > 0.0f) ? _delta_out_max : INFINITY;
+
+	const uint16_t *mask_high = &_saturation_masks[0];
+	const uint16_t *mask_low_roll_pitch = &_saturation_masks[_rotor_count];
+	const uint16_t *mask_low_yaw = &_saturation_masks[2 * _rotor_count];
+
+	uint16_t saturation = _saturation_status.value;
+
 	// Slew rate limiting and saturation checking
 	for (unsigned i = 0; i < _rotor_count; i++) {
-		bool clipping_high = false;
-		bool clipping_low_roll_pitch = false;
-		bool clipping_low_yaw = false;
-
-		// Check for saturation against static limits.
-		// We only check for low clipping if airmode is disabled (or yaw
-		// clipping if airmode==roll/pitch), since in all other cases thrust will
-		// be reduced or boosted and we can keep the integrators enabled, which
-		// leads to better tracking performance.
-		if (outputs[i] < -0.99f) {
-			if (_airmode == Airmode::disabled) {
-				clipping_low_roll_pitch = true;
-				clipping_low_yaw = true;
-
-			} else if (_airmode == Airmode::roll_pitch) {
-				clipping_low_yaw = true;
-			}
-		}
+		const bool clipping_low_static = (outputs[i] < -0.99f);
 
 		// check for saturation against slew rate limits
-		if (_delta_out_max > 0.0f) {
-			float delta_out = outputs[i] - _outputs_prev[i];
-
-			if (delta_out > _delta_out_max) {
-				outputs[i] = _outputs_prev[i] + _delta_out_max;
-				clipping_high = true;
-
-			} else if (delta_out < -_delta_out_max) {
-				outputs[i] = _outputs_prev[i] - _delta_out_max;
-				clipping_low_roll_pitch = true;
-				clipping_low_yaw = true;
-			}
-		}
+		const float delta_out = outputs[i] - _outputs_prev[i];
+		const bool clipping_high = (delta_out > delta_out_max);
+		const bool clipping_low = (delta_out < -delta_out_max);
+
+		outputs[i] = clipping_high ? (_outputs_prev[i] + delta_out_max) :
+			     clipping_low ? (_outputs_prev[i] - delta_out_max) : outputs[i];
 
 		_outputs_prev[i] = outputs[i];
 
 		// update the saturation status report
-		update_saturation_status(i, clipping_high, clipping_low_roll_pitch, clipping_low_yaw);
+		saturation |= (clipping_high ? mask_high[i] : 0)
+			      | (((clipping_low_static && check_low_roll_pitch) || clipping_low) ? mask_low_roll_pitch[i] : 0)
+			      | (((clipping_low_static && check_low_yaw) || clipping_low) ? mask_low_yaw[i] : 0);
 	}
 
+	_saturation_status.value = saturation;
+	_saturation_status.flags.valid = true;
+
 	// this will force the caller of the mixer to always supply new slew rate values, otherwise no slew rate limiting will happen
 	_delta_out_max = 0.0f;
 
@@ -408,51 +414,53 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 }
 
 /*
- * This function update the control saturation status report using the following inputs:
+ * This function computes the control saturation status flags set using the following inputs:
  *
  * index: 0 based index identifying the motor that is saturating
  * clipping_high: true if the motor demand is being limited in the positive direction
  * clipping_low_roll_pitch: true if the motor demand is being limited in the negative direction (roll/pitch)
  * clipping_low_yaw: true if the motor demand is being limited in the negative direction (yaw)
 */
-void
-MultirotorMixer::update_saturation_status(unsigned index, bool clipping_high, bool clipping_low_roll_pitch,
-		bool clipping_low_yaw)
+uint16_t
+MultirotorMixer::saturation_mask(unsigned index, bool clipping_high, bool clipping_low_roll_pitch,
+				 bool clipping_low_yaw) const
 {
+	saturation_status status{};
+
 	// The motor is saturated at the upper limit
 	// check which control axes and which directions are contributing
 	if (clipping_high) {
 		if (_rotors[index].roll_scale > 0.0f) {
 			// A positive change in roll will increase saturation
-			_saturation_status.flags.roll_pos = true;
+			status.flags.roll_pos = true;
 
 		} else if (_rotors[index].roll_scale < 0.0f) {
 			// A negative change in roll will increase saturation
-			_saturation_status.flags.roll_neg = true;
+			status.flags.roll_neg = true;
 		}
 
 		// check if the pitch input is saturating
 		if (_rotors[index].pitch_scale > 0.0f) {
 			// A positive change in pitch will increase saturation
-			_saturation_status.flags.pitch_pos = true;
+			status.flags.pitch_pos = true;
 
 		} else if (_rotors[index].pitch_scale < 0.0f) {
 			// A negative change in pitch will increase saturation
-			_saturation_status.flags.pitch_neg = true;
+			status.flags.pitch_neg = true;
 		}
 
 		// check if the yaw input is saturating
 		if (_rotors[index].yaw_scale > 0.0f) {
 			// A positive change in yaw will increase saturation
-			_saturation_status.flags.yaw_pos = true;
+			status.flags.yaw_pos = true;
 
 		} else if (_rotors[index].yaw_scale < 0.0f) {
 			// A negative change in yaw will increase saturation
-			_saturation_status.flags.yaw_neg = true;
+			status.flags.yaw_neg = true;
 		}
 
 		// A positive change in thrust will increase saturation
-		_saturation_status.flags.thrust_pos = true;
+		status.flags.thrust_pos = true;
 	}
 
 	// The motor is saturated at the lower limit
@@ -461,38 +469,38 @@ MultirotorMixer::update_saturation_status(unsigned index, bool clipping_high, bo
 		// check if the roll input is saturating
 		if (_rotors[index].roll_scale > 0.0f) {
 			// A negative change in roll will increase saturation
-			_saturation_status.flags.roll_neg = true;
+			status.flags.roll_neg = true;
 
 		} else if (_rotors[index].roll_scale < 0.0f) {
 			// A positive change in roll will increase saturation
-			_saturation_status.flags.roll_pos = true;
+			status.flags.roll_pos = true;
 		}
 
 		// check if the pitch input is saturating
 		if (_rotors[index].pitch_scale > 0.0f) {
 			// A negative change in pitch will increase saturation
-			_saturation_status.flags.pitch_neg = true;
+			status.flags.pitch_neg = true;
 
 		} else if (_rotors[index].pitch_scale < 0.0f) {
 			// A positive change in pitch will increase saturation
-			_saturation_status.flags.pitch_pos = true;
+			status.flags.pitch_pos = true;
 		}
 
 		// A negative change in thrust will increase saturation
-		_saturation_status.flags.thrust_neg = true;
+		status.flags.thrust_neg = true;
 	}
 
 	if (clipping_low_yaw) {
 		// check if the yaw input is saturating
 		if (_rotors[index].yaw_scale > 0.0f) {
 			// A negative change in yaw will increase saturation
-			_saturation_status.flags.yaw_neg = true;
+			status.flags.yaw_neg = true;
 
 		} else if (_rotors[index].yaw_scale < 0.0f) {
 			// A positive change in yaw will increase saturation
-			_saturation_status.flags.yaw_pos = true;
+			status.flags.yaw_pos = true;
 		}
 	}
 
-	_saturation_status.flags.valid = true;
+	return status.value;
 }
@@ -168,36 +168,61 @@ public:
 
 private:
 	/**
-	 * Computes the gain k by which desaturation_vector has to be multiplied
+	 * Control axes of the rotor table.
+	 */
+	enum Axis {
+		ROLL = 0,
+		PITCH,
+		YAW,
+		THRUST,
+		AXIS_COUNT
+	};
+
+	/**
+	 * Scales of all rotors for a given axis (SoA layout).
+	 */
+	const float *scale(Axis axis) const { return &_rotor_table[axis * _rotor_count]; }
+
+	/**
+	 * Scales of all rotors for a given axis used as desaturation divisor, 1 if the scale is 0.
+	 */
+	const float *scale_divisor(Axis axis) const { return &_rotor_table[(AXIS_COUNT + axis) * _rotor_count]; }
+
+	/**
+	 * Computes the gain k by which the scales of an axis have to be multiplied
 	 * in order to unsaturate the output that has the greatest saturation.
 	 * @see also minimize_saturation().
 	 *
 	 * @return desaturation gain
 	 */
-	float compute_desaturation_gain(const float *desaturation_vector, const float *outputs, saturation_status &sat_status,
+	float compute_desaturation_gain(Axis axis, const float *outputs, saturation_status &sat_status,
 					float min_output, float max_output) const;
 
 	/**
-	 * Minimize the saturation of the actuators by adding or substracting a fraction of desaturation_vector.
-	 * desaturation_vector is the vector that added to the output outputs, modifies the thrust or angular
+	 * Minimize the saturation of the actuators by adding or substracting a fraction of the scales of an axis.
+	 * The scales of an axis are the vector that added to the output outputs, modifies the thrust or angular
 	 * acceleration on a specific axis.
-	 * For example, if desaturation_vector is given to slide along the vertical thrust axis (thrust_scale), the
-	 * saturation will be minimized by shifting the vertical thrust setpoint, without changing the
-	 * roll/pitch/yaw accelerations.
+	 * For example, if the thrust axis is given, the saturation will be minimized by shifting the vertical
+	 * thrust setpoint, without changing the roll/pitch/yaw accelerations.
 	 *
 	 * Note that as we only slide along the given axis, in extreme cases outputs can still contain values
 	 * outside of [min_output, max_output].
 	 *
-	 * @param desaturation_vector vector that is added to the outputs, e.g. thrust_scale
+	 * @param axis axis whose scales are added to the outputs, e.g. THRUST
 	 * @param outputs output vector that is modified
 	 * @param sat_status saturation status output
 	 * @param min_output minimum desired value in outputs
 	 * @param max_output maximum desired value in outputs
-	 * @param reduce_only if true, only allow to reduce (substract) a fraction of desaturation_vector
+	 * @param reduce_only if true, only allow to reduce (substract) a fraction of the scales
 	 */
-	void minimize_saturation(const float *desaturation_vector, float *outputs, saturation_status &sat_status,
+	void minimize_saturation(Axis axis, float *outputs, saturation_status &sat_status,
 				 float min_output = 0.f, float max_output = 1.f, bool reduce_only = false) const;
 
+	/**
+	 * Mix the given axes for all rotors and set the outputs vector.
+	 */
+	inline void mix_axes(float roll, float pitch, float yaw, float thrust, float *outputs) const;
+
 	/**
 	 * Mix roll, pitch, yaw, thrust and set the outputs vector.
 	 *
@@ -238,7 +263,10 @@ private:
 	 */
 	inline void mix_yaw(float yaw, float *outputs);
 
-	void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low_roll_pitch, bool clipping_low_yaw);
+	/**
+	 * Saturation status flags set by a clipping motor, precomputed for each rotor.
+	 */
+	uint16_t saturation_mask(unsigned index, bool clipping_high, bool clipping_low_roll_pitch, bool clipping_low_yaw) const;
 
 	float 				_delta_out_max{0.0f};
 	float 				_thrust_factor{0.0f};
@@ -250,6 +278,9 @@ private:
 	unsigned			_rotor_count;
 	const Rotor			*_rotors;
 
+	float 				*_rotor_table{nullptr}; ///< scales and divisors per axis, [2 * AXIS_COUNT][_rotor_count]
+	uint16_t			*_saturation_masks{nullptr}; ///< [3][_rotor_count]: clipping high, low roll/pitch, low yaw
+	bool				*_can_unsaturate{nullptr}; ///< [AXIS_COUNT][_rotor_count]: scale is non-zero
+
 	float 				*_outputs_prev{nullptr};
-	float 				*_tmp_array{nullptr};
 };
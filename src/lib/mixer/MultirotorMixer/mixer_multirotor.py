@@ -13,6 +13,9 @@ it against the C++ implementation.
 from __future__ import print_function
 
 from argparse import ArgumentParser
+import glob
+import os
+import sys
 import numpy as np
 import numpy.matlib
 import subprocess
@@ -307,8 +310,52 @@ def run_tests(mixer_cb, P, test_mixer_binary, test_index=None):
         print(result)
         raise Exception('Test failed')
 
+def run_benchmark(P, mode_idx, test_mixer_binary):
+    """
+    Run the benchmark of the C++ implementation for an airmode and a control
+    allocation matrix P, returns the time per mix in ns of the previous
+    array-of-structures implementation and of MultirotorMixer
+    """
+    proc = subprocess.Popen(
+        [test_mixer_binary, '--benchmark'],
+        stdout=subprocess.PIPE,
+        stdin=subprocess.PIPE)
+    proc.stdin.write("{:}\n".format(mode_idx).encode('utf-8')) # airmode
+    proc.stdin.write("{:}\n".format(P.shape[0]).encode('utf-8')) # motor count
+    # control allocation matrix
+    for row in P:
+        proc.stdin.write((" ".join("{:.8f}".format(col) for col in row) + "\n").encode('utf-8'))
+    proc.stdin.close()
+    result = proc.stdout.read().decode('utf-8')
+    proc.wait()
+    if proc.returncode != 0:
+        raise Exception('Benchmark failed: ' + result)
+    return float(result.split()[0]), float(result.split()[1])
+
+def run_benchmarks(test_mixer_binary):
+    """
+    Report the time per mix for each geometry in geometries/ and each airmode,
+    for the previous array-of-structures implementation and for MultirotorMixer
+    """
+    geometries_dir = os.path.join(os.path.dirname(os.path.realpath(__file__)), 'geometries')
+    sys.path.append(os.path.join(geometries_dir, 'tools'))
+    import px_generate_mixers
+
+    print('{:<20} {:>6} {:>15} {:>15} {:>15}'.format('geometry', 'rotors', 'none [ns]', 'rp [ns]', 'rpy [ns]'))
+    print('{:<20} {:>6} {:>15} {:>15} {:>15}'.format('', '', 'AoS / SoA', 'AoS / SoA', 'AoS / SoA'))
+    for filename in sorted(glob.glob(os.path.join(geometries_dir, '*.toml'))):
+        geometry = px_generate_mixers.parse_geometry_toml(filename)
+        A, B = px_generate_mixers.geometry_to_mix(geometry)
+        B_px = px_generate_mixers.normalize_mix_px4(B)
+        # same rotor table as the generated header: roll, pitch, yaw, upward thrust
+        P = np.column_stack([B_px[:, 0], B_px[:, 1], B_px[:, 2], -B_px[:, 5]])
+        times = ['{:.1f} / {:.1f}'.format(*run_benchmark(P, mode_idx, test_mixer_binary)) for mode_idx in range(3)]
+        print('{:<20} {:>6} {:>15} {:>15} {:>15}'.format(geometry['info']['name'], P.shape[0], *times))
+
 parser = ArgumentParser(description=__doc__)
 parser.add_argument('--test', action='store_true', default=False, help='Run tests')
+parser.add_argument('--benchmark', action='store_true', default=False,
+                  help='Report the mixing time of the AoS and SoA C++ implementations for each geometry')
 parser.add_argument("--mixer-multirotor-binary",
                   help="select test_mixer_multirotor binary file name",
                   default='./test_mixer_multirotor')
@@ -320,6 +367,10 @@ parser.add_argument("-i", dest="index", type=int,
 args = parser.parse_args()
 mixer_mode = args.mode
 
+if args.benchmark:
+    run_benchmarks(args.mixer_multirotor_binary)
+    exit(0)
+
 if args.test:
     mixer_binary = args.mixer_multirotor_binary
     test_index = args.index
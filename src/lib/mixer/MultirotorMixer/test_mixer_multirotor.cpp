@@ -34,11 +34,18 @@
 /**
  * testing binary that runs the multirotor mixer through test cases given
  * via file or stdin and compares the mixer output against expected values.
+ *
+ * With --benchmark as first argument, only the airmode and control allocation
+ * matrix are read. The average time per mix of the previous array-of-structures
+ * implementation and of MultirotorMixer is reported.
  */
 
 #include "MultirotorMixer.hpp"
+#include "test_mixer_multirotor_aos.hpp"
 
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <math.h>
 
 static const unsigned output_max = 16;
@@ -56,9 +63,110 @@ mixer_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, f
 	return 0;
 }
 
+static constexpr unsigned benchmark_num_controls = 1024;
+static float benchmark_controls[benchmark_num_controls][4];
+
+template<class T>
+static double time_mix(T &mixer, unsigned rotor_count)
+{
+	static constexpr unsigned num_runs = 50;
+
+	float actuator_outputs[output_max];
+	float checksum = 0.f;
+	double min_elapsed_ns = INFINITY;
+
+	// report the fastest of several repetitions to reduce the influence of other processes
+	for (unsigned repetition = 0; repetition < 5; repetition++) {
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned run = 0; run < num_runs; run++) {
+			for (unsigned i = 0; i < benchmark_num_controls; i++) {
+				memcpy(actuator_controls, benchmark_controls[i], sizeof(benchmark_controls[i]));
+
+				if (mixer.mix(actuator_outputs, output_max) != rotor_count) {
+					return -1.;
+				}
+
+				checksum += actuator_outputs[0];
+			}
+		}
+
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		const double elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+		if (elapsed_ns < min_elapsed_ns) {
+			min_elapsed_ns = elapsed_ns;
+		}
+	}
+
+	// keep the outputs alive
+	if (!isfinite(checksum)) {
+		return -1.;
+	}
+
+	return min_elapsed_ns / (num_runs * benchmark_num_controls);
+}
+
+/**
+ * Time the SoA mixer against the previous AoS implementation on the same
+ * controls, after checking that both give bit-identical outputs and saturation flags.
+ */
+static int benchmark(const MultirotorMixer::Rotor *rotors, unsigned rotor_count, Mixer::Airmode airmode)
+{
+	// pseudo-random controls (fixed seed), a large part of them saturating
+	uint32_t seed = 1;
+
+	for (unsigned i = 0; i < benchmark_num_controls; i++) {
+		for (unsigned j = 0; j < 4; j++) {
+			seed = seed * 1664525u + 1013904223u;
+			const float r = (seed >> 8) / (float)(1 << 24);
+			benchmark_controls[i][j] = (j < 3) ? (2.f * r - 1.f) : r;
+		}
+	}
+
+	MultirotorMixer mixer(mixer_callback, 0, rotors, rotor_count);
+	MultirotorMixerAoS mixer_aos(mixer_callback, 0, rotors, rotor_count);
+	mixer.set_airmode(airmode);
+	mixer_aos.set_airmode(airmode);
+
+	for (unsigned i = 0; i < benchmark_num_controls; i++) {
+		float outputs[output_max];
+		float outputs_aos[output_max];
+
+		memcpy(actuator_controls, benchmark_controls[i], sizeof(benchmark_controls[i]));
+
+		if (mixer.mix(outputs, output_max) != rotor_count || mixer_aos.mix(outputs_aos, output_max) != rotor_count) {
+			return -1;
+		}
+
+		if (memcmp(outputs, outputs_aos, rotor_count * sizeof(float)) != 0
+		    || mixer.get_saturation_status() != mixer_aos.get_saturation_status()) {
+			printf("AoS and SoA mixer differ for controls %u\n", i);
+			return -1;
+		}
+	}
+
+	const double aos_ns = time_mix(mixer_aos, rotor_count);
+	const double soa_ns = time_mix(mixer, rotor_count);
+
+	if (aos_ns < 0. || soa_ns < 0.) {
+		return -1;
+	}
+
+	printf("%.1f %.1f ns per mix (AoS, SoA)\n", aos_ns, soa_ns);
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	FILE *file_in = stdin;
+	bool run_benchmark = false;
+
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+		run_benchmark = true;
+		argc--;
+		argv++;
+	}
 
 	if (argc > 1) {
 		file_in = fopen(argv[1], "r");
@@ -84,6 +192,14 @@ int main(int argc, char *argv[])
 		       &rotors[i].yaw_scale, &rotors[i].thrust_scale);
 	}
 
+	if (run_benchmark) {
+		if (file_in != stdin) {
+			fclose(file_in);
+		}
+
+		return benchmark(rotors, rotor_count, (Mixer::Airmode)airmode);
+	}
+
 	MultirotorMixer mixer(mixer_callback, 0, rotors, rotor_count);
 	mixer.set_airmode((Mixer::Airmode)airmode);
 
@@ -0,0 +1,365 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_mixer_multirotor_aos.hpp
+ *
+ * Array-of-structures multirotor mixer, as MultirotorMixer was implemented
+ * before the SoA rotor table. Only used by test_mixer_multirotor --benchmark
+ * as the reference for timing and for bit-exact output comparison.
+ */
+
+#pragma once
+
+#include "MultirotorMixer.hpp"
+
+#include <float.h>
+#include <math.h>
+
+class MultirotorMixerAoS
+{
+public:
+	MultirotorMixerAoS(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const MultirotorMixer::Rotor *rotors,
+			   unsigned rotor_count) :
+		_control_cb(control_cb),
+		_cb_handle(cb_handle),
+		_rotor_count(rotor_count),
+		_rotors(rotors)
+	{
+		for (unsigned i = 0; i < _rotor_count; ++i) {
+			_outputs_prev[i] = -1.f;
+		}
+	}
+
+	unsigned mix(float *outputs, unsigned space)
+	{
+		if (space < _rotor_count) {
+			return 0;
+		}
+
+		float roll    = math::constrain(get_control(0), -1.0f, 1.0f);
+		float pitch   = math::constrain(get_control(1), -1.0f, 1.0f);
+		float yaw     = math::constrain(get_control(2), -1.0f, 1.0f);
+		float thrust  = math::constrain(get_control(3), 0.0f, 1.0f);
+
+		_saturation_status.value = 0;
+
+		switch (_airmode) {
+		case Mixer::Airmode::roll_pitch:
+			mix_airmode_rp(roll, pitch, yaw, thrust, outputs);
+			break;
+
+		case Mixer::Airmode::roll_pitch_yaw:
+			mix_airmode_rpy(roll, pitch, yaw, thrust, outputs);
+			break;
+
+		case Mixer::Airmode::disabled:
+		default:
+			mix_airmode_disabled(roll, pitch, yaw, thrust, outputs);
+			break;
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			if (_thrust_factor > 0.0f) {
+				outputs[i] = -(1.0f - _thrust_factor) / (2.0f * _thrust_factor) + sqrtf((1.0f - _thrust_factor) *
+						(1.0f - _thrust_factor) / (4.0f * _thrust_factor * _thrust_factor) + (outputs[i] < 0.0f ? 0.0f : outputs[i] /
+								_thrust_factor));
+			}
+
+			outputs[i] = math::constrain((2.f * outputs[i] - 1.f), -1.f, 1.f);
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			bool clipping_high = false;
+			bool clipping_low_roll_pitch = false;
+			bool clipping_low_yaw = false;
+
+			if (outputs[i] < -0.99f) {
+				if (_airmode == Mixer::Airmode::disabled) {
+					clipping_low_roll_pitch = true;
+					clipping_low_yaw = true;
+
+				} else if (_airmode == Mixer::Airmode::roll_pitch) {
+					clipping_low_yaw = true;
+				}
+			}
+
+			if (_delta_out_max > 0.0f) {
+				float delta_out = outputs[i] - _outputs_prev[i];
+
+				if (delta_out > _delta_out_max) {
+					outputs[i] = _outputs_prev[i] + _delta_out_max;
+					clipping_high = true;
+
+				} else if (delta_out < -_delta_out_max) {
+					outputs[i] = _outputs_prev[i] - _delta_out_max;
+					clipping_low_roll_pitch = true;
+					clipping_low_yaw = true;
+				}
+			}
+
+			_outputs_prev[i] = outputs[i];
+
+			update_saturation_status(i, clipping_high, clipping_low_roll_pitch, clipping_low_yaw);
+		}
+
+		_delta_out_max = 0.0f;
+
+		return _rotor_count;
+	}
+
+	uint16_t get_saturation_status() const { return _saturation_status.value; }
+
+	void set_airmode(Mixer::Airmode airmode) { _airmode = airmode; }
+
+private:
+	using saturation_status = MultirotorMixer::saturation_status;
+
+	float get_control(uint8_t index)
+	{
+		float value = 0.f;
+		_control_cb(_cb_handle, 0, index, value);
+		return value;
+	}
+
+	float compute_desaturation_gain(const float *desaturation_vector, const float *outputs,
+					saturation_status &sat_status, float min_output, float max_output) const
+	{
+		float k_min = 0.f;
+		float k_max = 0.f;
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			if (fabsf(desaturation_vector[i]) < FLT_EPSILON) {
+				continue;
+			}
+
+			if (outputs[i] < min_output) {
+				float k = (min_output - outputs[i]) / desaturation_vector[i];
+
+				if (k < k_min) { k_min = k; }
+
+				if (k > k_max) { k_max = k; }
+
+				sat_status.flags.motor_neg = true;
+			}
+
+			if (outputs[i] > max_output) {
+				float k = (max_output - outputs[i]) / desaturation_vector[i];
+
+				if (k < k_min) { k_min = k; }
+
+				if (k > k_max) { k_max = k; }
+
+				sat_status.flags.motor_pos = true;
+			}
+		}
+
+		return k_min + k_max;
+	}
+
+	void minimize_saturation(const float *desaturation_vector, float *outputs, saturation_status &sat_status,
+				 float min_output = 0.f, float max_output = 1.f, bool reduce_only = false) const
+	{
+		float k1 = compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output, max_output);
+
+		if (reduce_only && k1 > 0.f) {
+			return;
+		}
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] += k1 * desaturation_vector[i];
+		}
+
+		float k2 = 0.5f * compute_desaturation_gain(desaturation_vector, outputs, sat_status, min_output, max_output);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] += k2 * desaturation_vector[i];
+		}
+	}
+
+	void mix_airmode_rp(float roll, float pitch, float yaw, float thrust, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = roll * _rotors[i].roll_scale +
+				     pitch * _rotors[i].pitch_scale +
+				     thrust * _rotors[i].thrust_scale;
+
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status);
+
+		mix_yaw(yaw, outputs);
+	}
+
+	void mix_airmode_rpy(float roll, float pitch, float yaw, float thrust, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = roll * _rotors[i].roll_scale +
+				     pitch * _rotors[i].pitch_scale +
+				     yaw * _rotors[i].yaw_scale +
+				     thrust * _rotors[i].thrust_scale;
+
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].yaw_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status);
+	}
+
+	void mix_airmode_disabled(float roll, float pitch, float yaw, float thrust, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] = roll * _rotors[i].roll_scale +
+				     pitch * _rotors[i].pitch_scale +
+				     thrust * _rotors[i].thrust_scale;
+
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.f, true);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].roll_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].pitch_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status);
+
+		mix_yaw(yaw, outputs);
+	}
+
+	void mix_yaw(float yaw, float *outputs)
+	{
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			outputs[i] += yaw * _rotors[i].yaw_scale;
+
+			_tmp_array[i] = _rotors[i].yaw_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.15f);
+
+		for (unsigned i = 0; i < _rotor_count; i++) {
+			_tmp_array[i] = _rotors[i].thrust_scale;
+		}
+
+		minimize_saturation(_tmp_array, outputs, _saturation_status, 0.f, 1.f, true);
+	}
+
+	void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low_roll_pitch,
+				      bool clipping_low_yaw)
+	{
+		const MultirotorMixer::Rotor &rotor = _rotors[index];
+
+		if (clipping_high) {
+			if (rotor.roll_scale > 0.0f) {
+				_saturation_status.flags.roll_pos = true;
+
+			} else if (rotor.roll_scale < 0.0f) {
+				_saturation_status.flags.roll_neg = true;
+			}
+
+			if (rotor.pitch_scale > 0.0f) {
+				_saturation_status.flags.pitch_pos = true;
+
+			} else if (rotor.pitch_scale < 0.0f) {
+				_saturation_status.flags.pitch_neg = true;
+			}
+
+			if (rotor.yaw_scale > 0.0f) {
+				_saturation_status.flags.yaw_pos = true;
+
+			} else if (rotor.yaw_scale < 0.0f) {
+				_saturation_status.flags.yaw_neg = true;
+			}
+
+			_saturation_status.flags.thrust_pos = true;
+		}
+
+		if (clipping_low_roll_pitch) {
+			if (rotor.roll_scale > 0.0f) {
+				_saturation_status.flags.roll_neg = true;
+
+			} else if (rotor.roll_scale < 0.0f) {
+				_saturation_status.flags.roll_pos = true;
+			}
+
+			if (rotor.pitch_scale > 0.0f) {
+				_saturation_status.flags.pitch_neg = true;
+
+			} else if (rotor.pitch_scale < 0.0f) {
+				_saturation_status.flags.pitch_pos = true;
+			}
+
+			_saturation_status.flags.thrust_neg = true;
+		}
+
+		if (clipping_low_yaw) {
+			if (rotor.yaw_scale > 0.0f) {
+				_saturation_status.flags.yaw_neg = true;
+
+			} else if (rotor.yaw_scale < 0.0f) {
+				_saturation_status.flags.yaw_pos = true;
+			}
+		}
+
+		_saturation_status.flags.valid = true;
+	}
+
+	static constexpr unsigned MAX_ROTORS = 16;
+
+	Mixer::ControlCallback _control_cb;
+	uintptr_t _cb_handle;
+
+	Mixer::Airmode _airmode{Mixer::Airmode::disabled};
+	float _delta_out_max{0.0f};
+	float _thrust_factor{0.0f};
+
+	const unsigned _rotor_count;
+	const MultirotorMixer::Rotor *_rotors;
+
+	saturation_status _saturation_status{};
+
+	float _outputs_prev[MAX_ROTORS] {};
+	float _tmp_array[MAX_ROTORS] {};
+};
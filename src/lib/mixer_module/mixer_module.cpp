@@ -428,10 +428,11 @@ bool MixingOutput::update()
 	/* now return the outputs to the driver */
 	if (_interface.updateOutputs(stop_motors, _current_output_value, mixed_num_outputs, n_updates)) {
 		actuator_outputs_s actuator_outputs{};
+		actuator_outputs.timestamp_sample = controlsTimestampSample();
 		setAndPublishActuatorOutputs(mixed_num_outputs, actuator_outputs);
 
 		publishMixerStatus(actuator_outputs);
-		updateLatencyPerfCounter(actuator_outputs);
+		updateLatency(actuator_outputs);
 	}
 
 	handleCommands();
@@ -467,8 +468,8 @@ MixingOutput::publishMixerStatus(const actuator_outputs_s &actuator_outputs)
 	}
 }
 
-void
-MixingOutput::updateLatencyPerfCounter(const actuator_outputs_s &actuator_outputs)
+hrt_abstime
+MixingOutput::controlsTimestampSample() const
 {
 	// use first valid timestamp_sample for latency tracking
 	for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
@@ -476,10 +477,93 @@ MixingOutput::updateLatencyPerfCounter(const actuator_outputs_s &actuator_output
 		const hrt_abstime &timestamp_sample = _controls[i].timestamp_sample;
 
 		if (required && (timestamp_sample > 0)) {
-			perf_set_elapsed(_control_latency_perf, actuator_outputs.timestamp - timestamp_sample);
-			break;
+			return timestamp_sample;
+		}
+	}
+
+	return 0;
+}
+
+void
+MixingOutput::updateLatency(const actuator_outputs_s &actuator_outputs)
+{
+	if (_latency.interval_start == 0) {
+		_latency.interval_start = actuator_outputs.timestamp;
+	}
+
+	if ((actuator_outputs.timestamp_sample > 0) && (actuator_outputs.timestamp >= actuator_outputs.timestamp_sample)) {
+		const hrt_abstime elapsed = actuator_outputs.timestamp - actuator_outputs.timestamp_sample;
+		perf_set_elapsed(_control_latency_perf, elapsed);
+
+		const uint32_t latency = (elapsed < UINT32_MAX) ? (uint32_t)elapsed : UINT32_MAX;
+
+		int bucket = latency;
+
+		if (latency >= 8) {
+			const int octave = 31 - __builtin_clz(latency);
+			bucket = 8 + (octave - 3) * 4 + ((latency >> (octave - 2)) & 3);
+		}
+
+		if (bucket >= LATENCY_HISTOGRAM_BUCKETS) {
+			bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+		}
+
+		if (_latency.histogram[bucket] < UINT16_MAX) {
+			_latency.histogram[bucket]++;
+		}
+
+		_latency.sum += latency;
+		_latency.cycles++;
+		_latency.last = latency;
+		_latency.min = math::min(_latency.min, latency);
+		_latency.max = math::max(_latency.max, latency);
+	}
+
+	if (actuator_outputs.timestamp - _latency.interval_start >= LATENCY_PUBLISH_INTERVAL) {
+		publishLatency(actuator_outputs.timestamp);
+	}
+}
+
+void
+MixingOutput::publishLatency(hrt_abstime now)
+{
+	control_latency_s control_latency{};
+	control_latency.actuator_outputs_instance = _outputs_pub.get_instance();
+	control_latency.cycles = _latency.cycles;
+
+	if (_latency.cycles > 0) {
+		control_latency.latency_last = _latency.last;
+		control_latency.latency_min = _latency.min;
+		control_latency.latency_avg = _latency.sum / _latency.cycles;
+		control_latency.latency_max = _latency.max;
+
+		// upper bound of the bucket containing the 99th percentile
+		const uint32_t rank = _latency.cycles - _latency.cycles / 100;
+		uint32_t count = 0;
+		control_latency.latency_p99 = _latency.max;
+
+		for (int bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; bucket++) {
+			count += _latency.histogram[bucket];
+
+			if (count >= rank) {
+				uint32_t upper = bucket;
+
+				if (bucket >= 8) {
+					const int octave = 3 + (bucket - 8) / 4;
+					upper = (1u << octave) + (((bucket - 8) % 4) + 1) * (1u << (octave - 2)) - 1;
+				}
+
+				control_latency.latency_p99 = math::min(upper, _latency.max);
+				break;
+			}
 		}
 	}
+
+	control_latency.timestamp = hrt_absolute_time();
+	_control_latency_pub.publish(control_latency);
+
+	_latency = LatencyStatistics{};
+	_latency.interval_start = now;
 }
 
 void
@@ -48,6 +48,7 @@
 #include <uORB/topics/actuator_armed.h>
 #include <uORB/topics/actuator_controls.h>
 #include <uORB/topics/actuator_outputs.h>
+#include <uORB/topics/control_latency.h>
 #include <uORB/topics/multirotor_motor_limits.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/test_motor.h>
@@ -195,7 +196,9 @@ private:
 	void updateOutputSlewrateSimplemixer();
 	void setAndPublishActuatorOutputs(unsigned num_outputs, actuator_outputs_s &actuator_outputs);
 	void publishMixerStatus(const actuator_outputs_s &actuator_outputs);
-	void updateLatencyPerfCounter(const actuator_outputs_s &actuator_outputs);
+	hrt_abstime controlsTimestampSample() const;
+	void updateLatency(const actuator_outputs_s &actuator_outputs);
+	void publishLatency(hrt_abstime now);
 
 	static int controlCallback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &input);
 
@@ -241,6 +244,7 @@ private:
 
 	uORB::PublicationMulti<actuator_outputs_s> _outputs_pub{ORB_ID(actuator_outputs)};
 	uORB::PublicationMulti<multirotor_motor_limits_s> _to_mixer_status{ORB_ID(multirotor_motor_limits)}; 	///< mixer status flags
+	uORB::PublicationMulti<control_latency_s> _control_latency_pub{ORB_ID(control_latency)};
 
 	actuator_controls_s _controls[actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS] {};
 	actuator_armed_s _armed{};
@@ -274,6 +278,24 @@ private:
 
 	perf_counter_t _control_latency_perf;
 
+	/**
+	 * Gyro sample to output latency statistics of the control cycles since the last control_latency publication.
+	 * Histogram buckets: 0-7us, then 4 per power of 2 (8, 10, 12, 14, 16, 20, ...), the last one from ~115ms.
+	 */
+	static constexpr int LATENCY_HISTOGRAM_BUCKETS = 64;
+	static constexpr hrt_abstime LATENCY_PUBLISH_INTERVAL{1000000};
+
+	struct LatencyStatistics {
+		hrt_abstime interval_start{0};
+		uint64_t sum{0};
+		uint32_t cycles{0};
+		uint32_t last{0};
+		uint32_t min{UINT32_MAX};
+		uint32_t max{0};
+		uint16_t histogram[LATENCY_HISTOGRAM_BUCKETS] {};
+	};
+	LatencyStatistics _latency{};
+
 	DEFINE_PARAMETERS(
 		(ParamInt<px4::params::MC_AIRMODE>) _param_mc_airmode,   ///< multicopter air-mode
 		(ParamFloat<px4::params::MOT_SLEW_MAX>) _param_mot_slew_max,
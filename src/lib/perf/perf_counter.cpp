@@ -44,6 +44,9 @@
 #include <drivers/drv_hrt.h>
 #include <math.h>
 #include <pthread.h>
+#include <sched.h>
+#include <new>
+#include <px4_platform_common/atomic.h>
 #include <systemlib/err.h>
 
 #include "perf_counter.h"
@@ -96,6 +99,414 @@ struct perf_ctr_interval : public perf_ctr_header {
 	float			M2{0.0f};
 };
 
+#if defined(__PX4_NUTTX)
+static constexpr int PERF_SHARD_COUNT = 4;
+#else
+static constexpr int PERF_SHARD_COUNT = 8;
+#endif
+
+static constexpr size_t PERF_CACHE_LINE = 64;
+
+/**
+ * Histogram buckets: 0us and 1us, then two buckets per power of two (2, 3, 4-5, 6-7, 8-11, ...).
+ * The last bucket collects everything from ~0.79s.
+ */
+static constexpr int PERF_HISTOGRAM_BUCKETS = 40;
+
+/**
+ * Statistics of one shard of a PC_ELAPSED_SHARDED or PC_ELAPSED_HISTOGRAM counter.
+ */
+struct perf_shard_stats {
+	uint64_t		event_count{0};
+	uint64_t		time_total{0};
+	uint32_t		time_least{0};
+	uint32_t		time_most{0};
+	float			mean{0.0f};
+	float			M2{0.0f};
+};
+
+/**
+ * Per-thread part of a sharded counter.
+ *
+ * A thread claims a free shard on first use and from then on normally is its only
+ * writer. Writers still enter with a compare-and-swap on the sequence number (odd while
+ * updating), so threads without a shard of their own (all claimed) can still add samples
+ * with perf_set_elapsed(): a writer that finds a shard busy moves on to another one, and
+ * the sample is dropped only if all are busy (spinning on a preempted lower priority
+ * writer would never return on a single core). Readers retry until they copied a shard
+ * with the same even sequence number before and after.
+ *
+ * time_start is only ever accessed by the owning thread. perf_begin()/perf_end() pairs of
+ * threads without a shard of their own are dropped, as they have nowhere to keep it.
+ *
+ * Shards are given back when their thread exits, the statistics stay in the shard. On
+ * POSIX a thread specific key destructor releases them, on NuttX a thread that finds all
+ * shards claimed takes over the ones of owners that no longer exist.
+ *
+ * For PC_ELAPSED_HISTOGRAM, PERF_HISTOGRAM_BUCKETS bucket counts follow the shard.
+ */
+struct perf_shard {
+	px4::atomic<uintptr_t>	owner{0};	/**< pthread_self() + 1 of the owning thread, 0 if unclaimed */
+	px4::atomic<uint32_t>	seq{0};		/**< odd while the shard is updated */
+	uint32_t		generation{0};	/**< counter generation the statistics belong to */
+	uint64_t		time_start{0};	/**< perf_begin() timestamp of the owning thread */
+	perf_shard_stats	stats;
+};
+
+/**
+ * PC_ELAPSED_SHARDED and PC_ELAPSED_HISTOGRAM counter.
+ */
+struct perf_ctr_sharded : public perf_ctr_header {
+	uint8_t			*storage{nullptr};	/**< allocation backing the shards */
+	uint8_t			*shards{nullptr};	/**< first shard, cache line aligned */
+	size_t			shard_stride{0};	/**< shards are padded to full cache lines */
+	px4::atomic<uint32_t>	generation{0};		/**< incremented by perf_reset(), shards of older generations are stale */
+	px4::atomic<uint32_t>	dropped{0};		/**< samples lost because all shards were busy or the thread had no shard for perf_begin() */
+};
+
+static inline perf_shard *
+shard_at(perf_ctr_sharded *pcs, int index)
+{
+	return (perf_shard *)(pcs->shards + index * pcs->shard_stride);
+}
+
+static inline uint32_t *
+shard_histogram(perf_shard *shard)
+{
+	return (uint32_t *)(shard + 1);
+}
+
+static bool
+sharded_init(perf_ctr_sharded *pcs, bool histogram)
+{
+	const size_t size = sizeof(perf_shard) + (histogram ? PERF_HISTOGRAM_BUCKETS * sizeof(uint32_t) : 0);
+	pcs->shard_stride = (size + PERF_CACHE_LINE - 1) & ~(PERF_CACHE_LINE - 1);
+	pcs->storage = new uint8_t[pcs->shard_stride * PERF_SHARD_COUNT + PERF_CACHE_LINE - 1];
+
+	if (pcs->storage == nullptr) {
+		return false;
+	}
+
+	pcs->shards = (uint8_t *)(((uintptr_t)pcs->storage + PERF_CACHE_LINE - 1) & ~(uintptr_t)(PERF_CACHE_LINE - 1));
+	memset(pcs->shards, 0, pcs->shard_stride * PERF_SHARD_COUNT);
+
+	for (int i = 0; i < PERF_SHARD_COUNT; i++) {
+		new (shard_at(pcs, i)) perf_shard();
+	}
+
+	return true;
+}
+
+#if !defined(__PX4_NUTTX)
+static void shards_release_thread(void *arg);
+
+static pthread_key_t	shard_owner_key;
+static pthread_once_t	shard_owner_key_once = PTHREAD_ONCE_INIT;
+
+static void
+shard_owner_key_create()
+{
+	pthread_key_create(&shard_owner_key, shards_release_thread);
+}
+
+/**
+ * Make sure the shards claimed by the calling thread are released when it exits.
+ */
+static void
+shard_owner_register()
+{
+	pthread_once(&shard_owner_key_once, shard_owner_key_create);
+
+	if (pthread_getspecific(shard_owner_key) == nullptr) {
+		pthread_setspecific(shard_owner_key, (void *)1);
+	}
+}
+
+#else
+
+/**
+ * Take over a shard whose owning task or thread has exited.
+ *
+ * NuttX tasks do not run thread specific key destructors, so the shards are reclaimed
+ * lazily instead. A pid that is reused by a new task before that inherits the shard.
+ */
+static perf_shard *
+shard_reclaim(perf_ctr_sharded *pcs, uintptr_t self)
+{
+	for (int i = 0; i < PERF_SHARD_COUNT; i++) {
+		perf_shard *shard = shard_at(pcs, i);
+		uintptr_t owner = shard->owner.load();
+		struct sched_param param;
+
+		if (owner != 0 && sched_getparam((pid_t)(owner - 1), &param) != 0
+		    && shard->owner.compare_exchange(&owner, self)) {
+			shard->time_start = 0;
+			return shard;
+		}
+	}
+
+	return nullptr;
+}
+#endif
+
+/**
+ * Get the shard of the calling thread, claiming a free one if needed.
+ *
+ * @return the shard owned by the calling thread, nullptr if all are claimed by other threads
+ */
+static perf_shard *
+shard_for_thread(perf_ctr_sharded *pcs)
+{
+	const uintptr_t self = (uintptr_t)pthread_self() + 1;
+
+	// thread ids are often aligned addresses, mix in higher bits to spread the start index
+	const int first = (int)((self ^ (self >> 8) ^ (self >> 16)) % PERF_SHARD_COUNT);
+
+	for (int i = 0; i < PERF_SHARD_COUNT; i++) {
+		perf_shard *shard = shard_at(pcs, (first + i) % PERF_SHARD_COUNT);
+
+		if (shard->owner.load() == self) {
+			return shard;
+		}
+	}
+
+	// only claim after the full search, a shard released since ours was claimed could come first
+	for (int i = 0; i < PERF_SHARD_COUNT; i++) {
+		perf_shard *shard = shard_at(pcs, (first + i) % PERF_SHARD_COUNT);
+		uintptr_t owner = shard->owner.load();
+
+		if (owner == 0 && shard->owner.compare_exchange(&owner, self)) {
+#if !defined(__PX4_NUTTX)
+			shard_owner_register();
+#endif
+			return shard;
+		}
+	}
+
+#if defined(__PX4_NUTTX)
+	return shard_reclaim(pcs, self);
+#else
+	return nullptr;
+#endif
+}
+
+static inline bool
+shard_try_lock(perf_shard *shard, uint32_t &seq)
+{
+	seq = shard->seq.load();
+
+	if (((seq & 1) == 0) && shard->seq.compare_exchange(&seq, seq + 1)) {
+		// the statistics must not become visible before the odd sequence number
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		return true;
+	}
+
+	return false;
+}
+
+static void
+sharded_set_elapsed(perf_ctr_sharded *pcs, perf_shard *shard, uint32_t elapsed)
+{
+	uint32_t seq;
+
+	if (shard == nullptr || !shard_try_lock(shard, seq)) {
+		shard = nullptr;
+
+		for (int i = 0; i < PERF_SHARD_COUNT && shard == nullptr; i++) {
+			if (shard_try_lock(shard_at(pcs, i), seq)) {
+				shard = shard_at(pcs, i);
+			}
+		}
+
+		if (shard == nullptr) {
+			pcs->dropped.fetch_add(1);
+			return;
+		}
+	}
+
+	perf_shard_stats &stats = shard->stats;
+	const uint32_t generation = pcs->generation.load();
+
+	if (shard->generation != generation) {
+		// first update after a reset
+		stats = perf_shard_stats{};
+
+		if (pcs->type == PC_ELAPSED_HISTOGRAM) {
+			memset(shard_histogram(shard), 0, PERF_HISTOGRAM_BUCKETS * sizeof(uint32_t));
+		}
+
+		shard->generation = generation;
+	}
+
+	stats.event_count++;
+	stats.time_total += elapsed;
+
+	if ((stats.event_count == 1) || (elapsed < stats.time_least)) {
+		stats.time_least = elapsed;
+	}
+
+	if (elapsed > stats.time_most) {
+		stats.time_most = elapsed;
+	}
+
+	// Knuth/Welford recursive mean and variance, merged across shards on read
+	float dt = elapsed / 1e6f;
+	float delta_intvl = dt - stats.mean;
+	stats.mean += delta_intvl / stats.event_count;
+	stats.M2 += delta_intvl * (dt - stats.mean);
+
+	if (pcs->type == PC_ELAPSED_HISTOGRAM) {
+		int bucket = elapsed;
+
+		if (elapsed >= 2) {
+			const int octave = 31 - __builtin_clz(elapsed);
+			bucket = 2 * octave + ((elapsed >> (octave - 1)) & 1);
+		}
+
+		if (bucket >= PERF_HISTOGRAM_BUCKETS) {
+			bucket = PERF_HISTOGRAM_BUCKETS - 1;
+		}
+
+		shard_histogram(shard)[bucket]++;
+	}
+
+	shard->seq.store(seq + 2);
+}
+
+/**
+ * Largest value in a histogram bucket.
+ */
+static uint32_t
+histogram_bucket_upper(int bucket)
+{
+	if (bucket < 2) {
+		return bucket;
+	}
+
+	if (bucket >= PERF_HISTOGRAM_BUCKETS - 1) {
+		return UINT32_MAX;
+	}
+
+	const int next = bucket + 1;
+	return (1u << (next / 2)) + (next & 1) * (1u << (next / 2 - 1)) - 1;
+}
+
+/**
+ * Merge the shards of the current generation.
+ *
+ * @param histogram	PERF_HISTOGRAM_BUCKETS merged bucket counts, can be nullptr
+ */
+static void
+sharded_read(perf_ctr_sharded *pcs, perf_shard_stats &merged, uint32_t *histogram)
+{
+	const bool has_histogram = (pcs->type == PC_ELAPSED_HISTOGRAM) && (histogram != nullptr);
+	const uint32_t generation = pcs->generation.load();
+
+	merged = perf_shard_stats{};
+
+	if (has_histogram) {
+		memset(histogram, 0, PERF_HISTOGRAM_BUCKETS * sizeof(uint32_t));
+	}
+
+	for (int i = 0; i < PERF_SHARD_COUNT; i++) {
+		perf_shard *shard = shard_at(pcs, i);
+		perf_shard_stats stats;
+		uint32_t buckets[PERF_HISTOGRAM_BUCKETS];
+		bool consistent = false;
+
+		// bounded, a reader must not wait for a writer it preempted
+		for (int retry = 0; retry < 8 && !consistent; retry++) {
+			const uint32_t seq = shard->seq.load();
+
+			if (seq & 1) {
+				continue;
+			}
+
+			if (shard->generation != generation) {
+				stats = perf_shard_stats{};
+				memset(buckets, 0, sizeof(buckets));
+
+			} else {
+				stats = shard->stats;
+
+				if (has_histogram) {
+					memcpy(buckets, shard_histogram(shard), sizeof(buckets));
+				}
+			}
+
+			// order the copy before the re-check of the sequence number
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			consistent = (shard->seq.load() == seq);
+		}
+
+		if (!consistent || stats.event_count == 0) {
+			continue;
+		}
+
+		if (merged.event_count == 0) {
+			merged = stats;
+
+		} else {
+			// Chan et al. parallel variance
+			const float n_a = merged.event_count;
+			const float n_b = stats.event_count;
+			const float delta = stats.mean - merged.mean;
+			merged.mean += delta * n_b / (n_a + n_b);
+			merged.M2 += stats.M2 + delta * delta * n_a * n_b / (n_a + n_b);
+
+			merged.event_count += stats.event_count;
+			merged.time_total += stats.time_total;
+
+			if (stats.time_least < merged.time_least) {
+				merged.time_least = stats.time_least;
+			}
+
+			if (stats.time_most > merged.time_most) {
+				merged.time_most = stats.time_most;
+			}
+		}
+
+		if (has_histogram) {
+			for (int b = 0; b < PERF_HISTOGRAM_BUCKETS; b++) {
+				histogram[b] += buckets[b];
+			}
+		}
+	}
+}
+
+static uint32_t
+histogram_percentile(const uint32_t *histogram, const perf_shard_stats &stats, float quantile)
+{
+	uint64_t total = 0;
+
+	for (int b = 0; b < PERF_HISTOGRAM_BUCKETS; b++) {
+		total += histogram[b];
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t)ceilf(quantile * total);
+
+	if (rank < 1) {
+		rank = 1;
+	}
+
+	uint64_t count = 0;
+
+	for (int b = 0; b < PERF_HISTOGRAM_BUCKETS; b++) {
+		count += histogram[b];
+
+		if (count >= rank) {
+			const uint32_t upper = histogram_bucket_upper(b);
+			return upper < stats.time_most ? upper : stats.time_most;
+		}
+	}
+
+	return stats.time_most;
+}
+
 /**
  * List of all known counters.
  */
@@ -111,6 +522,42 @@ pthread_mutex_t perf_counters_mutex = PTHREAD_MUTEX_INITIALIZER;
 // (especially the 64bit values which are in general not atomically updated).
 // The same holds for shared perf counters (perf_alloc_once), that can be updated
 // concurrently (this affects the 'ctrl_latency' counter).
+// PC_ELAPSED_SHARDED and PC_ELAPSED_HISTOGRAM counters keep their data per
+// thread and can be updated and printed concurrently.
+
+#if !defined(__PX4_NUTTX)
+/**
+ * Thread specific key destructor, gives back the shards of the exiting thread.
+ */
+static void
+shards_release_thread(void *arg)
+{
+	const uintptr_t self = (uintptr_t)pthread_self() + 1;
+
+	pthread_mutex_lock(&perf_counters_mutex);
+
+	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+
+	while (handle != nullptr) {
+		if (handle->type == PC_ELAPSED_SHARDED || handle->type == PC_ELAPSED_HISTOGRAM) {
+			perf_ctr_sharded *pcs = (perf_ctr_sharded *)handle;
+
+			for (int i = 0; i < PERF_SHARD_COUNT; i++) {
+				perf_shard *shard = shard_at(pcs, i);
+
+				if (shard->owner.load() == self) {
+					shard->time_start = 0;
+					shard->owner.store(0);
+				}
+			}
+		}
+
+		handle = (perf_counter_t)sq_next(&handle->link);
+	}
+
+	pthread_mutex_unlock(&perf_counters_mutex);
+}
+#endif
 
 
 perf_counter_t
@@ -131,6 +578,19 @@ perf_alloc(enum perf_counter_type type, const char *name)
 		ctr = new perf_ctr_interval();
 		break;
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_ctr_sharded *pcs = new perf_ctr_sharded();
+
+			if (pcs != nullptr && !sharded_init(pcs, type == PC_ELAPSED_HISTOGRAM)) {
+				delete pcs;
+				pcs = nullptr;
+			}
+
+			ctr = pcs;
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -186,6 +646,19 @@ perf_free(perf_counter_t handle)
 	sq_rem(&handle->link, &perf_counters);
 	pthread_mutex_unlock(&perf_counters_mutex);
 
+	switch (handle->type) {
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_ctr_sharded *pcs = (perf_ctr_sharded *)handle;
+			delete[] pcs->storage;
+			delete pcs;
+			return;
+		}
+
+	default:
+		break;
+	}
+
 	delete handle;
 }
 
@@ -222,6 +695,16 @@ perf_begin(perf_counter_t handle)
 		((struct perf_ctr_elapsed *)handle)->time_start = hrt_absolute_time();
 		break;
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_shard *shard = shard_for_thread((perf_ctr_sharded *)handle);
+
+			if (shard != nullptr) {
+				shard->time_start = hrt_absolute_time();
+			}
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -244,6 +727,22 @@ perf_end(perf_counter_t handle)
 		}
 		break;
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_ctr_sharded *pcs = (perf_ctr_sharded *)handle;
+			perf_shard *shard = shard_for_thread(pcs);
+
+			if (shard == nullptr) {
+				// no shard to keep the begin timestamp in
+				pcs->dropped.fetch_add(1);
+
+			} else if (shard->time_start != 0) {
+				sharded_set_elapsed(pcs, shard, (uint32_t)hrt_elapsed_time(&shard->time_start));
+				shard->time_start = 0;
+			}
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -284,6 +783,20 @@ perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 		}
 		break;
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM:
+		if (elapsed >= 0) {
+			perf_ctr_sharded *pcs = (perf_ctr_sharded *)handle;
+			perf_shard *shard = shard_for_thread(pcs);
+			sharded_set_elapsed(pcs, shard, (uint32_t)elapsed);
+
+			if (shard != nullptr) {
+				shard->time_start = 0;
+			}
+		}
+
+		break;
+
 	default:
 		break;
 	}
@@ -377,6 +890,16 @@ perf_cancel(perf_counter_t handle)
 		}
 		break;
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_shard *shard = shard_for_thread((perf_ctr_sharded *)handle);
+
+			if (shard != nullptr) {
+				shard->time_start = 0;
+			}
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -414,6 +937,15 @@ perf_reset(perf_counter_t handle)
 			pci->time_most = 0;
 			break;
 		}
+
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			// the writers clear their shards on the next update
+			perf_ctr_sharded *pcs = (perf_ctr_sharded *)handle;
+			pcs->generation.fetch_add(1);
+			pcs->dropped.store(0);
+			break;
+		}
 	}
 }
 
@@ -469,6 +1001,14 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 			break;
 		}
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			char buffer[200];
+			perf_print_counter_buffer(buffer, sizeof(buffer), handle);
+			dprintf(fd, "%s\n", buffer);
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -519,6 +1059,38 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 			break;
 		}
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_ctr_sharded *pcs = (perf_ctr_sharded *)handle;
+			perf_shard_stats stats;
+			uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+			sharded_read(pcs, stats, histogram);
+
+			float rms = (stats.event_count > 1) ? sqrtf(stats.M2 / (stats.event_count - 1)) : 0.0f;
+			num_written = snprintf(buffer, length, "%s: %llu events, %lluus elapsed, %.2fus avg, min %lluus max %lluus %5.3fus rms",
+					       handle->name,
+					       (unsigned long long)stats.event_count,
+					       (unsigned long long)stats.time_total,
+					       (stats.event_count == 0) ? 0 : (double)stats.time_total / (double)stats.event_count,
+					       (unsigned long long)stats.time_least,
+					       (unsigned long long)stats.time_most,
+					       (double)(1e6f * rms));
+
+			if (handle->type == PC_ELAPSED_HISTOGRAM && num_written >= 0 && num_written < length) {
+				num_written += snprintf(buffer + num_written, length - num_written, ", p50 %uus p99 %uus",
+							(unsigned)histogram_percentile(histogram, stats, 0.5f),
+							(unsigned)histogram_percentile(histogram, stats, 0.99f));
+			}
+
+			const uint32_t dropped = pcs->dropped.load();
+
+			if (dropped > 0 && num_written >= 0 && num_written < length) {
+				num_written += snprintf(buffer + num_written, length - num_written, ", %u dropped", (unsigned)dropped);
+			}
+
+			break;
+		}
+
 	default:
 		break;
 	}
@@ -548,6 +1120,13 @@ perf_event_count(perf_counter_t handle)
 			return pci->event_count;
 		}
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_shard_stats stats;
+			sharded_read((perf_ctr_sharded *)handle, stats, nullptr);
+			return stats.event_count;
+		}
+
 	default:
 		break;
 	}
@@ -573,6 +1152,13 @@ perf_mean(perf_counter_t handle)
 			return pci->mean;
 		}
 
+	case PC_ELAPSED_SHARDED:
+	case PC_ELAPSED_HISTOGRAM: {
+			perf_shard_stats stats;
+			sharded_read((perf_ctr_sharded *)handle, stats, nullptr);
+			return stats.mean;
+		}
+
 	default:
 		break;
 	}
@@ -580,6 +1166,56 @@ perf_mean(perf_counter_t handle)
 	return 0.0f;
 }
 
+uint32_t
+perf_percentile(perf_counter_t handle, float quantile)
+{
+	if (handle == nullptr || handle->type != PC_ELAPSED_HISTOGRAM) {
+		return 0;
+	}
+
+	perf_shard_stats stats;
+	uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+	sharded_read((perf_ctr_sharded *)handle, stats, histogram);
+	return histogram_percentile(histogram, stats, quantile);
+}
+
+void
+perf_print_histogram(int fd, perf_counter_t handle)
+{
+	if (handle == nullptr || handle->type != PC_ELAPSED_HISTOGRAM) {
+		return;
+	}
+
+	perf_shard_stats stats;
+	uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+	sharded_read((perf_ctr_sharded *)handle, stats, histogram);
+
+	dprintf(fd, "%s: %llu events, p50 %uus p99 %uus max %uus\n",
+		handle->name,
+		(unsigned long long)stats.event_count,
+		(unsigned)histogram_percentile(histogram, stats, 0.5f),
+		(unsigned)histogram_percentile(histogram, stats, 0.99f),
+		(unsigned)stats.time_most);
+	dprintf(fd, "   bucket [us] : events\n");
+
+	uint32_t lower = 0;
+
+	for (int b = 0; b < PERF_HISTOGRAM_BUCKETS; b++) {
+		const uint32_t upper = histogram_bucket_upper(b);
+
+		if (histogram[b] > 0) {
+			if (b == PERF_HISTOGRAM_BUCKETS - 1) {
+				dprintf(fd, "   %7u -         : %u\n", (unsigned)lower, (unsigned)histogram[b]);
+
+			} else {
+				dprintf(fd, "   %7u - %7u : %u\n", (unsigned)lower, (unsigned)upper, (unsigned)histogram[b]);
+			}
+		}
+
+		lower = upper + 1;
+	}
+}
+
 void
 perf_iterate_all(perf_callback cb, void *user)
 {
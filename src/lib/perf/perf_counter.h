@@ -48,7 +48,9 @@
 enum perf_counter_type {
 	PC_COUNT,		/**< count the number of times an event occurs */
 	PC_ELAPSED,		/**< measure the time elapsed performing an event */
-	PC_INTERVAL		/**< measure the interval between instances of an event */
+	PC_INTERVAL,		/**< measure the interval between instances of an event */
+	PC_ELAPSED_SHARDED,	/**< PC_ELAPSED with per-thread storage, safe to update from several threads at once */
+	PC_ELAPSED_HISTOGRAM	/**< PC_ELAPSED_SHARDED that additionally keeps a latency histogram (p50/p99) */
 };
 
 struct perf_ctr_header;
@@ -109,6 +111,11 @@ __EXPORT extern void		perf_begin(perf_counter_t handle);
  * This call applies to counters that operate over ranges of time; PC_ELAPSED etc.
  * If a call is made without a corresponding perf_begin call, or if perf_cancel
  * has been called subsequently, no change is made to the counter.
+ * For PC_ELAPSED_SHARDED and PC_ELAPSED_HISTOGRAM, begin and end are matched per thread.
+ * This needs a shard of its own for the calling thread, pairs of threads beyond the
+ * shard count (4 on NuttX, 8 otherwise) are counted as dropped; use perf_set_elapsed there.
+ * A shard is given back when its thread exits (on NuttX once another thread needs it),
+ * so the limit applies to threads alive at the same time.
  *
  * @param handle		The handle returned from perf_alloc.
  */
@@ -192,6 +199,16 @@ __EXPORT extern void		perf_print_counter_fd(int fd, perf_counter_t handle);
  */
 __EXPORT extern int		perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle);
 
+/**
+ * Print the latency histogram of a counter.
+ *
+ * This call only applies to counters of type PC_ELAPSED_HISTOGRAM, others are ignored.
+ *
+ * @param fd			File descriptor to print to - e.g. 0 for stdout
+ * @param handle		The counter to print.
+ */
+__EXPORT extern void		perf_print_histogram(int fd, perf_counter_t handle);
+
 /**
  * Print all of the performance counters.
  *
@@ -242,6 +259,18 @@ __EXPORT extern uint64_t	perf_event_count(perf_counter_t handle);
  */
 __EXPORT extern float		perf_mean(perf_counter_t handle);
 
+/**
+ * Return a percentile of the elapsed time
+ *
+ * This call only applies to counters of type PC_ELAPSED_HISTOGRAM. The result is the
+ * upper bound of the histogram bucket the percentile falls into (at most the maximum).
+ *
+ * @param handle		The handle returned from perf_alloc.
+ * @param quantile		Quantile in [0, 1], e.g. 0.99 for p99
+ * @return			percentile in us, 0 if there are no events
+ */
+__EXPORT extern uint32_t	perf_percentile(perf_counter_t handle, float quantile);
+
 __END_DECLS
 
 #endif
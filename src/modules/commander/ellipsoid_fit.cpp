@@ -0,0 +1,274 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "ellipsoid_fit.hpp"
+
+using matrix::Matrix3f;
+using matrix::Vector3f;
+
+void EllipsoidFit::reset()
+{
+	for (float &value : _information) {
+		value = 0.f;
+	}
+
+	for (float &value : _projection) {
+		value = 0.f;
+	}
+
+	_target_sq = 0.f;
+	_weight = 0.f;
+	_samples = 0;
+}
+
+void EllipsoidFit::update(const Vector3f &sample)
+{
+	const float x = sample(0);
+	const float y = sample(1);
+	const float z = sample(2);
+	const float xx = x * x;
+	const float yy = y * y;
+	const float zz = z * z;
+
+	const float phi[N] {
+		xx + yy - 2.f * zz,
+		xx - 2.f * yy + zz,
+		2.f * x * y,
+		2.f * x * z,
+		2.f * y * z,
+		2.f * x,
+		2.f * y,
+		2.f * z,
+		1.f
+	};
+
+	const float target = xx + yy + zz;
+
+	int k = 0;
+
+	for (int row = 0; row < N; row++) {
+		for (int col = row; col < N; col++) {
+			_information[k] = _lambda * _information[k] + phi[row] * phi[col];
+			k++;
+		}
+
+		_projection[row] = _lambda * _projection[row] + phi[row] * target;
+	}
+
+	_target_sq = _lambda * _target_sq + target * target;
+	_weight = _lambda * _weight + 1.f;
+	_samples++;
+}
+
+bool EllipsoidFit::solve(int first, float u[N], float &sse) const
+{
+	const int n = N - first;
+	float L[N][N] {};
+
+	for (int row = 0; row < n; row++) {
+		for (int col = 0; col <= row; col++) {
+			float sum = _information[index(first + col, first + row)];
+
+			for (int i = 0; i < col; i++) {
+				sum -= L[row][i] * L[col][i];
+			}
+
+			if (row == col) {
+				// reject a (numerically) singular system, e.g. samples on a plane only
+				if (!(sum > 1e-6f * _information[index(first + row, first + row)])) {
+					return false;
+				}
+
+				L[row][row] = sqrtf(sum);
+
+			} else {
+				L[row][col] = sum / L[col][col];
+			}
+		}
+	}
+
+	// L * w = b
+	float w[N] {};
+
+	for (int row = 0; row < n; row++) {
+		float sum = _projection[first + row];
+
+		for (int i = 0; i < row; i++) {
+			sum -= L[row][i] * w[i];
+		}
+
+		w[row] = sum / L[row][row];
+	}
+
+	// L' * u = w
+	for (int row = n - 1; row >= 0; row--) {
+		float sum = w[row];
+
+		for (int i = row + 1; i < n; i++) {
+			sum -= L[i][row] * u[i];
+		}
+
+		u[row] = sum / L[row][row];
+	}
+
+	// at the least-squares solution sum(e^2) = sum(|m|^4) - b' * u = sum(|m|^4) - |w|^2
+	float w_sq = 0.f;
+
+	for (int row = 0; row < n; row++) {
+		w_sq += w[row] * w[row];
+	}
+
+	sse = fmaxf(_target_sq - w_sq, 0.f);
+
+	return true;
+}
+
+int EllipsoidFit::fitSphere(sphere_params &params, float &fitness) const
+{
+	float u[N];
+	float sse;
+
+	if (_samples < N - SPHERE_FIRST || !solve(SPHERE_FIRST, u, sse)) {
+		return 1;
+	}
+
+	// |m|^2 = 2 c' m + (r^2 - |c|^2)
+	const Vector3f offset{u[0], u[1], u[2]};
+	const float radius_sq = u[3] + offset.norm_squared();
+
+	if (!PX4_ISFINITE(radius_sq) || radius_sq <= 0.f) {
+		return 1;
+	}
+
+	params.offset = offset;
+	params.radius = sqrtf(radius_sq);
+	params.diag = {1.f, 1.f, 1.f};
+	params.offdiag.zero();
+
+	// a residual e of |m|^2 corresponds to a radial error of about e / (2 r)
+	fitness = sqrtf(sse / _weight) / (2.f * params.radius);
+
+	return 0;
+}
+
+int EllipsoidFit::fitEllipsoid(sphere_params &params, float &fitness) const
+{
+	sphere_params sphere;
+	float sphere_fitness;
+
+	if (fitSphere(sphere, sphere_fitness) != 0) {
+		return 1;
+	}
+
+	float u[N];
+	float sse;
+
+	if (_samples < N || !solve(0, u, sse)) {
+		return 1;
+	}
+
+	// quadric m' M m + 2 g' m + J = 0
+	float M_data[9] {
+		u[0] + u[1] - 1.f, u[2], u[3],
+		u[2], u[0] - 2.f * u[1] - 1.f, u[4],
+		u[3], u[4], u[1] - 2.f * u[0] - 1.f
+	};
+	const Matrix3f M{M_data};
+	const Vector3f g{u[5], u[6], u[7]};
+
+	Matrix3f M_inv;
+
+	if (!M.I(M_inv)) {
+		return 1;
+	}
+
+	// centered at c: (m - c)' M (m - c) = k
+	const Vector3f offset = -(M_inv * g);
+	const float k = -(g.dot(offset) + u[8]);
+
+	if (!PX4_ISFINITE(k) || fabsf(k) < FLT_EPSILON) {
+		return 1;
+	}
+
+	// scale such that |S (m - c)| = r, i.e. S = sqrtm(r^2 M / k)
+	const float radius = sphere.radius;
+	const Matrix3f Q = M * (radius * radius / k);
+
+	// must be positive definite to describe an ellipsoid
+	const float minor_1 = Q(0, 0);
+	const float minor_2 = Q(0, 0) * Q(1, 1) - Q(0, 1) * Q(1, 0);
+	const float minor_3 = Q(0, 0) * (Q(1, 1) * Q(2, 2) - Q(1, 2) * Q(2, 1))
+			      - Q(0, 1) * (Q(1, 0) * Q(2, 2) - Q(1, 2) * Q(2, 0))
+			      + Q(0, 2) * (Q(1, 0) * Q(2, 1) - Q(1, 1) * Q(2, 0));
+
+	if (!(minor_1 > 0.f && minor_2 > 0.f && minor_3 > 0.f)) {
+		return 1;
+	}
+
+	// principal square root by Denman-Beavers iteration, Q is close to identity for any sensible mag
+	Matrix3f Y = Q;
+	Matrix3f Z;
+	Z.setIdentity();
+
+	for (int i = 0; i < 10; i++) {
+		Matrix3f Y_inv;
+		Matrix3f Z_inv;
+
+		if (!Y.I(Y_inv) || !Z.I(Z_inv)) {
+			return 1;
+		}
+
+		Y = (Y + Z_inv) * 0.5f;
+		Z = (Z + Y_inv) * 0.5f;
+	}
+
+	const Matrix3f &S = Y;
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (!PX4_ISFINITE(S(i, j))) {
+				return 1;
+			}
+		}
+	}
+
+	params.offset = offset;
+	params.radius = radius;
+	params.diag = {S(0, 0), S(1, 1), S(2, 2)};
+	params.offdiag = {0.5f * (S(0, 1) + S(1, 0)), 0.5f * (S(0, 2) + S(2, 0)), 0.5f * (S(1, 2) + S(2, 1))};
+
+	// a residual e of the quadric corresponds to a radial error of about e r / (2 k)
+	fitness = sqrtf(sse / _weight) * radius / (2.f * fabsf(k));
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "lm_fit.hpp"
+
+/**
+ * Streaming least-squares sphere and ellipsoid fit.
+ *
+ * Every sample updates the normal equations of the linear ellipsoid model
+ *
+ *   x^2 + y^2 + z^2 = u0 (x^2 + y^2 - 2z^2) + u1 (x^2 - 2y^2 + z^2) + 2 u2 xy + 2 u3 xz + 2 u4 yz
+ *                     + 2 u5 x + 2 u6 y + 2 u7 z + u8
+ *
+ * so the memory used does not depend on the number of samples and the current fit can be
+ * solved for at any time. The last four regressors alone are the linear sphere model,
+ * which lets the sphere and the ellipsoid fit share the same accumulator.
+ */
+class EllipsoidFit
+{
+public:
+	EllipsoidFit() = default;
+	~EllipsoidFit() = default;
+
+	void reset();
+
+	/**
+	 * Exponential forgetting factor applied to the accumulated samples on each update.
+	 * 1 keeps all samples, values slightly below 1 let the fit track a slowly changing field.
+	 */
+	void setForgettingFactor(float lambda) { _lambda = lambda; }
+
+	void update(const matrix::Vector3f &sample);
+
+	unsigned samples() const { return _samples; }
+
+	/**
+	 * Solve for the sphere (offset and radius), the scale is reset to identity.
+	 *
+	 * @param params the fitted values
+	 * @param fitness RMS residual of the sample norms to the radius
+	 * @return 0 on success, 1 on failure
+	 */
+	int fitSphere(sphere_params &params, float &fitness) const;
+
+	/**
+	 * Solve for the full ellipsoid. The radius is the one of the sphere fit and
+	 * the symmetric scale matrix maps the ellipsoid onto that sphere.
+	 *
+	 * @param params the fitted values
+	 * @param fitness RMS residual of the corrected sample norms to the radius
+	 * @return 0 on success, 1 on failure
+	 */
+	int fitEllipsoid(sphere_params &params, float &fitness) const;
+
+private:
+	static constexpr int N = 9; ///< number of regressors
+	static constexpr int SPHERE_FIRST = 5; ///< index of the first sphere regressor
+
+	static constexpr int index(int row, int col) { return row * N - row * (row - 1) / 2 + (col - row); }
+
+	/**
+	 * Solve the normal equations restricted to the regressors [first, N) by Cholesky decomposition.
+	 *
+	 * @param first index of the first regressor to use
+	 * @param u solution, N - first elements
+	 * @param sse sum of the squared residuals at the solution
+	 * @return true on success, false if the problem is not constrained enough
+	 */
+	bool solve(int first, float u[N], float &sse) const;
+
+	float _information[N * (N + 1) / 2] {}; ///< upper triangle of sum(phi * phi')
+	float _projection[N] {}; ///< sum(phi * |m|^2)
+	float _target_sq{0.f}; ///< sum(|m|^4)
+	float _weight{0.f}; ///< sum of the sample weights
+	float _lambda{1.f};
+	unsigned _samples{0};
+};
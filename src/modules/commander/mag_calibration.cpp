@@ -40,7 +40,7 @@
 #include "mag_calibration.h"
 #include "commander_helper.h"
 #include "calibration_routines.h"
-#include "lm_fit.hpp"
+#include "ellipsoid_fit.hpp"
 #include "calibration_messages.h"
 #include "factory_calibration_storage.h"
 
@@ -77,6 +77,22 @@ static constexpr unsigned int calibraton_duration_s = 42; 	///< The total durati
 
 calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_mask);
 
+/// Streaming fit state of a single mag
+struct mag_fit_data_t {
+	EllipsoidFit	fit;							///< Updated with every accepted sample
+	float		fitness{NAN};						///< Current sphere fit residual (Gauss)
+	Vector3f	last_sample;
+
+	// Coverage grid: set of the cells holding an accepted sample, open addressing, 0 = empty slot
+	static constexpr unsigned COVERAGE_SLOTS = 512;			///< Power of two, twice calibration_total_points
+	uint32_t	coverage[COVERAGE_SLOTS] {};
+
+	// Raw sample moments, enough to compare the mags once calibrated without keeping the samples
+	Vector3f	sample_sum;
+	Matrix3f	sample_sum_sq;						///< sum(m * m')
+	Matrix3f	sample_sum_ref;						///< sum(m_reference * m')
+};
+
 /// Data passed to calibration worker routine
 struct mag_worker_data_t {
 	orb_advert_t	*mavlink_log_pub;
@@ -90,9 +106,8 @@ struct mag_worker_data_t {
 	uint64_t	calibration_interval_perside_us;
 	unsigned int	calibration_counter_total[MAX_MAGS];
 
-	float		*x[MAX_MAGS];
-	float		*y[MAX_MAGS];
-	float		*z[MAX_MAGS];
+	mag_fit_data_t	*fit_data[MAX_MAGS];
+	int		reference_index;					///< First internal mag, -1 if none
 
 	calibration::Magnetometer calibration[MAX_MAGS] {};
 };
@@ -139,28 +154,63 @@ int do_mag_calibration(orb_advert_t *mavlink_log_pub)
 	return result;
 }
 
-static bool reject_sample(float sx, float sy, float sz, float x[], float y[], float z[], unsigned count,
-			  unsigned max_count, float mag_sphere_radius)
+static uint32_t coverage_cell(const Vector3f &sample, float cell_size)
 {
-	float min_sample_dist = fabsf(5.4f * mag_sphere_radius / sqrtf(max_count)) / 3.0f;
+	uint32_t cell = 1u << 31; // never 0, which marks an empty slot
 
-	for (size_t i = 0; i < count; i++) {
-		float dx = sx - x[i];
-		float dy = sy - y[i];
-		float dz = sz - z[i];
-		float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+	for (int i = 0; i < 3; i++) {
+		const int index = math::constrain((int)floorf(sample(i) / cell_size), -512, 511);
+		cell |= (uint32_t)(index + 512) << (10 * i);
+	}
+
+	return cell;
+}
 
-		if (dist < min_sample_dist) {
-			PX4_DEBUG("rejected X: %.3f Y: %.3f Z: %.3f (%.3f < %.3f) (%d/%d) ", (double)sx, (double)sy, (double)sz, (double)dist,
-				  (double)min_sample_dist, count, max_count);
+/// Slot holding the cell, or the empty slot it would be stored in. nullptr if the table is full.
+static uint32_t *coverage_slot(mag_fit_data_t &fit_data, uint32_t cell)
+{
+	static constexpr uint32_t mask = mag_fit_data_t::COVERAGE_SLOTS - 1;
+	uint32_t index = (cell * 2654435761u) & mask;
 
-			return true;
+	for (unsigned probe = 0; probe < mag_fit_data_t::COVERAGE_SLOTS; probe++) {
+		uint32_t &slot = fit_data.coverage[(index + probe) & mask];
+
+		if (slot == cell || slot == 0) {
+			return &slot;
 		}
 	}
 
+	return nullptr;
+}
+
+static bool reject_sample(const Vector3f &sample, mag_fit_data_t &fit_data, float cell_size)
+{
+	// the samples are not stored, instead every accepted sample occupies a grid cell of the minimum sample distance
+	// and further samples falling into an occupied cell don't add coverage
+	const uint32_t *slot = coverage_slot(fit_data, coverage_cell(sample, cell_size));
+
+	if (slot != nullptr && *slot != 0) {
+		PX4_DEBUG("rejected X: %.3f Y: %.3f Z: %.3f (cell occupied)", (double)sample(0), (double)sample(1), (double)sample(2));
+
+		return true;
+	}
+
 	return false;
 }
 
+static Matrix3f outer_product(const Vector3f &a, const Vector3f &b)
+{
+	Matrix3f result;
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			result(i, j) = a(i) * b(j);
+		}
+	}
+
+	return result;
+}
+
 static unsigned progress_percentage(mag_worker_data_t *worker_data)
 {
 	return 100 * ((float)worker_data->done_count) / worker_data->calibration_sides;
@@ -256,7 +306,9 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 
 	mag_worker_data_t *worker_data = (mag_worker_data_t *)(data);
 
-	float mag_sphere_radius = get_sphere_radius();
+	const float mag_sphere_radius = get_sphere_radius();
+	const unsigned max_count = worker_data->calibration_sides * worker_data->calibration_points_perside;
+	const float min_sample_dist = fabsf(5.4f * mag_sphere_radius / sqrtf(max_count)) / 3.0f;
 
 	// notify user to start rotating
 	set_tune(tune_control_s::TUNE_ID_SINGLE_BEEP);
@@ -360,11 +412,7 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 						}
 
 						// Check if this measurement is good to go in
-						bool reject = reject_sample(mag.x, mag.y, mag.z,
-									    worker_data->x[cur_mag], worker_data->y[cur_mag], worker_data->z[cur_mag],
-									    worker_data->calibration_counter_total[cur_mag],
-									    worker_data->calibration_sides * worker_data->calibration_points_perside,
-									    mag_sphere_radius);
+						bool reject = reject_sample(Vector3f{mag.x, mag.y, mag.z}, *worker_data->fit_data[cur_mag], min_sample_dist);
 
 						if (!reject) {
 							new_samples[cur_mag] = Vector3f{mag.x, mag.y, mag.z};
@@ -384,10 +432,33 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 			if (!rejected) {
 				for (uint8_t cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
 					if (worker_data->calibration[cur_mag].device_id() != 0) {
-						worker_data->x[cur_mag][worker_data->calibration_counter_total[cur_mag]] = new_samples[cur_mag](0);
-						worker_data->y[cur_mag][worker_data->calibration_counter_total[cur_mag]] = new_samples[cur_mag](1);
-						worker_data->z[cur_mag][worker_data->calibration_counter_total[cur_mag]] = new_samples[cur_mag](2);
+						mag_fit_data_t &fit_data = *worker_data->fit_data[cur_mag];
+						const Vector3f &sample = new_samples[cur_mag];
+
+						fit_data.fit.update(sample);
+						fit_data.last_sample = sample;
+
+						const uint32_t cell = coverage_cell(sample, min_sample_dist);
+						uint32_t *slot = coverage_slot(fit_data, cell);
+
+						if (slot != nullptr) {
+							*slot = cell;
+						}
 						worker_data->calibration_counter_total[cur_mag]++;
+
+						fit_data.sample_sum += sample;
+						fit_data.sample_sum_sq += outer_product(sample, sample);
+
+						if (worker_data->reference_index >= 0) {
+							fit_data.sample_sum_ref += outer_product(new_samples[worker_data->reference_index], sample);
+						}
+
+						sphere_params sphere;
+						float fitness = NAN;
+
+						if (fit_data.fit.fitSphere(sphere, fitness) == PX4_OK) {
+							fit_data.fitness = fitness;
+						}
 					}
 				}
 
@@ -404,15 +475,16 @@ static calibrate_return mag_calibration_worker(detect_orientation_return orienta
 					status.side_data_collected[cur_mag] = worker_data->side_data_collected[cur_mag];
 
 					if (worker_data->calibration[cur_mag].device_id() != 0) {
-						const unsigned int sample = worker_data->calibration_counter_total[cur_mag] - 1;
-						status.x[cur_mag] = worker_data->x[cur_mag][sample];
-						status.y[cur_mag] = worker_data->y[cur_mag][sample];
-						status.z[cur_mag] = worker_data->z[cur_mag][sample];
+						status.x[cur_mag] = worker_data->fit_data[cur_mag]->last_sample(0);
+						status.y[cur_mag] = worker_data->fit_data[cur_mag]->last_sample(1);
+						status.z[cur_mag] = worker_data->fit_data[cur_mag]->last_sample(2);
+						status.fitness[cur_mag] = worker_data->fit_data[cur_mag]->fitness;
 
 					} else {
 						status.x[cur_mag] = 0.f;
 						status.y[cur_mag] = 0.f;
 						status.z[cur_mag] = 0.f;
+						status.fitness[cur_mag] = NAN;
 					}
 				}
 
@@ -502,13 +574,11 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 
 	for (size_t cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
 		// Initialize to no memory allocated
-		worker_data.x[cur_mag] = nullptr;
-		worker_data.y[cur_mag] = nullptr;
-		worker_data.z[cur_mag] = nullptr;
+		worker_data.fit_data[cur_mag] = nullptr;
 		worker_data.calibration_counter_total[cur_mag] = 0;
 	}
 
-	const unsigned int calibration_points_maxcount = worker_data.calibration_sides * worker_data.calibration_points_perside;
+	worker_data.reference_index = -1;
 
 	for (uint8_t cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
 
@@ -522,16 +592,19 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 		worker_data.calibration[cur_mag].set_calibration_index(cur_mag);
 
 		if (worker_data.calibration[cur_mag].device_id() != 0) {
-			worker_data.x[cur_mag] = static_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-			worker_data.y[cur_mag] = static_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-			worker_data.z[cur_mag] = static_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
+			worker_data.fit_data[cur_mag] = new mag_fit_data_t{};
 
-			if (worker_data.x[cur_mag] == nullptr || worker_data.y[cur_mag] == nullptr || worker_data.z[cur_mag] == nullptr) {
+			if (worker_data.fit_data[cur_mag] == nullptr) {
 				calibration_log_critical(mavlink_log_pub, "ERROR: out of memory");
 				result = calibrate_return_error;
 				break;
 			}
 
+			// first internal mag is the reference to determine external mag rotations
+			if (!worker_data.calibration[cur_mag].external() && (worker_data.reference_index < 0)) {
+				worker_data.reference_index = cur_mag;
+			}
+
 		} else {
 			break;
 		}
@@ -573,25 +646,24 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 
 				sphere_params sphere_data;
 				sphere_data.radius = sphere_radius[cur_mag];
-				sphere_data.offset = matrix::Vector3f(sphere[cur_mag](0), sphere[cur_mag](1), sphere[cur_mag](2));
-				sphere_data.diag = matrix::Vector3f(diag[cur_mag](0), diag[cur_mag](1), diag[cur_mag](2));
-				sphere_data.offdiag = matrix::Vector3f(offdiag[cur_mag](0), offdiag[cur_mag](1), offdiag[cur_mag](2));
 
 				bool sphere_fit_success = false;
 				bool ellipsoid_fit_success = false;
-				int ret = lm_mag_fit(worker_data.x[cur_mag], worker_data.y[cur_mag], worker_data.z[cur_mag],
-						     worker_data.calibration_counter_total[cur_mag], sphere_data, false);
+				float fitness = NAN;
+				int ret = worker_data.fit_data[cur_mag]->fit.fitSphere(sphere_data, fitness);
 
 				if (ret == PX4_OK) {
 					sphere_fit_success = true;
-					PX4_INFO("Mag: %d sphere radius: %.4f", cur_mag, (double)sphere_data.radius);
+					PX4_INFO("Mag: %d sphere radius: %.4f fitness: %.4f", cur_mag, (double)sphere_data.radius, (double)fitness);
 
 					if (!sphere_fit_only) {
-						int ellipsoid_ret = lm_mag_fit(worker_data.x[cur_mag], worker_data.y[cur_mag], worker_data.z[cur_mag],
-									       worker_data.calibration_counter_total[cur_mag], sphere_data, true);
+						sphere_params ellipsoid_data;
+						int ellipsoid_ret = worker_data.fit_data[cur_mag]->fit.fitEllipsoid(ellipsoid_data, fitness);
 
 						if (ellipsoid_ret == PX4_OK) {
-							ellipsoid_fit_success  = true;
+							ellipsoid_fit_success = true;
+							sphere_data = ellipsoid_data;
+							PX4_INFO("Mag: %d ellipsoid fitness: %.4f", cur_mag, (double)fitness);
 						}
 					}
 				}
@@ -634,9 +706,10 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 				continue;
 			}
 
-			printf("MAG %u with %u samples:\n", cur_mag, worker_data.calibration_counter_total[cur_mag]);
-			printf("RAW -> CALIBRATED\n");
+			printf("MAG %u with %u samples (fitness %.4f):\n", cur_mag, worker_data.calibration_counter_total[cur_mag],
+			       (double)worker_data.fit_data[cur_mag]->fitness);
 
+			// the samples are not kept, print the fit and the last sample instead
 			float scale_data[9] {
 				diag[cur_mag](0),    offdiag[cur_mag](0), offdiag[cur_mag](1),
 				offdiag[cur_mag](0),    diag[cur_mag](1), offdiag[cur_mag](2),
@@ -645,19 +718,16 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 
 			const Matrix3f scale{scale_data};
 			const Vector3f &offset = sphere[cur_mag];
+			const Vector3f &raw = worker_data.fit_data[cur_mag]->last_sample;
 
-			for (size_t i = 0; i < worker_data.calibration_counter_total[cur_mag]; i++) {
-				float x = worker_data.x[cur_mag][i];
-				float y = worker_data.y[cur_mag][i];
-				float z = worker_data.z[cur_mag][i];
+			// apply calibration
+			const Vector3f cal{scale *(raw - offset)};
 
-				// apply calibration
-				const Vector3f cal{scale *(Vector3f{x, y, z} - offset)};
-
-				printf("[%.3f, %.3f, %.3f] -> [%.3f, %.3f, %.3f]\n",
-				       (double)x, (double)y, (double)z,
-				       (double)cal(0), (double)cal(1), (double)cal(2));
-			}
+			printf("OFFSET: [%.3f, %.3f, %.3f]\n", (double)offset(0), (double)offset(1), (double)offset(2));
+			scale.print();
+			printf("[%.3f, %.3f, %.3f] -> [%.3f, %.3f, %.3f]\n",
+			       (double)raw(0), (double)raw(1), (double)raw(2),
+			       (double)cal(0), (double)cal(1), (double)cal(2));
 
 			printf("SPHERE RADIUS: %8.4f\n", (double)sphere_radius[cur_mag]);
 		}
@@ -673,22 +743,17 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 
 		if ((worker_data.calibration_sides >= 3) && (param_cal_mag_rot_auto == 1)) {
 
-			// find first internal mag to use as reference
-			int internal_index = -1;
-
-			for (unsigned cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
-				if (!worker_data.calibration[cur_mag].external() && (worker_data.calibration[cur_mag].device_id() != 0)) {
-					internal_index = cur_mag;
-					break;
-				}
-			}
+			// first internal mag to use as reference
+			const int internal_index = worker_data.reference_index;
 
 			// only proceed if there's a valid internal
 			if (internal_index >= 0) {
 
 				const Dcmf board_rotation = calibration::GetBoardRotationMatrix();
 
-				// apply new calibrations to all raw sensor data before comparison
+				// new calibrations to apply to all raw sensor data before comparison: T * (m - offset)
+				Matrix3f transform[MAX_MAGS];
+
 				for (unsigned cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
 					if (worker_data.calibration[cur_mag].device_id() != 0) {
 
@@ -699,35 +764,51 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 						};
 						const Matrix3f scale{scale_data};
 
-						const Vector3f &offset{sphere[cur_mag]};
+						if (worker_data.calibration[cur_mag].external()) {
+							transform[cur_mag] = scale;
 
-						for (unsigned i = 0; i < worker_data.calibration_counter_total[cur_mag]; i++) {
+						} else {
+							// rotate internal mag data to board
+							transform[cur_mag] = board_rotation * scale;
+						}
+					}
+				}
 
-							const Vector3f sample{worker_data.x[cur_mag][i], worker_data.y[cur_mag][i], worker_data.z[cur_mag][i]};
+				// sum(a * a') of the calibrated samples a = T * (m - offset), from the raw sample moments
+				const auto calibrated_sum_sq = [&](int mag_index) {
+					const mag_fit_data_t &fit_data = *worker_data.fit_data[mag_index];
+					const Vector3f &offset = sphere[mag_index];
+					const float n = worker_data.calibration_counter_total[mag_index];
 
-							// apply calibration
-							Vector3f m{scale *(sample - offset)};
+					const Matrix3f centered = fit_data.sample_sum_sq - outer_product(offset, fit_data.sample_sum)
+								  - outer_product(fit_data.sample_sum, offset) + outer_product(offset, offset) * n;
 
-							if (!worker_data.calibration[cur_mag].external()) {
-								// rotate internal mag data to board
-								m = board_rotation * m;
-							}
+					return Matrix3f{transform[mag_index] * centered * transform[mag_index].transpose()};
+				};
 
-							// store back in worker_data
-							worker_data.x[cur_mag][i] = m(0);
-							worker_data.y[cur_mag][i] = m(1);
-							worker_data.z[cur_mag][i] = m(2);
-						}
-					}
-				}
+				const Matrix3f reference_sum_sq = calibrated_sum_sq(internal_index);
 
 				// external mags try all rotations and compute mean square error (MSE) compared with first internal mag
 				for (int cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
 					if ((worker_data.calibration[cur_mag].device_id() != 0) && (cur_mag != internal_index)) {
 
+						// all mags are sampled in lockstep
 						const int last_sample_index = math::min(worker_data.calibration_counter_total[internal_index],
 											worker_data.calibration_counter_total[cur_mag]);
 
+						// sum(|R a - b|^2) = sum(|a|^2) + sum(|b|^2) - 2 sum(b' R a) with the calibrated samples a and reference b
+						const mag_fit_data_t &fit_data = *worker_data.fit_data[cur_mag];
+						const mag_fit_data_t &reference = *worker_data.fit_data[internal_index];
+						const Vector3f &offset = sphere[cur_mag];
+						const Vector3f &reference_offset = sphere[internal_index];
+
+						const Matrix3f centered_cross = fit_data.sample_sum_ref - outer_product(reference_offset, fit_data.sample_sum)
+										- outer_product(reference.sample_sum, offset)
+										+ outer_product(reference_offset, offset) * (float)last_sample_index;
+						const Matrix3f cross{transform[internal_index] * centered_cross * transform[cur_mag].transpose()};
+
+						const float norm_sq_sum = calibrated_sum_sq(cur_mag).trace() + reference_sum_sq.trace();
+
 						float MSE[ROTATION_MAX] {}; // mean square error for each rotation
 
 						float min_mse = FLT_MAX;
@@ -747,19 +828,17 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 								break;
 
 							default:
-								float diff_sum = 0.f;
+								const Dcmf R = get_rot_matrix((enum Rotation)r);
+								float cross_sum = 0.f;
 
-								for (int i = 0; i < last_sample_index; i++) {
-									float x = worker_data.x[cur_mag][i];
-									float y = worker_data.y[cur_mag][i];
-									float z = worker_data.z[cur_mag][i];
-									rotate_3f((enum Rotation)r, x, y, z);
-
-									Vector3f diff = Vector3f{x, y, z} - Vector3f{worker_data.x[internal_index][i], worker_data.y[internal_index][i], worker_data.z[internal_index][i]};
-
-									diff_sum += diff.norm_squared();
+								for (int i = 0; i < 3; i++) {
+									for (int j = 0; j < 3; j++) {
+										cross_sum += R(i, j) * cross(i, j);
+									}
 								}
 
+								const float diff_sum = norm_sq_sum - 2.f * cross_sum;
+
 								// compute mean squared error
 								MSE[r] = diff_sum / last_sample_index;
 
@@ -849,11 +928,9 @@ calibrate_return mag_calibrate_all(orb_advert_t *mavlink_log_pub, int32_t cal_ma
 	}
 
 
-	// Data points are no longer needed
+	// Fit state is no longer needed
 	for (size_t cur_mag = 0; cur_mag < MAX_MAGS; cur_mag++) {
-		free(worker_data.x[cur_mag]);
-		free(worker_data.y[cur_mag]);
-		free(worker_data.z[cur_mag]);
+		delete worker_data.fit_data[cur_mag];
 	}
 
 	FactoryCalibrationStorage factory_storage;
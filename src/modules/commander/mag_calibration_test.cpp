@@ -39,12 +39,15 @@
  */
 
 #include <gtest/gtest.h>
+#include <drivers/drv_hrt.h>
 #include <matrix/matrix/math.hpp>
 #include <px4_platform_common/defines.h>
 
+#include "ellipsoid_fit.hpp"
 #include "lm_fit.hpp"
 #include "mag_calibration_test_data.h"
 
+using matrix::Matrix3f;
 using matrix::Vector3f;
 
 class MagCalTest : public ::testing::Test
@@ -105,7 +108,7 @@ void MagCalTest::generateRegularData(float *x, float *y, float *z, unsigned int
 	}
 
 	if (n_count > n_samples) {
-		printf("Error placing samples, n = %d\n", n_count);
+		ADD_FAILURE() << "Error placing samples, n = " << n_count;
 		return;
 	}
 
@@ -218,7 +221,6 @@ TEST_F(MagCalTest, replayTestData)
 	EXPECT_NEAR(sphere.offset(1), offset_true(1), 0.01f) << "offset Y: " << sphere.offset(1);
 	EXPECT_NEAR(sphere.offset(2), offset_true(2), 0.01f) << "offset Z: " << sphere.offset(2);
 
-	printf("Ellipsoid fit\n");
 	sphere_params ellipsoid;
 	ellipsoid.diag = {1.f, 1.f, 1.f};
 	ellipsoid.radius = 0.2;
@@ -236,3 +238,155 @@ TEST_F(MagCalTest, replayTestData)
 	EXPECT_NEAR(ellipsoid.diag(1), scale_true(1), 0.01f) << "scale Y: " << ellipsoid.diag(1);
 	EXPECT_NEAR(ellipsoid.diag(2), scale_true(2), 0.01f) << "scale Z: " << ellipsoid.diag(2);
 }
+
+TEST_F(MagCalTest, ellipsoidFitSphereRegularlySpaced)
+{
+	// GIVEN: a dataset of regularly spaced points
+	// on a perfect sphere but not centered on the origin
+	static constexpr unsigned int N_SAMPLES = 240;
+
+	const float mag_str_true = 0.4f;
+	const Vector3f offset_true = {-1.07f, 0.35f, -0.78f};
+	const Vector3f scale_true = {1.f, 1.f, 1.f};
+
+	float x[N_SAMPLES];
+	float y[N_SAMPLES];
+	float z[N_SAMPLES];
+	generateRegularData(x, y, z, N_SAMPLES, mag_str_true);
+	modifyOffsetScale(x, y, z, N_SAMPLES, offset_true, scale_true);
+
+	// WHEN: streaming the samples through the estimator
+	EllipsoidFit fit;
+
+	for (unsigned int k = 0; k < N_SAMPLES; k++) {
+		fit.update(Vector3f{x[k], y[k], z[k]});
+	}
+
+	sphere_params sphere;
+	float fitness = INFINITY;
+	int success = fit.fitSphere(sphere, fitness);
+
+	// THEN: the closed form solution is exact
+	EXPECT_EQ(success, PX4_OK);
+	EXPECT_EQ(fit.samples(), N_SAMPLES);
+	EXPECT_NEAR(sphere.radius, mag_str_true, 0.001f) << "radius: " << sphere.radius;
+	EXPECT_NEAR(sphere.offset(0), offset_true(0), 0.001f) << "offset X: " << sphere.offset(0);
+	EXPECT_NEAR(sphere.offset(1), offset_true(1), 0.001f) << "offset Y: " << sphere.offset(1);
+	EXPECT_NEAR(sphere.offset(2), offset_true(2), 0.001f) << "offset Z: " << sphere.offset(2);
+	EXPECT_LT(fitness, 0.001f);
+}
+
+TEST_F(MagCalTest, ellipsoidFitScaledData)
+{
+	// GIVEN: regularly spaced points on an ellipsoid
+	static constexpr unsigned int N_SAMPLES = 240;
+
+	const float mag_str_true = 0.4f;
+	const Vector3f offset_true = {0.12f, -0.31f, 0.25f};
+	const Vector3f scale_true = {1.05f, 0.9f, 1.1f};
+
+	float x[N_SAMPLES];
+	float y[N_SAMPLES];
+	float z[N_SAMPLES];
+	generateRegularData(x, y, z, N_SAMPLES, mag_str_true);
+	modifyOffsetScale(x, y, z, N_SAMPLES, offset_true, scale_true);
+
+	EllipsoidFit fit;
+
+	for (unsigned int k = 0; k < N_SAMPLES; k++) {
+		fit.update(Vector3f{x[k], y[k], z[k]});
+	}
+
+	// WHEN: fitting the full ellipsoid
+	sphere_params ellipsoid;
+	float fitness = INFINITY;
+	int success = fit.fitEllipsoid(ellipsoid, fitness);
+
+	// THEN: the offsets are found and the corrected samples all lie on the sphere
+	EXPECT_EQ(success, PX4_OK);
+	EXPECT_NEAR(ellipsoid.offset(0), offset_true(0), 0.001f) << "offset X: " << ellipsoid.offset(0);
+	EXPECT_NEAR(ellipsoid.offset(1), offset_true(1), 0.001f) << "offset Y: " << ellipsoid.offset(1);
+	EXPECT_NEAR(ellipsoid.offset(2), offset_true(2), 0.001f) << "offset Z: " << ellipsoid.offset(2);
+	EXPECT_NEAR(ellipsoid.diag(0) / ellipsoid.diag(1), scale_true(1) / scale_true(0), 0.001f);
+	EXPECT_NEAR(ellipsoid.diag(2) / ellipsoid.diag(1), scale_true(1) / scale_true(2), 0.001f);
+	EXPECT_LT(fitness, 0.001f);
+
+	float scale_data[9] {
+		ellipsoid.diag(0),    ellipsoid.offdiag(0), ellipsoid.offdiag(1),
+		ellipsoid.offdiag(0), ellipsoid.diag(1),    ellipsoid.offdiag(2),
+		ellipsoid.offdiag(1), ellipsoid.offdiag(2), ellipsoid.diag(2)
+	};
+	const Matrix3f scale{scale_data};
+
+	for (unsigned int k = 0; k < N_SAMPLES; k++) {
+		const Vector3f corrected{scale *(Vector3f{x[k], y[k], z[k]} - ellipsoid.offset)};
+		EXPECT_NEAR(corrected.norm(), ellipsoid.radius, 0.001f) << "sample " << k;
+	}
+}
+
+TEST_F(MagCalTest, ellipsoidFitReplayTestData)
+{
+	// GIVEN: the real test dataset also used for the batch fit
+	constexpr unsigned int N_SAMPLES = 231;
+
+	const float mag_str_true = 0.4f;
+	const Vector3f offset_true = {-0.18f, 0.05f, -0.58f};
+	const Vector3f scale_true = {1.f, 1.06f, 0.94f};
+
+	// WHEN: streaming the samples once and solving after each of them
+	EllipsoidFit fit;
+	sphere_params sphere;
+	sphere_params ellipsoid;
+	float sphere_fitness = INFINITY;
+	float ellipsoid_fitness = INFINITY;
+	int sphere_success = PX4_ERROR;
+	int ellipsoid_success = PX4_ERROR;
+
+	for (unsigned int k = 0; k < N_SAMPLES; k++) {
+		fit.update(Vector3f{mag_data1_x[k], mag_data1_y[k], mag_data1_z[k]});
+		sphere_success = fit.fitSphere(sphere, sphere_fitness);
+		ellipsoid_success = fit.fitEllipsoid(ellipsoid, ellipsoid_fitness);
+	}
+
+	// THEN: it finds the same parameters as the batch fit
+	EXPECT_EQ(sphere_success, PX4_OK);
+	EXPECT_NEAR(sphere.radius, mag_str_true, 0.1f) << "radius: " << sphere.radius;
+	EXPECT_NEAR(sphere.offset(0), offset_true(0), 0.01f) << "offset X: " << sphere.offset(0);
+	EXPECT_NEAR(sphere.offset(1), offset_true(1), 0.01f) << "offset Y: " << sphere.offset(1);
+	EXPECT_NEAR(sphere.offset(2), offset_true(2), 0.01f) << "offset Z: " << sphere.offset(2);
+
+	EXPECT_EQ(ellipsoid_success, PX4_OK);
+	EXPECT_NEAR(ellipsoid.radius, mag_str_true, 0.1f) << "radius: " << ellipsoid.radius;
+	EXPECT_NEAR(ellipsoid.offset(0), offset_true(0), 0.01f) << "offset X: " << ellipsoid.offset(0);
+	EXPECT_NEAR(ellipsoid.offset(1), offset_true(1), 0.01f) << "offset Y: " << ellipsoid.offset(1);
+	EXPECT_NEAR(ellipsoid.offset(2), offset_true(2), 0.01f) << "offset Z: " << ellipsoid.offset(2);
+	EXPECT_NEAR(ellipsoid.diag(0), scale_true(0), 0.01f) << "scale X: " << ellipsoid.diag(0);
+	EXPECT_NEAR(ellipsoid.diag(1), scale_true(1), 0.01f) << "scale Y: " << ellipsoid.diag(1);
+	EXPECT_NEAR(ellipsoid.diag(2), scale_true(2), 0.01f) << "scale Z: " << ellipsoid.diag(2);
+
+	// the ellipsoid explains the data better than the sphere
+	EXPECT_LT(ellipsoid_fitness, sphere_fitness);
+	EXPECT_LT(ellipsoid_fitness, 0.02f);
+}
+
+TEST_F(MagCalTest, streamingFitState)
+{
+	// GIVEN: the real test dataset
+	constexpr unsigned int N_SAMPLES = 231;
+
+	// WHEN: streaming the samples, solving the sphere after each one as done during calibration
+	EllipsoidFit fit;
+	sphere_params sphere;
+	float fitness;
+
+	for (unsigned int k = 0; k < N_SAMPLES; k++) {
+		fit.update(Vector3f{mag_data1_x[k], mag_data1_y[k], mag_data1_z[k]});
+		fit.fitSphere(sphere, fitness);
+	}
+
+	sphere_params ellipsoid;
+
+	// THEN: the ellipsoid can be solved and the streaming fit keeps O(1) state per mag
+	EXPECT_EQ(fit.fitEllipsoid(ellipsoid, fitness), PX4_OK);
+	EXPECT_LT(sizeof(EllipsoidFit), 3 * N_SAMPLES * sizeof(float));
+}
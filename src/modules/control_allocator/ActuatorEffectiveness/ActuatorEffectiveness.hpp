@@ -72,6 +72,12 @@ public:
 		_flight_phase = flight_phase;
 	}
 
+	/**
+	 * Rebuild the effectiveness matrix on the next getEffectivenessMatrix() call,
+	 * e.g. after the allocation method or the actuator limits changed
+	 */
+	void forceUpdate() { _updated = true; }
+
 	/**
 	 * Get the control effectiveness matrix if updated
 	 *
@@ -107,4 +113,5 @@ public:
 protected:
 	matrix::Vector<float, NUM_ACTUATORS> _trim;			///< Actuator trim
 	FlightPhase _flight_phase{FlightPhase::HOVER_FLIGHT};		///< Current flight phase
+	bool _updated{true};						///< Matrix needs to be rebuilt
 };
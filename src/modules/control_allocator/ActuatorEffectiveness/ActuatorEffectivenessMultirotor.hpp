@@ -82,7 +82,6 @@ public:
 private:
 	uORB::SubscriptionInterval _parameter_update_sub{ORB_ID(parameter_update), 1_s};
 
-	bool _updated{true};
 	int _num_actuators{0};
 
 	DEFINE_PARAMETERS(
@@ -109,7 +109,11 @@ ActuatorEffectivenessTiltrotorVTOL::getEffectivenessMatrix(matrix::Matrix<float,
 void
 ActuatorEffectivenessTiltrotorVTOL::setFlightPhase(const FlightPhase &flight_phase)
 {
-	ActuatorEffectiveness::setFlightPhase(flight_phase);
+	// vehicle_status is republished at a high rate; only rebuild the matrix on an actual phase change
+	if (flight_phase == _flight_phase) {
+		return;
+	}
 
+	ActuatorEffectiveness::setFlightPhase(flight_phase);
 	_updated = true;
 }
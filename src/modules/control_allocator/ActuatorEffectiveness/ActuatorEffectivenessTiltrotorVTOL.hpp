@@ -59,6 +59,4 @@ public:
 	void setFlightPhase(const FlightPhase &flight_phase) override;
 
 	int numActuators() const override { return 10; }
-protected:
-	bool _updated{true};
 };
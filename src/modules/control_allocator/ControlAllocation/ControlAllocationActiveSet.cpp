@@ -0,0 +1,316 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ControlAllocationActiveSet.cpp
+ */
+
+#include "ControlAllocationActiveSet.hpp"
+
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+
+constexpr float ControlAllocationActiveSet::AXIS_WEIGHTS[];
+
+// Tolerances on the bounds and on the Lagrange multipliers
+static constexpr float BOUND_EPSILON = 1e-5f;
+static constexpr float MULTIPLIER_EPSILON = 1e-3f;
+
+void
+ControlAllocationActiveSet::setEffectivenessMatrix(
+	const matrix::Matrix<float, ControlAllocation::NUM_AXES, ControlAllocation::NUM_ACTUATORS> &effectiveness,
+	const matrix::Vector<float, ControlAllocation::NUM_ACTUATORS> &actuator_trim, int num_actuators)
+{
+	ControlAllocation::setEffectivenessMatrix(effectiveness, actuator_trim, num_actuators);
+	updateHessian();
+}
+
+void
+ControlAllocationActiveSet::updateHessian()
+{
+	// H = gamma * B^T W B + I
+	for (int i = 0; i < NUM_ACTUATORS; i++) {
+		for (int j = i; j < NUM_ACTUATORS; j++) {
+			float h = 0.f;
+
+			for (int k = 0; k < NUM_AXES; k++) {
+				h += AXIS_WEIGHTS[k] * _effectiveness(k, i) * _effectiveness(k, j);
+			}
+
+			h *= CONTROL_WEIGHT;
+			_hessian(i, j) = h;
+			_hessian(j, i) = h;
+		}
+
+		_hessian(i, i) += 1.f;
+	}
+}
+
+bool
+ControlAllocationActiveSet::solveFree(const ActuatorVector &u, const ActuatorVector &c, ActuatorVector &u_opt) const
+{
+	u_opt = u;
+
+	int free_idx[NUM_ACTUATORS];
+	int num_free = 0;
+
+	for (int i = 0; i < NUM_ACTUATORS; i++) {
+		if (_bound[i] == Bound::FREE) {
+			free_idx[num_free++] = i;
+		}
+	}
+
+	if (num_free == 0) {
+		return true;
+	}
+
+	// H_ff x = c_f - H_fa u_a, solved by Cholesky decomposition of H_ff (lower triangle in l)
+	float l[NUM_ACTUATORS][NUM_ACTUATORS];
+	float x[NUM_ACTUATORS];
+
+	for (int r = 0; r < num_free; r++) {
+		const int i = free_idx[r];
+		float rhs = c(i);
+
+		for (int j = 0; j < NUM_ACTUATORS; j++) {
+			if (_bound[j] != Bound::FREE) {
+				rhs -= _hessian(i, j) * u(j);
+			}
+		}
+
+		x[r] = rhs;
+	}
+
+	for (int r = 0; r < num_free; r++) {
+		for (int s = 0; s <= r; s++) {
+			float sum = _hessian(free_idx[r], free_idx[s]);
+
+			for (int k = 0; k < s; k++) {
+				sum -= l[r][k] * l[s][k];
+			}
+
+			if (r == s) {
+				if (sum <= FLT_EPSILON) {
+					return false;
+				}
+
+				l[r][r] = sqrtf(sum);
+
+			} else {
+				l[r][s] = sum / l[s][s];
+			}
+		}
+	}
+
+	// forward substitution L y = rhs
+	for (int r = 0; r < num_free; r++) {
+		for (int k = 0; k < r; k++) {
+			x[r] -= l[r][k] * x[k];
+		}
+
+		x[r] /= l[r][r];
+	}
+
+	// backward substitution L^T x = y
+	for (int r = num_free - 1; r >= 0; r--) {
+		for (int k = r + 1; k < num_free; k++) {
+			x[r] -= l[k][r] * x[k];
+		}
+
+		x[r] /= l[r][r];
+	}
+
+	for (int r = 0; r < num_free; r++) {
+		u_opt(free_idx[r]) = x[r];
+	}
+
+	return true;
+}
+
+void
+ControlAllocationActiveSet::allocate()
+{
+	const hrt_abstime start = hrt_absolute_time();
+
+	// Linear term of the cost: c = gamma * B^T W v + u_trim
+	ActuatorVector c = _actuator_trim;
+
+	for (int i = 0; i < NUM_ACTUATORS; i++) {
+		float bv = 0.f;
+
+		for (int k = 0; k < NUM_AXES; k++) {
+			bv += AXIS_WEIGHTS[k] * _effectiveness(k, i) * _control_sp(k);
+		}
+
+		c(i) += CONTROL_WEIGHT * bv;
+	}
+
+	// Warm start from the previous solution and working set, projected onto the current bounds
+	ActuatorVector u = _actuator_sp;
+
+	for (int i = 0; i < NUM_ACTUATORS; i++) {
+		if (i >= _num_actuators || _actuator_max(i) <= _actuator_min(i)) {
+			_bound[i] = Bound::FIXED;
+
+			if (i < _num_actuators && _actuator_max(i) >= _actuator_min(i)) {
+				// min == max, the only feasible value
+				u(i) = _actuator_min(i);
+
+			} else {
+				// unused or disabled
+				u(i) = _actuator_trim(i);
+			}
+
+			continue;
+		}
+
+		switch (_bound[i]) {
+		case Bound::LOWER:
+			u(i) = _actuator_min(i);
+			break;
+
+		case Bound::UPPER:
+			u(i) = _actuator_max(i);
+			break;
+
+		case Bound::FREE:
+		case Bound::FIXED: // actuator got enabled
+			_bound[i] = Bound::FREE;
+			u(i) = math::constrain(u(i), _actuator_min(i), _actuator_max(i));
+			break;
+		}
+	}
+
+	const int max_iterations = math::max(_param_ca_as_max_iter.get(), 1);
+	const hrt_abstime max_time = math::max(_param_ca_as_max_time.get(), 0);
+
+	int iterations = 0;
+	bool converged = false;
+
+	// The first iteration is always done, as it is the only one needed when the working set did not change
+	while (iterations < max_iterations && (iterations == 0 || hrt_elapsed_time(&start) < max_time)) {
+		++iterations;
+
+		ActuatorVector u_opt;
+
+		if (!solveFree(u, c, u_opt)) {
+			break;
+		}
+
+		// Move towards the sub-problem optimum, stopping at the first bound in the way
+		float alpha = 1.f;
+		int blocking = -1;
+		Bound blocking_bound = Bound::FREE;
+
+		for (int i = 0; i < NUM_ACTUATORS; i++) {
+			if (_bound[i] != Bound::FREE) {
+				continue;
+			}
+
+			if (u_opt(i) < _actuator_min(i) - BOUND_EPSILON) {
+				const float a = (_actuator_min(i) - u(i)) / (u_opt(i) - u(i));
+
+				if (a < alpha) {
+					alpha = a;
+					blocking = i;
+					blocking_bound = Bound::LOWER;
+				}
+
+			} else if (u_opt(i) > _actuator_max(i) + BOUND_EPSILON) {
+				const float a = (_actuator_max(i) - u(i)) / (u_opt(i) - u(i));
+
+				if (a < alpha) {
+					alpha = a;
+					blocking = i;
+					blocking_bound = Bound::UPPER;
+				}
+			}
+		}
+
+		for (int i = 0; i < NUM_ACTUATORS; i++) {
+			if (_bound[i] == Bound::FREE) {
+				u(i) = math::constrain(u(i) + alpha * (u_opt(i) - u(i)), _actuator_min(i), _actuator_max(i));
+			}
+		}
+
+		if (blocking >= 0) {
+			_bound[blocking] = blocking_bound;
+			u(blocking) = (blocking_bound == Bound::LOWER) ? _actuator_min(blocking) : _actuator_max(blocking);
+			continue;
+		}
+
+		// u is optimal for the current working set: release the bound with the most negative multiplier, if any
+		int release = -1;
+		float release_multiplier = -MULTIPLIER_EPSILON;
+
+		for (int i = 0; i < NUM_ACTUATORS; i++) {
+			if (_bound[i] != Bound::LOWER && _bound[i] != Bound::UPPER) {
+				continue;
+			}
+
+			float gradient = -c(i);
+
+			for (int j = 0; j < NUM_ACTUATORS; j++) {
+				gradient += _hessian(i, j) * u(j);
+			}
+
+			const float multiplier = (_bound[i] == Bound::LOWER) ? gradient : -gradient;
+
+			if (multiplier < release_multiplier) {
+				release_multiplier = multiplier;
+				release = i;
+			}
+		}
+
+		if (release < 0) {
+			converged = true;
+			break;
+		}
+
+		_bound[release] = Bound::FREE;
+	}
+
+	_last_iterations = iterations;
+	_last_limited = !converged;
+
+	_actuator_sp = u;
+
+	// Compute achieved control
+	_control_allocated = _effectiveness * _actuator_sp;
+}
+
+void
+ControlAllocationActiveSet::updateParameters()
+{
+	updateParams();
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ControlAllocationActiveSet.hpp
+ *
+ * Control Allocation Algorithm solving a box-constrained weighted least-squares problem
+ * with a warm-started active-set method.
+ *
+ * The allocation is the solution of
+ *
+ *   min_u  gamma * ||W (B u - v)||^2 + ||u - u_trim||^2
+ *   s.t.   u_min <= u <= u_max
+ *
+ * The iterate stays feasible at every step, so the solver can be stopped after a bounded
+ * number of iterations or a time budget and still return valid actuator setpoints.
+ */
+
+#pragma once
+
+#include "ControlAllocation.hpp"
+
+#include <px4_platform_common/module_params.h>
+
+class ControlAllocationActiveSet: public ControlAllocation, public ModuleParams
+{
+public:
+
+	ControlAllocationActiveSet() : ModuleParams(nullptr) {}
+	virtual ~ControlAllocationActiveSet() = default;
+
+	void allocate() override;
+
+	void setEffectivenessMatrix(const matrix::Matrix<float, NUM_AXES, NUM_ACTUATORS> &effectiveness,
+				    const matrix::Vector<float, NUM_ACTUATORS> &actuator_trim, int num_actuators) override;
+
+	void updateParameters() override;
+
+	/**
+	 * @return number of active-set iterations of the last allocate() call
+	 */
+	int lastIterations() const { return _last_iterations; }
+
+	/**
+	 * @return true if the last allocate() call was stopped by the iteration or time limit
+	 */
+	bool lastLimited() const { return _last_limited; }
+
+	static constexpr float CONTROL_WEIGHT = 1000.f; ///< gamma, weight of the control error against the actuator deviation
+
+	/// Relative priority of the control axes once the actuators saturate: yaw is sacrificed first
+	static constexpr float AXIS_WEIGHTS[NUM_AXES] = {1.f, 1.f, 0.1f, 1.f, 1.f, 1.f};
+
+private:
+
+	enum class Bound : uint8_t {
+		FREE = 0,
+		LOWER,
+		UPPER,
+		FIXED ///< unused or disabled actuator, held at trim
+	};
+
+	/**
+	 * Compute the Hessian of the cost function. Only depends on the effectiveness matrix.
+	 */
+	void updateHessian();
+
+	/**
+	 * Solve the equality-constrained sub-problem for the free actuators,
+	 * holding all the others at their current value.
+	 *
+	 * @param u current (feasible) actuator vector
+	 * @param c linear term of the cost function
+	 * @param u_opt output: u with the free entries replaced by the sub-problem optimum
+	 * @return false if the sub-problem is numerically singular
+	 */
+	bool solveFree(const ActuatorVector &u, const ActuatorVector &c, ActuatorVector &u_opt) const;
+
+	matrix::SquareMatrix<float, NUM_ACTUATORS> _hessian;
+	Bound _bound[NUM_ACTUATORS] {}; ///< working set, kept between calls for warm starting
+
+	int _last_iterations{0};
+	bool _last_limited{false};
+
+	DEFINE_PARAMETERS(
+		(ParamInt<px4::params::CA_AS_MAX_ITER>) _param_ca_as_max_iter,	///< iteration limit per allocation
+		(ParamInt<px4::params::CA_AS_MAX_TIME>) _param_ca_as_max_time	///< time limit per allocation [us]
+	);
+};
@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file ControlAllocationActiveSetTest.cpp
+ *
+ * Tests for the active-set allocator, compared against the
+ * pseudo-inverse based allocators.
+ *
+ * to run: make tests TESTFILTER=ControlAllocationActiveSet
+ */
+
+#include <gtest/gtest.h>
+#include <ControlAllocationActiveSet.hpp>
+#include <ControlAllocationPseudoInverse.hpp>
+#include <ControlAllocationSequentialDesaturation.hpp>
+
+using namespace matrix;
+
+namespace
+{
+
+Matrix<float, 6, 16> quadXEffectiveness()
+{
+	Matrix<float, 6, 16> effectiveness;
+	const float roll[4] = {-0.5f, 0.5f, 0.5f, -0.5f};
+	const float pitch[4] = {0.5f, -0.5f, 0.5f, -0.5f};
+	const float yaw[4] = {0.25f, 0.25f, -0.25f, -0.25f};
+
+	for (int i = 0; i < 4; i++) {
+		effectiveness(0, i) = roll[i];
+		effectiveness(1, i) = pitch[i];
+		effectiveness(2, i) = yaw[i];
+		effectiveness(5, i) = -0.25f;
+	}
+
+	return effectiveness;
+}
+
+Matrix<float, 6, 16> hexXEffectiveness()
+{
+	Matrix<float, 6, 16> effectiveness;
+
+	for (int i = 0; i < 6; i++) {
+		const float angle = M_PI_F / 6.f + i * M_PI_F / 3.f;
+		effectiveness(0, i) = -0.33f * sinf(angle);
+		effectiveness(1, i) = 0.33f * cosf(angle);
+		effectiveness(2, i) = (i % 2 == 0) ? 0.17f : -0.17f;
+		effectiveness(5, i) = -0.17f;
+	}
+
+	return effectiveness;
+}
+
+template<class T>
+void configure(T &method, const Matrix<float, 6, 16> &effectiveness, int num_actuators)
+{
+	Vector<float, 16> actuator_min;
+	Vector<float, 16> actuator_max;
+
+	for (int i = 0; i < num_actuators; i++) {
+		actuator_max(i) = 1.f;
+	}
+
+	method.setActuatorMin(actuator_min);
+	method.setActuatorMax(actuator_max);
+	method.setEffectivenessMatrix(effectiveness, Vector<float, 16>(), num_actuators);
+}
+
+float weightedError(const ControlAllocation &method)
+{
+	const Vector<float, 6> error = method.getControlSetpoint() - method.getAllocatedControl();
+	float sum = 0.f;
+
+	for (int k = 0; k < 6; k++) {
+		sum += ControlAllocationActiveSet::AXIS_WEIGHTS[k] * error(k) * error(k);
+	}
+
+	return sum;
+}
+
+bool withinBounds(const ControlAllocation &method)
+{
+	for (int i = 0; i < method.numConfiguredActuators(); i++) {
+		const float u = method.getActuatorSetpoint()(i);
+
+		if (u < method.getActuatorMin()(i) - 1e-5f || u > method.getActuatorMax()(i) + 1e-5f) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// deterministic pseudo-random control setpoints, half of them saturating
+Vector<float, 6> randomSetpoint(uint32_t &seed)
+{
+	auto rand_uniform = [&seed](float min, float max) {
+		seed = seed * 1664525u + 1013904223u;
+		return min + (max - min) * (seed >> 8) / float(1 << 24);
+	};
+
+	Vector<float, 6> control_sp;
+	control_sp(0) = rand_uniform(-0.6f, 0.6f);
+	control_sp(1) = rand_uniform(-0.6f, 0.6f);
+	control_sp(2) = rand_uniform(-0.3f, 0.3f);
+	control_sp(5) = rand_uniform(-1.f, 0.f);
+	return control_sp;
+}
+
+struct AccuracyResult {
+	float mean_error{0.f};
+	bool within_bounds{true};
+};
+
+template<class T>
+AccuracyResult runRandomSetpoints(T &method, const Matrix<float, 6, 16> &effectiveness, int num_actuators,
+				  int num_solves)
+{
+	configure(method, effectiveness, num_actuators);
+
+	AccuracyResult result;
+	uint32_t seed = 1;
+
+	for (int n = 0; n < num_solves; n++) {
+		method.setControlSetpoint(randomSetpoint(seed));
+		method.allocate();
+
+		result.mean_error += weightedError(method) / num_solves;
+		result.within_bounds = result.within_bounds && withinBounds(method);
+	}
+
+	return result;
+}
+
+} // namespace
+
+class ControlAllocationActiveSetTest : public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		param_control_autosave(false);
+		param_reset_all();
+	}
+};
+
+TEST_F(ControlAllocationActiveSetTest, UnsaturatedMatchesPseudoInverse)
+{
+	ControlAllocationActiveSet active_set;
+	ControlAllocationPseudoInverse pseudo_inverse;
+	configure(active_set, quadXEffectiveness(), 4);
+	configure(pseudo_inverse, quadXEffectiveness(), 4);
+
+	Vector<float, 6> control_sp;
+	control_sp(0) = 0.05f;
+	control_sp(1) = -0.05f;
+	control_sp(2) = 0.02f;
+	control_sp(5) = -0.5f;
+
+	active_set.setControlSetpoint(control_sp);
+	pseudo_inverse.setControlSetpoint(control_sp);
+	active_set.allocate();
+	pseudo_inverse.allocate();
+
+	for (int i = 0; i < 4; i++) {
+		EXPECT_NEAR(active_set.getActuatorSetpoint()(i), pseudo_inverse.getActuatorSetpoint()(i), 1e-2f) << i;
+	}
+
+	EXPECT_FALSE(active_set.lastLimited());
+}
+
+TEST_F(ControlAllocationActiveSetTest, SaturatedWithinBoundsAndBetterThanClipping)
+{
+	ControlAllocationActiveSet active_set;
+	ControlAllocationPseudoInverse pseudo_inverse;
+	configure(active_set, quadXEffectiveness(), 4);
+	configure(pseudo_inverse, quadXEffectiveness(), 4);
+
+	// full roll at high thrust: clipping loses roll authority
+	Vector<float, 6> control_sp;
+	control_sp(0) = 0.6f;
+	control_sp(5) = -0.9f;
+
+	active_set.setControlSetpoint(control_sp);
+	pseudo_inverse.setControlSetpoint(control_sp);
+	active_set.allocate();
+	pseudo_inverse.allocate();
+
+	EXPECT_TRUE(withinBounds(active_set));
+	EXPECT_FALSE(active_set.lastLimited());
+	EXPECT_LT(weightedError(active_set), weightedError(pseudo_inverse));
+
+	// warm start: the same setpoint converges in a single iteration
+	active_set.allocate();
+	EXPECT_EQ(active_set.lastIterations(), 1);
+}
+
+TEST_F(ControlAllocationActiveSetTest, DisabledActuatorHeldAtTrim)
+{
+	ControlAllocationActiveSet active_set;
+	Vector<float, 16> actuator_min;
+	Vector<float, 16> actuator_max;
+	Vector<float, 16> actuator_trim;
+
+	for (int i = 0; i < 4; i++) {
+		actuator_max(i) = 1.f;
+	}
+
+	// actuator 3 disabled (max < min)
+	actuator_min(3) = 1.f;
+	actuator_max(3) = 0.f;
+	actuator_trim(3) = 0.3f;
+
+	// actuator 5 unused, with valid limits
+	actuator_max(5) = 1.f;
+	actuator_trim(5) = 0.2f;
+
+	active_set.setActuatorMin(actuator_min);
+	active_set.setActuatorMax(actuator_max);
+	active_set.setEffectivenessMatrix(quadXEffectiveness(), actuator_trim, 4);
+
+	Vector<float, 6> control_sp;
+	control_sp(0) = 0.2f;
+	control_sp(5) = -0.5f;
+	active_set.setControlSetpoint(control_sp);
+	active_set.allocate();
+
+	EXPECT_FLOAT_EQ(active_set.getActuatorSetpoint()(3), 0.3f);
+	EXPECT_FLOAT_EQ(active_set.getActuatorSetpoint()(5), 0.2f);
+}
+
+TEST_F(ControlAllocationActiveSetTest, RandomSetpoints)
+{
+	static constexpr int num_solves = 1000;
+
+	struct Geometry {
+		const char *name;
+		Matrix<float, 6, 16> effectiveness;
+		int num_actuators;
+	};
+
+	const Geometry geometries[] = {
+		{"quad_x", quadXEffectiveness(), 4},
+		{"hex_x", hexXEffectiveness(), 6},
+	};
+
+	for (const Geometry &geometry : geometries) {
+		ControlAllocationPseudoInverse pseudo_inverse;
+		ControlAllocationSequentialDesaturation sequential_desaturation;
+		ControlAllocationActiveSet active_set;
+
+		// GIVEN: the same random setpoints for all allocators
+		const AccuracyResult pi = runRandomSetpoints(pseudo_inverse, geometry.effectiveness, geometry.num_actuators,
+					  num_solves);
+		const AccuracyResult sd = runRandomSetpoints(sequential_desaturation, geometry.effectiveness,
+					  geometry.num_actuators, num_solves);
+		const AccuracyResult as = runRandomSetpoints(active_set, geometry.effectiveness, geometry.num_actuators,
+					  num_solves);
+
+		// THEN: the active set stays within bounds and allocates at least as accurately
+		EXPECT_TRUE(as.within_bounds) << geometry.name;
+		EXPECT_LE(as.mean_error, pi.mean_error) << geometry.name;
+		EXPECT_LE(as.mean_error, sd.mean_error) << geometry.name;
+	}
+}
@@ -41,22 +41,68 @@
 
 #include "ControlAllocationPseudoInverse.hpp"
 
+#include <string.h>
+
+static bool
+isEqual(const matrix::Matrix<float, ControlAllocation::NUM_AXES, ControlAllocation::NUM_ACTUATORS> &a,
+	const matrix::Matrix<float, ControlAllocation::NUM_AXES, ControlAllocation::NUM_ACTUATORS> &b)
+{
+	static_assert(sizeof(a) == sizeof(float) * ControlAllocation::NUM_AXES * ControlAllocation::NUM_ACTUATORS,
+		      "matrix is expected to only hold its elements");
+
+	// exact bitwise comparison: a cached inverse is only reused for the very same matrix, a NaN never matches a number
+	return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
 void
 ControlAllocationPseudoInverse::setEffectivenessMatrix(
 	const matrix::Matrix<float, ControlAllocation::NUM_AXES, ControlAllocation::NUM_ACTUATORS> &effectiveness,
 	const matrix::Vector<float, ControlAllocation::NUM_ACTUATORS> &actuator_trim, int num_actuators)
 {
+	const bool effectiveness_changed = !isEqual(effectiveness, _effectiveness);
+
 	ControlAllocation::setEffectivenessMatrix(effectiveness, actuator_trim, num_actuators);
-	_mix_update_needed = true;
+
+	if (effectiveness_changed) {
+		_mix_update_needed = true;
+	}
 }
 
 void
 ControlAllocationPseudoInverse::updatePseudoInverse()
 {
-	if (_mix_update_needed) {
-		_mix = matrix::geninv(_effectiveness);
-		_mix_update_needed = false;
+	if (!_mix_update_needed) {
+		return;
 	}
+
+	_mix_update_needed = false;
+	_mix_cache_counter++;
+
+	int lru = 0;
+
+	for (int i = 0; i < MIX_CACHE_SIZE; i++) {
+		CachedMix &entry = _mix_cache[i];
+
+		if (entry.valid && isEqual(entry.effectiveness, _effectiveness)) {
+			_mix = entry.mix;
+			entry.last_used = _mix_cache_counter;
+			return;
+		}
+
+		// prefer empty slots, then the least recently used one
+		if (!entry.valid || (_mix_cache[lru].valid && entry.last_used < _mix_cache[lru].last_used)) {
+			lru = i;
+		}
+	}
+
+	_mix = matrix::geninv(_effectiveness);
+	_geninv_count++;
+
+	CachedMix &entry = _mix_cache[lru];
+	entry.effectiveness = _effectiveness;
+	entry.mix = _mix;
+	entry.last_used = _mix_cache_counter;
+	entry.valid = true;
 }
 
 void
@@ -57,14 +57,36 @@ public:
 	virtual void setEffectivenessMatrix(const matrix::Matrix<float, NUM_AXES, NUM_ACTUATORS> &effectiveness,
 					    const matrix::Vector<float, NUM_ACTUATORS> &actuator_trim, int num_actuators) override;
 
+	/**
+	 * Number of pseudo-inverses kept in the cache.
+	 *
+	 * The effectiveness matrix typically switches between a few fixed configurations
+	 * (e.g. one per VTOL flight phase), so a handful of entries covers all of them.
+	 */
+	static constexpr int MIX_CACHE_SIZE = 4;
+
 protected:
 	matrix::Matrix<float, NUM_ACTUATORS, NUM_AXES> _mix;
 
 	bool _mix_update_needed{false};
+	uint32_t _geninv_count{0};	///< Number of pseudo-inverses computed, cache misses
 
 	/**
 	 * Recalculate pseudo inverse if required.
 	 *
+	 * Previously computed inverses are looked up first, so switching back to a known
+	 * effectiveness matrix does not trigger a new geninv().
 	 */
 	void updatePseudoInverse();
+
+private:
+	struct CachedMix {
+		matrix::Matrix<float, NUM_AXES, NUM_ACTUATORS> effectiveness;
+		matrix::Matrix<float, NUM_ACTUATORS, NUM_AXES> mix;
+		uint32_t last_used{0};
+		bool valid{false};
+	};
+
+	CachedMix _mix_cache[MIX_CACHE_SIZE] {};
+	uint32_t _mix_cache_counter{0};
 };
@@ -42,6 +42,8 @@
 #include <gtest/gtest.h>
 #include <ControlAllocationPseudoInverse.hpp>
 
+#include <cmath>
+
 using namespace matrix;
 
 TEST(ControlAllocationTest, AllZeroCase)
@@ -65,3 +67,110 @@ TEST(ControlAllocationTest, AllZeroCase)
 	EXPECT_EQ(actuator_sp, actuator_sp_expected);
 	EXPECT_EQ(control_allocated, control_allocated_expected);
 }
+
+namespace
+{
+
+/**
+ * Tiltrotor-like effectiveness: 4 tilting motors, 4 tilt servos, 3 control surfaces
+ */
+matrix::Matrix<float, 6, 16> tiltrotorEffectiveness(float tilt)
+{
+	matrix::Matrix<float, 6, 16> effectiveness;
+	const float c = cosf(tilt);
+	const float s = sinf(tilt);
+	const float roll[4] = {-0.5f, 0.5f, 0.5f, -0.5f};
+	const float pitch[4] = {0.5f, -0.5f, 0.5f, -0.5f};
+	const float yaw[4] = {-0.5f, 0.5f, 0.5f, -0.5f};
+
+	for (int i = 0; i < 4; i++) {
+		effectiveness(0, i) = roll[i] * c;
+		effectiveness(1, i) = pitch[i] * c;
+		effectiveness(2, i) = yaw[i] * s;
+		effectiveness(3, i) = 0.25f * s;
+		effectiveness(5, i) = -0.25f * c;
+
+		effectiveness(0, 4 + i) = -0.25f * roll[i] * s;
+		effectiveness(1, 4 + i) = -0.25f * pitch[i] * s;
+		effectiveness(2, 4 + i) = -0.25f * yaw[i] * c;
+	}
+
+	effectiveness(0, 8) = -0.5f;
+	effectiveness(0, 9) = 0.5f;
+	effectiveness(1, 10) = 0.5f;
+
+	return effectiveness;
+}
+
+// tilt per cycle of a hover -> forward flight -> hover sequence, one entry per flight phase
+float transitionTilt(int cycle, int num_cycles)
+{
+	static constexpr float tilts[] = {0.f, 1.f, 1.5f, 1.f, 0.f};
+	static constexpr int num_phases = sizeof(tilts) / sizeof(tilts[0]);
+	return tilts[cycle * num_phases / num_cycles];
+}
+
+} // namespace
+
+TEST(ControlAllocationTest, CachedMixMatchesGeninv)
+{
+	ControlAllocationPseudoInverse method;
+	matrix::Vector<float, 16> actuator_trim;
+	matrix::Vector<float, 6> control_sp;
+	control_sp(0) = 0.1f;
+	control_sp(1) = -0.2f;
+	control_sp(2) = 0.05f;
+	control_sp(5) = -0.6f;
+
+	// more distinct matrices than cache entries to exercise eviction
+	const float tilts[] = {0.f, 0.5f, 1.f, 1.5f, 0.2f, 0.f, 1.f, 0.7f, 1.5f, 0.f};
+
+	for (float tilt : tilts) {
+		const matrix::Matrix<float, 6, 16> effectiveness = tiltrotorEffectiveness(tilt);
+		method.setEffectivenessMatrix(effectiveness, actuator_trim, 11);
+		method.setControlSetpoint(control_sp);
+		method.allocate();
+
+		ControlAllocationPseudoInverse reference;
+		reference.setEffectivenessMatrix(effectiveness, actuator_trim, 11);
+		reference.setControlSetpoint(control_sp);
+		reference.allocate();
+
+		EXPECT_EQ(method.getActuatorSetpoint(), reference.getActuatorSetpoint()) << "tilt " << tilt;
+	}
+}
+
+class CountingPseudoInverse : public ControlAllocationPseudoInverse
+{
+public:
+	uint32_t geninvCount() const { return _geninv_count; }
+};
+
+TEST(ControlAllocationTest, TransitionCacheHits)
+{
+	static constexpr int num_cycles = 500;
+
+	matrix::Vector<float, 16> actuator_trim;
+	matrix::Vector<float, 6> control_sp;
+	control_sp(0) = 0.1f;
+	control_sp(5) = -0.5f;
+
+	// GIVEN: the effectiveness matrix is fed every cycle, as during a transition
+	CountingPseudoInverse method;
+
+	for (int i = 0; i < num_cycles; i++) {
+		const matrix::Matrix<float, 6, 16> effectiveness = tiltrotorEffectiveness(transitionTilt(i, num_cycles));
+		method.setEffectivenessMatrix(effectiveness, actuator_trim, 16);
+		method.setControlSetpoint(control_sp);
+		method.allocate();
+
+		// THEN: the allocation matches a freshly computed pseudo-inverse
+		const matrix::Matrix<float, 16, 6> mix = matrix::geninv(effectiveness);
+		matrix::Vector<float, 16> expected = actuator_trim + mix * control_sp;
+		method.clipActuatorSetpoint(expected);
+		EXPECT_EQ(method.getActuatorSetpoint(), expected) << "cycle " << i;
+	}
+
+	// AND: only the 3 distinct flight phase matrices were inverted, returning to a phase hits the cache
+	EXPECT_EQ(method.geninvCount(), 3u);
+}
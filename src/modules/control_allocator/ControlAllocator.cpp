@@ -132,6 +132,11 @@ ControlAllocator::parameters_updated()
 	actuator_max(14) = _param_ca_act14_max.get();
 	actuator_max(15) = _param_ca_act15_max.get();
 	_control_allocation->setActuatorMax(actuator_max);
+
+	// the matrix depends on the actuator limits, and a new allocation method starts without one
+	if (_actuator_effectiveness != nullptr) {
+		_actuator_effectiveness->forceUpdate();
+	}
 }
 
 void
@@ -160,6 +165,10 @@ ControlAllocator::update_allocation_method()
 			tmp = new ControlAllocationSequentialDesaturation();
 			break;
 
+		case AllocationMethod::ACTIVE_SET:
+			tmp = new ControlAllocationActiveSet();
+			break;
+
 		default:
 			PX4_ERR("Unknown allocation method");
 			break;
@@ -498,6 +507,10 @@ int ControlAllocator::print_status()
 	case AllocationMethod::SEQUENTIAL_DESATURATION:
 		PX4_INFO("Method: Sequential desaturation");
 		break;
+
+	case AllocationMethod::ACTIVE_SET:
+		PX4_INFO("Method: Active set");
+		break;
 	}
 
 	// Print current airframe
@@ -49,6 +49,7 @@
 #include <ControlAllocation.hpp>
 #include <ControlAllocationPseudoInverse.hpp>
 #include <ControlAllocationSequentialDesaturation.hpp>
+#include <ControlAllocationActiveSet.hpp>
 
 #include <lib/matrix/matrix/math.hpp>
 #include <lib/perf/perf_counter.h>
@@ -117,6 +118,7 @@ private:
 		NONE = -1,
 		PSEUDO_INVERSE = 0,
 		SEQUENTIAL_DESATURATION = 1,
+		ACTIVE_SET = 2,
 	};
 
 	AllocationMethod _allocation_method_id{AllocationMethod::NONE};
@@ -59,12 +59,39 @@ PARAM_DEFINE_INT32(CA_AIRFRAME, 0);
  *
  * @value 0 Pseudo-inverse with output clipping (default)
  * @value 1 Pseudo-inverse with sequential desaturation technique
+ * @value 2 Weighted least squares with active-set solver
  * @min 0
- * @max 1
+ * @max 2
  * @group Control Allocation
  */
 PARAM_DEFINE_INT32(CA_METHOD, 0);
 
+/**
+ * Active-set allocation iteration limit
+ *
+ * Maximum number of active-set iterations per allocation (CA_METHOD 2).
+ * The solution is always within the actuator limits, but may be suboptimal
+ * if the limit is reached.
+ *
+ * @min 1
+ * @max 64
+ * @group Control Allocation
+ */
+PARAM_DEFINE_INT32(CA_AS_MAX_ITER, 10);
+
+/**
+ * Active-set allocation time limit
+ *
+ * Maximum time spent in the active-set solver per allocation (CA_METHOD 2).
+ * At least one iteration is always done.
+ *
+ * @unit us
+ * @min 10
+ * @max 1000
+ * @group Control Allocation
+ */
+PARAM_DEFINE_INT32(CA_AS_MAX_TIME, 200);
+
 /**
  * Battery power level scaler
  *
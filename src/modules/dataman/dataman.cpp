@@ -42,6 +42,7 @@
  */
 
 #include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/atomic.h>
 #include <px4_platform_common/defines.h>
 #include <px4_platform_common/module.h>
 #include <px4_platform_common/posix.h>
@@ -51,6 +52,8 @@
 #include <lib/parameters/param.h>
 #include <lib/perf/perf_counter.h>
 
+#include <crc32.h>
+
 #include "dataman.h"
 
 __BEGIN_DECLS
@@ -62,12 +65,27 @@ static constexpr int TASK_STACK_SIZE = 1220;
 /* Private File based Operations */
 static ssize_t _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 			   size_t count);
+static ssize_t _file_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence,
+				 const void *buf, size_t item_size);
 static ssize_t _file_read(dm_item_t item, unsigned index, void *buf, size_t count);
 static int  _file_clear(dm_item_t item);
 static int  _file_restart(dm_reset_reason reason);
 static int _file_initialize(unsigned max_offset);
 static void _file_shutdown();
 
+/* Private journaled File based Operations */
+static ssize_t _journal_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
+			      size_t count);
+static int  _journal_clear(dm_item_t item);
+static int  _journal_restart(dm_reset_reason reason);
+static int _journal_initialize(unsigned max_offset);
+static void _journal_shutdown();
+static int _journal_wait(px4_sem_t *sem);
+
+/* Generic range write, using the single item write of the backend */
+static ssize_t _write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence,
+			    const void *buf, size_t item_size);
+
 /* Private Ram based Operations */
 static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 			  size_t count);
@@ -79,6 +97,8 @@ static void _ram_shutdown();
 
 typedef struct dm_operations_t {
 	ssize_t (*write)(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count);
+	ssize_t (*write_range)(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+			       size_t item_size);
 	ssize_t (*read)(dm_item_t item, unsigned index, void *buf, size_t count);
 	int (*clear)(dm_item_t item);
 	int (*restart)(dm_reset_reason reason);
@@ -89,6 +109,7 @@ typedef struct dm_operations_t {
 
 static constexpr dm_operations_t dm_file_operations = {
 	.write   = _file_write,
+	.write_range = _file_write_range,
 	.read    = _file_read,
 	.clear   = _file_clear,
 	.restart = _file_restart,
@@ -97,8 +118,20 @@ static constexpr dm_operations_t dm_file_operations = {
 	.wait = px4_sem_wait,
 };
 
+static constexpr dm_operations_t dm_journal_operations = {
+	.write   = _journal_write,
+	.write_range = _write_range,
+	.read    = _file_read,
+	.clear   = _journal_clear,
+	.restart = _journal_restart,
+	.initialize = _journal_initialize,
+	.shutdown = _journal_shutdown,
+	.wait = _journal_wait,
+};
+
 static constexpr dm_operations_t dm_ram_operations = {
 	.write   = _ram_write,
+	.write_range = _write_range,
 	.read    = _ram_read,
 	.clear   = _ram_clear,
 	.restart = _ram_restart,
@@ -113,6 +146,9 @@ static struct {
 	union {
 		struct {
 			int fd;
+			int journal_fd;
+			unsigned journal_size;		/* bytes in the journal since the last checkpoint */
+			unsigned journal_pending;	/* journaled writes which are not committed yet */
 		} file;
 		struct {
 			uint8_t *data;
@@ -126,6 +162,8 @@ static struct {
 typedef enum {
 	dm_write_func = 0,
 	dm_read_func,
+	dm_write_range_func,
+	dm_read_range_func,
 	dm_clear_func,
 	dm_restart_func,
 	dm_number_of_funcs
@@ -152,6 +190,21 @@ typedef struct {
 			void *buf;
 			size_t count;
 		} read_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			unsigned count;
+			dm_persitence_t persistence;
+			const void *buf;
+			size_t item_size;
+		} write_range_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			unsigned count;
+			void *buf;
+			size_t item_size;
+		} read_range_params;
 		struct {
 			dm_item_t item;
 		} clear_params;
@@ -204,10 +257,20 @@ static perf_counter_t _dm_write_perf{nullptr};
 /* The data manager store file handle and file name */
 static const char *default_device_path = PX4_STORAGEDIR "/dataman";
 static char *k_data_manager_device_path = nullptr;
+static char *k_data_manager_journal_path = nullptr;
+
+/* Journal usage statistics */
+static unsigned g_journal_commits;
+static unsigned g_journal_checkpoints;
+
+/* Idle commit of the journal */
+static struct hrt_call g_journal_commit_call;
+static px4::atomic_bool g_journal_commit_due{false};
 
 static enum {
 	BACKEND_NONE = 0,
 	BACKEND_FILE,
+	BACKEND_FILE_JOURNAL,
 	BACKEND_RAM,
 	BACKEND_LAST
 } backend = BACKEND_NONE;
@@ -401,6 +464,35 @@ calculate_offset(dm_item_t item, unsigned index)
  * The total size must not exceed g_per_item_max_index[item]
  */
 
+/* The journaled file backend writes every item to the data manager file without syncing it, and
+ * additionally appends it to a journal. Writes are grouped into transactions, which are committed by
+ * appending a commit record and syncing the journal, so a transaction costs a single fsync.
+ * On startup, all committed records are replayed into the data manager file, records after the last
+ * commit are discarded. At a checkpoint the data manager file is synced and the journal is emptied.
+ *
+ * Each journal record is stored as follows
+ *
+ * byte 0..3: Offset of the item in the data manager file
+ * byte 4..5: Length of the item, including the per item header (0 for a commit record)
+ * byte 6..7: Record type
+ * byte 8..11: CRC32 of the record header (with this field set to 0) and the item
+ * byte 12... : item, as it is stored in the data manager file
+ */
+struct dm_journal_record_s {
+	uint32_t offset;
+	uint16_t length;
+	uint16_t type;
+	uint32_t crc;
+};
+
+enum {
+	DM_JOURNAL_RECORD_ITEM = 1,
+	DM_JOURNAL_RECORD_COMMIT = 2
+};
+
+static constexpr unsigned DM_JOURNAL_CHECKPOINT_SIZE = 32 * 1024;	/* checkpoint when the journal exceeds this size */
+static constexpr unsigned DM_JOURNAL_COMMIT_TIMEOUT_MS = 300;	/* commit pending writes after this idle time */
+
 /* write to the data manager RAM buffer  */
 static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 			  size_t count)
@@ -439,9 +531,12 @@ static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persis
 	return count;
 }
 
-/* write to the data manager file */
+static int _journal_append(uint16_t type, uint32_t offset, const uint8_t *data, uint16_t length);
+
+/* write to the data manager file, optionally logging the write in the journal first */
 static ssize_t
-_file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
+_file_write_item(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count,
+		 bool journal)
 {
 	unsigned char buffer[g_per_item_size[item]];
 
@@ -470,6 +565,10 @@ _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const v
 
 	count += DM_SECTOR_HDR_SIZE;
 
+	if (journal && _journal_append(DM_JOURNAL_RECORD_ITEM, offset, buffer, count) != 0) {
+		return -1;
+	}
+
 	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
 		return -1;
 	}
@@ -478,11 +577,74 @@ _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const v
 		return -1;
 	}
 
+	/* All is well... return the number of user data written */
+	return count - DM_SECTOR_HDR_SIZE;
+}
+
+/* write to the data manager file */
+static ssize_t
+_file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
+{
+	ssize_t ret = _file_write_item(item, index, persistence, buf, count, false);
+
+	if (ret >= 0) {
+		/* Make sure data is written to physical media */
+		fsync(dm_operations_data.file.fd);
+	}
+
+	return ret;
+}
+
+/* write a range of items to the data manager file, syncing them once */
+static ssize_t
+_file_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+		  size_t item_size)
+{
+	const uint8_t *buffer = (const uint8_t *)buf;
+	unsigned i = 0;
+
+	for (; i < count; i++) {
+		if (_file_write_item(item, index + i, persistence, buffer + i * item_size, item_size, false) != (ssize_t)item_size) {
+			break;
+		}
+	}
+
 	/* Make sure data is written to physical media */
 	fsync(dm_operations_data.file.fd);
 
-	/* All is well... return the number of user data written */
-	return count - DM_SECTOR_HDR_SIZE;
+	return i;
+}
+
+static ssize_t
+_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+	     size_t item_size)
+{
+	const uint8_t *buffer = (const uint8_t *)buf;
+	unsigned i = 0;
+
+	for (; i < count; i++) {
+		if (g_dm_ops->write(item, index + i, persistence, buffer + i * item_size, item_size) != (ssize_t)item_size) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* Retrieve a range of items, using the single item read of the backend */
+static ssize_t
+_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t item_size)
+{
+	uint8_t *buffer = (uint8_t *)buf;
+	unsigned i = 0;
+
+	for (; i < count; i++) {
+		if (g_dm_ops->read(item, index + i, buffer + i * item_size, item_size) != (ssize_t)item_size) {
+			break;
+		}
+	}
+
+	return i;
 }
 
 /* Retrieve from the data manager RAM buffer*/
@@ -860,6 +1022,292 @@ _ram_shutdown()
 	dm_operations_data.running = false;
 }
 
+static constexpr size_t max_item_size(unsigned item = 0)
+{
+	return item >= DM_KEY_NUM_KEYS ? 0 : (g_per_item_size[item] > max_item_size(item + 1) ?
+					       g_per_item_size[item] : max_item_size(item + 1));
+}
+
+/* append a record to the journal */
+static int
+_journal_append(uint16_t type, uint32_t offset, const uint8_t *data, uint16_t length)
+{
+	dm_journal_record_s record;
+	record.offset = offset;
+	record.length = length;
+	record.type = type;
+	record.crc = 0;
+	record.crc = crc32part(data, length, crc32part((const uint8_t *)&record, sizeof(record), 0));
+
+	if (write(dm_operations_data.file.journal_fd, &record, sizeof(record)) != (ssize_t)sizeof(record)
+	    || (length > 0 && write(dm_operations_data.file.journal_fd, data, length) != length)) {
+		/* drop a partially written record, so that later records can still be replayed */
+		if (ftruncate(dm_operations_data.file.journal_fd, dm_operations_data.file.journal_size) != 0) {
+			PX4_ERR("journal truncate failed");
+		}
+
+		return -1;
+	}
+
+	dm_operations_data.file.journal_size += sizeof(record) + length;
+
+	if (type == DM_JOURNAL_RECORD_ITEM) {
+		dm_operations_data.file.journal_pending++;
+	}
+
+	return 0;
+}
+
+/* make the data manager file durable and empty the journal */
+static int
+_journal_checkpoint()
+{
+	/* all journaled writes are already in the data manager file */
+	fsync(dm_operations_data.file.fd);
+
+	if (ftruncate(dm_operations_data.file.journal_fd, 0) != 0) {
+		return -1;
+	}
+
+	fsync(dm_operations_data.file.journal_fd);
+	dm_operations_data.file.journal_size = 0;
+	g_journal_checkpoints++;
+
+	return 0;
+}
+
+/* commit all pending writes with a single sync of the journal */
+static int
+_journal_commit()
+{
+	if (dm_operations_data.file.journal_pending == 0) {
+		return 0;
+	}
+
+	if (_journal_append(DM_JOURNAL_RECORD_COMMIT, 0, nullptr, 0) != 0) {
+		return -1;
+	}
+
+	fsync(dm_operations_data.file.journal_fd);
+	dm_operations_data.file.journal_pending = 0;
+	g_journal_commits++;
+
+	if (dm_operations_data.file.journal_size > DM_JOURNAL_CHECKPOINT_SIZE) {
+		return _journal_checkpoint();
+	}
+
+	return 0;
+}
+
+/* replay all committed records of the journal into the data manager file, returns the number of replayed items */
+static int
+_journal_replay(int fd, int journal_fd, unsigned max_offset)
+{
+	dm_journal_record_s record;
+	uint8_t data[max_item_size()];
+
+	/* first pass: find the end of the last valid commit record */
+	off_t position = 0;
+	off_t committed_end = 0;
+
+	while (read(journal_fd, &record, sizeof(record)) == (ssize_t)sizeof(record)) {
+		if (record.length > sizeof(data) || read(journal_fd, data, record.length) != record.length) {
+			break;
+		}
+
+		const uint32_t crc = record.crc;
+		record.crc = 0;
+
+		if (crc32part(data, record.length, crc32part((const uint8_t *)&record, sizeof(record), 0)) != crc) {
+			break;
+		}
+
+		position += sizeof(record) + record.length;
+
+		if (record.type == DM_JOURNAL_RECORD_COMMIT) {
+			committed_end = position;
+
+		} else if (record.type != DM_JOURNAL_RECORD_ITEM || record.offset + record.length > max_offset) {
+			break;
+		}
+	}
+
+	/* second pass: write the committed items */
+	int replayed = 0;
+	position = 0;
+
+	if (lseek(journal_fd, 0, SEEK_SET) != 0) {
+		return -1;
+	}
+
+	while (position < committed_end) {
+		if (read(journal_fd, &record, sizeof(record)) != (ssize_t)sizeof(record)
+		    || read(journal_fd, data, record.length) != record.length) {
+			return -1;
+		}
+
+		position += sizeof(record) + record.length;
+
+		if (record.type == DM_JOURNAL_RECORD_ITEM) {
+			if (lseek(fd, record.offset, SEEK_SET) != (off_t)record.offset
+			    || write(fd, data, record.length) != record.length) {
+				return -1;
+			}
+
+			replayed++;
+		}
+	}
+
+	fsync(fd);
+	return replayed;
+}
+
+static ssize_t
+_journal_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
+{
+	/* The mission state and the stats entry of safe and fence points reference the items written before them,
+	 * so these are committed first, and the referencing item is committed immediately */
+	const bool commit_point = item == DM_KEY_MISSION_STATE || item == DM_KEY_COMPAT
+				  || ((item == DM_KEY_SAFE_POINTS || item == DM_KEY_FENCE_POINTS) && index == 0);
+
+	if (commit_point && _journal_commit() != 0) {
+		return -1;
+	}
+
+	ssize_t ret = _file_write_item(item, index, persistence, buf, count, true);
+
+	if (ret >= 0 && commit_point && _journal_commit() != 0) {
+		return -1;
+	}
+
+	return ret;
+}
+
+static int
+_journal_clear(dm_item_t item)
+{
+	/* the cleared items must not be restored by a later replay */
+	if (_journal_commit() != 0 || _journal_checkpoint() != 0) {
+		return -1;
+	}
+
+	return _file_clear(item);
+}
+
+static int
+_journal_restart(dm_reset_reason reason)
+{
+	/* the invalidated items must not be restored by a later replay */
+	if (_journal_commit() != 0 || _journal_checkpoint() != 0) {
+		return -1;
+	}
+
+	return _file_restart(reason);
+}
+
+/* wakes the worker thread once no request arrived for DM_JOURNAL_COMMIT_TIMEOUT_MS */
+static void
+_journal_commit_timeout(void *arg)
+{
+	g_journal_commit_due.store(true);
+	px4_sem_post((px4_sem_t *)arg);
+}
+
+static int
+_journal_wait(px4_sem_t *sem)
+{
+	/* commit pending writes once no new request arrives for a while, e.g. at the end of a mission upload.
+	 * The worker is woken by a timer instead of a timed wait, an empty wakeup just finds no work queued. */
+	if (dm_operations_data.file.journal_pending > 0) {
+		hrt_call_after(&g_journal_commit_call, DM_JOURNAL_COMMIT_TIMEOUT_MS * 1000, &_journal_commit_timeout, sem);
+	}
+
+	int ret = px4_sem_wait(sem);
+
+	hrt_cancel(&g_journal_commit_call);
+
+	if (g_journal_commit_due.load()) {
+		g_journal_commit_due.store(false);
+		_journal_commit();
+	}
+
+	return ret;
+}
+
+static int
+_journal_initialize(unsigned max_offset)
+{
+	const size_t path_len = strlen(k_data_manager_device_path) + sizeof(".journal");
+	k_data_manager_journal_path = (char *)malloc(path_len);
+
+	if (k_data_manager_journal_path == nullptr) {
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	snprintf(k_data_manager_journal_path, path_len, "%s.journal", k_data_manager_device_path);
+
+	/* Replay the writes committed before the last shutdown or crash */
+	int journal_fd = open(k_data_manager_journal_path, O_RDONLY | O_BINARY);
+
+	if (journal_fd >= 0) {
+		int fd = open(k_data_manager_device_path, O_RDWR | O_BINARY);
+
+		if (fd >= 0) {
+			int replayed = _journal_replay(fd, journal_fd, max_offset);
+
+			if (replayed < 0) {
+				PX4_ERR("journal replay failed");
+
+			} else if (replayed > 0) {
+				PX4_INFO("replayed %i items from journal", replayed);
+			}
+
+			close(fd);
+		}
+
+		close(journal_fd);
+	}
+
+	/* Start with an empty journal */
+	dm_operations_data.file.journal_fd = open(k_data_manager_journal_path, O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_BINARY,
+					     PX4_O_MODE_666);
+
+	if (dm_operations_data.file.journal_fd < 0) {
+		PX4_WARN("Could not open data manager journal %s", k_data_manager_journal_path);
+		free(k_data_manager_journal_path);
+		k_data_manager_journal_path = nullptr;
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	dm_operations_data.file.journal_size = 0;
+	dm_operations_data.file.journal_pending = 0;
+
+	int ret = _file_initialize(max_offset);
+
+	if (ret != 0) {
+		close(dm_operations_data.file.journal_fd);
+		free(k_data_manager_journal_path);
+		k_data_manager_journal_path = nullptr;
+	}
+
+	return ret;
+}
+
+static void
+_journal_shutdown()
+{
+	if (_journal_commit() != 0 || _journal_checkpoint() != 0) {
+		PX4_ERR("journal checkpoint failed");
+	}
+
+	close(dm_operations_data.file.journal_fd);
+	free(k_data_manager_journal_path);
+	k_data_manager_journal_path = nullptr;
+	_file_shutdown();
+}
+
 /** Write to the data manager file */
 __EXPORT ssize_t
 dm_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
@@ -923,6 +1371,87 @@ dm_read(dm_item_t item, unsigned index, void *buf, size_t count)
 	return ret;
 }
 
+/* Check that a range of items is valid */
+static bool
+valid_range(dm_item_t item, unsigned index, unsigned count)
+{
+	return item < DM_KEY_NUM_KEYS && index < g_per_item_max_index[item] && count <= g_per_item_max_index[item] - index;
+}
+
+/** Write a range of items to the data manager file */
+__EXPORT ssize_t
+dm_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+	       size_t item_size)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	if (!valid_range(item, index, count)) {
+		return -1;
+	}
+
+	perf_begin(_dm_write_perf);
+
+	/* get a work item and queue up a write request */
+	if ((work = create_work_item()) == nullptr) {
+		perf_end(_dm_write_perf);
+		return -1;
+	}
+
+	work->func = dm_write_range_func;
+	work->write_range_params.item = item;
+	work->write_range_params.index = index;
+	work->write_range_params.count = count;
+	work->write_range_params.persistence = persistence;
+	work->write_range_params.buf = buf;
+	work->write_range_params.item_size = item_size;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	ssize_t ret = (ssize_t)enqueue_work_item_and_wait_for_result(work);
+	perf_end(_dm_write_perf);
+	return ret;
+}
+
+/** Retrieve a range of items from the data manager file */
+__EXPORT ssize_t
+dm_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t item_size)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	if (!valid_range(item, index, count)) {
+		return -1;
+	}
+
+	perf_begin(_dm_read_perf);
+
+	/* get a work item and queue up a read request */
+	if ((work = create_work_item()) == nullptr) {
+		perf_end(_dm_read_perf);
+		return -1;
+	}
+
+	work->func = dm_read_range_func;
+	work->read_range_params.item = item;
+	work->read_range_params.index = index;
+	work->read_range_params.count = count;
+	work->read_range_params.buf = buf;
+	work->read_range_params.item_size = item_size;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	ssize_t ret = (ssize_t)enqueue_work_item_and_wait_for_result(work);
+	perf_end(_dm_read_perf);
+	return ret;
+}
+
 /** Clear a data Item */
 __EXPORT int
 dm_clear(dm_item_t item)
@@ -1040,6 +1569,10 @@ task_main(int argc, char *argv[])
 		g_dm_ops = &dm_file_operations;
 		break;
 
+	case BACKEND_FILE_JOURNAL:
+		g_dm_ops = &dm_journal_operations;
+		break;
+
 	case BACKEND_RAM:
 		g_dm_ops = &dm_ram_operations;
 		break;
@@ -1065,6 +1598,9 @@ task_main(int argc, char *argv[])
 		g_func_counts[i] = 0;
 	}
 
+	g_journal_commits = 0;
+	g_journal_checkpoints = 0;
+
 	/* Initialize the item type locks, for now only DM_KEY_MISSION_STATE & DM_KEY_FENCE_POINTS supports locking */
 	px4_sem_init(&g_sys_state_mutex_mission, 1, 1); /* Initially unlocked */
 	px4_sem_init(&g_sys_state_mutex_fence, 1, 1); /* Initially unlocked */
@@ -1115,6 +1651,7 @@ task_main(int argc, char *argv[])
 
 	switch (backend) {
 	case BACKEND_FILE:
+	case BACKEND_FILE_JOURNAL:
 		if (sys_restart_val != DM_INIT_REASON_POWER_ON) {
 			PX4_INFO("%s, data manager file '%s' size is %d bytes",
 				 restart_type_str, k_data_manager_device_path, max_offset);
@@ -1162,6 +1699,21 @@ task_main(int argc, char *argv[])
 					g_dm_ops->read(work->read_params.item, work->read_params.index, work->read_params.buf, work->read_params.count);
 				break;
 
+			case dm_write_range_func:
+				g_func_counts[dm_write_range_func]++;
+				work->result =
+					g_dm_ops->write_range(work->write_range_params.item, work->write_range_params.index,
+							      work->write_range_params.count, work->write_range_params.persistence,
+							      work->write_range_params.buf, work->write_range_params.item_size);
+				break;
+
+			case dm_read_range_func:
+				g_func_counts[dm_read_range_func]++;
+				work->result =
+					_read_range(work->read_range_params.item, work->read_range_params.index, work->read_range_params.count,
+						    work->read_range_params.buf, work->read_range_params.item_size);
+				break;
+
 			case dm_clear_func:
 				g_func_counts[dm_clear_func]++;
 				work->result = g_dm_ops->clear(work->clear_params.item);
@@ -1249,9 +1801,17 @@ status()
 	/* display usage statistics */
 	PX4_INFO("Writes   %d", g_func_counts[dm_write_func]);
 	PX4_INFO("Reads    %d", g_func_counts[dm_read_func]);
+	PX4_INFO("Range writes %d", g_func_counts[dm_write_range_func]);
+	PX4_INFO("Range reads  %d", g_func_counts[dm_read_range_func]);
 	PX4_INFO("Clears   %d", g_func_counts[dm_clear_func]);
 	PX4_INFO("Restarts %d", g_func_counts[dm_restart_func]);
 	PX4_INFO("Max Q lengths work %d, free %d", g_work_q.max_size, g_free_q.max_size);
+
+	if (backend == BACKEND_FILE_JOURNAL) {
+		PX4_INFO("Journal commits %d, checkpoints %d, size %d bytes", g_journal_commits, g_journal_checkpoints,
+			 dm_operations_data.file.journal_size);
+	}
+
 	perf_print_counter(_dm_read_perf);
 	perf_print_counter(_dm_write_perf);
 }
@@ -1273,6 +1833,7 @@ usage()
 Module to provide persistent storage for the rest of the system in form of a simple database through a C API.
 Multiple backends are supported:
 - a file (eg. on the SD card)
+- a journaled file: writes are synced once per transaction (eg. a mission upload) instead of once per item
 - RAM (this is obviously not persistent)
 
 It is used to store structured data of different types: mission waypoints, mission state and geofence polygons.
@@ -1292,6 +1853,7 @@ check for geofence violations.
 	PRINT_MODULE_USAGE_NAME("dataman", "system");
 	PRINT_MODULE_USAGE_COMMAND("start");
 	PRINT_MODULE_USAGE_PARAM_STRING('f', nullptr, "<file>", "Storage file", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('j', "Use journaled file backend (writes are synced per transaction)", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Use RAM backend (NOT persistent)", true);
 	PRINT_MODULE_USAGE_PARAM_COMMENT("The options -f and -r are mutually exclusive. If nothing is specified, a file 'dataman' is used");
 
@@ -1329,10 +1891,11 @@ dataman_main(int argc, char *argv[])
 		int ch;
 		int dmoptind = 1;
 		const char *dmoptarg = nullptr;
+		bool journal = false;
 
 		/* jump over start and look at options first */
 
-		while ((ch = px4_getopt(argc, argv, "f:r", &dmoptind, &dmoptarg)) != EOF) {
+		while ((ch = px4_getopt(argc, argv, "f:jr", &dmoptind, &dmoptarg)) != EOF) {
 			switch (ch) {
 			case 'f':
 				if (backend_check()) {
@@ -1344,6 +1907,10 @@ dataman_main(int argc, char *argv[])
 				PX4_INFO("dataman file set to: %s", k_data_manager_device_path);
 				break;
 
+			case 'j':
+				journal = true;
+				break;
+
 			case 'r':
 				if (backend_check()) {
 					return -1;
@@ -1364,6 +1931,16 @@ dataman_main(int argc, char *argv[])
 			k_data_manager_device_path = strdup(default_device_path);
 		}
 
+		if (journal) {
+			if (backend != BACKEND_FILE) {
+				PX4_WARN("-j requires a file backend");
+				usage();
+				return -1;
+			}
+
+			backend = BACKEND_FILE_JOURNAL;
+		}
+
 		start();
 
 		if (!is_running()) {
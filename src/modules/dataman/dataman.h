@@ -125,6 +125,36 @@ dm_write(
 	size_t buflen			/* Length in bytes of data to retrieve */
 );
 
+/**
+ * Retrieve count consecutive items starting at index in a single request.
+ * The items are stored in the buffer with a stride of item_size bytes.
+ * @return number of items read, reading stops at the first item which cannot be read or whose stored length
+ *         differs from item_size. -1 on error (invalid item or range)
+ */
+__EXPORT ssize_t
+dm_read_range(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of items to retrieve */
+	void *buffer,			/* Pointer to caller data buffer, at least count * item_size bytes */
+	size_t item_size		/* Length in bytes of each item */
+);
+
+/**
+ * Write count consecutive items starting at index in a single request.
+ * The items are taken from the buffer with a stride of item_size bytes.
+ * @return number of items written, writing stops at the first failure. -1 on error (invalid item or range)
+ */
+__EXPORT ssize_t
+dm_write_range(
+	dm_item_t item,			/* The item type to store */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of items to store */
+	dm_persitence_t persistence,	/* The persistence level of these items */
+	const void *buffer,		/* Pointer to caller data buffer, at least count * item_size bytes */
+	size_t item_size		/* Length in bytes of each item */
+);
+
 /**
  * Lock all items of a type. Can be used for atomic updates of multiple items (single items are always updated
  * atomically).
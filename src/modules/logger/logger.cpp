@@ -50,6 +50,8 @@
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/vehicle_command_ack.h>
 #include <uORB/topics/battery_status.h>
+#include <uORB/topics/sensor_accel_fifo.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
 
 #include <drivers/drv_hrt.h>
 #include <mathlib/math/Limits.hpp>
@@ -535,6 +537,20 @@ bool Logger::initialize_topics()
 	}
 
 	_num_subscriptions = logged_topics.subscriptions().count;
+
+	// full rate FIFO topics are captured losslessly from the driver while logging
+	_num_raw_imu_fifo = 0;
+
+	for (int i = 0; i < _num_subscriptions; ++i) {
+		const orb_metadata *meta = _subscriptions[i].get_topic();
+
+		if (((meta == ORB_ID(sensor_gyro_fifo)) || (meta == ORB_ID(sensor_accel_fifo)))
+		    && (_subscriptions[i].get_interval_us() == 0) && (_num_raw_imu_fifo < MAX_RAW_IMU_FIFO)) {
+
+			_raw_imu_fifo[_num_raw_imu_fifo++].sub_idx = i;
+		}
+	}
+
 	return true;
 }
 
@@ -681,6 +697,8 @@ void Logger::run()
 
 		const hrt_abstime loop_time = hrt_absolute_time();
 
+		update_raw_imu_capture(_writer.is_started(LogType::Full));
+
 		if (_writer.is_started(LogType::Full)) { // mission log only runs when full log is also started
 
 			/* check if we need to output the process load */
@@ -711,6 +729,11 @@ void Logger::run()
 
 			for (int sub_idx = 0; sub_idx < _num_subscriptions; ++sub_idx) {
 				LoggerSubscription &sub = _subscriptions[sub_idx];
+
+				if (sub.raw_imu_capture) {
+					continue;
+				}
+
 				/* if this topic has been updated, copy the new data into the message buffer
 				 * and write a message to the log
 				 */
@@ -756,6 +779,17 @@ void Logger::run()
 				}
 			}
 
+			for (int i = 0; i < _num_raw_imu_fifo; ++i) {
+				LoggerSubscription &sub = _subscriptions[_raw_imu_fifo[i].sub_idx];
+
+				if (_raw_imu_fifo[i].gyro_queue) {
+					write_raw_imu_fifo(sub, *_raw_imu_fifo[i].gyro_queue);
+
+				} else if (_raw_imu_fifo[i].accel_queue) {
+					write_raw_imu_fifo(sub, *_raw_imu_fifo[i].accel_queue);
+				}
+			}
+
 			// check for new logging message(s)
 			log_message_s log_message;
 
@@ -880,6 +914,7 @@ void Logger::run()
 	}
 
 	px4_lockstep_unregister_component(_lockstep_component);
+	update_raw_imu_capture(false);
 
 	stop_log_file(LogType::Full);
 	stop_log_file(LogType::Mission);
@@ -1035,6 +1070,78 @@ bool Logger::start_stop_logging()
 	return false;
 }
 
+void Logger::update_raw_imu_capture(bool logging)
+{
+	if (logging == _raw_imu_capture_started) {
+		return;
+	}
+
+	if (logging) {
+		for (int i = 0; i < _num_raw_imu_fifo; ++i) {
+			RawImuFifo &fifo = _raw_imu_fifo[i];
+			LoggerSubscription &sub = _subscriptions[fifo.sub_idx];
+
+			if (sub.get_topic() == ORB_ID(sensor_gyro_fifo)) {
+				fifo.gyro_queue = raw_imu_capture::start_gyro(sub.get_instance());
+
+			} else {
+				fifo.accel_queue = raw_imu_capture::start_accel(sub.get_instance());
+			}
+
+			sub.raw_imu_capture = (fifo.gyro_queue != nullptr) || (fifo.accel_queue != nullptr);
+
+			if (!sub.raw_imu_capture) {
+				PX4_ERR("raw IMU capture failed for %s", sub.get_topic()->o_name);
+			}
+		}
+
+	} else {
+		raw_imu_capture::stop();
+
+		for (int i = 0; i < _num_raw_imu_fifo; ++i) {
+			_subscriptions[_raw_imu_fifo[i].sub_idx].raw_imu_capture = false;
+			_raw_imu_fifo[i].gyro_queue = nullptr;
+			_raw_imu_fifo[i].accel_queue = nullptr;
+		}
+	}
+
+	_raw_imu_capture_started = logging;
+}
+
+template<typename Q>
+void Logger::write_raw_imu_fifo(LoggerSubscription &sub, Q &queue)
+{
+	if (!sub.valid()) {
+		if (queue.size() == 0) {
+			return;
+		}
+
+		// the driver is publishing, subscribe right away to get the message id
+		if (!sub.subscribe()) {
+			queue.flush();
+			return;
+		}
+
+		write_add_logged_msg(LogType::Full, sub);
+	}
+
+	const size_t msg_size = sizeof(ulog_message_data_header_s) + sub.get_topic()->o_size_no_padding;
+	const uint16_t write_msg_size = static_cast<uint16_t>(msg_size - ULOG_MSG_HEADER_LEN);
+	const uint16_t write_msg_id = sub.msg_id;
+
+	_msg_buffer[0] = (uint8_t)write_msg_size;
+	_msg_buffer[1] = (uint8_t)(write_msg_size >> 8);
+	_msg_buffer[2] = static_cast<uint8_t>(ULogMessageType::DATA);
+	_msg_buffer[3] = (uint8_t)write_msg_id;
+	_msg_buffer[4] = (uint8_t)(write_msg_id >> 8);
+
+	// messages dropped because the queue was full never reached the log buffer
+	_message_gaps += raw_imu_capture::drain(queue, [&](const typename Q::value_type & sample) {
+		memcpy(_msg_buffer + sizeof(ulog_message_data_header_s), &sample, sub.get_topic()->o_size_no_padding);
+		write_message(LogType::Full, _msg_buffer, msg_size);
+	});
+}
+
 void Logger::handle_vehicle_command_update()
 {
 	vehicle_command_s command;
@@ -44,6 +44,7 @@
 #include <px4_platform_common/printload.h>
 #include <px4_platform_common/module.h>
 #include <px4_platform_common/module_params.h>
+#include <lib/drivers/raw_imu_capture/RawImuCapture.hpp>
 
 #include <uORB/PublicationMulti.hpp>
 #include <uORB/Subscription.hpp>
@@ -77,6 +78,13 @@ struct LoggerSubscription : public uORB::SubscriptionInterval {
 	{}
 
 	uint8_t msg_id{MSG_ID_INVALID};
+	bool raw_imu_capture{false}; ///< data is written from the raw IMU capture queue instead of the uORB subscription
+};
+
+struct RawImuFifo {
+	int sub_idx{-1};
+	raw_imu_capture::GyroQueue *gyro_queue{nullptr};
+	raw_imu_capture::AccelQueue *accel_queue{nullptr};
 };
 
 class Logger : public ModuleBase<Logger>, public ModuleParams
@@ -312,6 +320,18 @@ private:
 
 	void publish_logger_status();
 
+	/**
+	 * Start or stop the lossless capture of the logged raw IMU FIFO topics, depending on the logging state.
+	 * Without a capture queue the FIFO topics are logged from the uORB subscription.
+	 */
+	void update_raw_imu_capture(bool logging);
+
+	/**
+	 * Write all queued raw IMU FIFO messages. The caller must call _writer.lock() before calling this.
+	 */
+	template<typename Q>
+	void write_raw_imu_fifo(LoggerSubscription &sub, Q &queue);
+
 	uint8_t						*_msg_buffer{nullptr};
 	int						_msg_buffer_len{0};
 
@@ -331,6 +351,11 @@ private:
 	MissionSubscription 				_mission_subscriptions[MAX_MISSION_TOPICS_NUM] {}; ///< additional data for mission subscriptions
 	int						_num_mission_subs{0};
 
+	static constexpr int				MAX_RAW_IMU_FIFO{2 * raw_imu_capture::MAX_INSTANCES};
+	RawImuFifo					_raw_imu_fifo[MAX_RAW_IMU_FIFO] {}; ///< logged gyro & accel FIFO topics
+	int						_num_raw_imu_fifo{0};
+	bool						_raw_imu_capture_started{false};
+
 	LogWriter					_writer;
 	uint32_t					_log_interval{0};
 	const orb_metadata				*_polling_topic_meta{nullptr}; ///< if non-null, poll on this topic instead of sleeping
@@ -0,0 +1,394 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file muorb_shm_main.cpp
+ *
+ * Shared memory uORB bridge for processes on the same (Linux) host.
+ */
+
+#include "uORBShmChannel.hpp"
+
+#include <px4_platform_common/getopt.h>
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/module.h>
+#include <px4_platform_common/posix.h>
+#include <drivers/drv_hrt.h>
+#include <lib/mathlib/mathlib.h>
+#include <uORB/Publication.hpp>
+#include <uORB/uORBManager.hpp>
+#include <uORB/topics/orb_test.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" __EXPORT int muorb_shm_main(int argc, char *argv[]);
+
+static void usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+uORB bridge over a POSIX shared memory segment (/dev/shm/px4_uorb_shm).
+
+Exported topics are copied into the segment on every publication without serialization.
+Other processes of the same user can map the segment read-only and read them in place, using
+the lock-free protocol described in uORBShmLayout.hpp. Imported topics are written by an
+external process and published into uORB.
+
+Requires a build with ORB_COMMUNICATOR.
+
+### Examples
+$ muorb_shm start -e vehicle_attitude,sensor_combined -i vehicle_visual_odometry
+$ muorb_shm bench -n 100000
+
+`bench -u` runs the same publish loop over a UDP loopback socket instead, the transport
+micrortps_client uses between processes on a host, as a baseline for the segment.
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("muorb_shm", "communication");
+	PRINT_MODULE_USAGE_COMMAND("start");
+	PRINT_MODULE_USAGE_PARAM_STRING('e', nullptr, "<topic1,topic2,...>", "Topics to export", false);
+	PRINT_MODULE_USAGE_PARAM_STRING('i', nullptr, "<topic1,topic2,...>", "Topics to import", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("bench", "Measure latency through the segment (needs orb_test exported)");
+	PRINT_MODULE_USAGE_PARAM_INT('n', 10000, 1, 10000000, "Number of messages", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('u', "Measure a UDP loopback socket instead (baseline)", true);
+	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
+}
+
+struct BenchReader {
+	const void *segment{nullptr};
+	const uORB::shm::Topic *topic{nullptr};
+	int socket_fd{-1};
+	px4::atomic_bool should_exit{false};
+
+	uint64_t received{0};
+	uint64_t missed{0};
+	uint64_t latency_sum{0};
+	uint64_t latency_max{0};
+	int32_t last_val{-1};
+};
+
+static void *bench_reader(void *context)
+{
+	BenchReader &reader = *static_cast<BenchReader *>(context);
+	uint64_t last_generation = reader.topic->generation.load();
+
+	while (!reader.should_exit.load()) {
+		if (reader.topic->generation.load(std::memory_order_acquire) == last_generation) {
+			continue; // spin, like a latency critical consumer would
+		}
+
+		// read in place, only the sequence number is taken out of the slot
+		uint64_t timestamp = 0;
+		int32_t val = 0;
+		const uint64_t generation = uORB::shm::read_in_place(reader.segment, *reader.topic, [&](const uint8_t *data) {
+			memcpy(&val, data + offsetof(orb_test_s, val), sizeof(val));
+		}, &timestamp);
+
+		if (generation > last_generation) {
+			const hrt_abstime latency = hrt_absolute_time() - timestamp;
+			reader.missed += generation - last_generation - 1;
+			reader.received++;
+			reader.latency_sum += latency;
+			reader.latency_max = math::max(reader.latency_max, latency);
+			last_generation = generation;
+			reader.last_val = val;
+		}
+	}
+
+	return nullptr;
+}
+
+static void *bench_udp_reader(void *context)
+{
+	BenchReader &reader = *static_cast<BenchReader *>(context);
+
+	while (!reader.should_exit.load()) {
+		orb_test_s msg;
+
+		// blocks until a message arrives or the receive timeout expires
+		if (recv(reader.socket_fd, &msg, sizeof(msg), 0) != sizeof(msg)) {
+			continue;
+		}
+
+		const hrt_abstime latency = hrt_absolute_time() - msg.timestamp;
+		reader.missed += msg.val - reader.last_val - 1;
+		reader.received++;
+		reader.latency_sum += latency;
+		reader.latency_max = math::max(reader.latency_max, latency);
+		reader.last_val = msg.val;
+	}
+
+	return nullptr;
+}
+
+static void bench_print(const BenchReader &reader, uint32_t count, hrt_abstime elapsed)
+{
+	PX4_INFO("published %" PRIu32 " in %.3f s", count, (double)(elapsed * 1e-6f));
+	PX4_INFO("received %" PRIu64 " (last val %" PRIi32 "), missed %" PRIu64, reader.received, reader.last_val,
+		 reader.missed);
+
+	if (reader.received > 0) {
+		PX4_INFO("latency avg %.2f us, max %" PRIu64 " us", (double)reader.latency_sum / reader.received,
+			 reader.latency_max);
+	}
+}
+
+static int bench_udp(uint32_t count)
+{
+	// the receiving side binds an ephemeral loopback port, the sending side connects to it
+	BenchReader reader{};
+	reader.socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+	const int send_fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	sockaddr_in addr{};
+	socklen_t addr_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+
+	const timeval timeout{0, 100000};
+
+	if (reader.socket_fd < 0 || send_fd < 0
+	    || bind(reader.socket_fd, (sockaddr *)&addr, sizeof(addr)) != 0
+	    || getsockname(reader.socket_fd, (sockaddr *)&addr, &addr_len) != 0
+	    || setsockopt(reader.socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0
+	    || connect(send_fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+		PX4_ERR("UDP loopback setup failed (%i)", errno);
+
+		if (reader.socket_fd >= 0) {
+			close(reader.socket_fd);
+		}
+
+		if (send_fd >= 0) {
+			close(send_fd);
+		}
+
+		return PX4_ERROR;
+	}
+
+	pthread_t reader_thread;
+	pthread_create(&reader_thread, nullptr, &bench_udp_reader, &reader);
+
+	uORB::Publication<orb_test_s> orb_test_pub{ORB_ID(orb_test)};
+	orb_test_s msg{};
+
+	const hrt_abstime time_start = hrt_absolute_time();
+
+	for (uint32_t i = 0; i < count; i++) {
+		msg.timestamp = hrt_absolute_time();
+		msg.val = i;
+		orb_test_pub.publish(msg);
+
+		// the message is sent as is, without the CDR serialization of the RTPS bridge
+		send(send_fd, &msg, sizeof(msg), 0);
+
+		px4_usleep(10);
+	}
+
+	const hrt_abstime elapsed = hrt_elapsed_time(&time_start);
+
+	px4_usleep(10000);
+	reader.should_exit.store(true);
+	pthread_join(reader_thread, nullptr);
+	close(send_fd);
+	close(reader.socket_fd);
+
+	bench_print(reader, count, elapsed);
+
+	return PX4_OK;
+}
+
+static int bench(uint32_t count)
+{
+	// map the segment read-only, exactly like an external process
+	int fd = shm_open(uORB::shm::SEGMENT_NAME, O_RDONLY, 0);
+
+	if (fd < 0) {
+		PX4_ERR("segment not found, start muorb_shm first");
+		return PX4_ERROR;
+	}
+
+	struct stat st {};
+	fstat(fd, &st);
+	const void *segment = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (segment == MAP_FAILED) {
+		PX4_ERR("mmap failed (%i)", errno);
+		return PX4_ERROR;
+	}
+
+	const uORB::shm::Header *header = static_cast<const uORB::shm::Header *>(segment);
+	BenchReader reader{};
+	reader.segment = segment;
+
+	for (uint32_t i = 0; (header->magic == uORB::shm::MAGIC) && (i < header->num_topics); i++) {
+		if (strcmp(uORB::shm::topics(segment)[i].name, "orb_test") == 0) {
+			reader.topic = &uORB::shm::topics(segment)[i];
+		}
+	}
+
+	if (reader.topic == nullptr) {
+		PX4_ERR("orb_test is not exported (muorb_shm start -e orb_test)");
+		munmap((void *)segment, st.st_size);
+		return PX4_ERROR;
+	}
+
+	pthread_t reader_thread;
+	pthread_create(&reader_thread, nullptr, &bench_reader, &reader);
+
+	uORB::Publication<orb_test_s> orb_test_pub{ORB_ID(orb_test)};
+	orb_test_s msg{};
+
+	const hrt_abstime time_start = hrt_absolute_time();
+
+	for (uint32_t i = 0; i < count; i++) {
+		msg.timestamp = hrt_absolute_time();
+		msg.val = i;
+		orb_test_pub.publish(msg);
+
+		// ~100 kHz, give the reader a chance to see every message
+		px4_usleep(10);
+	}
+
+	const hrt_abstime elapsed = hrt_elapsed_time(&time_start);
+
+	px4_usleep(10000);
+	reader.should_exit.store(true);
+	pthread_join(reader_thread, nullptr);
+	munmap((void *)segment, st.st_size);
+
+	bench_print(reader, count, elapsed);
+
+	return PX4_OK;
+}
+
+int muorb_shm_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		usage();
+		return -EINVAL;
+	}
+
+	const char *verb = argv[1];
+	const char *exported = nullptr;
+	const char *imported = nullptr;
+	uint32_t count = 10000;
+	bool udp = false;
+
+	int myoptind = 2;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "e:i:n:u", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'e':
+			exported = myoptarg;
+			break;
+
+		case 'i':
+			imported = myoptarg;
+			break;
+
+		case 'n':
+			count = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'u':
+			udp = true;
+			break;
+
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	if (!strcmp(verb, "start")) {
+		if (uORB::ShmChannel::isInstance() && uORB::ShmChannel::GetInstance()->running()) {
+			PX4_WARN("already running");
+			return 0;
+		}
+
+		if (exported == nullptr) {
+			usage();
+			return -EINVAL;
+		}
+
+		int ret = uORB::ShmChannel::GetInstance()->Start(exported, imported);
+
+		if (ret == 0) {
+			// register the shared memory channel with uORB
+			uORB::Manager::get_instance()->set_uorb_communicator(uORB::ShmChannel::GetInstance());
+		}
+
+		return ret;
+	}
+
+	if (!strcmp(verb, "bench") && udp) {
+		return bench_udp(count);
+	}
+
+	if (!uORB::ShmChannel::isInstance() || !uORB::ShmChannel::GetInstance()->running()) {
+		PX4_INFO("not running");
+		return (!strcmp(verb, "status")) ? 0 : -1;
+	}
+
+	if (!strcmp(verb, "stop")) {
+		uORB::Manager::get_instance()->set_uorb_communicator(nullptr);
+		uORB::ShmChannel::GetInstance()->Stop();
+		return 0;
+	}
+
+	if (!strcmp(verb, "status")) {
+		uORB::ShmChannel::GetInstance()->print_status();
+		return 0;
+	}
+
+	if (!strcmp(verb, "bench")) {
+		return bench(count);
+	}
+
+	usage();
+	return -EINVAL;
+}
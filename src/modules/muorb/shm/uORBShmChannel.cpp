@@ -0,0 +1,372 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "uORBShmChannel.hpp"
+
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/posix.h>
+#include <px4_platform_common/time.h>
+#include <drivers/drv_hrt.h>
+#include <lib/mathlib/mathlib.h>
+#include <uORB/uORBTopics.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace time_literals;
+
+uORB::ShmChannel *uORB::ShmChannel::_InstancePtr = nullptr;
+
+static const orb_metadata *find_topic_meta(const char *name, size_t len)
+{
+	const orb_metadata *const *topics = orb_get_topics();
+
+	for (size_t i = 0; i < orb_topics_count(); i++) {
+		if ((strlen(topics[i]->o_name) == len) && (strncmp(topics[i]->o_name, name, len) == 0)) {
+			return topics[i];
+		}
+	}
+
+	return nullptr;
+}
+
+int uORB::ShmChannel::add_topics(const char *list, uint32_t flags)
+{
+	if (list == nullptr) {
+		return 0;
+	}
+
+	uint8_t *segment = static_cast<uint8_t *>(_segment);
+	shm::Header *header = reinterpret_cast<shm::Header *>(segment);
+
+	while (*list != '\0') {
+		const char *end = strchr(list, ',');
+		const size_t len = end ? (size_t)(end - list) : strlen(list);
+
+		if (len > 0) {
+			const orb_metadata *meta = find_topic_meta(list, len);
+
+			if (meta == nullptr) {
+				PX4_ERR("unknown topic %.*s", (int)len, list);
+				return -ENOENT;
+			}
+
+			if ((_num_topics >= shm::MAX_TOPICS) || (strlen(meta->o_name) >= shm::TOPIC_NAME_LEN)) {
+				PX4_ERR("can't add %s", meta->o_name);
+				return -ENOMEM;
+			}
+
+			// topic table entry, the slot rings are appended to the segment
+			shm::Topic &topic = shm::topics(_segment)[_num_topics];
+			strncpy(topic.name, meta->o_name, sizeof(topic.name) - 1);
+			topic.size = meta->o_size;
+			topic.slot_size = shm::slot_size(meta->o_size);
+			topic.ring_len = shm::RING_LEN;
+			topic.offset = header->segment_size;
+			topic.flags.store(flags);
+			topic.generation.store(0);
+
+			header->segment_size += topic.slot_size * topic.ring_len;
+
+			pthread_mutex_init(&_write_mutex[_num_topics], nullptr);
+
+			// insertion into the lookup table sorted by name address
+			int i = _num_topics;
+
+			while ((i > 0) && (_lookup[i - 1].name > meta->o_name)) {
+				_lookup[i] = _lookup[i - 1];
+				i--;
+			}
+
+			_lookup[i].name = meta->o_name;
+			_lookup[i].index = _num_topics;
+
+			_num_topics++;
+			header->num_topics = _num_topics;
+		}
+
+		list += len;
+
+		if (*list == ',') {
+			list++;
+		}
+	}
+
+	return 0;
+}
+
+int uORB::ShmChannel::Start(const char *exported, const char *imported)
+{
+	if (_running) {
+		PX4_WARN("already running");
+		return 0;
+	}
+
+	// the topic table has a fixed size, the slots are sized by the topics added
+	uint32_t max_size = sizeof(shm::Header) + shm::MAX_TOPICS * sizeof(shm::Topic);
+	const orb_metadata *const *topics = orb_get_topics();
+	uint32_t max_slot_size = 0;
+
+	for (size_t i = 0; i < orb_topics_count(); i++) {
+		max_slot_size = math::max(max_slot_size, shm::slot_size(topics[i]->o_size));
+	}
+
+	max_size += shm::MAX_TOPICS * shm::RING_LEN * max_slot_size;
+
+	shm_unlink(shm::SEGMENT_NAME); // stale segment of a previous run
+
+	int fd = shm_open(shm::SEGMENT_NAME, O_CREAT | O_RDWR, 0600);
+
+	if (fd < 0) {
+		PX4_ERR("shm_open failed (%i)", errno);
+		return -errno;
+	}
+
+	if (ftruncate(fd, max_size) != 0) {
+		PX4_ERR("ftruncate failed (%i)", errno);
+		close(fd);
+		shm_unlink(shm::SEGMENT_NAME);
+		return -errno;
+	}
+
+	void *segment = mmap(nullptr, max_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (segment == MAP_FAILED) {
+		PX4_ERR("mmap failed (%i)", errno);
+		shm_unlink(shm::SEGMENT_NAME);
+		return -errno;
+	}
+
+	memset(segment, 0, max_size);
+	_segment = segment;
+	_segment_size = max_size;
+	_num_topics = 0;
+
+	shm::Header *header = static_cast<shm::Header *>(segment);
+	header->segment_size = sizeof(shm::Header) + shm::MAX_TOPICS * sizeof(shm::Topic);
+
+	int ret = add_topics(exported, shm::TOPIC_EXPORTED);
+
+	if (ret == 0) {
+		ret = add_topics(imported, shm::TOPIC_IMPORTED);
+	}
+
+	if (ret != 0) {
+		munmap(_segment, _segment_size);
+		_segment = nullptr;
+		shm_unlink(shm::SEGMENT_NAME);
+		return ret;
+	}
+
+	header->version = shm::VERSION;
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = shm::MAGIC; // readers wait for the magic
+
+	_running = true;
+
+	_rx_should_exit.store(false);
+	_rx_thread_started = (pthread_create(&_rx_thread, nullptr, &RxTrampoline, this) == 0);
+
+	if (!_rx_thread_started) {
+		PX4_ERR("failed to start receive thread");
+	}
+
+	PX4_INFO("%s: %d topics, %" PRIu32 " bytes", shm::SEGMENT_NAME, _num_topics, header->segment_size);
+
+	return 0;
+}
+
+void uORB::ShmChannel::Stop()
+{
+	if (_rx_thread_started) {
+		_rx_should_exit.store(true);
+		pthread_join(_rx_thread, nullptr);
+		_rx_thread_started = false;
+	}
+
+	// Publishers might still be in send_message(), so the mapping is kept until the process exits
+	// and only the lookup is emptied. External readers keep their mapping, new ones can't attach anymore.
+	_num_topics = 0;
+	_running = false;
+	shm_unlink(shm::SEGMENT_NAME);
+}
+
+int uORB::ShmChannel::find(const char *messageName) const
+{
+	int low = 0;
+	int high = _num_topics - 1;
+
+	while (low <= high) {
+		const int mid = (low + high) / 2;
+
+		if (_lookup[mid].name == messageName) {
+			return _lookup[mid].index;
+
+		} else if (_lookup[mid].name < messageName) {
+			low = mid + 1;
+
+		} else {
+			high = mid - 1;
+		}
+	}
+
+	return -1;
+}
+
+int16_t uORB::ShmChannel::topic_advertised(const char *messageName)
+{
+	const int index = find(messageName);
+
+	if (index >= 0) {
+		shm::topics(_segment)[index].flags.fetch_or(shm::TOPIC_ADVERTISED);
+	}
+
+	return 0;
+}
+
+int16_t uORB::ShmChannel::register_handler(uORBCommunicator::IChannelRxHandler *handler)
+{
+	_rx_handler = handler;
+	return 0;
+}
+
+int16_t uORB::ShmChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	const int index = find(messageName);
+
+	if (index < 0) {
+		return 0;
+	}
+
+	shm::Topic &topic = shm::topics(_segment)[index];
+
+	if (!(topic.flags.load() & shm::TOPIC_EXPORTED) || (length != (int32_t)topic.size)) {
+		return 0;
+	}
+
+	perf_begin(_send_perf);
+
+	// a topic can have several publishers, but the seqlock needs a single writer
+	pthread_mutex_lock(&_write_mutex[index]);
+	shm::write(_segment, topic, data, hrt_absolute_time());
+	pthread_mutex_unlock(&_write_mutex[index]);
+
+	perf_end(_send_perf);
+
+	return 0;
+}
+
+void *uORB::ShmChannel::RxTrampoline(void *context)
+{
+	static_cast<ShmChannel *>(context)->RxRun();
+	return nullptr;
+}
+
+void uORB::ShmChannel::RxRun()
+{
+	shm::Header *header = static_cast<shm::Header *>(_segment);
+	uint32_t last_rx_generation = 0;
+
+	uint32_t buffer_size = 0;
+
+	for (int i = 0; i < _num_topics; i++) {
+		buffer_size = math::max(buffer_size, shm::topics(_segment)[i].size);
+	}
+
+	// Imported messages are copied out of the segment: the external writer can overwrite a slot
+	// at any time and a torn message must never reach uORB, which copies the data anyway.
+	uint8_t *buffer = (uint8_t *)malloc(buffer_size);
+
+	if (buffer == nullptr) {
+		PX4_ERR("alloc failed");
+		return;
+	}
+
+	while (!_rx_should_exit.load()) {
+		// sleep until an external writer signals new data, wake up regularly to check for exit
+		const uint32_t rx_generation = shm::wait_imported(*header, last_rx_generation, 100000);
+
+		if ((rx_generation == last_rx_generation) || (_rx_handler == nullptr)) {
+			continue;
+		}
+
+		last_rx_generation = rx_generation;
+
+		for (int i = 0; i < _num_topics; i++) {
+			const shm::Topic &topic = shm::topics(_segment)[i];
+
+			if (!(topic.flags.load() & shm::TOPIC_IMPORTED) || (topic.generation.load() == _rx_generation[i])) {
+				continue;
+			}
+
+			const uint64_t generation = shm::read(_segment, topic, buffer);
+
+			if (generation != 0) {
+				_rx_generation[i] = generation;
+				_rx_handler->process_received_message(topic.name, topic.size, buffer);
+				perf_count(_rx_perf);
+			}
+		}
+	}
+
+	free(buffer);
+}
+
+void uORB::ShmChannel::print_status()
+{
+	if (!_running) {
+		PX4_INFO("not running");
+		return;
+	}
+
+	PX4_INFO("segment %s, %" PRIu32 " bytes", shm::SEGMENT_NAME, static_cast<shm::Header *>(_segment)->segment_size);
+
+	for (int i = 0; i < _num_topics; i++) {
+		const shm::Topic &topic = shm::topics(_segment)[i];
+		const uint32_t flags = topic.flags.load();
+
+		PX4_INFO_RAW("  %-32s %s%s size: %4" PRIu32 " generation: %" PRIu64 "\n", topic.name,
+			     (flags & shm::TOPIC_EXPORTED) ? "out" : "in ",
+			     (flags & shm::TOPIC_ADVERTISED) ? "*" : " ",
+			     topic.size, topic.generation.load());
+	}
+
+	perf_print_counter(_send_perf);
+	perf_print_counter(_rx_perf);
+}
@@ -0,0 +1,145 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "uORBShmLayout.hpp"
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <px4_platform_common/atomic.h>
+#include <lib/perf/perf_counter.h>
+#include <uORB/uORBCommunicator.hpp>
+
+namespace uORB
+{
+class ShmChannel;
+}
+
+/**
+ * uORB communicator channel over a POSIX shared memory segment (see uORBShmLayout.hpp).
+ *
+ * Exported topics are written into the segment on every publication, without any
+ * serialization, so that other processes on the same host can map the segment
+ * read-only and read them in place. Imported topics are written by an external
+ * process and forwarded into uORB by a receive thread.
+ *
+ * Note: send_message() only gets the topic name, so all instances of a
+ * multi-instance topic share the same entry.
+ */
+class uORB::ShmChannel : public uORBCommunicator::IChannel
+{
+public:
+	/**
+	 * static method to get the IChannel Implementor.
+	 */
+	static uORB::ShmChannel *GetInstance()
+	{
+		if (_InstancePtr == nullptr) {
+			_InstancePtr = new uORB::ShmChannel();
+		}
+
+		return _InstancePtr;
+	}
+
+	/**
+	 * Static method to check if there is an instance.
+	 */
+	static bool isInstance() { return (_InstancePtr != nullptr); }
+
+	int16_t topic_advertised(const char *messageName) override;
+	int16_t add_subscription(const char *messageName, int32_t msgRateInHz) override { return 0; }
+	int16_t remove_subscription(const char *messageName) override { return 0; }
+	int16_t register_handler(uORBCommunicator::IChannelRxHandler *handler) override;
+
+	/**
+	 * Called for every publication, returns immediately for topics that are not exported.
+	 */
+	int16_t send_message(const char *messageName, int32_t length, uint8_t *data) override;
+
+	/**
+	 * Create the segment and start the receive thread.
+	 * @param exported comma separated list of topics written to the segment
+	 * @param imported comma separated list of topics read from the segment (can be nullptr)
+	 * @return 0 on success
+	 */
+	int Start(const char *exported, const char *imported);
+	void Stop();
+
+	bool running() const { return _running; }
+
+	void print_status();
+
+private:
+	ShmChannel() = default;
+	~ShmChannel() = default;
+
+	int add_topics(const char *list, uint32_t flags);
+
+	/**
+	 * Find the entry of a topic by the address of its orb_metadata::o_name.
+	 * @return topic index or -1
+	 */
+	int find(const char *messageName) const;
+
+	static void *RxTrampoline(void *context);
+	void RxRun();
+
+	static uORB::ShmChannel *_InstancePtr;
+
+	uORBCommunicator::IChannelRxHandler *_rx_handler{nullptr};
+
+	void *_segment{nullptr};
+	uint32_t _segment_size{0};
+	bool _running{false};
+
+	struct TopicEntry {
+		const char *name{nullptr}; // orb_metadata::o_name (compared by address)
+		int index{-1};
+	};
+
+	// sorted by name address for a binary search in send_message()
+	TopicEntry _lookup[shm::MAX_TOPICS] {};
+	int _num_topics{0};
+
+	pthread_mutex_t _write_mutex[shm::MAX_TOPICS] {};
+	uint64_t _rx_generation[shm::MAX_TOPICS] {};
+
+	pthread_t _rx_thread{};
+	bool _rx_thread_started{false};
+	px4::atomic_bool _rx_should_exit{false};
+
+	perf_counter_t _send_perf{perf_alloc(PC_ELAPSED, "muorb_shm: send")};
+	perf_counter_t _rx_perf{perf_alloc(PC_COUNT, "muorb_shm: received")};
+};
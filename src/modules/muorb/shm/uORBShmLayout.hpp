@@ -0,0 +1,276 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file uORBShmLayout.hpp
+ *
+ * Binary layout of the uORB shared-memory bridge segment. This header has no PX4
+ * dependencies so that external processes can include it to map the segment.
+ *
+ * Segment: [Header][Topic 0..num_topics-1][slot rings]
+ *
+ * Each topic owns a ring of ring_len slots of slot_size bytes ({seq, data}).
+ * The writer of a topic (PX4 for exported topics, the external process for
+ * imported ones) stores generation g into slot (g - 1) % ring_len:
+ *   slot.seq = 2g - 1, copy data, slot.seq = 2g, topic.generation = g
+ * A reader loads g = generation, reads the slot in place and accepts the data if
+ * slot.seq == 2g both before and after the read (seqlock). Readers never write to
+ * exported topics, so the segment can be mapped read-only.
+ *
+ * An external writer of imported topics increments header.rx_generation after
+ * writing and wakes the PX4 receive thread with a futex if it is sleeping
+ * (notify_imported()).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace uORB
+{
+namespace shm
+{
+
+static constexpr char SEGMENT_NAME[] = "/px4_uorb_shm";
+
+static constexpr uint32_t MAGIC = 0x4d485355; // 'USHM'
+static constexpr uint32_t VERSION = 2;
+
+static constexpr int MAX_TOPICS = 64;
+static constexpr int TOPIC_NAME_LEN = 48;
+static constexpr uint32_t RING_LEN = 4;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory bridge requires lock-free 64 bit atomics");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32 bit integers");
+
+enum TopicFlags : uint32_t {
+	TOPIC_EXPORTED   = (1 << 0), // PX4 -> external
+	TOPIC_IMPORTED   = (1 << 1), // external -> PX4
+	TOPIC_ADVERTISED = (1 << 2), // PX4 has a publisher for this topic
+};
+
+struct Header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_topics;
+	uint32_t segment_size;
+	std::atomic<uint32_t> rx_generation; // bumped by external writers of imported topics (futex word)
+	std::atomic<uint32_t> rx_waiters;    // PX4 receive threads sleeping on rx_generation
+};
+
+struct Topic {
+	char name[TOPIC_NAME_LEN];
+	uint32_t size;       // message size (orb_metadata::o_size)
+	uint32_t slot_size;  // sizeof(Slot) + size, 8 byte aligned
+	uint32_t ring_len;
+	uint32_t offset;     // of the first slot from the segment start
+	std::atomic<uint32_t> flags;
+	std::atomic<uint64_t> generation; // 0: never written
+};
+
+struct Slot {
+	std::atomic<uint64_t> seq;
+	uint64_t timestamp; // hrt time of the write (PX4 clock)
+	// uint8_t data[]
+};
+
+static constexpr uint32_t slot_size(uint32_t msg_size)
+{
+	return (sizeof(Slot) + msg_size + 7) & ~7u;
+}
+
+inline Topic *topics(void *segment)
+{
+	return reinterpret_cast<Topic *>(static_cast<uint8_t *>(segment) + sizeof(Header));
+}
+
+inline const Topic *topics(const void *segment)
+{
+	return reinterpret_cast<const Topic *>(static_cast<const uint8_t *>(segment) + sizeof(Header));
+}
+
+inline Slot *slot(void *segment, const Topic &topic, uint64_t generation)
+{
+	return reinterpret_cast<Slot *>(static_cast<uint8_t *>(segment) + topic.offset
+					+ ((generation - 1) % topic.ring_len) * topic.slot_size);
+}
+
+inline const Slot *slot(const void *segment, const Topic &topic, uint64_t generation)
+{
+	return reinterpret_cast<const Slot *>(static_cast<const uint8_t *>(segment) + topic.offset
+					      + ((generation - 1) % topic.ring_len) * topic.slot_size);
+}
+
+inline uint8_t *slot_data(Slot *s) { return reinterpret_cast<uint8_t *>(s + 1); }
+inline const uint8_t *slot_data(const Slot *s) { return reinterpret_cast<const uint8_t *>(s + 1); }
+
+/**
+ * Write a new generation of a topic (single writer per topic).
+ */
+inline uint64_t write(void *segment, Topic &topic, const void *data, uint64_t timestamp)
+{
+	const uint64_t generation = topic.generation.load(std::memory_order_relaxed) + 1;
+	Slot *s = slot(segment, topic, generation);
+
+	s->seq.store(2 * generation - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	s->timestamp = timestamp;
+	memcpy(slot_data(s), data, topic.size);
+
+	s->seq.store(2 * generation, std::memory_order_release);
+	topic.generation.store(generation, std::memory_order_release);
+
+	return generation;
+}
+
+/**
+ * Access the latest generation of a topic in place, without copying it.
+ *
+ * visitor(const uint8_t *data) runs while the writer may already overwrite the
+ * slot, so it must only extract what it needs (e.g. into locals) and the result
+ * may only be used if this returns a generation.
+ * @return the generation read, 0 if there is no (consistent) data
+ */
+template<typename Visitor>
+inline uint64_t read_in_place(const void *segment, const Topic &topic, Visitor &&visitor,
+			      uint64_t *timestamp = nullptr)
+{
+	for (int tries = 0; tries < 4; tries++) {
+		const uint64_t generation = topic.generation.load(std::memory_order_acquire);
+
+		if (generation == 0) {
+			return 0;
+		}
+
+		const Slot *s = slot(segment, topic, generation);
+
+		if (s->seq.load(std::memory_order_acquire) != 2 * generation) {
+			continue; // overwritten by a newer generation, retry
+		}
+
+		const uint64_t ts = s->timestamp;
+		visitor(slot_data(s));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (s->seq.load(std::memory_order_relaxed) == 2 * generation) {
+			if (timestamp) {
+				*timestamp = ts;
+			}
+
+			return generation;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Copy the latest generation of a topic.
+ * @return the generation read, 0 if there is no (consistent) data
+ */
+inline uint64_t read(const void *segment, const Topic &topic, void *data, uint64_t *timestamp = nullptr)
+{
+	return read_in_place(segment, topic, [&](const uint8_t * slot_data) { memcpy(data, slot_data, topic.size); },
+			     timestamp);
+}
+
+inline void futex_wait(std::atomic<uint32_t> &word, uint32_t expected, uint32_t timeout_us)
+{
+#if defined(__linux__)
+	struct timespec timeout;
+	timeout.tv_sec = timeout_us / 1000000;
+	timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+
+	// the segment is mapped by several processes, so this cannot be a FUTEX_PRIVATE_FLAG futex
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+	// no futex, poll instead
+	(void)word;
+	(void)expected;
+	usleep(timeout_us < 1000 ? timeout_us : 1000);
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t> &word)
+{
+#if defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+	(void)word;
+#endif
+}
+
+/**
+ * Signal new data of imported topics (external writer, after write()).
+ */
+inline void notify_imported(Header &header)
+{
+	header.rx_generation.fetch_add(1, std::memory_order_seq_cst);
+
+	// only issue the syscall if the receive thread is sleeping
+	if (header.rx_waiters.load(std::memory_order_seq_cst) > 0) {
+		futex_wake(header.rx_generation);
+	}
+}
+
+/**
+ * Sleep until rx_generation differs from last_generation (PX4 receive thread).
+ * @return the current rx_generation (equal to last_generation on timeout)
+ */
+inline uint32_t wait_imported(Header &header, uint32_t last_generation, uint32_t timeout_us)
+{
+	header.rx_waiters.fetch_add(1, std::memory_order_seq_cst);
+
+	if (header.rx_generation.load(std::memory_order_seq_cst) == last_generation) {
+		futex_wait(header.rx_generation, last_generation, timeout_us);
+	}
+
+	header.rx_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+	return header.rx_generation.load(std::memory_order_acquire);
+}
+
+} // namespace shm
+} // namespace uORB
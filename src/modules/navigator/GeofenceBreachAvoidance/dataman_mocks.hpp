@@ -59,6 +59,27 @@ extern "C" {
 		size_t buflen			/* Length in bytes of data to retrieve */
 	) {return 0;};
 
+	/** Retrieve a range of items from the data manager store */
+	__EXPORT ssize_t
+	dm_read_range(
+		dm_item_t item,			/* The item type to retrieve */
+		unsigned index,			/* The index of the first item */
+		unsigned count,			/* The number of items to retrieve */
+		void *buffer,			/* Pointer to caller data buffer */
+		size_t item_size		/* Length in bytes of each item */
+	) {return 0;};
+
+	/** write a range of items to the data manager store */
+	__EXPORT ssize_t
+	dm_write_range(
+		dm_item_t  item,		/* The item type to store */
+		unsigned index,			/* The index of the first item */
+		unsigned count,			/* The number of items to store */
+		dm_persitence_t persistence,	/* The persistence level of these items */
+		const void *buffer,		/* Pointer to caller data buffer */
+		size_t item_size		/* Length in bytes of each item */
+	) {return 0;};
+
 	/**
 	 * Lock all items of a type. Can be used for atomic updates of multiple items (single items are always updated
 	 * atomically).
@@ -0,0 +1,224 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file GeofenceTest.cpp
+ * Tests the cached polygon geometry and edge index of the geofence.
+ */
+
+#include <gtest/gtest.h>
+#include "geofence.h"
+#include "navigation.h"
+#include "GeofenceBreachAvoidance/dataman_mocks.hpp"
+#include <drivers/drv_hrt.h>
+#include <parameters/param.h>
+
+#include <vector>
+
+// to run: make tests TESTFILTER=Geofence
+
+class TestGeofence : public Geofence
+{
+public:
+	using Geofence::Vertex;
+
+	TestGeofence() : Geofence(nullptr) {}
+
+	void addPolygon(uint16_t fence_type, const std::vector<Vertex> &polygon)
+	{
+		PolygonInfo *polygons = new PolygonInfo[_num_polygons + 1];
+		memcpy(polygons, _polygons, sizeof(PolygonInfo) * _num_polygons);
+		delete[] _polygons;
+		_polygons = polygons;
+
+		Vertex *vertices = new Vertex[_num_vertices + polygon.size()];
+		memcpy(vertices, _vertices, sizeof(Vertex) * _num_vertices);
+		memcpy(vertices + _num_vertices, polygon.data(), sizeof(Vertex) * polygon.size());
+		delete[] _vertices;
+		_vertices = vertices;
+
+		PolygonInfo &info = _polygons[_num_polygons++];
+		info.fence_type = fence_type;
+		info.dataman_index = 0;
+		info.vertex_count = polygon.size();
+		info.vertex_index = _num_vertices;
+		info.valid = true;
+		_num_vertices += polygon.size();
+
+		_buildIndex();
+	}
+
+	uint32_t numIndexedEdges() const { return _num_slab_edges; }
+};
+
+// reference: PNPOLY over all edges, as the geofence did before the edge index
+static bool insidePolygonLinear(const std::vector<TestGeofence::Vertex> &polygon, double lat, double lon)
+{
+	bool c = false;
+
+	for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+		if ((polygon[i].lon >= lon) != (polygon[j].lon >= lon) &&
+		    (lat <= (polygon[j].lat - polygon[i].lat) * (lon - polygon[i].lon) /
+		     (polygon[j].lon - polygon[i].lon) + polygon[i].lat)) {
+			c = !c;
+		}
+	}
+
+	return c;
+}
+
+// star shaped (concave) polygon around (lat, lon) with alternating inner and outer radius
+static std::vector<TestGeofence::Vertex> starPolygon(double lat, double lon, int num_vertices)
+{
+	std::vector<TestGeofence::Vertex> polygon(num_vertices);
+
+	for (int i = 0; i < num_vertices; i++) {
+		const double angle = 2.0 * M_PI * i / num_vertices;
+		const double radius = (i % 2 == 0) ? 0.01 : 0.006;
+		polygon[i].lat = lat + radius * cos(angle);
+		polygon[i].lon = lon + radius * sin(angle);
+	}
+
+	return polygon;
+}
+
+// smooth concave polygon around (lat, lon), similar to a fence drawn along a coastline or border
+static std::vector<TestGeofence::Vertex> wavyPolygon(double lat, double lon, int num_vertices)
+{
+	std::vector<TestGeofence::Vertex> polygon(num_vertices);
+
+	for (int i = 0; i < num_vertices; i++) {
+		const double angle = 2.0 * M_PI * i / num_vertices;
+		const double radius = 0.01 * (1.0 + 0.2 * sin(16.0 * angle));
+		polygon[i].lat = lat + radius * cos(angle);
+		polygon[i].lon = lon + radius * sin(angle);
+	}
+
+	return polygon;
+}
+
+// deterministic pseudo random numbers in [0, 1)
+static double nextRandom(uint32_t &state)
+{
+	state = state * 1664525u + 1013904223u;
+	return (state >> 8) / 16777216.0;
+}
+
+class GeofenceTest : public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		param_control_autosave(false);
+	}
+};
+
+TEST_F(GeofenceTest, emptyFence)
+{
+	// GIVEN: no fence
+	TestGeofence geofence;
+
+	// THEN: all points are accepted
+	EXPECT_TRUE(geofence.isEmpty());
+	EXPECT_TRUE(geofence.isInsidePolygonOrCircle(47.39, 8.54, 500.f));
+}
+
+TEST_F(GeofenceTest, inclusionAndExclusionPolygon)
+{
+	// GIVEN: a square inclusion polygon with a square exclusion polygon in its center
+	TestGeofence geofence;
+	geofence.addPolygon(NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION, {{47.0, 8.0}, {47.0, 8.1}, {47.1, 8.1}, {47.1, 8.0}});
+	geofence.addPolygon(NAV_CMD_FENCE_POLYGON_VERTEX_EXCLUSION, {{47.04, 8.04}, {47.04, 8.06}, {47.06, 8.06}, {47.06, 8.04}});
+
+	// THEN: only points inside the inclusion and outside of the exclusion area pass
+	EXPECT_TRUE(geofence.isInsidePolygonOrCircle(47.02, 8.02, 0.f));
+	EXPECT_TRUE(geofence.isInsidePolygonOrCircle(47.08, 8.05, 0.f));
+	EXPECT_FALSE(geofence.isInsidePolygonOrCircle(47.05, 8.05, 0.f));
+	EXPECT_FALSE(geofence.isInsidePolygonOrCircle(46.99, 8.05, 0.f));
+	EXPECT_FALSE(geofence.isInsidePolygonOrCircle(47.05, 8.11, 0.f));
+}
+
+TEST_F(GeofenceTest, indexedPolygonMatchesLinearScan)
+{
+	// GIVEN: a large concave polygon, which gets an edge index
+	TestGeofence geofence;
+	const std::vector<TestGeofence::Vertex> polygon = starPolygon(47.4, 8.5, 2000);
+	geofence.addPolygon(NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION, polygon);
+	EXPECT_GT(geofence.numIndexedEdges(), 0u);
+
+	// WHEN: we check random points in and around the polygon
+	uint32_t state = 1;
+	int num_inside = 0;
+
+	for (int i = 0; i < 20000; i++) {
+		const double lat = 47.4 + (nextRandom(state) - 0.5) * 0.024;
+		const double lon = 8.5 + (nextRandom(state) - 0.5) * 0.024;
+		const bool inside = insidePolygonLinear(polygon, lat, lon);
+		num_inside += inside;
+
+		// THEN: the result is identical to the linear scan over all edges
+		ASSERT_EQ(inside, geofence.isInsidePolygonOrCircle(lat, lon, 0.f)) << lat << ", " << lon;
+	}
+
+	// AND: both cases have been covered
+	EXPECT_GT(num_inside, 0);
+	EXPECT_LT(num_inside, 20000);
+
+	// AND: the vertices themselves match too
+	for (const TestGeofence::Vertex &vertex : polygon) {
+		ASSERT_EQ(insidePolygonLinear(polygon, vertex.lat, vertex.lon),
+			  geofence.isInsidePolygonOrCircle(vertex.lat, vertex.lon, 0.f));
+	}
+}
+
+TEST_F(GeofenceTest, largePolygons)
+{
+	// GIVEN: fences with thousands of vertices
+	for (int num_vertices : {1000, 4000, 16000}) {
+		TestGeofence geofence;
+		const std::vector<TestGeofence::Vertex> polygon = wavyPolygon(47.4, 8.5, num_vertices);
+		geofence.addPolygon(NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION, polygon);
+
+		// WHEN: we check a set of points with the index and with a linear scan
+		uint32_t state = 1;
+
+		for (int i = 0; i < 500; i++) {
+			const double lat = 47.4 + (nextRandom(state) - 0.5) * 0.024;
+			const double lon = 8.5 + (nextRandom(state) - 0.5) * 0.024;
+
+			// THEN: both give the same result
+			ASSERT_EQ(insidePolygonLinear(polygon, lat, lon), geofence.isInsidePolygonOrCircle(lat, lon, 0.f))
+					<< num_vertices << " vertices, point " << i;
+		}
+	}
+}
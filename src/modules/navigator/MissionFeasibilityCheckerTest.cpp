@@ -0,0 +1,301 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file MissionFeasibilityCheckerTest.cpp
+ * Feeds canned missions item by item through the mission feasibility checker.
+ */
+
+#include <gtest/gtest.h>
+#include "navigator.h"
+#include "mission_feasibility_checker.h"
+#include "navigation.h"
+#include "GeofenceBreachAvoidance/dataman_mocks.hpp"
+#include <parameters/param.h>
+
+#include <vector>
+
+// to run: make tests TESTFILTER=MissionFeasibilityChecker
+
+static constexpr double HOME_LAT = 47.397742;
+static constexpr double HOME_LON = 8.545594;
+static constexpr float HOME_ALT = 488.f;
+
+static mission_item_s item(uint16_t nav_cmd, double lat = HOME_LAT, double lon = HOME_LON, float altitude = 30.f)
+{
+	mission_item_s mission_item{};
+	mission_item.nav_cmd = nav_cmd;
+	mission_item.lat = lat;
+	mission_item.lon = lon;
+	mission_item.altitude = altitude;
+	mission_item.altitude_is_relative = true;
+	return mission_item;
+}
+
+class MissionFeasibilityCheckerTest : public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		setTakeoffRequired(false);
+	}
+
+	void TearDown() override
+	{
+		setTakeoffRequired(false);
+	}
+
+	// MIS_TAKEOFF_REQ is read by the Navigator constructor, set it before creating one
+	static void setTakeoffRequired(bool required)
+	{
+		const int32_t value = required ? 1 : 0;
+		param_set(param_find("MIS_TAKEOFF_REQ"), &value);
+	}
+
+	static void setState(Navigator &navigator, uint8_t vehicle_type, bool is_vtol, bool landed)
+	{
+		home_position_s home{};
+		home.timestamp = 1000;
+		home.lat = HOME_LAT;
+		home.lon = HOME_LON;
+		home.alt = HOME_ALT;
+		home.valid_alt = true;
+		home.valid_hpos = true;
+		home.valid_lpos = true;
+		*navigator.get_home_position() = home;
+
+		vehicle_status_s status{};
+		status.vehicle_type = vehicle_type;
+		status.is_vtol = is_vtol;
+		*navigator.get_vstatus() = status;
+
+		vehicle_land_detected_s land_detected{};
+		land_detected.landed = landed;
+		*navigator.get_land_detected() = land_detected;
+
+		navigator.get_mission_result()->warning = false;
+	}
+
+	// feed all items, returns the index of the first rejected item or -1
+	static int feed(MissionFeasibilityChecker &checker, const std::vector<mission_item_s> &items)
+	{
+		for (size_t i = 0; i < items.size(); i++) {
+			if (!checker.addItem(items[i])) {
+				return (int)i;
+			}
+		}
+
+		return -1;
+	}
+};
+
+TEST_F(MissionFeasibilityCheckerTest, rejectsWithoutHomeAltitude)
+{
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_ROTARY_WING, false, true);
+	navigator.get_home_position()->valid_alt = false;
+
+	MissionFeasibilityChecker checker(&navigator);
+	EXPECT_FALSE(checker.begin(0.f, 0.f, false));
+	EXPECT_FALSE(checker.addItem(item(NAV_CMD_WAYPOINT)));
+	EXPECT_FALSE(checker.finish());
+}
+
+TEST_F(MissionFeasibilityCheckerTest, takeoffFirst)
+{
+	setTakeoffRequired(true);
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_ROTARY_WING, false, true);
+	MissionFeasibilityChecker checker(&navigator);
+
+	// GIVEN: a takeoff as first item
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_TAKEOFF), item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_LAND)}), -1);
+	EXPECT_TRUE(checker.finish());
+
+	// GIVEN: only non-position items before the takeoff
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_DO_CHANGE_SPEED), item(NAV_CMD_DO_SET_ROI_NONE), item(NAV_CMD_TAKEOFF),
+				 item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001)}), -1);
+	EXPECT_TRUE(checker.finish());
+
+	// GIVEN: a waypoint before the takeoff
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_TAKEOFF)}), -1);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: no takeoff at all
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001)}), -1);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: a takeoff below the acceptance radius
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	const float low_altitude = navigator.get_default_acceptance_radius();
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_TAKEOFF, HOME_LAT, HOME_LON, low_altitude)}), 0);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: the same missions are fine in flight, no takeoff is required then
+	navigator.get_land_detected()->landed = false;
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_TAKEOFF)}), -1);
+	EXPECT_TRUE(checker.finish());
+}
+
+TEST_F(MissionFeasibilityCheckerTest, takeoffNotRequired)
+{
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_ROTARY_WING, false, true);
+	MissionFeasibilityChecker checker(&navigator);
+
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_LAND)}), -1);
+	EXPECT_TRUE(checker.finish());
+
+	// landing while landed is not a mission
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_LAND)}), 0);
+	EXPECT_FALSE(checker.finish());
+}
+
+TEST_F(MissionFeasibilityCheckerTest, homeAltitudeWarnsOnce)
+{
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_ROTARY_WING, false, false);
+	MissionFeasibilityChecker checker(&navigator);
+
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+
+	// WHEN: a waypoint is above home
+	EXPECT_TRUE(checker.addItem(item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001, HOME_LON, 10.f)));
+	EXPECT_FALSE(navigator.get_mission_result()->warning);
+
+	// WHEN: the first waypoint below home is fed, THEN: it only warns
+	EXPECT_TRUE(checker.addItem(item(NAV_CMD_WAYPOINT, HOME_LAT + 0.002, HOME_LON, -5.f)));
+	EXPECT_TRUE(navigator.get_mission_result()->warning);
+
+	// WHEN: another waypoint below home is fed, THEN: the check is not repeated
+	navigator.get_mission_result()->warning = false;
+	EXPECT_TRUE(checker.addItem(item(NAV_CMD_WAYPOINT, HOME_LAT + 0.003, HOME_LON, -10.f)));
+	EXPECT_FALSE(navigator.get_mission_result()->warning);
+
+	// AMSL altitudes are compared against the home altitude as well
+	mission_item_s amsl = item(NAV_CMD_WAYPOINT, HOME_LAT + 0.004, HOME_LON, HOME_ALT - 1.f);
+	amsl.altitude_is_relative = false;
+	EXPECT_TRUE(checker.addItem(amsl));
+	EXPECT_TRUE(checker.finish());
+
+	// WHEN: the checker is restarted, THEN: the warning is raised again
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_TRUE(checker.addItem(amsl));
+	EXPECT_TRUE(navigator.get_mission_result()->warning);
+	EXPECT_TRUE(checker.finish());
+}
+
+TEST_F(MissionFeasibilityCheckerTest, vtolLandingPattern)
+{
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_ROTARY_WING, true, false);
+	MissionFeasibilityChecker checker(&navigator);
+
+	// GIVEN: a land start is required but missing
+	ASSERT_TRUE(checker.begin(0.f, 0.f, true));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_VTOL_LAND)}), -1);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: a land start followed by an approach and a landing
+	ASSERT_TRUE(checker.begin(0.f, 0.f, true));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_DO_LAND_START),
+				 item(NAV_CMD_WAYPOINT, HOME_LAT + 0.002), item(NAV_CMD_VTOL_LAND)}), -1);
+	EXPECT_TRUE(checker.finish());
+
+	// GIVEN: a second land start
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_DO_LAND_START), item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001),
+				 item(NAV_CMD_DO_LAND_START)}), 2);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: a RTL after the land start
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_DO_LAND_START), item(NAV_CMD_RETURN_TO_LAUNCH)}), 1);
+
+	// GIVEN: a land start after the landing approach
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_VTOL_LAND),
+				 item(NAV_CMD_DO_LAND_START)}), -1);
+	EXPECT_FALSE(checker.finish());
+}
+
+TEST_F(MissionFeasibilityCheckerTest, fixedWingLandingNeedsApproach)
+{
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_FIXED_WING, false, false);
+	MissionFeasibilityChecker checker(&navigator);
+
+	// GIVEN: the item before the landing has no position
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_DO_LAND_START),
+				 item(NAV_CMD_LAND)}), 2);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: a land start without any landing
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_DO_LAND_START),
+				 item(NAV_CMD_WAYPOINT, HOME_LAT + 0.002)}), -1);
+	EXPECT_FALSE(checker.finish());
+
+	// GIVEN: no landing at all and none required
+	ASSERT_TRUE(checker.begin(0.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_WAYPOINT, HOME_LAT + 0.002)}), -1);
+	EXPECT_TRUE(checker.finish());
+}
+
+TEST_F(MissionFeasibilityCheckerTest, waypointDistances)
+{
+	Navigator navigator;
+	setState(navigator, vehicle_status_s::VEHICLE_TYPE_ROTARY_WING, false, false);
+	MissionFeasibilityChecker checker(&navigator);
+
+	// GIVEN: the first waypoint is ~1.1 km from home
+	ASSERT_TRUE(checker.begin(900.f, 0.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_DO_CHANGE_SPEED), item(NAV_CMD_WAYPOINT, HOME_LAT + 0.01)}), 1);
+	EXPECT_TRUE(navigator.get_mission_result()->warning);
+
+	// GIVEN: two waypoints ~1.1 km apart
+	navigator.get_mission_result()->warning = false;
+	ASSERT_TRUE(checker.begin(0.f, 900.f, false));
+	EXPECT_EQ(feed(checker, {item(NAV_CMD_WAYPOINT, HOME_LAT + 0.001), item(NAV_CMD_WAYPOINT, HOME_LAT + 0.002),
+				 item(NAV_CMD_WAYPOINT, HOME_LAT + 0.012)}), 2);
+	EXPECT_TRUE(navigator.get_mission_result()->warning);
+}
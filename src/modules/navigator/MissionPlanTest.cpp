@@ -0,0 +1,322 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file MissionPlanTest.cpp
+ * Tests the compiled mission plan against an in-memory dataman.
+ */
+
+#include <gtest/gtest.h>
+#include "mission_plan.h"
+#include "mission_feasibility_checker.h"
+#include "navigation.h"
+#include "navigator.h"
+#include <drivers/drv_hrt.h>
+
+#include <float.h>
+#include <math.h>
+
+#include <vector>
+
+// to run: make tests TESTFILTER=MissionPlan
+
+// in-memory dataman, only the waypoint storage is backed
+static std::vector<mission_item_s> g_mission_items;
+static int g_dataman_requests = 0;
+
+extern "C" {
+	__EXPORT ssize_t dm_read(dm_item_t item, unsigned index, void *buffer, size_t buflen)
+	{
+		g_dataman_requests++;
+
+		if (index >= g_mission_items.size() || buflen != sizeof(mission_item_s)) {
+			return -1;
+		}
+
+		memcpy(buffer, &g_mission_items[index], buflen);
+		return buflen;
+	}
+
+	__EXPORT ssize_t dm_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buffer,
+				  size_t buflen)
+	{
+		g_dataman_requests++;
+
+		if (index >= g_mission_items.size() || buflen != sizeof(mission_item_s)) {
+			return -1;
+		}
+
+		memcpy(&g_mission_items[index], buffer, buflen);
+		return buflen;
+	}
+
+	__EXPORT ssize_t dm_read_range(dm_item_t item, unsigned index, unsigned count, void *buffer, size_t item_size)
+	{
+		g_dataman_requests++;
+
+		if (index + count > g_mission_items.size() || item_size != sizeof(mission_item_s)) {
+			return -1;
+		}
+
+		memcpy(buffer, &g_mission_items[index], count * item_size);
+		return count;
+	}
+
+	__EXPORT ssize_t dm_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence,
+					const void *buffer, size_t item_size) {return 0;}
+	__EXPORT int dm_lock(dm_item_t item) {return 0;}
+	__EXPORT int dm_trylock(dm_item_t item) {return 0;}
+	__EXPORT void dm_unlock(dm_item_t item) {}
+	__EXPORT int dm_clear(dm_item_t item) {return 0;}
+	__EXPORT int dm_restart(dm_reset_reason restart_type) {return 0;}
+}
+
+static mission_item_s waypoint(uint16_t nav_cmd, double lat, double lon, float altitude)
+{
+	mission_item_s item{};
+	item.nav_cmd = nav_cmd;
+	item.lat = lat;
+	item.lon = lon;
+	item.altitude = altitude;
+	item.altitude_is_relative = true;
+	return item;
+}
+
+static mission_s missionOf(const std::vector<mission_item_s> &items)
+{
+	g_mission_items = items;
+	g_dataman_requests = 0;
+
+	mission_s mission{};
+	mission.dataman_id = DM_KEY_WAYPOINTS_OFFBOARD_0;
+	mission.count = items.size();
+	return mission;
+}
+
+TEST(MissionPlanTest, emptyMission)
+{
+	MissionPlan plan;
+	EXPECT_TRUE(plan.build(missionOf({})));
+	EXPECT_EQ(plan.count(), 0);
+	EXPECT_FALSE(plan.landing(false).available);
+
+	mission_item_s item;
+	EXPECT_FALSE(plan.readItem(0, item));
+}
+
+TEST(MissionPlanTest, legsAndPositions)
+{
+	// a square with ~111 m sides, starting north bound
+	const mission_s mission = missionOf({
+		waypoint(NAV_CMD_TAKEOFF, 47.0, 8.0, 10.f),
+		waypoint(NAV_CMD_WAYPOINT, 47.001, 8.0, 20.f),
+		waypoint(NAV_CMD_DO_CHANGE_SPEED, 0.0, 0.0, 0.f),
+		waypoint(NAV_CMD_WAYPOINT, 47.001, 8.0 + 0.001 / cos(47.0 * M_PI / 180.0), 20.f),
+	});
+
+	MissionPlan plan;
+	ASSERT_TRUE(plan.build(mission));
+	ASSERT_TRUE(plan.entriesValid());
+	ASSERT_EQ(plan.count(), 4);
+
+	EXPECT_TRUE(plan.item(0).flags & MissionPlan::FLAG_POSITION);
+	EXPECT_FLOAT_EQ(plan.item(0).north, 0.f);
+	EXPECT_FLOAT_EQ(plan.item(0).leg_length, 0.f);
+
+	EXPECT_NEAR(plan.item(1).north, 111.2f, 0.5f);
+	EXPECT_NEAR(plan.item(1).leg_length, 111.2f, 0.5f);
+	EXPECT_NEAR(plan.item(1).leg_heading, 0.f, 1e-3f);
+
+	// items without position don't start a new leg
+	EXPECT_FALSE(plan.item(2).flags & MissionPlan::FLAG_POSITION);
+	EXPECT_NEAR(plan.item(3).leg_length, 111.2f, 0.5f);
+	EXPECT_NEAR(plan.item(3).leg_heading, M_PI_2, 1e-2f);
+	EXPECT_TRUE(plan.item(3).flags & MissionPlan::FLAG_ALTITUDE_RELATIVE);
+
+	float north = 0.f;
+	float east = 0.f;
+	ASSERT_TRUE(plan.project(47.001, 8.0, north, east));
+	EXPECT_NEAR(north, plan.item(1).north, 0.01f);
+	EXPECT_NEAR(east, plan.item(1).east, 0.01f);
+}
+
+TEST(MissionPlanTest, landingSequence)
+{
+	const mission_s mission = missionOf({
+		waypoint(NAV_CMD_TAKEOFF, 47.0, 8.0, 10.f),
+		waypoint(NAV_CMD_WAYPOINT, 47.001, 8.0, 20.f),
+		waypoint(NAV_CMD_DO_LAND_START, 0.0, 0.0, 0.f),
+		waypoint(NAV_CMD_WAYPOINT, 47.002, 8.0, 15.f),
+		waypoint(NAV_CMD_VTOL_LAND, 47.003, 8.0, 0.f),
+	});
+
+	MissionPlan plan;
+	ASSERT_TRUE(plan.build(mission));
+
+	// a multicopter or fixed wing doesn't consider the VTOL landing, but still the land start marker
+	const MissionPlan::Landing &landing = plan.landing(false);
+	EXPECT_TRUE(landing.available);
+	EXPECT_EQ(landing.land_start_index, 2);
+	EXPECT_DOUBLE_EQ(landing.start_lat, 47.002);
+	EXPECT_DOUBLE_EQ(landing.lat, 0.0);
+
+	const MissionPlan::Landing &landing_vtol = plan.landing(true);
+	EXPECT_TRUE(landing_vtol.available);
+	EXPECT_EQ(landing_vtol.land_start_index, 2);
+	EXPECT_DOUBLE_EQ(landing_vtol.start_lat, 47.002);
+	EXPECT_DOUBLE_EQ(landing_vtol.lat, 47.003);
+	EXPECT_TRUE(landing_vtol.alt_relative);
+}
+
+TEST(MissionPlanTest, readAheadAndWriteThrough)
+{
+	std::vector<mission_item_s> items;
+
+	for (int i = 0; i < 20; i++) {
+		items.push_back(waypoint(NAV_CMD_WAYPOINT, 47.0 + i * 1e-4, 8.0, 10.f));
+	}
+
+	items[5].nav_cmd = NAV_CMD_DO_JUMP;
+	items[5].do_jump_repeat_count = 3;
+
+	MissionPlan plan;
+	ASSERT_TRUE(plan.build(missionOf(items)));
+	EXPECT_TRUE(plan.item(5).flags & MissionPlan::FLAG_DO_JUMP);
+
+	// reading consecutive items is served by a single dataman request
+	g_dataman_requests = 0;
+	mission_item_s item;
+
+	for (int i = 4; i < 8; i++) {
+		ASSERT_TRUE(plan.readItem(i, item));
+		EXPECT_DOUBLE_EQ(item.lat, items[i].lat);
+	}
+
+	EXPECT_EQ(g_dataman_requests, 1);
+
+	// writes update the cached copy
+	ASSERT_TRUE(plan.readItem(5, item));
+	item.do_jump_current_count = 1;
+	ASSERT_TRUE(plan.writeItem(5, item));
+	EXPECT_EQ(g_mission_items[5].do_jump_current_count, 1);
+
+	ASSERT_TRUE(plan.readItem(5, item));
+	EXPECT_EQ(item.do_jump_current_count, 1);
+
+	EXPECT_FALSE(plan.readItem(20, item));
+
+	// a rebuild after reading the end of the mission starts with an empty cache
+	items.resize(10);
+	ASSERT_TRUE(plan.build(missionOf(items)));
+	ASSERT_TRUE(plan.readItem(0, item));
+	EXPECT_DOUBLE_EQ(item.lat, items[0].lat);
+}
+
+TEST(MissionPlanTest, largeMission)
+{
+	// survey pattern with 5000 waypoints
+	std::vector<mission_item_s> items;
+
+	for (int i = 0; i < 5000; i++) {
+		const int row = i / 50;
+		const int column = (row % 2 == 0) ? (i % 50) : (49 - i % 50);
+		items.push_back(waypoint(NAV_CMD_WAYPOINT, 47.0 + row * 2e-4, 8.0 + column * 2e-4, 30.f));
+	}
+
+	items.push_back(waypoint(NAV_CMD_LAND, 47.0, 8.0, 0.f));
+	const mission_s mission = missionOf(items);
+
+	MissionPlan plan;
+	ASSERT_TRUE(plan.build(mission));
+	EXPECT_EQ(plan.count(), 5001);
+	EXPECT_EQ(plan.landing(false).land_start_index, 5000);
+
+	// closest item search, as done when resuming a mission
+	float north = 0.f;
+	float east = 0.f;
+	ASSERT_TRUE(plan.project(47.0102, 8.005, north, east));
+
+	unsigned closest = 0;
+	float min_dist = FLT_MAX;
+
+	for (unsigned i = 0; i < plan.count(); i++) {
+		const float d_north = plan.item(i).north - north;
+		const float d_east = plan.item(i).east - east;
+		const float dist = d_north * d_north + d_east * d_east;
+
+		if (dist < min_dist) {
+			min_dist = dist;
+			closest = i;
+		}
+	}
+
+	// row 51 is flown westwards
+	EXPECT_EQ(closest, 51 * 50 + 24);
+}
+
+TEST(MissionPlanTest, checkedWhileBuilding)
+{
+	Navigator navigator;
+	home_position_s &home = *navigator.get_home_position();
+	home.timestamp = 1000;
+	home.lat = 47.0;
+	home.lon = 8.0;
+	home.alt = 488.f;
+	home.valid_alt = true;
+	home.valid_hpos = true;
+	navigator.get_vstatus()->vehicle_type = vehicle_status_s::VEHICLE_TYPE_ROTARY_WING;
+
+	std::vector<mission_item_s> items;
+
+	for (int i = 0; i < 20; i++) {
+		items.push_back(waypoint(NAV_CMD_WAYPOINT, 47.0 + i * 1e-4, 8.0, 10.f));
+	}
+
+	// WHEN: the plan is compiled and checked together
+	MissionPlan plan;
+	MissionFeasibilityChecker checker(&navigator);
+	EXPECT_TRUE(checker.checkMissionFeasible(missionOf(items), plan, 0.f, 0.f, false, true));
+
+	// THEN: the mission is read once, one read-ahead request per 8 items
+	EXPECT_EQ(plan.count(), 20);
+	EXPECT_EQ(g_dataman_requests, 3);
+
+	// WHEN: an item is not supported
+	items[10].nav_cmd = NAV_CMD_INVALID;
+
+	// THEN: the mission is rejected, but the plan is still compiled completely
+	EXPECT_FALSE(checker.checkMissionFeasible(missionOf(items), plan, 0.f, 0.f, false, true));
+	EXPECT_EQ(plan.count(), 20);
+	EXPECT_TRUE(plan.item(19).flags & MissionPlan::FLAG_POSITION);
+	EXPECT_EQ(g_dataman_requests, 3);
+}
@@ -50,8 +50,14 @@
 
 #include "navigator.h"
 
+using namespace time_literals;
+
 #define GEOFENCE_RANGE_WARNING_LIMIT 5000000
 
+static constexpr int GEOFENCE_INDEX_MIN_VERTICES = 16; ///< smaller polygons are checked with a linear scan over all edges
+static constexpr int GEOFENCE_INDEX_MAX_SLABS = 1024;
+static constexpr int GEOFENCE_INDEX_MAX_EDGES_PER_VERTEX = 8; ///< bounds the memory of the edge index
+
 Geofence::Geofence(Navigator *navigator) :
 	ModuleParams(navigator),
 	_navigator(navigator),
@@ -65,9 +71,7 @@ Geofence::Geofence(Navigator *navigator) :
 
 Geofence::~Geofence()
 {
-	if (_polygons) {
-		delete[](_polygons);
-	}
+	_clearCache();
 }
 
 void Geofence::updateFence()
@@ -99,7 +103,9 @@ void Geofence::_updateFence()
 	}
 
 	// iterate over all polygons and store their starting vertices
-	_num_polygons = 0;
+	_clearCache();
+	_load_failed = false;
+	_last_load_attempt = hrt_absolute_time();
 	int current_seq = 1;
 
 	while (current_seq <= num_fence_items) {
@@ -108,8 +114,9 @@ void Geofence::_updateFence()
 
 		if (dm_read(DM_KEY_FENCE_POINTS, current_seq, &mission_fence_point, sizeof(mission_fence_point_s)) !=
 		    sizeof(mission_fence_point_s)) {
-			PX4_ERR("dm_read failed");
-			break;
+			PX4_ERR("dm_read failed, rejecting all positions until the fence is loaded");
+			_load_failed = true;
+			return;
 		}
 
 		switch (mission_fence_point.nav_cmd) {
@@ -147,7 +154,8 @@ void Geofence::_updateFence()
 
 				if (!_polygons) {
 					_num_polygons = 0;
-					PX4_ERR("alloc failed");
+					PX4_ERR("alloc failed, rejecting all positions until the fence is loaded");
+					_load_failed = true;
 					return;
 				}
 
@@ -177,6 +185,252 @@ void Geofence::_updateFence()
 
 	}
 
+	if (!_loadVertices()) {
+		PX4_ERR("loading fence vertices failed, rejecting all positions until the fence is loaded");
+		_load_failed = true;
+		return;
+	}
+
+	_buildIndex();
+}
+
+bool Geofence::_loadVertices()
+{
+	int num_vertices = 0;
+
+	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+		const PolygonInfo &polygon = _polygons[polygon_idx];
+		const bool is_circle_area = polygon.fence_type == NAV_CMD_FENCE_CIRCLE_INCLUSION
+					    || polygon.fence_type == NAV_CMD_FENCE_CIRCLE_EXCLUSION;
+		num_vertices += is_circle_area ? 1 : polygon.vertex_count;
+	}
+
+	if (num_vertices == 0) {
+		return true;
+	}
+
+	_vertices = new Vertex[num_vertices];
+
+	if (!_vertices) {
+		PX4_ERR("alloc failed");
+		return false;
+	}
+
+	_num_vertices = 0;
+
+	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+		PolygonInfo &polygon = _polygons[polygon_idx];
+		const bool is_circle_area = polygon.fence_type == NAV_CMD_FENCE_CIRCLE_INCLUSION
+					    || polygon.fence_type == NAV_CMD_FENCE_CIRCLE_EXCLUSION;
+		const int count = is_circle_area ? 1 : polygon.vertex_count;
+
+		polygon.vertex_index = _num_vertices;
+		polygon.valid = true;
+
+		// read the vertices in chunks, a single dataman request each
+		mission_fence_point_s fence_points[8];
+		int chunk_start = 0;
+		int chunk_count = 0;
+
+		for (int i = 0; i < count; ++i) {
+			if (i >= chunk_start + chunk_count) {
+				chunk_start = i;
+				chunk_count = math::min(count - i, (int)(sizeof(fence_points) / sizeof(fence_points[0])));
+
+				if (dm_read_range(DM_KEY_FENCE_POINTS, polygon.dataman_index + i, chunk_count, fence_points,
+						  sizeof(mission_fence_point_s)) != chunk_count) {
+					PX4_ERR("dm_read_range failed");
+					return false;
+				}
+			}
+
+			const mission_fence_point_s &mission_fence_point = fence_points[i - chunk_start];
+
+			if (mission_fence_point.frame != NAV_FRAME_GLOBAL && mission_fence_point.frame != NAV_FRAME_GLOBAL_INT
+			    && mission_fence_point.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
+			    && mission_fence_point.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
+				// TODO: handle different frames
+				PX4_ERR("Frame type %i not supported", (int)mission_fence_point.frame);
+				polygon.valid = false;
+			}
+
+			_vertices[_num_vertices].lat = mission_fence_point.lat;
+			_vertices[_num_vertices].lon = mission_fence_point.lon;
+			++_num_vertices;
+		}
+	}
+
+	return true;
+}
+
+static inline int slabOf(double lon, double lon_min, double slab_scale, int slab_count)
+{
+	return math::constrain((int)((lon - lon_min) * slab_scale), 0, slab_count - 1);
+}
+
+void Geofence::_buildIndex()
+{
+	delete[] _slab_offsets;
+	_slab_offsets = nullptr;
+	delete[] _slab_edges;
+	_slab_edges = nullptr;
+	_num_slab_edges = 0;
+
+	// The edge index splits the bounding box of a polygon into slabs of equal longitude width. Every slab
+	// lists the edges overlapping it in longitude, so that a point only needs to be tested against the edges
+	// of the slab it lies in. The crossing test is the same as for the linear scan, so the result is identical.
+	uint32_t num_offsets = 0;
+
+	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+		PolygonInfo &polygon = _polygons[polygon_idx];
+		polygon.slab_count = 0;
+		polygon.slab_index = 0;
+
+		if (polygon.fence_type != NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION
+		    && polygon.fence_type != NAV_CMD_FENCE_POLYGON_VERTEX_EXCLUSION) {
+			continue;
+		}
+
+		const Vertex *vertices = &_vertices[polygon.vertex_index];
+		polygon.lat_min = polygon.lat_max = vertices[0].lat;
+		polygon.lon_min = polygon.lon_max = vertices[0].lon;
+
+		for (unsigned i = 1; i < polygon.vertex_count; ++i) {
+			polygon.lat_min = math::min(polygon.lat_min, vertices[i].lat);
+			polygon.lat_max = math::max(polygon.lat_max, vertices[i].lat);
+			polygon.lon_min = math::min(polygon.lon_min, vertices[i].lon);
+			polygon.lon_max = math::max(polygon.lon_max, vertices[i].lon);
+		}
+
+		if (polygon.vertex_count < GEOFENCE_INDEX_MIN_VERTICES || !(polygon.lon_max > polygon.lon_min)) {
+			continue;
+		}
+
+		// reduce the number of slabs until the index fits into its memory bound
+		const uint32_t max_edges = (uint32_t)polygon.vertex_count * GEOFENCE_INDEX_MAX_EDGES_PER_VERTEX;
+		int slab_count = math::min(polygon.vertex_count / 2, GEOFENCE_INDEX_MAX_SLABS);
+		uint32_t num_edges = 0;
+
+		while (slab_count > 1) {
+			const double slab_scale = slab_count / (polygon.lon_max - polygon.lon_min);
+			num_edges = 0;
+
+			for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
+				const double lon_low = math::min(vertices[i].lon, vertices[j].lon);
+				const double lon_high = math::max(vertices[i].lon, vertices[j].lon);
+				num_edges += slabOf(lon_high, polygon.lon_min, slab_scale, slab_count)
+					     - slabOf(lon_low, polygon.lon_min, slab_scale, slab_count) + 1;
+			}
+
+			if (num_edges <= max_edges) {
+				polygon.slab_count = slab_count;
+				polygon.slab_scale = slab_scale;
+				polygon.slab_index = num_offsets;
+				num_offsets += slab_count + 1;
+				_num_slab_edges += num_edges;
+				break;
+			}
+
+			slab_count /= 2;
+		}
+	}
+
+	if (num_offsets == 0) {
+		return;
+	}
+
+	_slab_offsets = new uint32_t[num_offsets];
+	_slab_edges = new uint16_t[_num_slab_edges];
+
+	if (!_slab_offsets || !_slab_edges) {
+		PX4_ERR("alloc failed");
+		delete[] _slab_offsets;
+		_slab_offsets = nullptr;
+		delete[] _slab_edges;
+		_slab_edges = nullptr;
+		_num_slab_edges = 0;
+
+		// fall back to the linear scan
+		for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+			_polygons[polygon_idx].slab_count = 0;
+		}
+
+		return;
+	}
+
+	uint32_t edge_start = 0;
+
+	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+		const PolygonInfo &polygon = _polygons[polygon_idx];
+
+		if (polygon.slab_count == 0) {
+			continue;
+		}
+
+		const Vertex *vertices = &_vertices[polygon.vertex_index];
+		uint32_t *offsets = &_slab_offsets[polygon.slab_index];
+
+		// count the edges per slab, then turn the counts into start offsets
+		for (int s = 0; s <= polygon.slab_count; ++s) {
+			offsets[s] = 0;
+		}
+
+		for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
+			const int slab_low = slabOf(math::min(vertices[i].lon, vertices[j].lon), polygon.lon_min, polygon.slab_scale,
+						    polygon.slab_count);
+			const int slab_high = slabOf(math::max(vertices[i].lon, vertices[j].lon), polygon.lon_min, polygon.slab_scale,
+						     polygon.slab_count);
+
+			for (int s = slab_low; s <= slab_high; ++s) {
+				++offsets[s + 1];
+			}
+		}
+
+		const uint32_t polygon_edge_start = edge_start;
+		offsets[0] = polygon_edge_start;
+
+		for (int s = 1; s <= polygon.slab_count; ++s) {
+			offsets[s] += offsets[s - 1];
+		}
+
+		edge_start = offsets[polygon.slab_count];
+
+		// fill in the edges, using offsets[s] as insertion cursor of slab s
+		for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
+			const int slab_low = slabOf(math::min(vertices[i].lon, vertices[j].lon), polygon.lon_min, polygon.slab_scale,
+						    polygon.slab_count);
+			const int slab_high = slabOf(math::max(vertices[i].lon, vertices[j].lon), polygon.lon_min, polygon.slab_scale,
+						     polygon.slab_count);
+
+			for (int s = slab_low; s <= slab_high; ++s) {
+				_slab_edges[offsets[s]++] = i;
+			}
+		}
+
+		// the cursors now point to the end of each slab, shift them back to the start
+		for (int s = polygon.slab_count; s > 0; --s) {
+			offsets[s] = offsets[s - 1];
+		}
+
+		offsets[0] = polygon_edge_start;
+	}
+}
+
+void Geofence::_clearCache()
+{
+	delete[] _polygons;
+	_polygons = nullptr;
+	_num_polygons = 0;
+
+	delete[] _vertices;
+	_vertices = nullptr;
+	_num_vertices = 0;
+
+	delete[] _slab_offsets;
+	_slab_offsets = nullptr;
+	delete[] _slab_edges;
+	_slab_edges = nullptr;
+	_num_slab_edges = 0;
 }
 
 bool Geofence::checkAll(const struct vehicle_global_position_s &global_position)
@@ -305,8 +559,8 @@ bool Geofence::checkAll(double lat, double lon, float altitude)
 
 bool Geofence::isInsidePolygonOrCircle(double lat, double lon, float altitude)
 {
-	// the following uses dm_read, so first we try to lock all items. If that fails, it (most likely) means
-	// the data is currently being updated (via a mavlink geofence transfer), and we do not check for a violation now
+	// the fence might currently be updated (via a mavlink geofence transfer), so first we try to lock all items.
+	// If that fails, we do not check for a violation now
 	if (dm_trylock(DM_KEY_FENCE_POINTS) != 0) {
 		return true;
 	}
@@ -315,12 +569,27 @@ bool Geofence::isInsidePolygonOrCircle(double lat, double lon, float altitude)
 	mission_stats_entry_s stats;
 	int ret = dm_read(DM_KEY_FENCE_POINTS, 0, &stats, sizeof(mission_stats_entry_s));
 
-	if (ret == sizeof(mission_stats_entry_s) && _update_counter != stats.update_counter) {
+	// retry a failed load, but not on every check
+	const bool retry_load = _load_failed && (hrt_elapsed_time(&_last_load_attempt) > 1_s);
+
+	if (ret == sizeof(mission_stats_entry_s) && (_update_counter != stats.update_counter || retry_load)) {
 		_updateFence();
 	}
 
+	dm_unlock(DM_KEY_FENCE_POINTS);
+
+	// the fence geometry is cached, no further dataman access is needed
+	return checkPolygons(lat, lon, altitude);
+}
+
+bool Geofence::checkPolygons(double lat, double lon, float altitude)
+{
+	if (_load_failed) {
+		/* Fence could not be read from dataman -> fail closed */
+		return false;
+	}
+
 	if (isEmpty()) {
-		dm_unlock(DM_KEY_FENCE_POINTS);
 		/* Empty fence -> accept all points */
 		return true;
 	}
@@ -328,7 +597,6 @@ bool Geofence::isInsidePolygonOrCircle(double lat, double lon, float altitude)
 	/* Vertical check */
 	if (_altitude_max > _altitude_min) { // only enable vertical check if configured properly
 		if (altitude > _altitude_max || altitude < _altitude_min) {
-			dm_unlock(DM_KEY_FENCE_POINTS);
 			return false;
 		}
 	}
@@ -374,8 +642,6 @@ bool Geofence::isInsidePolygonOrCircle(double lat, double lon, float altitude)
 		}
 	}
 
-	dm_unlock(DM_KEY_FENCE_POINTS);
-
 	return (!had_inclusion_areas || inside_inclusion) && outside_exclusion;
 }
 
@@ -388,33 +654,43 @@ bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon,
 	 * Only supports non-complex polygons (not self intersecting)
 	 */
 
-	mission_fence_point_s temp_vertex_i;
-	mission_fence_point_s temp_vertex_j;
+	if (!polygon.valid) {
+		return false;
+	}
+
+	// no edge can be crossed from outside of the bounding box
+	if (lat < polygon.lat_min || lat > polygon.lat_max || lon < polygon.lon_min || lon > polygon.lon_max) {
+		return false;
+	}
+
+	const Vertex *vertices = &_vertices[polygon.vertex_index];
+
+	auto crosses = [&](unsigned i, unsigned j) {
+		return (vertices[i].lon >= lon) != (vertices[j].lon >= lon) &&
+		       (lat <= (vertices[j].lat - vertices[i].lat) * (lon - vertices[i].lon) /
+			(vertices[j].lon - vertices[i].lon) + vertices[i].lat);
+	};
+
 	bool c = false;
 
-	for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + i, &temp_vertex_i,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
+	if (polygon.slab_count > 0) {
+		// only test the edges overlapping the longitude slab of the point
+		const int slab = slabOf(lon, polygon.lon_min, polygon.slab_scale, polygon.slab_count);
+		const uint32_t *offsets = &_slab_offsets[polygon.slab_index];
 
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + j, &temp_vertex_j,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
+		for (uint32_t k = offsets[slab]; k < offsets[slab + 1]; ++k) {
+			const unsigned i = _slab_edges[k];
 
-		if (temp_vertex_i.frame != NAV_FRAME_GLOBAL && temp_vertex_i.frame != NAV_FRAME_GLOBAL_INT
-		    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
-		    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-			// TODO: handle different frames
-			PX4_ERR("Frame type %i not supported", (int)temp_vertex_i.frame);
-			break;
+			if (crosses(i, (i == 0) ? polygon.vertex_count - 1 : i - 1)) {
+				c = !c;
+			}
 		}
 
-		if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
-		    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
-		     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
-			c = !c;
+	} else {
+		for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
+			if (crosses(i, j)) {
+				c = !c;
+			}
 		}
 	}
 
@@ -423,22 +699,11 @@ bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon,
 
 bool Geofence::insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude)
 {
-
-	mission_fence_point_s circle_point;
-
-	if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index, &circle_point,
-		    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-		PX4_ERR("dm_read failed");
+	if (!polygon.valid) {
 		return false;
 	}
 
-	if (circle_point.frame != NAV_FRAME_GLOBAL && circle_point.frame != NAV_FRAME_GLOBAL_INT
-	    && circle_point.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
-	    && circle_point.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-		// TODO: handle different frames
-		PX4_ERR("Frame type %i not supported", (int)circle_point.frame);
-		return false;
-	}
+	const Vertex &circle_center = _vertices[polygon.vertex_index];
 
 	if (!map_projection_initialized(&_projection_reference)) {
 		map_projection_init(&_projection_reference, lat, lon);
@@ -446,9 +711,9 @@ bool Geofence::insideCircle(const PolygonInfo &polygon, double lat, double lon,
 
 	float x1, y1, x2, y2;
 	map_projection_project(&_projection_reference, lat, lon, &x1, &y1);
-	map_projection_project(&_projection_reference, circle_point.lat, circle_point.lon, &x2, &y2);
+	map_projection_project(&_projection_reference, circle_center.lat, circle_center.lon, &x2, &y2);
 	float dx = x1 - x2, dy = y1 - y2;
-	return dx * dx + dy * dy < circle_point.circle_radius * circle_point.circle_radius;
+	return dx * dx + dy * dy < polygon.circle_radius * polygon.circle_radius;
 }
 
 bool
@@ -628,4 +893,5 @@ void Geofence::printStatus()
 	PX4_INFO("Geofence: %i inclusion, %i exclusion polygons, %i inclusion, %i exclusion circles, %i total vertices",
 		 num_inclusion_polygons, num_exclusion_polygons, num_inclusion_circles, num_exclusion_circles,
 		 total_num_vertices);
+	PX4_INFO("Geofence: %i cached vertices, %u indexed edges", _num_vertices, (unsigned)_num_slab_edges);
 }
@@ -153,15 +153,7 @@ public:
 	 */
 	void printStatus();
 
-private:
-	Navigator	*_navigator{nullptr};
-
-	hrt_abstime _last_horizontal_range_warning{0};
-	hrt_abstime _last_vertical_range_warning{0};
-
-	float _altitude_min{0.0f};
-	float _altitude_max{0.0f};
-
+protected:
 	struct PolygonInfo {
 		uint16_t fence_type; ///< one of MAV_CMD_NAV_FENCE_* (can also be a circular region)
 		uint16_t dataman_index;
@@ -169,30 +161,41 @@ private:
 			uint16_t vertex_count;
 			float circle_radius;
 		};
+		uint16_t vertex_index; ///< index of the first vertex (or the circle center) in _vertices
+		bool valid; ///< false if the area uses an unsupported frame
+		double lat_min, lat_max, lon_min, lon_max; ///< bounding box (polygons only)
+		uint16_t slab_count; ///< number of longitude slabs of the edge index, 0 if not indexed
+		uint32_t slab_index; ///< index of the first slab offset in _slab_offsets
+		double slab_scale; ///< slabs per degree longitude
 	};
+
+	struct Vertex {
+		double lat;
+		double lon;
+	};
+
 	PolygonInfo *_polygons{nullptr};
 	int _num_polygons{0};
 
-	map_projection_reference_s _projection_reference = {}; ///< reference to convert (lon, lat) to local [m]
+	Vertex *_vertices{nullptr}; ///< RAM copy of the fence vertices, so that checks do not need dataman
+	int _num_vertices{0};
 
-	DEFINE_PARAMETERS(
-		(ParamInt<px4::params::GF_ACTION>) _param_gf_action,
-		(ParamInt<px4::params::GF_ALTMODE>) _param_gf_altmode,
-		(ParamInt<px4::params::GF_SOURCE>) _param_gf_source,
-		(ParamInt<px4::params::GF_COUNT>) _param_gf_count,
-		(ParamFloat<px4::params::GF_MAX_HOR_DIST>) _param_gf_max_hor_dist,
-		(ParamFloat<px4::params::GF_MAX_VER_DIST>) _param_gf_max_ver_dist
-	)
+	uint32_t *_slab_offsets{nullptr}; ///< per slab: start of its edges in _slab_edges (slab_count + 1 entries per polygon)
+	uint16_t *_slab_edges{nullptr}; ///< edges overlapping a slab (edge i connects vertex i-1 and i)
+	uint32_t _num_slab_edges{0};
 
-	uORB::SubscriptionData<vehicle_air_data_s>	_sub_airdata;
+	float _altitude_min{0.0f};
+	float _altitude_max{0.0f};
 
-	int _outside_counter{0};
-	uint16_t _update_counter{0}; ///< dataman update counter: if it does not match, we polygon data was updated
+	/**
+	 * Build the bounding boxes and the edge index from _polygons and _vertices
+	 */
+	void _buildIndex();
 
 	/**
-	 * implementation of updateFence(), but without locking
+	 * Free the cached fence geometry
 	 */
-	void _updateFence();
+	void _clearCache();
 
 	/**
 	 * Check if a point passes the Geofence test.
@@ -206,11 +209,6 @@ private:
 	 */
 	bool checkPolygons(double lat, double lon, float altitude);
 
-
-
-	bool checkAll(const vehicle_global_position_s &global_position);
-	bool checkAll(const vehicle_global_position_s &global_position, float baro_altitude_amsl);
-
 	/**
 	 * Check if a single point is within a polygon
 	 * @return true if within polygon
@@ -223,4 +221,42 @@ private:
 	 * @return true if within polygon the circle
 	 */
 	bool insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude);
+
+private:
+	Navigator	*_navigator{nullptr};
+
+	hrt_abstime _last_horizontal_range_warning{0};
+	hrt_abstime _last_vertical_range_warning{0};
+
+	map_projection_reference_s _projection_reference = {}; ///< reference to convert (lon, lat) to local [m]
+
+	DEFINE_PARAMETERS(
+		(ParamInt<px4::params::GF_ACTION>) _param_gf_action,
+		(ParamInt<px4::params::GF_ALTMODE>) _param_gf_altmode,
+		(ParamInt<px4::params::GF_SOURCE>) _param_gf_source,
+		(ParamInt<px4::params::GF_COUNT>) _param_gf_count,
+		(ParamFloat<px4::params::GF_MAX_HOR_DIST>) _param_gf_max_hor_dist,
+		(ParamFloat<px4::params::GF_MAX_VER_DIST>) _param_gf_max_ver_dist
+	)
+
+	uORB::SubscriptionData<vehicle_air_data_s>	_sub_airdata;
+
+	int _outside_counter{0};
+	uint16_t _update_counter{0}; ///< dataman update counter: if it does not match, we polygon data was updated
+	bool _load_failed{false}; ///< the fence could not be read from dataman, all positions are rejected
+	hrt_abstime _last_load_attempt{0};
+
+	/**
+	 * implementation of updateFence(), but without locking
+	 */
+	void _updateFence();
+
+	/**
+	 * Read the vertices of all areas from dataman into _vertices
+	 * @return false on a read or allocation failure
+	 */
+	bool _loadVertices();
+
+	bool checkAll(const vehicle_global_position_s &global_position);
+	bool checkAll(const vehicle_global_position_s &global_position, float baro_altitude_amsl);
 };
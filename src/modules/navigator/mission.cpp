@@ -120,6 +120,8 @@ Mission::on_inactive()
 			_mission.count = mission_state.count;
 			_current_mission_index = mission_state.current_seq;
 
+			_plan.build(_mission);
+
 			// find and store landing start marker (if available)
 			find_mission_land_start();
 		}
@@ -389,57 +391,20 @@ Mission::find_mission_land_start()
 	 *  return false if not found
 	 */
 
-	const dm_item_t dm_current = (dm_item_t)_mission.dataman_id;
-	struct mission_item_s missionitem = {};
-	struct mission_item_s missionitem_prev = {}; //to store mission item before currently checked on, needed to get pos of wp before NAV_CMD_DO_LAND_START
-
-	_land_start_available = false;
-
-	bool found_land_start_marker = false;
-
-	for (size_t i = 1; i < _mission.count; i++) {
-		const ssize_t len = sizeof(missionitem);
-		missionitem_prev = missionitem; // store the last mission item before reading a new one
-
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			PX4_ERR("dataman read failure");
-			break;
-		}
-
-		if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
-			found_land_start_marker = true;
-			_land_start_index = i;
-		}
+	const MissionPlan::Landing &landing = _plan.landing(_navigator->get_vstatus()->is_vtol);
+	const float home_alt = _navigator->get_home_position()->alt;
 
-		if (found_land_start_marker && !_land_start_available && i > _land_start_index
-		    && item_contains_position(missionitem)) {
-			// use the position of any waypoint after the land start marker which specifies a position.
-			_landing_start_lat = missionitem.lat;
-			_landing_start_lon = missionitem.lon;
-			_landing_start_alt = missionitem.altitude_is_relative ?	missionitem.altitude +
-					     _navigator->get_home_position()->alt : missionitem.altitude;
-			_land_start_available = true;
-		}
+	_land_start_available = landing.available;
 
-		if (((missionitem.nav_cmd == NAV_CMD_VTOL_LAND) && _navigator->get_vstatus()->is_vtol) ||
-		    (missionitem.nav_cmd == NAV_CMD_LAND)) {
-
-			_landing_lat = missionitem.lat;
-			_landing_lon = missionitem.lon;
-			_landing_alt = missionitem.altitude_is_relative ?	missionitem.altitude + _navigator->get_home_position()->alt :
-				       missionitem.altitude;
-
-			// don't have a valid land start yet, use the landing item itself then
-			if (!_land_start_available) {
-				_land_start_index = i;
-				_landing_start_lat = _landing_lat;
-				_landing_start_lon = _landing_lon;
-				_landing_start_alt = _landing_alt;
-				_land_start_available = true;
-			}
+	if (landing.available) {
+		_land_start_index = landing.land_start_index;
+		_landing_start_lat = landing.start_lat;
+		_landing_start_lon = landing.start_lon;
+		_landing_start_alt = landing.start_alt_relative ? landing.start_alt + home_alt : landing.start_alt;
 
-		}
+		_landing_lat = landing.lat;
+		_landing_lon = landing.lon;
+		_landing_alt = landing.alt_relative ? landing.alt + home_alt : landing.alt;
 	}
 
 	return _land_start_available;
@@ -508,7 +473,7 @@ Mission::update_mission()
 			/* otherwise, just leave it */
 		}
 
-		check_mission_valid(true);
+		check_mission_valid(true, true);
 
 		failed = !_navigator->get_mission_result()->valid;
 
@@ -547,6 +512,7 @@ Mission::update_mission()
 		_mission.count = 0;
 		_mission.current_seq = 0;
 		_current_mission_index = 0;
+		_plan.reset();
 	}
 
 	// find and store landing start marker (if available)
@@ -575,13 +541,19 @@ Mission::advance_mission()
 
 		case mission_result_s::MISSION_EXECUTION_MODE_REVERSE: {
 				// find next position item in reverse order
-				dm_item_t dm_current = (dm_item_t)(_mission.dataman_id);
-
 				for (int32_t i = _current_mission_index - 1; i >= 0; i--) {
+					if (_plan.entriesValid()) {
+						if (_plan.item(i).flags & MissionPlan::FLAG_POSITION) {
+							_current_mission_index = i;
+							return;
+						}
+
+						continue;
+					}
+
 					struct mission_item_s missionitem = {};
-					const ssize_t len = sizeof(missionitem);
 
-					if (dm_read(dm_current, i, &missionitem, len) != len) {
+					if (!_plan.readItem(i, missionitem)) {
 						/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 						PX4_ERR("dataman read failure");
 						break;
@@ -1506,7 +1478,6 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 	int index_to_read = current_index + offset;
 
 	int *mission_index_ptr = (offset == 0) ? &_current_mission_index : &index_to_read;
-	const dm_item_t dm_item = (dm_item_t)_mission.dataman_id;
 
 	/* do not work on empty missions */
 	if (_mission.count == 0) {
@@ -1526,13 +1497,11 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 			return false;
 		}
 
-		const ssize_t len = sizeof(struct mission_item_s);
-
 		/* read mission item to temp storage first to not overwrite current mission item if data damaged */
 		struct mission_item_s mission_item_tmp;
 
-		/* read mission item from datamanager */
-		if (dm_read(dm_item, *mission_index_ptr, &mission_item_tmp, len) != len) {
+		/* read mission item from the plan, which reads ahead from the datamanager */
+		if (!_plan.readItem(*mission_index_ptr, mission_item_tmp)) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Waypoint could not be read.");
 			return false;
@@ -1551,7 +1520,7 @@ Mission::read_mission_item(int offset, struct mission_item_s *mission_item)
 					(mission_item_tmp.do_jump_current_count)++;
 
 					/* save repeat count */
-					if (dm_write(dm_item, *mission_index_ptr, DM_PERSIST_POWER_ON_RESET, &mission_item_tmp, len) != len) {
+					if (!_plan.writeItem(*mission_index_ptr, mission_item_tmp)) {
 						/* not supposed to happen unless the datamanager can't access the dataman */
 						mavlink_log_critical(_navigator->get_mavlink_log_pub(), "DO JUMP waypoint could not be written.");
 						return false;
@@ -1681,17 +1650,17 @@ Mission::set_current_mission_item()
 }
 
 void
-Mission::check_mission_valid(bool force)
+Mission::check_mission_valid(bool force, bool build_plan)
 {
 	if ((!_home_inited && _navigator->home_position_valid()) || force) {
 
 		MissionFeasibilityChecker _missionFeasibilityChecker(_navigator);
 
 		_navigator->get_mission_result()->valid =
-			_missionFeasibilityChecker.checkMissionFeasible(_mission,
+			_missionFeasibilityChecker.checkMissionFeasible(_mission, _plan,
 					_param_mis_dist_1wp.get(),
 					_param_mis_dist_wps.get(),
-					_navigator->mission_landing_required());
+					_navigator->mission_landing_required(), build_plan);
 
 		_navigator->get_mission_result()->seq_total = _mission.count;
 		_navigator->increment_mission_instance_count();
@@ -1717,7 +1686,15 @@ Mission::reset_mission(struct mission_s &mission)
 			if (mission.count > 0) {
 				const dm_item_t dm_current = (dm_item_t)mission.dataman_id;
 
+				// the plan knows where the DO_JUMP items are if it was compiled from this mission
+				const bool use_plan = _plan.entriesValid() && _plan.count() == mission.count
+						      && _plan.datamanId() == dm_current;
+
 				for (unsigned index = 0; index < mission.count; index++) {
+					if (use_plan && !(_plan.item(index).flags & MissionPlan::FLAG_DO_JUMP)) {
+						continue;
+					}
+
 					struct mission_item_s item;
 					const ssize_t len = sizeof(struct mission_item_s);
 
@@ -1777,38 +1754,70 @@ Mission::generate_waypoint_from_heading(struct position_setpoint_s *setpoint, fl
 }
 
 int32_t
-Mission::index_closest_mission_item() const
+Mission::index_closest_mission_item()
 {
 	int32_t min_dist_index(0);
 	float min_dist(FLT_MAX), dist_xy(FLT_MAX), dist_z(FLT_MAX);
 
-	dm_item_t dm_current = (dm_item_t)(_mission.dataman_id);
+	const bool fixed_wing = _navigator->get_vstatus()->vehicle_type == vehicle_status_s::VEHICLE_TYPE_FIXED_WING
+				&& !_navigator->get_vstatus()->is_vtol;
 
-	for (size_t i = 0; i < _mission.count; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(missionitem);
+	if (_plan.entriesValid()) {
+		// use the local positions of the compiled plan
+		float north = 0.f;
+		float east = 0.f;
 
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			PX4_ERR("dataman read failure");
-			break;
-		}
+		// no reference means there's no position item at all
+		const bool has_reference = _plan.project(_navigator->get_global_position()->lat,
+					   _navigator->get_global_position()->lon, north, east);
+
+		const float home_alt = _navigator->get_home_position()->alt;
+		const float alt = _navigator->get_global_position()->alt;
+
+		for (unsigned i = 0; has_reference && i < _plan.count(); i++) {
+			const MissionPlan::Item &item = _plan.item(i);
 
-		if (item_contains_position(missionitem)) {
 			// do not consider land waypoints for a fw
-			if (!((missionitem.nav_cmd == NAV_CMD_LAND) &&
-			      (_navigator->get_vstatus()->vehicle_type == vehicle_status_s::VEHICLE_TYPE_FIXED_WING) &&
-			      (!_navigator->get_vstatus()->is_vtol))) {
-				float dist = get_distance_to_point_global_wgs84(missionitem.lat, missionitem.lon,
-						get_absolute_altitude_for_item(missionitem),
-						_navigator->get_global_position()->lat,
-						_navigator->get_global_position()->lon,
-						_navigator->get_global_position()->alt,
-						&dist_xy, &dist_z);
-
-				if (dist < min_dist) {
-					min_dist = dist;
-					min_dist_index = i;
+			if (!(item.flags & MissionPlan::FLAG_POSITION) || (item.nav_cmd == NAV_CMD_LAND && fixed_wing)) {
+				continue;
+			}
+
+			const float item_alt = (item.flags & MissionPlan::FLAG_ALTITUDE_RELATIVE) ? item.altitude + home_alt : item.altitude;
+			const float d_north = item.north - north;
+			const float d_east = item.east - east;
+			const float d_alt = item_alt - alt;
+			const float dist = sqrtf(d_north * d_north + d_east * d_east + d_alt * d_alt);
+
+			if (dist < min_dist) {
+				min_dist = dist;
+				min_dist_index = i;
+			}
+		}
+
+	} else {
+		for (size_t i = 0; i < _mission.count; i++) {
+			struct mission_item_s missionitem = {};
+
+			if (!_plan.readItem(i, missionitem)) {
+				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
+				PX4_ERR("dataman read failure");
+				break;
+			}
+
+			if (item_contains_position(missionitem)) {
+				// do not consider land waypoints for a fw
+				if (!((missionitem.nav_cmd == NAV_CMD_LAND) && fixed_wing)) {
+					float dist = get_distance_to_point_global_wgs84(missionitem.lat, missionitem.lon,
+							get_absolute_altitude_for_item(missionitem),
+							_navigator->get_global_position()->lat,
+							_navigator->get_global_position()->lon,
+							_navigator->get_global_position()->alt,
+							&dist_xy, &dist_z);
+
+					if (dist < min_dist) {
+						min_dist = dist;
+						min_dist_index = i;
+					}
 				}
 			}
 		}
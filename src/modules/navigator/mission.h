@@ -46,6 +46,7 @@
 
 #include "mission_block.h"
 #include "mission_feasibility_checker.h"
+#include "mission_plan.h"
 #include "navigator_mode.h"
 
 #include <float.h>
@@ -205,8 +206,9 @@ private:
 
 	/**
 	 * Check whether a mission is ready to go
+	 * @param build_plan compile _plan for the updated mission in the same pass
 	 */
-	void check_mission_valid(bool force);
+	void check_mission_valid(bool force, bool build_plan = false);
 
 	/**
 	 * Reset mission
@@ -231,7 +233,7 @@ private:
 	/**
 	 * Return the index of the closest mission item to the current global position.
 	 */
-	int32_t index_closest_mission_item() const;
+	int32_t index_closest_mission_item();
 
 	bool position_setpoint_equal(const position_setpoint_s *p1, const position_setpoint_s *p2) const;
 
@@ -247,6 +249,7 @@ private:
 
 	uORB::Subscription	_mission_sub{ORB_ID(mission)};		/**< mission subscription */
 	mission_s		_mission {};
+	MissionPlan		_plan;				/**< compiled representation of _mission */
 
 	int32_t _current_mission_index{-1};
 
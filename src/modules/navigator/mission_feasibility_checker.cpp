@@ -54,167 +54,226 @@
 #include <uORB/topics/position_controller_landing_status.h>
 
 bool
-MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission,
+MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission, MissionPlan &plan,
 		float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
-		bool land_start_req)
+		bool land_start_req, bool build_plan)
 {
+	if (build_plan) {
+		// compile the plan even if the mission can't be feasible, it's also used to execute it
+		const bool checking = ((int)mission.count > 0)
+				      && begin(max_distance_to_1st_waypoint, max_distance_between_waypoints, land_start_req);
+
+		if (!plan.build(mission, checking ? this : nullptr)) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
+			return false;
+		}
+
+		return checking && finish();
+	}
+
 	// trivial case: A mission with length zero cannot be valid
 	if ((int)mission.count <= 0) {
 		return false;
 	}
 
-	bool failed = false;
-	bool warned = false;
+	if (!begin(max_distance_to_1st_waypoint, max_distance_between_waypoints, land_start_req)) {
+		return false;
+	}
 
-	// first check if we have a valid position
-	const bool home_valid = _navigator->home_position_valid();
-	const bool home_alt_valid = _navigator->home_alt_valid();
+	// single pass over the mission, all checks are fed item by item
+	for (size_t i = 0; i < mission.count; i++) {
+		struct mission_item_s missionitem = {};
 
-	if (!home_alt_valid) {
-		failed = true;
-		warned = true;
-		mavlink_log_info(_navigator->get_mavlink_log_pub(), "Not yet ready for mission, no position lock.");
+		if (!plan.readItem(i, missionitem)) {
+			// not supposed to happen unless the datamanager can't access the SD card, etc.
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
+			return false;
+		}
 
-	} else {
-		failed = failed || !checkDistanceToFirstWaypoint(mission, max_distance_to_1st_waypoint);
+		if (!addItem(missionitem)) {
+			return false;
+		}
 	}
 
-	const float home_alt = _navigator->get_home_position()->alt;
+	return finish();
+}
 
-	// check if all mission item commands are supported
-	failed = failed || !checkMissionItemValidity(mission);
-	failed = failed || !checkDistancesBetweenWaypoints(mission, max_distance_between_waypoints);
-	failed = failed || !checkGeofence(mission, home_alt, home_valid);
-	failed = failed || !checkHomePositionAltitude(mission, home_alt, home_alt_valid, warned);
+bool
+MissionFeasibilityChecker::begin(float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
+				 bool land_start_req)
+{
+	_index = 0;
+	_failed = false;
+	_warned = false;
+	_previous_item = {};
+
+	_first_waypoint_checked = false;
+	_home_alt_checked = false;
+
+	_last_lat = (double)NAN;
+	_last_lon = (double)NAN;
+	_last_cmd = 0;
+
+	_has_takeoff = false;
+	_takeoff_first = false;
+	_takeoff_index = -1;
+
+	_land_start_found = false;
+	_landing_valid = false;
+	_do_land_start_index = 0;
+	_landing_approach_index = 0;
+
+	_max_distance_to_1st_waypoint = max_distance_to_1st_waypoint;
+	_max_distance_between_waypoints = max_distance_between_waypoints;
+	_land_start_req = land_start_req;
 
 	if (_navigator->get_vstatus()->is_vtol) {
-		failed = failed || !checkVTOL(mission, home_alt, false);
+		_vehicle_type = VehicleType::VTOL;
 
 	} else if (_navigator->get_vstatus()->vehicle_type == vehicle_status_s::VEHICLE_TYPE_ROTARY_WING) {
-		failed = failed || !checkRotarywing(mission, home_alt);
+		_vehicle_type = VehicleType::ROTARY_WING;
 
 	} else {
-		failed = failed || !checkFixedwing(mission, home_alt, land_start_req);
+		_vehicle_type = VehicleType::FIXED_WING;
 	}
 
-	return !failed;
-}
+	// first check if we have a valid position
+	_home_valid = _navigator->home_position_valid();
+	_home_alt_valid = _navigator->home_alt_valid();
+	_home_alt = _navigator->get_home_position()->alt;
 
-bool
-MissionFeasibilityChecker::checkRotarywing(const mission_s &mission, float home_alt)
-{
-	/*
-	 * Perform check and issue feedback to the user
-	 * Mission is only marked as feasible if takeoff check passes
-	 */
-	return checkTakeoff(mission, home_alt);
+	if (!_home_alt_valid) {
+		_failed = true;
+		_warned = true;
+		mavlink_log_info(_navigator->get_mavlink_log_pub(), "Not yet ready for mission, no position lock.");
+		return false;
+	}
+
+	if (_navigator->get_geofence().isHomeRequired() && !_home_valid) {
+		_failed = true;
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
+		return false;
+	}
+
+	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkFixedwing(const mission_s &mission, float home_alt, bool land_start_req)
+MissionFeasibilityChecker::addItem(const mission_item_s &missionitem)
 {
-	/* Perform checks and issue feedback to the user for all checks */
-	bool resTakeoff = checkTakeoff(mission, home_alt);
-	bool resLanding = checkFixedWingLanding(mission, land_start_req);
+	if (_failed) {
+		return false;
+	}
 
-	/* Mission is only marked as feasible if all checks return true */
-	return (resTakeoff && resLanding);
+	const size_t i = _index;
+
+	bool failed = !checkDistanceToFirstWaypoint(missionitem);
+
+	// check if all mission item commands are supported
+	failed = failed || !checkMissionItemValidity(missionitem, i);
+	failed = failed || !checkDistancesBetweenWaypoints(missionitem);
+	failed = failed || !checkGeofence(missionitem, i);
+	failed = failed || !checkHomePositionAltitude(missionitem, i);
+	failed = failed || !checkTakeoff(missionitem, i);
+
+	if (_vehicle_type == VehicleType::VTOL) {
+		failed = failed || !checkVTOLLanding(missionitem, i);
+
+	} else if (_vehicle_type == VehicleType::FIXED_WING) {
+		failed = failed || !checkFixedWingLanding(missionitem, i);
+	}
+
+	_previous_item = missionitem;
+	_index++;
+	_failed = failed;
+
+	return !failed;
 }
 
 bool
-MissionFeasibilityChecker::checkVTOL(const mission_s &mission, float home_alt, bool land_start_req)
+MissionFeasibilityChecker::finish()
 {
+	if (_failed) {
+		return false;
+	}
+
 	/* Perform checks and issue feedback to the user for all checks */
-	bool resTakeoff = checkTakeoff(mission, home_alt);
-	bool resLanding = checkVTOLLanding(mission, land_start_req);
+	bool resTakeoff = checkTakeoffFinished();
+	bool resLanding = true;
+
+	if (_vehicle_type != VehicleType::ROTARY_WING) {
+		resLanding = checkLandingFinished();
+	}
 
 	/* Mission is only marked as feasible if all checks return true */
 	return (resTakeoff && resLanding);
 }
 
 bool
-MissionFeasibilityChecker::checkGeofence(const mission_s &mission, float home_alt, bool home_valid)
+MissionFeasibilityChecker::checkGeofence(const mission_item_s &missionitem, size_t index)
 {
-	if (_navigator->get_geofence().isHomeRequired() && !home_valid) {
+	/* Check if all mission items are inside the geofence (if we have a valid geofence) */
+	if (!_navigator->get_geofence().valid()) {
+		return true;
+	}
+
+	if (missionitem.altitude_is_relative && !_home_valid) {
 		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
 		return false;
 	}
 
-	/* Check if all mission items are inside the geofence (if we have a valid geofence) */
-	if (_navigator->get_geofence().valid()) {
-		for (size_t i = 0; i < mission.count; i++) {
-			struct mission_item_s missionitem = {};
-			const ssize_t len = sizeof(missionitem);
-
-			if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-				return false;
-			}
-
-			if (missionitem.altitude_is_relative && !home_valid) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
-				return false;
-			}
+	// Geofence function checks against home altitude amsl
+	struct mission_item_s missionitem_amsl = missionitem;
+	missionitem_amsl.altitude = missionitem.altitude_is_relative ? missionitem.altitude + _home_alt : missionitem.altitude;
 
-			// Geofence function checks against home altitude amsl
-			missionitem.altitude = missionitem.altitude_is_relative ? missionitem.altitude + home_alt : missionitem.altitude;
+	if (MissionBlock::item_contains_position(missionitem_amsl) && !_navigator->get_geofence().check(missionitem_amsl)) {
 
-			if (MissionBlock::item_contains_position(missionitem) && !_navigator->get_geofence().check(missionitem)) {
-
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence violation for waypoint %zu", i + 1);
-				return false;
-			}
-		}
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence violation for waypoint %zu", index + 1);
+		return false;
 	}
 
 	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkHomePositionAltitude(const mission_s &mission, float home_alt, bool home_alt_valid,
-		bool throw_error)
+MissionFeasibilityChecker::checkHomePositionAltitude(const mission_item_s &missionitem, size_t index)
 {
-	/* Check if all waypoints are above the home altitude */
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
-
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			_navigator->get_mission_result()->warning = true;
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
-		}
+	/* Check if all waypoints are above the home altitude, stop checking after the first warning */
+	if (_home_alt_checked) {
+		return true;
+	}
 
-		/* reject relative alt without home set */
-		if (missionitem.altitude_is_relative && !home_alt_valid && MissionBlock::item_contains_position(missionitem)) {
+	/* reject relative alt without home set */
+	if (missionitem.altitude_is_relative && !_home_alt_valid && MissionBlock::item_contains_position(missionitem)) {
 
-			_navigator->get_mission_result()->warning = true;
+		_navigator->get_mission_result()->warning = true;
 
-			if (throw_error) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: No home pos, WP %zu uses rel alt", i + 1);
-				return false;
+		if (_warned) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: No home pos, WP %zu uses rel alt", index + 1);
+			return false;
 
-			} else	{
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: No home pos, WP %zu uses rel alt", i + 1);
-				return true;
-			}
+		} else	{
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: No home pos, WP %zu uses rel alt", index + 1);
+			_home_alt_checked = true;
+			return true;
 		}
+	}
 
-		/* calculate the global waypoint altitude */
-		float wp_alt = (missionitem.altitude_is_relative) ? missionitem.altitude + home_alt : missionitem.altitude;
+	/* calculate the global waypoint altitude */
+	float wp_alt = (missionitem.altitude_is_relative) ? missionitem.altitude + _home_alt : missionitem.altitude;
 
-		if ((home_alt > wp_alt) && MissionBlock::item_contains_position(missionitem)) {
+	if ((_home_alt > wp_alt) && MissionBlock::item_contains_position(missionitem)) {
 
-			_navigator->get_mission_result()->warning = true;
+		_navigator->get_mission_result()->warning = true;
 
-			if (throw_error) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Waypoint %zu below home", i + 1);
-				return false;
+		if (_warned) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Waypoint %zu below home", index + 1);
+			return false;
 
-			} else	{
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: Waypoint %zu below home", i + 1);
-				return true;
-			}
+		} else	{
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: Waypoint %zu below home", index + 1);
+			_home_alt_checked = true;
+			return true;
 		}
 	}
 
@@ -222,201 +281,169 @@ MissionFeasibilityChecker::checkHomePositionAltitude(const mission_s &mission, f
 }
 
 bool
-MissionFeasibilityChecker::checkMissionItemValidity(const mission_s &mission)
+MissionFeasibilityChecker::checkMissionItemValidity(const mission_item_s &missionitem, size_t index)
 {
-	// do not allow mission if we find unsupported item
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(struct mission_item_s);
+	// check if we find unsupported items and reject mission if so
+	if (missionitem.nav_cmd != NAV_CMD_IDLE &&
+	    missionitem.nav_cmd != NAV_CMD_WAYPOINT &&
+	    missionitem.nav_cmd != NAV_CMD_LOITER_UNLIMITED &&
+	    missionitem.nav_cmd != NAV_CMD_LOITER_TIME_LIMIT &&
+	    missionitem.nav_cmd != NAV_CMD_RETURN_TO_LAUNCH &&
+	    missionitem.nav_cmd != NAV_CMD_LAND &&
+	    missionitem.nav_cmd != NAV_CMD_TAKEOFF &&
+	    missionitem.nav_cmd != NAV_CMD_LOITER_TO_ALT &&
+	    missionitem.nav_cmd != NAV_CMD_VTOL_TAKEOFF &&
+	    missionitem.nav_cmd != NAV_CMD_VTOL_LAND &&
+	    missionitem.nav_cmd != NAV_CMD_DELAY &&
+	    missionitem.nav_cmd != NAV_CMD_CONDITION_GATE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_JUMP &&
+	    missionitem.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_HOME &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_SERVO &&
+	    missionitem.nav_cmd != NAV_CMD_DO_LAND_START &&
+	    missionitem.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
+	    missionitem.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
+	    missionitem.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_CONTROL_VIDEO &&
+	    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
+	    missionitem.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_PITCHYAW &&
+	    missionitem.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_CONFIGURE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_LOCATION &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_WPNEXT_OFFSET &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_NONE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
+	    missionitem.nav_cmd != NAV_CMD_OBLIQUE_SURVEY &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
+	    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
+	    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_ZOOM &&
+	    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_FOCUS &&
+	    missionitem.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION) {
+
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: item %i: unsupported cmd: %d", (int)(index + 1),
+				     (int)missionitem.nav_cmd);
+		return false;
+	}
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			// not supposed to happen unless the datamanager can't access the SD card, etc.
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
-			return false;
-		}
+	/* Check non navigation item */
+	if (missionitem.nav_cmd == NAV_CMD_DO_SET_SERVO) {
 
-		// check if we find unsupported items and reject mission if so
-		if (missionitem.nav_cmd != NAV_CMD_IDLE &&
-		    missionitem.nav_cmd != NAV_CMD_WAYPOINT &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_UNLIMITED &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_TIME_LIMIT &&
-		    missionitem.nav_cmd != NAV_CMD_RETURN_TO_LAUNCH &&
-		    missionitem.nav_cmd != NAV_CMD_LAND &&
-		    missionitem.nav_cmd != NAV_CMD_TAKEOFF &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_TO_ALT &&
-		    missionitem.nav_cmd != NAV_CMD_VTOL_TAKEOFF &&
-		    missionitem.nav_cmd != NAV_CMD_VTOL_LAND &&
-		    missionitem.nav_cmd != NAV_CMD_DELAY &&
-		    missionitem.nav_cmd != NAV_CMD_CONDITION_GATE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_JUMP &&
-		    missionitem.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_HOME &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_SERVO &&
-		    missionitem.nav_cmd != NAV_CMD_DO_LAND_START &&
-		    missionitem.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_CONTROL_VIDEO &&
-		    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_PITCHYAW &&
-		    missionitem.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_CONFIGURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_LOCATION &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_WPNEXT_OFFSET &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_NONE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
-		    missionitem.nav_cmd != NAV_CMD_OBLIQUE_SURVEY &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
-		    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
-		    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_ZOOM &&
-		    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_FOCUS &&
-		    missionitem.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION) {
-
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: item %i: unsupported cmd: %d", (int)(i + 1),
-					     (int)missionitem.nav_cmd);
+		/* check actuator number */
+		if (missionitem.params[0] < 0 || missionitem.params[0] > 5) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Actuator number %d is out of bounds 0..5",
+					     (int)missionitem.params[0]);
 			return false;
 		}
 
-		/* Check non navigation item */
-		if (missionitem.nav_cmd == NAV_CMD_DO_SET_SERVO) {
-
-			/* check actuator number */
-			if (missionitem.params[0] < 0 || missionitem.params[0] > 5) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Actuator number %d is out of bounds 0..5",
-						     (int)missionitem.params[0]);
-				return false;
-			}
-
-			/* check actuator value */
-			if (missionitem.params[1] < -PWM_DEFAULT_MAX || missionitem.params[1] > PWM_DEFAULT_MAX) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Actuator value %d is out of bounds -PWM_DEFAULT_MAX..PWM_DEFAULT_MAX", (int)missionitem.params[1]);
-				return false;
-			}
+		/* check actuator value */
+		if (missionitem.params[1] < -PWM_DEFAULT_MAX || missionitem.params[1] > PWM_DEFAULT_MAX) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Actuator value %d is out of bounds -PWM_DEFAULT_MAX..PWM_DEFAULT_MAX", (int)missionitem.params[1]);
+			return false;
 		}
+	}
 
-		// check if the mission starts with a land command while the vehicle is landed
-		if ((i == 0) && missionitem.nav_cmd == NAV_CMD_LAND && _navigator->get_land_detected()->landed) {
+	// check if the mission starts with a land command while the vehicle is landed
+	if ((index == 0) && missionitem.nav_cmd == NAV_CMD_LAND && _navigator->get_land_detected()->landed) {
 
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with landing");
-			return false;
-		}
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with landing");
+		return false;
 	}
 
 	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkTakeoff(const mission_s &mission, float home_alt)
+MissionFeasibilityChecker::checkTakeoff(const mission_item_s &missionitem, size_t index)
 {
-	bool has_takeoff = false;
-	bool takeoff_first = false;
-	int takeoff_index = -1;
-
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
-
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
-		}
-
-		// look for a takeoff waypoint
-		if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
-			// make sure that the altitude of the waypoint is at least one meter larger than the acceptance radius
-			// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
-
-			float takeoff_alt = missionitem.altitude_is_relative
-					    ? missionitem.altitude
-					    : missionitem.altitude - home_alt;
-
-			// check if we should use default acceptance radius
-			float acceptance_radius = _navigator->get_default_acceptance_radius();
+	// look for a takeoff waypoint
+	if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
+		// make sure that the altitude of the waypoint is at least one meter larger than the acceptance radius
+		// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
 
-			if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
-				acceptance_radius = missionitem.acceptance_radius;
-			}
-
-			if (takeoff_alt - 1.0f < acceptance_radius) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
-				return false;
-			}
+		float takeoff_alt = missionitem.altitude_is_relative
+				    ? missionitem.altitude
+				    : missionitem.altitude - _home_alt;
 
-			// tell that mission has a takeoff waypoint
-			has_takeoff = true;
+		// check if we should use default acceptance radius
+		float acceptance_radius = _navigator->get_default_acceptance_radius();
 
-			// tell that a takeoff waypoint is the first "waypoint"
-			// mission item
-			if (i == 0) {
-				takeoff_first = true;
-
-			} else if (takeoff_index == -1) {
-				// stores the index of the first takeoff waypoint
-				takeoff_index = i;
-			}
+		if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
+			acceptance_radius = missionitem.acceptance_radius;
 		}
-	}
-
-	if (takeoff_index != -1) {
-		// checks if all the mission items before the first takeoff waypoint
-		// are not waypoints or position-related items;
-		// this means that, before a takeoff waypoint, one can set
-		// one of the bellow mission items
-		for (size_t i = 0; i < (size_t)takeoff_index; i++) {
-			struct mission_item_s missionitem = {};
-			const ssize_t len = sizeof(struct mission_item_s);
 
-			if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-				return false;
-			}
+		if (takeoff_alt - 1.0f < acceptance_radius) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
+			return false;
+		}
 
-			takeoff_first = !(missionitem.nav_cmd != NAV_CMD_IDLE &&
-					  missionitem.nav_cmd != NAV_CMD_DELAY &&
-					  missionitem.nav_cmd != NAV_CMD_DO_JUMP &&
-					  missionitem.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_HOME &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_SERVO &&
-					  missionitem.nav_cmd != NAV_CMD_DO_LAND_START &&
-					  missionitem.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
-					  missionitem.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
-					  missionitem.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
-					  missionitem.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
-					  missionitem.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
-					  missionitem.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
-					  missionitem.nav_cmd != NAV_CMD_DO_CONTROL_VIDEO &&
-					  missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
-					  missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
-					  missionitem.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_PITCHYAW &&
-					  missionitem.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_CONFIGURE &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_ROI &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_LOCATION &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_WPNEXT_OFFSET &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_ROI_NONE &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
-					  missionitem.nav_cmd != NAV_CMD_OBLIQUE_SURVEY &&
-					  missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
-					  missionitem.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
-					  missionitem.nav_cmd != NAV_CMD_SET_CAMERA_ZOOM &&
-					  missionitem.nav_cmd != NAV_CMD_SET_CAMERA_FOCUS &&
-					  missionitem.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION);
+		// tell that mission has a takeoff waypoint
+		_has_takeoff = true;
+
+		// tell that a takeoff waypoint is the first "waypoint"
+		// mission item
+		if (index == 0) {
+			_takeoff_first = true;
+
+		} else if (_takeoff_index == -1) {
+			// stores the index of the first takeoff waypoint
+			_takeoff_index = index;
+
+			// checks if the mission item before the first takeoff waypoint
+			// is not a waypoint or position-related item;
+			// this means that, before a takeoff waypoint, one can set
+			// one of the bellow mission items
+			_takeoff_first = !(_previous_item.nav_cmd != NAV_CMD_IDLE &&
+					   _previous_item.nav_cmd != NAV_CMD_DELAY &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_JUMP &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_HOME &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_SERVO &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_LAND_START &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
+					   _previous_item.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
+					   _previous_item.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
+					   _previous_item.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
+					   _previous_item.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_CONTROL_VIDEO &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_PITCHYAW &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_GIMBAL_MANAGER_CONFIGURE &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_ROI &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_ROI_LOCATION &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_ROI_WPNEXT_OFFSET &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_ROI_NONE &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
+					   _previous_item.nav_cmd != NAV_CMD_OBLIQUE_SURVEY &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
+					   _previous_item.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
+					   _previous_item.nav_cmd != NAV_CMD_SET_CAMERA_ZOOM &&
+					   _previous_item.nav_cmd != NAV_CMD_SET_CAMERA_FOCUS &&
+					   _previous_item.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION);
 		}
 	}
 
+	return true;
+}
+
+bool
+MissionFeasibilityChecker::checkTakeoffFinished()
+{
 	if (_navigator->get_takeoff_required() && _navigator->get_land_detected()->landed) {
 		// check for a takeoff waypoint, after the above conditions have been met
 		// MIS_TAKEOFF_REQ param has to be set and the vehicle has to be landed - one can load a mission
 		// while the vehicle is flying and it does not require a takeoff waypoint
-		if (!has_takeoff) {
+		if (!_has_takeoff) {
 			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: takeoff waypoint required.");
 			return false;
 
-		} else if (!takeoff_first) {
+		} else if (!_takeoff_first) {
 			// check if the takeoff waypoint is the first waypoint item on the mission
 			// i.e, an item with position/attitude change modification
 			// if it is not, the mission should be rejected
@@ -430,194 +457,145 @@ MissionFeasibilityChecker::checkTakeoff(const mission_s &mission, float home_alt
 }
 
 bool
-MissionFeasibilityChecker::checkFixedWingLanding(const mission_s &mission, bool land_start_req)
+MissionFeasibilityChecker::checkFixedWingLanding(const mission_item_s &missionitem, size_t index)
 {
-	/* Go through all mission items and search for a landing waypoint
-	 * if landing waypoint is found: the previous waypoint is checked to be at a feasible distance and altitude given the landing slope */
-
-	bool landing_valid = false;
-
-	bool land_start_found = false;
-	size_t do_land_start_index = 0;
-	size_t landing_approach_index = 0;
-
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(missionitem);
+	/* Search for a landing waypoint, if landing waypoint is found: the previous waypoint is checked to be at a
+	 * feasible distance and altitude given the landing slope */
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
+	// if DO_LAND_START found then require valid landing AFTER
+	if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
+		if (_land_start_found) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
 			return false;
-		}
-
-		// if DO_LAND_START found then require valid landing AFTER
-		if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
-			if (land_start_found) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
-				return false;
 
-			} else {
-				land_start_found = true;
-				do_land_start_index = i;
-			}
+		} else {
+			_land_start_found = true;
+			_do_land_start_index = index;
 		}
+	}
 
-		if (missionitem.nav_cmd == NAV_CMD_LAND) {
-			mission_item_s missionitem_previous {};
-
-			if (i > 0) {
-				landing_approach_index = i - 1;
-
-				if (dm_read((dm_item_t)mission.dataman_id, landing_approach_index, &missionitem_previous, len) != len) {
-					/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-					return false;
-				}
-
-				if (MissionBlock::item_contains_position(missionitem_previous)) {
+	if (missionitem.nav_cmd == NAV_CMD_LAND) {
+		if (index > 0) {
+			_landing_approach_index = index - 1;
+			const mission_item_s &missionitem_previous = _previous_item;
 
-					uORB::SubscriptionData<position_controller_landing_status_s> landing_status{ORB_ID(position_controller_landing_status)};
+			if (MissionBlock::item_contains_position(missionitem_previous)) {
 
-					const bool landing_status_valid = (landing_status.get().timestamp > 0);
-					const float wp_distance = get_distance_to_next_waypoint(missionitem_previous.lat, missionitem_previous.lon,
-								  missionitem.lat, missionitem.lon);
+				uORB::SubscriptionData<position_controller_landing_status_s> landing_status{ORB_ID(position_controller_landing_status)};
 
-					if (landing_status_valid && (wp_distance > landing_status.get().flare_length)) {
-						/* Last wp is before flare region */
+				const bool landing_status_valid = (landing_status.get().timestamp > 0);
+				const float wp_distance = get_distance_to_next_waypoint(missionitem_previous.lat, missionitem_previous.lon,
+							  missionitem.lat, missionitem.lon);
 
-						const float delta_altitude = missionitem.altitude - missionitem_previous.altitude;
+				if (landing_status_valid && (wp_distance > landing_status.get().flare_length)) {
+					/* Last wp is before flare region */
 
-						if (delta_altitude < 0) {
+					const float delta_altitude = missionitem.altitude - missionitem_previous.altitude;
 
-							const float horizontal_slope_displacement = landing_status.get().horizontal_slope_displacement;
-							const float slope_angle_rad = landing_status.get().slope_angle_rad;
-							const float slope_alt_req = Landingslope::getLandingSlopeAbsoluteAltitude(wp_distance, missionitem.altitude,
-										    horizontal_slope_displacement, slope_angle_rad);
+					if (delta_altitude < 0) {
 
-							if (missionitem_previous.altitude > slope_alt_req + 1.0f) {
-								/* Landing waypoint is above altitude of slope at the given waypoint distance (with small tolerance for floating point discrepancies) */
-								mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: adjust landing approach.");
+						const float horizontal_slope_displacement = landing_status.get().horizontal_slope_displacement;
+						const float slope_angle_rad = landing_status.get().slope_angle_rad;
+						const float slope_alt_req = Landingslope::getLandingSlopeAbsoluteAltitude(wp_distance, missionitem.altitude,
+									    horizontal_slope_displacement, slope_angle_rad);
 
-								const float wp_distance_req = Landingslope::getLandingSlopeWPDistance(missionitem_previous.altitude,
-											      missionitem.altitude, horizontal_slope_displacement, slope_angle_rad);
+						if (missionitem_previous.altitude > slope_alt_req + 1.0f) {
+							/* Landing waypoint is above altitude of slope at the given waypoint distance (with small tolerance for floating point discrepancies) */
+							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: adjust landing approach.");
 
-								mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Move down %d m or move further away by %d m.",
-										     (int)ceilf(slope_alt_req - missionitem_previous.altitude),
-										     (int)ceilf(wp_distance_req - wp_distance));
+							const float wp_distance_req = Landingslope::getLandingSlopeWPDistance(missionitem_previous.altitude,
+										      missionitem.altitude, horizontal_slope_displacement, slope_angle_rad);
 
-								return false;
-							}
+							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Move down %d m or move further away by %d m.",
+									     (int)ceilf(slope_alt_req - missionitem_previous.altitude),
+									     (int)ceilf(wp_distance_req - wp_distance));
 
-						} else {
-							/* Landing waypoint is above last waypoint */
-							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing above last waypoint.");
 							return false;
 						}
 
 					} else {
-						/* Last wp is in flare region */
-						mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: waypoint within landing flare.");
+						/* Landing waypoint is above last waypoint */
+						mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing above last waypoint.");
 						return false;
 					}
 
-					landing_valid = true;
-
 				} else {
-					// mission item before land doesn't have a position
-					mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: need landing approach.");
+					/* Last wp is in flare region */
+					mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: waypoint within landing flare.");
 					return false;
 				}
 
+				_landing_valid = true;
+
 			} else {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
+				// mission item before land doesn't have a position
+				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: need landing approach.");
 				return false;
 			}
 
-		} else if (missionitem.nav_cmd == NAV_CMD_RETURN_TO_LAUNCH) {
-			if (land_start_found && do_land_start_index < i) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Mission rejected: land start item before RTL item not possible.");
-				return false;
-			}
+		} else {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
+			return false;
 		}
-	}
 
-	if (land_start_req && !land_start_found) {
-		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing pattern required.");
-		return false;
-	}
-
-	if (land_start_found && (!landing_valid || (do_land_start_index > landing_approach_index))) {
-		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: invalid land start.");
-		return false;
+	} else if (missionitem.nav_cmd == NAV_CMD_RETURN_TO_LAUNCH) {
+		if (_land_start_found && _do_land_start_index < index) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Mission rejected: land start item before RTL item not possible.");
+			return false;
+		}
 	}
 
-	/* No landing waypoints or no waypoints */
 	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkVTOLLanding(const mission_s &mission, bool land_start_req)
+MissionFeasibilityChecker::checkVTOLLanding(const mission_item_s &missionitem, size_t index)
 {
-	/* Go through all mission items and search for a landing waypoint
-	 * if landing waypoint is found: the previous waypoint is checked to be at a feasible distance and altitude given the landing slope */
-
-	bool land_start_found = false;
-	size_t do_land_start_index = 0;
-	size_t landing_approach_index = 0;
-
-	for (size_t i = 0; i < mission.count; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(missionitem);
-
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
+	// if DO_LAND_START found then require valid landing AFTER
+	if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
+		if (_land_start_found) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
 			return false;
-		}
 
-		// if DO_LAND_START found then require valid landing AFTER
-		if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
-			if (land_start_found) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
-				return false;
-
-			} else {
-				land_start_found = true;
-				do_land_start_index = i;
-			}
+		} else {
+			_land_start_found = true;
+			_do_land_start_index = index;
 		}
+	}
 
-		if (missionitem.nav_cmd == NAV_CMD_LAND || missionitem.nav_cmd == NAV_CMD_VTOL_LAND) {
-			mission_item_s missionitem_previous {};
-
-			if (i > 0) {
-				landing_approach_index = i - 1;
-
-				if (dm_read((dm_item_t)mission.dataman_id, landing_approach_index, &missionitem_previous, len) != len) {
-					/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-					return false;
-				}
-
+	if (missionitem.nav_cmd == NAV_CMD_LAND || missionitem.nav_cmd == NAV_CMD_VTOL_LAND) {
+		if (index > 0) {
+			_landing_approach_index = index - 1;
 
-			} else {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
-				return false;
-			}
+		} else {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
+			return false;
+		}
 
-		} else if (missionitem.nav_cmd == NAV_CMD_RETURN_TO_LAUNCH) {
-			if (land_start_found && do_land_start_index < i) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Mission rejected: land start item before RTL item not possible.");
-				return false;
-			}
+	} else if (missionitem.nav_cmd == NAV_CMD_RETURN_TO_LAUNCH) {
+		if (_land_start_found && _do_land_start_index < index) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Mission rejected: land start item before RTL item not possible.");
+			return false;
 		}
 	}
 
-	if (land_start_req && !land_start_found) {
+	return true;
+}
+
+bool
+MissionFeasibilityChecker::checkLandingFinished()
+{
+	if (_land_start_req && !_land_start_found) {
 		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing pattern required.");
 		return false;
 	}
 
-	if (land_start_found && (do_land_start_index > landing_approach_index)) {
+	// a fixedwing additionally needs a valid landing approach after the land start
+	const bool landing_valid = (_vehicle_type == VehicleType::VTOL) || _landing_valid;
+
+	if (_land_start_found && (!landing_valid || (_do_land_start_index > _landing_approach_index))) {
 		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: invalid land start.");
 		return false;
 	}
@@ -627,123 +605,93 @@ MissionFeasibilityChecker::checkVTOLLanding(const mission_s &mission, bool land_
 }
 
 bool
-MissionFeasibilityChecker::checkDistanceToFirstWaypoint(const mission_s &mission, float max_distance)
+MissionFeasibilityChecker::checkDistanceToFirstWaypoint(const mission_item_s &mission_item)
 {
-	if (max_distance <= 0.0f) {
-		/* param not set, check is ok */
+	if (_max_distance_to_1st_waypoint <= 0.0f || _first_waypoint_checked) {
+		/* param not set or first waypoint already checked, check is ok */
 		return true;
 	}
 
-	/* find first waypoint (with lat/lon) item in datamanager */
-	for (size_t i = 0; i < mission.count; i++) {
-
-		struct mission_item_s mission_item {};
-
-		if (!(dm_read((dm_item_t)mission.dataman_id, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
-			/* error reading, mission is invalid */
-			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
-			return false;
-		}
+	/* check only items with valid lat/lon */
+	if (!MissionBlock::item_contains_position(mission_item)) {
+		return true;
+	}
 
-		/* check only items with valid lat/lon */
-		if (!MissionBlock::item_contains_position(mission_item)) {
-			continue;
-		}
+	_first_waypoint_checked = true;
 
-		/* check distance from current position to item */
-		float dist_to_1wp = get_distance_to_next_waypoint(
-					    mission_item.lat, mission_item.lon,
-					    _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
+	/* check distance from current position to item */
+	float dist_to_1wp = get_distance_to_next_waypoint(
+				    mission_item.lat, mission_item.lon,
+				    _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
 
-		if (dist_to_1wp < max_distance) {
+	if (dist_to_1wp < _max_distance_to_1st_waypoint) {
 
-			return true;
+		return true;
 
-		} else {
-			/* item is too far from home */
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-					     "First waypoint too far away: %d meters, %d max.",
-					     (int)dist_to_1wp, (int)max_distance);
+	} else {
+		/* item is too far from home */
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+				     "First waypoint too far away: %d meters, %d max.",
+				     (int)dist_to_1wp, (int)_max_distance_to_1st_waypoint);
 
-			_navigator->get_mission_result()->warning = true;
-			return false;
-		}
+		_navigator->get_mission_result()->warning = true;
+		return false;
 	}
-
-	/* no waypoints found in mission, then we will not fly far away */
-	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkDistancesBetweenWaypoints(const mission_s &mission, float max_distance)
+MissionFeasibilityChecker::checkDistancesBetweenWaypoints(const mission_item_s &mission_item)
 {
-	if (max_distance <= 0.0f) {
+	if (_max_distance_between_waypoints <= 0.0f) {
 		/* param not set, check is ok */
 		return true;
 	}
 
-	double last_lat = (double)NAN;
-	double last_lon = (double)NAN;
-	int last_cmd = 0;
-
-	/* Go through all waypoints */
-	for (size_t i = 0; i < mission.count; i++) {
-
-		struct mission_item_s mission_item {};
-
-		if (!(dm_read((dm_item_t)mission.dataman_id, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
-			/* error reading, mission is invalid */
-			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
-			return false;
-		}
-
-		/* check only items with valid lat/lon */
-		if (!MissionBlock::item_contains_position(mission_item)) {
-			continue;
-		}
+	/* check only items with valid lat/lon */
+	if (!MissionBlock::item_contains_position(mission_item)) {
+		return true;
+	}
 
-		/* Compare it to last waypoint if already available. */
-		if (PX4_ISFINITE(last_lat) && PX4_ISFINITE(last_lon)) {
+	/* Compare it to last waypoint if already available. */
+	if (PX4_ISFINITE(_last_lat) && PX4_ISFINITE(_last_lon)) {
 
-			/* check distance from current position to item */
-			const float dist_between_waypoints = get_distance_to_next_waypoint(
-					mission_item.lat, mission_item.lon,
-					last_lat, last_lon);
+		/* check distance from current position to item */
+		const float dist_between_waypoints = get_distance_to_next_waypoint(
+				mission_item.lat, mission_item.lon,
+				_last_lat, _last_lon);
 
 
-			if (dist_between_waypoints > max_distance) {
-				/* distance between waypoints is too high */
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Distance between waypoints too far: %d meters, %d max.",
-						     (int)dist_between_waypoints, (int)max_distance);
+		if (dist_between_waypoints > _max_distance_between_waypoints) {
+			/* distance between waypoints is too high */
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Distance between waypoints too far: %d meters, %d max.",
+					     (int)dist_between_waypoints, (int)_max_distance_between_waypoints);
 
-				_navigator->get_mission_result()->warning = true;
-				return false;
+			_navigator->get_mission_result()->warning = true;
+			return false;
 
-				/* do not allow waypoints that are literally on top of each other */
+			/* do not allow waypoints that are literally on top of each other */
 
-				/* and do not allow condition gates that are at the same position as a navigation waypoint */
+			/* and do not allow condition gates that are at the same position as a navigation waypoint */
 
-			} else if (dist_between_waypoints < 0.05f &&
-				   (mission_item.nav_cmd == NAV_CMD_CONDITION_GATE || last_cmd == NAV_CMD_CONDITION_GATE)) {
+		} else if (dist_between_waypoints < 0.05f &&
+			   (mission_item.nav_cmd == NAV_CMD_CONDITION_GATE || _last_cmd == NAV_CMD_CONDITION_GATE)) {
 
-				/* Waypoints and gate are at the exact same position, which indicates an
-				 * invalid mission and makes calculating the direction from one waypoint
-				 * to another impossible. */
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Distance between waypoint and gate too close: %d meters",
-						     (int)dist_between_waypoints);
+			/* Waypoints and gate are at the exact same position, which indicates an
+			 * invalid mission and makes calculating the direction from one waypoint
+			 * to another impossible. */
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Distance between waypoint and gate too close: %d meters",
+					     (int)dist_between_waypoints);
 
-				_navigator->get_mission_result()->warning = true;
-				return false;
-			}
+			_navigator->get_mission_result()->warning = true;
+			return false;
 		}
-
-		last_lat = mission_item.lat;
-		last_lon = mission_item.lon;
-		last_cmd = mission_item.nav_cmd;
 	}
 
-	/* We ran through all waypoints and have not found any distances between waypoints that are too far. */
+	_last_lat = mission_item.lat;
+	_last_lon = mission_item.lon;
+	_last_cmd = mission_item.nav_cmd;
+
 	return true;
 }
@@ -42,6 +42,9 @@
 
 #pragma once
 
+#include "mission_plan.h"
+#include "navigation.h"
+
 #include <dataman/dataman.h>
 #include <uORB/topics/mission.h>
 
@@ -53,28 +56,64 @@ class MissionFeasibilityChecker
 private:
 	Navigator *_navigator{nullptr};
 
+	enum class VehicleType {
+		ROTARY_WING,
+		FIXED_WING,
+		VTOL
+	};
+
+	/* Setup of the mission being checked */
+	VehicleType _vehicle_type{VehicleType::ROTARY_WING};
+	float _home_alt{0.f};
+	bool _home_valid{false};
+	bool _home_alt_valid{false};
+	bool _warned{false};
+	float _max_distance_to_1st_waypoint{0.f};
+	float _max_distance_between_waypoints{0.f};
+	bool _land_start_req{false};
+
+	/* State of the checks, carried from one mission item to the next */
+	size_t _index{0};
+	bool _failed{false};
+	mission_item_s _previous_item{};
+
+	bool _first_waypoint_checked{false};
+	bool _home_alt_checked{false};
+
+	double _last_lat{0.0};
+	double _last_lon{0.0};
+	int _last_cmd{0};
+
+	bool _has_takeoff{false};
+	bool _takeoff_first{false};
+	int _takeoff_index{-1};
+
+	bool _land_start_found{false};
+	bool _landing_valid{false};
+	size_t _do_land_start_index{0};
+	size_t _landing_approach_index{0};
+
 	/* Checks for all airframes */
-	bool checkGeofence(const mission_s &mission, float home_alt, bool home_valid);
+	bool checkGeofence(const mission_item_s &missionitem, size_t index);
 
-	bool checkHomePositionAltitude(const mission_s &mission, float home_alt, bool home_alt_valid, bool throw_error);
+	bool checkHomePositionAltitude(const mission_item_s &missionitem, size_t index);
 
-	bool checkMissionItemValidity(const mission_s &mission);
+	bool checkMissionItemValidity(const mission_item_s &missionitem, size_t index);
 
-	bool checkDistanceToFirstWaypoint(const mission_s &mission, float max_distance);
-	bool checkDistancesBetweenWaypoints(const mission_s &mission, float max_distance);
+	bool checkDistanceToFirstWaypoint(const mission_item_s &missionitem);
+	bool checkDistancesBetweenWaypoints(const mission_item_s &missionitem);
 
-	bool checkTakeoff(const mission_s &mission, float home_alt);
+	bool checkTakeoff(const mission_item_s &missionitem, size_t index);
+	bool checkTakeoffFinished();
 
 	/* Checks specific to fixedwing airframes */
-	bool checkFixedwing(const mission_s &mission, float home_alt, bool land_start_req);
-	bool checkFixedWingLanding(const mission_s &mission, bool land_start_req);
-
-	/* Checks specific to rotarywing airframes */
-	bool checkRotarywing(const mission_s &mission, float home_alt);
+	bool checkFixedWingLanding(const mission_item_s &missionitem, size_t index);
 
 	/* Checks specific to VTOL airframes */
-	bool checkVTOL(const mission_s &mission, float home_alt, bool land_start_req);
-	bool checkVTOLLanding(const mission_s &mission, bool land_start_req);
+	bool checkVTOLLanding(const mission_item_s &missionitem, size_t index);
+
+	/* Final landing checks for fixedwing and VTOL airframes */
+	bool checkLandingFinished();
 
 public:
 	MissionFeasibilityChecker(Navigator *navigator) : _navigator(navigator) {}
@@ -84,10 +123,31 @@ public:
 	MissionFeasibilityChecker &operator=(const MissionFeasibilityChecker &) = delete;
 
 	/*
-	 * Returns true if mission is feasible and false otherwise
+	 * Incremental checking: call begin(), then addItem() for every mission item in order and finally finish().
+	 * The checks stop at the first item which makes the mission infeasible.
+	 */
+
+	/*
+	 * Start checking a new mission, returns false if it can't be feasible regardless of its items
+	 */
+	bool begin(float max_distance_to_1st_waypoint, float max_distance_between_waypoints, bool land_start_req);
+
+	/*
+	 * Check the next mission item, returns false if the mission is infeasible
+	 */
+	bool addItem(const mission_item_s &missionitem);
+
+	/*
+	 * Returns true if the mission fed so far is feasible
+	 */
+	bool finish();
+
+	/*
+	 * Returns true if mission is feasible and false otherwise, reading the items through the compiled plan.
+	 * With build_plan the plan is compiled for the mission first, and the items are checked in the same pass.
 	 */
-	bool checkMissionFeasible(const mission_s &mission,
+	bool checkMissionFeasible(const mission_s &mission, MissionPlan &plan,
 				  float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
-				  bool land_start_req);
+				  bool land_start_req, bool build_plan = false);
 
 };
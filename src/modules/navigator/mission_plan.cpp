@@ -0,0 +1,243 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mission_plan.cpp
+ * Compiled in-memory representation of the active mission.
+ */
+
+#include "mission_plan.h"
+#include "mission_block.h"
+#include "mission_feasibility_checker.h"
+
+#include <lib/mathlib/mathlib.h>
+#include <px4_platform_common/log.h>
+
+MissionPlan::~MissionPlan()
+{
+	delete[] _items;
+}
+
+void MissionPlan::reset()
+{
+	_count = 0;
+	_cache_start = 0;
+	_cache_count = 0;
+	_reference = {};
+
+	for (Landing &landing : _landing) {
+		landing = {};
+		landing.land_start_index = UINT16_MAX;
+	}
+}
+
+bool MissionPlan::build(const mission_s &mission, MissionFeasibilityChecker *checker)
+{
+	reset();
+
+	_dataman_id = (dm_item_t)mission.dataman_id;
+	_count = mission.count;
+
+	if (_count == 0) {
+		return true;
+	}
+
+	// the entries are reused across updates as long as they are large enough
+	if (_count > _items_allocated) {
+		delete[] _items;
+		_items = new Item[_count];
+		_items_allocated = _items ? _count : 0;
+
+		if (!_items) {
+			PX4_WARN("mission plan: no memory for %u items", _count);
+		}
+	}
+
+	bool found_land_start_marker = false;
+	bool has_previous_position = false;
+	float previous_north = 0.f;
+	float previous_east = 0.f;
+
+	// single pass over the mission, the read-ahead cache fetches it from dataman in chunks
+	for (unsigned index = 0; index < _count; index++) {
+		if (index >= _cache_start + _cache_count && !fillCache(index)) {
+			PX4_ERR("dataman read failure");
+			reset();
+			return false;
+		}
+
+		const mission_item_s &mission_item = _cache[index - _cache_start];
+		const bool has_position = MissionBlock::item_contains_position(mission_item);
+
+		if (checker) {
+			// stops checking at the first infeasible item by itself
+			checker->addItem(mission_item);
+		}
+
+		if (_items) {
+			Item &item = _items[index];
+			item = {};
+			item.nav_cmd = mission_item.nav_cmd;
+			item.altitude = mission_item.altitude;
+			item.leg_heading = NAN;
+
+			if (mission_item.altitude_is_relative) {
+				item.flags |= FLAG_ALTITUDE_RELATIVE;
+			}
+
+			if (mission_item.nav_cmd == NAV_CMD_DO_JUMP) {
+				item.flags |= FLAG_DO_JUMP;
+			}
+
+			if (has_position) {
+				if (!map_projection_initialized(&_reference)) {
+					map_projection_init(&_reference, mission_item.lat, mission_item.lon);
+				}
+
+				item.flags |= FLAG_POSITION;
+				map_projection_project(&_reference, mission_item.lat, mission_item.lon, &item.north, &item.east);
+
+				if (has_previous_position) {
+					const float d_north = item.north - previous_north;
+					const float d_east = item.east - previous_east;
+					item.leg_length = sqrtf(d_north * d_north + d_east * d_east);
+					item.leg_heading = atan2f(d_east, d_north);
+				}
+
+				has_previous_position = true;
+				previous_north = item.north;
+				previous_east = item.east;
+			}
+
+		} else if (has_position && !map_projection_initialized(&_reference)) {
+			map_projection_init(&_reference, mission_item.lat, mission_item.lon);
+		}
+
+		// landing sequence, the first item is never considered
+		if (index == 0) {
+			continue;
+		}
+
+		if (mission_item.nav_cmd == NAV_CMD_DO_LAND_START) {
+			found_land_start_marker = true;
+		}
+
+		for (int is_vtol = 0; is_vtol < 2; is_vtol++) {
+			Landing &landing = _landing[is_vtol];
+
+			if (mission_item.nav_cmd == NAV_CMD_DO_LAND_START) {
+				landing.land_start_index = index;
+			}
+
+			if (found_land_start_marker && !landing.available && index > landing.land_start_index && has_position) {
+				// use the position of any waypoint after the land start marker which specifies a position.
+				landing.start_lat = mission_item.lat;
+				landing.start_lon = mission_item.lon;
+				landing.start_alt = mission_item.altitude;
+				landing.start_alt_relative = mission_item.altitude_is_relative;
+				landing.available = true;
+			}
+
+			if ((mission_item.nav_cmd == NAV_CMD_VTOL_LAND && is_vtol) || mission_item.nav_cmd == NAV_CMD_LAND) {
+				landing.lat = mission_item.lat;
+				landing.lon = mission_item.lon;
+				landing.alt = mission_item.altitude;
+				landing.alt_relative = mission_item.altitude_is_relative;
+
+				// don't have a valid land start yet, use the landing item itself then
+				if (!landing.available) {
+					landing.land_start_index = index;
+					landing.start_lat = landing.lat;
+					landing.start_lon = landing.lon;
+					landing.start_alt = landing.alt;
+					landing.start_alt_relative = landing.alt_relative;
+					landing.available = true;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MissionPlan::project(double lat, double lon, float &north, float &east) const
+{
+	if (!map_projection_initialized(&_reference)) {
+		return false;
+	}
+
+	return map_projection_project(&_reference, lat, lon, &north, &east) == 0;
+}
+
+bool MissionPlan::fillCache(unsigned index)
+{
+	const unsigned count = math::min(CACHE_SIZE, (unsigned)_count - index);
+	const ssize_t ret = dm_read_range(_dataman_id, index, count, _cache, sizeof(mission_item_s));
+
+	if (ret <= 0) {
+		_cache_count = 0;
+		return false;
+	}
+
+	_cache_start = index;
+	_cache_count = ret;
+	return true;
+}
+
+bool MissionPlan::readItem(unsigned index, mission_item_s &mission_item)
+{
+	if (index >= _count) {
+		return false;
+	}
+
+	if ((index < _cache_start || index >= _cache_start + _cache_count) && !fillCache(index)) {
+		return false;
+	}
+
+	mission_item = _cache[index - _cache_start];
+	return true;
+}
+
+bool MissionPlan::writeItem(unsigned index, const mission_item_s &mission_item)
+{
+	if (dm_write(_dataman_id, index, DM_PERSIST_POWER_ON_RESET, &mission_item,
+		     sizeof(mission_item_s)) != (ssize_t)sizeof(mission_item_s)) {
+		return false;
+	}
+
+	if (index >= _cache_start && index < _cache_start + _cache_count) {
+		_cache[index - _cache_start] = mission_item;
+	}
+
+	return true;
+}
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mission_plan.h
+ * Compiled in-memory representation of the active mission, built once per mission update.
+ *
+ * Keeps a compact entry per mission item (local position, altitude, leg length and heading),
+ * the planned landing sequence and a small read-ahead cache of full mission items, so that
+ * mission execution and RTL don't need to walk the mission in dataman.
+ */
+
+#pragma once
+
+#include "navigation.h"
+
+#include <dataman/dataman.h>
+#include <lib/ecl/geo/geo.h>
+#include <uORB/topics/mission.h>
+
+class MissionFeasibilityChecker;
+
+class MissionPlan
+{
+public:
+	MissionPlan() = default;
+	~MissionPlan();
+
+	MissionPlan(const MissionPlan &) = delete;
+	MissionPlan &operator=(const MissionPlan &) = delete;
+
+	enum ItemFlags : uint8_t {
+		FLAG_POSITION = (1 << 0),		///< item contains a position
+		FLAG_ALTITUDE_RELATIVE = (1 << 1),	///< altitude is relative to home
+		FLAG_DO_JUMP = (1 << 2),		///< item is a DO_JUMP
+	};
+
+	struct Item {
+		float north;		///< north position relative to the plan reference [m], 0 if the item has no position
+		float east;		///< east position relative to the plan reference [m], 0 if the item has no position
+		float altitude;		///< altitude as stored in the mission item [m]
+		float leg_length;	///< horizontal distance from the previous position item [m], 0 for the first one
+		float leg_heading;	///< heading of the leg from the previous position item [rad], NAN for the first one
+		uint16_t nav_cmd;
+		uint8_t flags;
+	};
+
+	/**
+	 * Planned landing sequence, see Mission::find_mission_land_start().
+	 */
+	struct Landing {
+		bool available;
+		uint16_t land_start_index;
+		double start_lat;
+		double start_lon;
+		float start_alt;
+		bool start_alt_relative;
+		double lat;
+		double lon;
+		float alt;
+		bool alt_relative;
+	};
+
+	/**
+	 * Compile the given mission, reading it from dataman once.
+	 * If there is not enough memory for the per item entries, only the landing sequence is available and
+	 * item() must not be used (check entriesValid()).
+	 * @param checker if set, every item is also fed to the (begun) checker, so that the mission is checked in the same pass
+	 * @return false on dataman read failure
+	 */
+	bool build(const mission_s &mission, MissionFeasibilityChecker *checker = nullptr);
+
+	/**
+	 * Drop all compiled data
+	 */
+	void reset();
+
+	uint16_t count() const { return _count; }
+	dm_item_t datamanId() const { return _dataman_id; }
+	bool entriesValid() const { return _items != nullptr; }
+	const Item &item(unsigned index) const { return _items[index]; }
+
+	/**
+	 * Planned landing sequence, which differs for VTOL since NAV_CMD_VTOL_LAND is only considered for VTOL vehicles.
+	 */
+	const Landing &landing(bool is_vtol) const { return _landing[is_vtol ? 1 : 0]; }
+
+	/**
+	 * Project a global position into the plan's local frame.
+	 * @return false if there's no reference (no position items)
+	 */
+	bool project(double lat, double lon, float &north, float &east) const;
+
+	/**
+	 * Read a full mission item through the read-ahead cache.
+	 */
+	bool readItem(unsigned index, mission_item_s &mission_item);
+
+	/**
+	 * Write a mission item to dataman and update the read-ahead cache.
+	 */
+	bool writeItem(unsigned index, const mission_item_s &mission_item);
+
+private:
+	static constexpr unsigned CACHE_SIZE = 8;
+
+	bool fillCache(unsigned index);
+
+	Item *_items{nullptr};
+	uint16_t _items_allocated{0};
+	uint16_t _count{0};
+	dm_item_t _dataman_id{DM_KEY_WAYPOINTS_OFFBOARD_0};
+
+	map_projection_reference_s _reference{};
+
+	Landing _landing[2] {};
+
+	mission_item_s _cache[CACHE_SIZE] {};
+	unsigned _cache_start{0};
+	unsigned _cache_count{0};
+};
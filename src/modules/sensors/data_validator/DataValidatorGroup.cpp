@@ -41,124 +41,249 @@
 
 #include "DataValidatorGroup.hpp"
 
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
 #include <px4_platform_common/log.h>
 
 #include <float.h>
 
-DataValidatorGroup::DataValidatorGroup(unsigned siblings)
+DataValidatorGroup::DataValidatorGroup(unsigned siblings) :
+	_siblings((siblings < MAX_SIBLINGS) ? siblings : MAX_SIBLINGS)
 {
+}
 
-	DataValidator *next = nullptr;
-	DataValidator *prev = nullptr;
-
-	for (unsigned i = 0; i < siblings; i++) {
-		next = new DataValidator();
+bool DataValidatorGroup::add_new_validator()
+{
+	if (_siblings >= MAX_SIBLINGS) {
+		return false;
+	}
 
-		if (i == 0) {
-			_first = next;
+	_siblings++;
+	return true;
+}
 
-		} else {
-			prev->setSibling(next);
-		}
+void DataValidatorGroup::put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count,
+			     uint8_t priority)
+{
+	if (index >= _siblings) {
+		return;
+	}
 
-		prev = next;
+	// this instance already has queued data, process it first
+	if (_queued & (1 << index)) {
+		update();
 	}
 
-	_last = next;
+	_queued_timestamp[index] = timestamp;
+	_queued_error_count[index] = error_count;
+	_queued_priority[index] = priority;
 
-	if (_first) {
-		_timeout_interval_us = _first->get_timeout();
+	for (unsigned axis = 0; axis < dimensions; axis++) {
+		_queued_value[axis][index] = val[axis];
 	}
+
+	_queued |= (1 << index);
 }
 
-DataValidatorGroup::~DataValidatorGroup()
+void DataValidatorGroup::update()
 {
-	while (_first) {
-		DataValidator *next = _first->sibling();
-		delete (_first);
-		_first = next;
+	if (_queued == 0) {
+		return;
 	}
-}
 
-DataValidator *DataValidatorGroup::add_new_validator()
-{
+	float event_count_inv[MAX_SIBLINGS] {};
+	bool running[MAX_SIBLINGS] {}; /**< queued and initialized, updated in the vectorized pass */
 
-	DataValidator *validator = new DataValidator();
+	for (unsigned i = 0; i < _siblings; i++) {
+		if (_queued & (1 << i)) {
+			_event_count[i]++;
 
-	if (!validator) {
-		return nullptr;
-	}
+			if (_queued_error_count[i] > _error_count[i]) {
+				_error_density[i] += (_queued_error_count[i] - _error_count[i]);
 
-	_last->setSibling(validator);
-	_last = validator;
-	_last->set_timeout(_timeout_interval_us);
-	return _last;
-}
+			} else if (_error_density[i] > 0) {
+				_error_density[i]--;
+			}
 
-void DataValidatorGroup::set_timeout(uint32_t timeout_interval_us)
-{
+			_error_count[i] = _queued_error_count[i];
+			_priority[i] = _queued_priority[i];
 
-	DataValidator *next = _first;
+			event_count_inv[i] = 1.f / _event_count[i];
+			running[i] = (_time_last[i] != 0);
+		}
+	}
 
-	while (next != nullptr) {
-		next->set_timeout(timeout_interval_us);
-		next = next->sibling();
+	// all instances and axes in one branchless pass, idle instances are masked
+	for (unsigned axis = 0; axis < dimensions; axis++) {
+		for (unsigned i = 0; i < MAX_SIBLINGS; i++) {
+			const float val = _queued_value[axis][i];
+			const float lp_val = val - _lp[axis][i];
+			const float delta_val = lp_val - _mean[axis][i];
+			const float mean = _mean[axis][i] + delta_val * event_count_inv[i];
+			const float M2 = _M2[axis][i] + delta_val * (lp_val - mean);
+			const bool equal = fabsf(_value[axis][i] - val) < 0.000001f;
+
+			_mean[axis][i] = running[i] ? mean : _mean[axis][i];
+			_M2[axis][i] = running[i] ? M2 : _M2[axis][i];
+			_lp[axis][i] = running[i] ? (_lp[axis][i] * 0.99f + 0.01f * val) : _lp[axis][i];
+			_value[axis][i] = running[i] ? val : _value[axis][i];
+			_value_equal_count[i] = running[i] ? (equal ? _value_equal_count[i] + 1 : 0) : _value_equal_count[i];
+		}
+	}
+
+	for (unsigned i = 0; i < _siblings; i++) {
+		if (_queued & (1 << i)) {
+			if (_time_last[i] == 0) {
+				// first sample
+				for (unsigned axis = 0; axis < dimensions; axis++) {
+					_mean[axis][i] = 0.f;
+					_lp[axis][i] = _queued_value[axis][i];
+					_M2[axis][i] = 0.f;
+					_value[axis][i] = _queued_value[axis][i];
+				}
+			}
+
+			_time_last[i] = _queued_timestamp[i];
+		}
 	}
 
-	_timeout_interval_us = timeout_interval_us;
+	_updated |= _queued;
+	_queued = 0;
 }
 
-void DataValidatorGroup::set_equal_value_threshold(uint32_t threshold)
+float DataValidatorGroup::confidence(unsigned i, uint64_t timestamp)
 {
+	float ret = 1.0f;
+
+	/* check if we have any data */
+	if (_time_last[i] == 0) {
+		_error_mask[i] |= DataValidator::ERROR_FLAG_NO_DATA;
+		ret = 0.0f;
+
+	} else if (timestamp - _time_last[i] > _timeout_interval_us) {
+		/* timed out - that's it */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_TIMEOUT;
+		ret = 0.0f;
+
+	} else if (_value_equal_count[i] > _value_equal_count_threshold) {
+		/* we got the exact same sensor value N times in a row */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_STALE_DATA;
+		ret = 0.0f;
+
+	} else if (_error_count[i] > DataValidator::NORETURN_ERRCOUNT) {
+		/* check error count limit */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_HIGH_ERRCOUNT;
+		ret = 0.0f;
+
+	} else if (_error_density[i] > DataValidator::ERROR_DENSITY_WINDOW) {
+		/* cap error density counter at window size */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_HIGH_ERRDENSITY;
+		_error_density[i] = DataValidator::ERROR_DENSITY_WINDOW;
+	}
 
-	DataValidator *next = _first;
+	/* no critical errors */
+	if (ret > 0.0f) {
+		/* return local error density for last N measurements */
+		ret = 1.0f - (_error_density[i] / DataValidator::ERROR_DENSITY_WINDOW);
 
-	while (next != nullptr) {
-		next->set_equal_value_threshold(threshold);
-		next = next->sibling();
+		if (ret > 0.0f) {
+			_error_mask[i] = DataValidator::ERROR_FLAG_NO_ERROR;
+		}
 	}
+
+	return ret;
 }
 
-void DataValidatorGroup::put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count,
-			     uint8_t priority)
+void DataValidatorGroup::update_median(const float confidence[MAX_SIBLINGS])
 {
+	for (unsigned axis = 0; axis < dimensions; axis++) {
+		float valid[MAX_SIBLINGS];
+		unsigned n = 0;
 
-	DataValidator *next = _first;
-	unsigned i = 0;
+		for (unsigned i = 0; i < _siblings; i++) {
+			if (confidence[i] > 0.f) {
+				valid[n++] = _value[axis][i];
+			}
+		}
 
-	while (next != nullptr) {
-		if (i == index) {
-			next->put(timestamp, val, error_count, priority);
+		switch (n) {
+		case 1:
+			_median[axis] = valid[0];
+			break;
+
+		case 2:
+			_median[axis] = 0.5f * (valid[0] + valid[1]);
+			break;
+
+		case 3:
+			_median[axis] = math::max(math::min(valid[0], valid[1]), math::min(math::max(valid[0], valid[1]), valid[2]));
+			break;
+
+		case 4:
+			// mean of the two middle values
+			_median[axis] = 0.5f * (valid[0] + valid[1] + valid[2] + valid[3]
+						- math::min(math::min(valid[0], valid[1]), math::min(valid[2], valid[3]))
+						- math::max(math::max(valid[0], valid[1]), math::max(valid[2], valid[3])));
 			break;
 		}
+	}
+
+	for (unsigned i = 0; i < _siblings; i++) {
+		if ((_updated & (1 << i)) && (confidence[i] > 0.f)) {
+			float distance_sq = 0.f;
+
+			for (unsigned axis = 0; axis < dimensions; axis++) {
+				const float diff = _value[axis][i] - _median[axis];
+				distance_sq += diff * diff;
+			}
 
-		next = next->sibling();
-		i++;
+			_inconsistency_sq[i] += INCONSISTENCY_FILTER_ALPHA * (distance_sq - _inconsistency_sq[i]);
+		}
 	}
+
+	_updated = 0;
 }
 
 float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 {
+	update();
+
+	float confidence[MAX_SIBLINGS] {};
+	unsigned valid_count = 0;
 
-	DataValidator *next = _first;
+	for (unsigned i = 0; i < _siblings; i++) {
+		confidence[i] = this->confidence(i, timestamp);
+
+		if (confidence[i] > 0.f) {
+			valid_count++;
+		}
+	}
+
+	// median voting: exclude instances disagreeing with the majority
+	if (_inconsistency_threshold > 0.f) {
+		update_median(confidence);
+
+		if (valid_count >= 3) {
+			for (unsigned i = 0; i < _siblings; i++) {
+				if ((confidence[i] > 0.f) && (_inconsistency_sq[i] > _inconsistency_threshold * _inconsistency_threshold)) {
+					_error_mask[i] |= ERROR_FLAG_INCONSISTENT;
+					confidence[i] = 0.f;
+				}
+			}
+		}
+	}
 
-	// XXX This should eventually also include voting
 	int pre_check_best = _curr_best;
 	float pre_check_confidence = 1.0f;
 	int pre_check_prio = -1;
 	float max_confidence = -1.0f;
 	int max_priority = -1000;
 	int max_index = -1;
-	DataValidator *best = nullptr;
-
-	int i = 0;
-
-	while (next != nullptr) {
-		float confidence = next->confidence(timestamp);
 
-		if (i == pre_check_best) {
-			pre_check_prio = next->priority();
-			pre_check_confidence = confidence;
+	for (unsigned i = 0; i < _siblings; i++) {
+		if ((int)i == pre_check_best) {
+			pre_check_prio = _priority[i];
+			pre_check_confidence = confidence[i];
 		}
 
 		/*
@@ -166,18 +291,14 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 		 * 1) the confidence is higher and priority is equal or higher
 		 * 2) the confidence is less than 1% different and the priority is higher
 		 */
-		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence >= MIN_REGULAR_CONFIDENCE)) ||
-		     (confidence > max_confidence && (next->priority() >= max_priority)) ||
-		     (fabsf(confidence - max_confidence) < 0.01f && (next->priority() > max_priority))) &&
-		    (confidence > 0.0f)) {
+		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence[i] >= MIN_REGULAR_CONFIDENCE)) ||
+		     (confidence[i] > max_confidence && (_priority[i] >= max_priority)) ||
+		     (fabsf(confidence[i] - max_confidence) < 0.01f && (_priority[i] > max_priority))) &&
+		    (confidence[i] > 0.0f)) {
 			max_index = i;
-			max_confidence = confidence;
-			max_priority = next->priority();
-			best = next;
+			max_confidence = confidence[i];
+			max_priority = _priority[i];
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	/* the current best sensor is not matching the previous best sensor,
@@ -192,8 +313,8 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 			true_failsafe = false;
 
 			/* reset error flags, this is likely a hotplug sensor coming online late */
-			if (best != nullptr) {
-				best->reset_state();
+			if (max_index >= 0) {
+				_error_mask[max_index] = DataValidator::ERROR_FLAG_NO_ERROR;
 			}
 		}
 
@@ -220,7 +341,16 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 	}
 
 	*index = max_index;
-	return (best) ? best->value() : nullptr;
+
+	if (max_index >= 0) {
+		for (unsigned axis = 0; axis < dimensions; axis++) {
+			_best[axis] = _value[axis][max_index];
+		}
+
+		return _best;
+	}
+
+	return nullptr;
 }
 
 void DataValidatorGroup::print()
@@ -228,42 +358,37 @@ void DataValidatorGroup::print()
 	PX4_INFO("validator: best: %d, prev best: %d, failsafe: %s (%u events)", _curr_best, _prev_best,
 		 (_toggle_count > 0) ? "YES" : "NO", _toggle_count);
 
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used()) {
-			uint32_t flags = next->state();
+	for (unsigned i = 0; i < _siblings; i++) {
+		if (_time_last[i] > 0) {
+			uint32_t flags = _error_mask[i];
 
-			PX4_INFO("sensor #%u, prio: %d, state:%s%s%s%s%s%s", i, next->priority(),
+			PX4_INFO("sensor #%u, prio: %d, inconsistency: %.4f, state:%s%s%s%s%s%s%s", i, _priority[i],
+				 (double)inconsistency(i),
 				 ((flags & DataValidator::ERROR_FLAG_NO_DATA) ? " OFF" : ""),
 				 ((flags & DataValidator::ERROR_FLAG_STALE_DATA) ? " STALE" : ""),
 				 ((flags & DataValidator::ERROR_FLAG_TIMEOUT) ? " TOUT" : ""),
 				 ((flags & DataValidator::ERROR_FLAG_HIGH_ERRCOUNT) ? " ECNT" : ""),
 				 ((flags & DataValidator::ERROR_FLAG_HIGH_ERRDENSITY) ? " EDNST" : ""),
+				 ((flags & ERROR_FLAG_INCONSISTENT) ? " INCONS" : ""),
 				 ((flags == DataValidator::ERROR_FLAG_NO_ERROR) ? " OK" : ""));
 
-			next->print();
-		}
+			// RMS is only needed for reporting
+			const float event_count_inv = (_event_count[i] > 1) ? 1.f / (_event_count[i] - 1) : 0.f;
+			const float conf = confidence(i, hrt_absolute_time());
 
-		next = next->sibling();
-		i++;
+			for (unsigned axis = 0; axis < dimensions; axis++) {
+				PX4_INFO("\tval: %8.4f, lp: %8.4f mean dev: %8.4f RMS: %8.4f conf: %8.4f", (double)_value[axis][i],
+					 (double)_lp[axis][i], (double)_mean[axis][i], (double)sqrtf(_M2[axis][i] * event_count_inv), (double)conf);
+			}
+		}
 	}
 }
 
 int DataValidatorGroup::failover_index()
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) &&
-		    (i == (unsigned)_prev_best)) {
-			return i;
-		}
-
-		next = next->sibling();
-		i++;
+	if ((_prev_best >= 0) && ((unsigned)_prev_best < _siblings) && (_time_last[_prev_best] > 0)
+	    && (_error_mask[_prev_best] != DataValidator::ERROR_FLAG_NO_ERROR)) {
+		return _prev_best;
 	}
 
 	return -1;
@@ -271,18 +396,10 @@ int DataValidatorGroup::failover_index()
 
 uint32_t DataValidatorGroup::failover_state()
 {
+	const int index = failover_index();
 
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) &&
-		    (i == (unsigned)_prev_best)) {
-			return next->state();
-		}
-
-		next = next->sibling();
-		i++;
+	if (index >= 0) {
+		return _error_mask[index];
 	}
 
 	return DataValidator::ERROR_FLAG_NO_ERROR;
@@ -290,16 +407,8 @@ uint32_t DataValidatorGroup::failover_state()
 
 uint32_t DataValidatorGroup::get_sensor_state(unsigned index)
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (i == index) {
-			return next->state();
-		}
-
-		next = next->sibling();
-		i++;
+	if (index < _siblings) {
+		return _error_mask[index];
 	}
 
 	// sensor index not found
@@ -36,6 +36,9 @@
  *
  * A data validation group to identify anomalies in data streams
  *
+ * The statistics of all instances are kept in structure of arrays form and
+ * updated together, so a vote costs a single pass over all instances and axes.
+ *
  * @author Lorenz Meier <lorenz@px4.io>
  */
 
@@ -46,20 +49,24 @@
 class DataValidatorGroup
 {
 public:
+	static constexpr unsigned MAX_SIBLINGS = 4;
+	static constexpr unsigned dimensions = DataValidator::dimensions;
+
 	/**
-	 * @param siblings initial number of DataValidator's. Must be > 0.
+	 * @param siblings initial number of validated instances. Must be > 0 and <= MAX_SIBLINGS.
 	 */
 	DataValidatorGroup(unsigned siblings);
-	~DataValidatorGroup();
+	~DataValidatorGroup() = default;
 
 	/**
-	 * Create a new Validator (with index equal to the number of currently existing validators)
-	 * @return the newly created DataValidator or nullptr on error
+	 * Add a new instance (with index equal to the number of currently existing instances)
+	 * @return true on success, false if the group is full
 	 */
-	DataValidator *add_new_validator();
+	bool add_new_validator();
 
 	/**
-	 * Put an item into the validator group.
+	 * Put an item into the validator group. The data is queued and processed
+	 * together with the other instances on the next vote.
 	 *
 	 * @param index		Sensor index
 	 * @param timestamp	The timestamp of the measurement
@@ -76,6 +83,21 @@ public:
 	 */
 	float *get_best(uint64_t timestamp, int *index);
 
+	/**
+	 * Get the per axis median of all valid instances, updated by get_best() while median voting is enabled
+	 *
+	 * @return		pointer to the median triplet
+	 */
+	const float *median() const { return _median; }
+
+	/**
+	 * Get the inconsistency of an instance, the RMS distance from the median of all valid instances.
+	 * Only tracked while median voting is enabled.
+	 *
+	 * @return		inconsistency in sensor units, 0 if unknown
+	 */
+	float inconsistency(unsigned index) const { return (index < _siblings) ? sqrtf(_inconsistency_sq[index]) : 0.f; }
+
 	/**
 	 * Get the number of failover events
 	 *
@@ -115,20 +137,76 @@ public:
 	 *
 	 * @param timeout_interval_us The timeout interval in microseconds
 	 */
-	void set_timeout(uint32_t timeout_interval_us);
+	void set_timeout(uint32_t timeout_interval_us) { _timeout_interval_us = timeout_interval_us; }
 
 	/**
 	 * Set the equal count threshold for the whole group
 	 *
 	 * @param threshold The number of equal values before considering the sensor stale
 	 */
-	void set_equal_value_threshold(uint32_t threshold);
+	void set_equal_value_threshold(uint32_t threshold) { _value_equal_count_threshold = threshold; }
+
+	/**
+	 * Enable median voting. With at least 3 valid instances, an instance whose inconsistency
+	 * exceeds the threshold is flagged ERROR_FLAG_INCONSISTENT and excluded from the vote.
+	 *
+	 * @param threshold Maximum inconsistency in sensor units, 0 to disable
+	 */
+	void set_inconsistency_threshold(float threshold) { _inconsistency_threshold = threshold; }
+
+	/**
+	 * Additional group error state (the instance disagrees with the median of the group)
+	 */
+	static constexpr uint32_t ERROR_FLAG_INCONSISTENT = (0x00000001U << 5);
 
 private:
-	DataValidator *_first{nullptr}; /**< first node in the group */
-	DataValidator *_last{nullptr};  /**< last node in the group */
+	/**
+	 * Process all queued data
+	 */
+	void update();
+
+	/**
+	 * Update the error state and get the confidence of an instance
+	 * @return		the confidence between 0 and 1
+	 */
+	float confidence(unsigned index, uint64_t timestamp);
 
-	uint32_t _timeout_interval_us{0}; /**< currently set timeout */
+	/**
+	 * Update the median of the valid instances and the inconsistency of the updated ones
+	 */
+	void update_median(const float confidence[MAX_SIBLINGS]);
+
+	unsigned _siblings{0}; /**< number of instances in use */
+
+	uint32_t _timeout_interval_us{DataValidator::TIMEOUT_INTERVAL_DEFAULT}; /**< currently set timeout */
+	uint32_t _value_equal_count_threshold{DataValidator::VALUE_EQUAL_COUNT_DEFAULT}; /**< when to consider an equal count as a problem */
+
+	// queued input, processed by update()
+	uint8_t _queued{0}; /**< bitmask of instances with queued data */
+	uint8_t _updated{0}; /**< bitmask of instances updated since the last median */
+	uint64_t _queued_timestamp[MAX_SIBLINGS] {};
+	float _queued_value[dimensions][MAX_SIBLINGS] {};
+	uint32_t _queued_error_count[MAX_SIBLINGS] {};
+	uint8_t _queued_priority[MAX_SIBLINGS] {};
+
+	// per instance state, see DataValidator
+	uint64_t _time_last[MAX_SIBLINGS] {};   /**< last timestamp */
+	uint64_t _event_count[MAX_SIBLINGS] {}; /**< total data counter */
+	uint32_t _error_mask[MAX_SIBLINGS] {};  /**< sensor error state */
+	uint32_t _error_count[MAX_SIBLINGS] {}; /**< error count */
+	int _error_density[MAX_SIBLINGS] {};    /**< ratio between successful reads and errors */
+	unsigned _value_equal_count[MAX_SIBLINGS] {}; /**< equal values in a row */
+	uint8_t _priority[MAX_SIBLINGS] {};     /**< sensor nominal priority */
+
+	float _mean[dimensions][MAX_SIBLINGS] {}; /**< mean of value */
+	float _lp[dimensions][MAX_SIBLINGS] {};   /**< low pass value */
+	float _M2[dimensions][MAX_SIBLINGS] {};   /**< RMS component value */
+	float _value[dimensions][MAX_SIBLINGS] {}; /**< last value */
+
+	float _best[dimensions] {};                 /**< last value of the best instance */
+	float _median[dimensions] {};               /**< median of the valid instances */
+	float _inconsistency_sq[MAX_SIBLINGS] {};   /**< filtered squared distance from the median */
+	float _inconsistency_threshold{0.f};        /**< median voting threshold, 0 if disabled */
 
 	int _curr_best{-1}; /**< currently best index */
 	int _prev_best{-1}; /**< the previous best index */
@@ -138,6 +216,7 @@ private:
 	unsigned _toggle_count{0}; /**< number of back and forth switches between two sensors */
 
 	static constexpr float MIN_REGULAR_CONFIDENCE = 0.9f;
+	static constexpr float INCONSISTENCY_FILTER_ALPHA = 0.05f; /**< low pass coefficient of the inconsistency */
 
 	/* we don't want this class to be copied */
 	DataValidatorGroup(const DataValidatorGroup &);
@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Test code for the DataValidatorGroup
+ * Run this test only using make tests TESTFILTER=DataValidatorGroup
+ */
+
+#include <gtest/gtest.h>
+
+#include "DataValidatorGroup.hpp"
+
+static constexpr uint64_t TIMESTAMP_START = 1000000;
+static constexpr uint64_t DT = 4000; // 250 Hz
+
+// put a noisy triplet around value into an instance
+static void putNoisy(DataValidatorGroup &group, unsigned index, uint64_t timestamp, float value, uint8_t priority,
+		     uint32_t error_count = 0)
+{
+	const float noise = 0.01f * ((float)rand() / (float)RAND_MAX - 0.5f);
+	const float val[3] {value + noise, -value + noise, 9.81f + noise};
+	group.put(index, timestamp, val, error_count, priority);
+}
+
+TEST(DataValidatorGroupTest, HighestPriorityIsBest)
+{
+	// GIVEN: three healthy instances with different priorities
+	DataValidatorGroup group{1};
+	EXPECT_TRUE(group.add_new_validator());
+	EXPECT_TRUE(group.add_new_validator());
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+	float *best = nullptr;
+
+	for (int n = 0; n < 100; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 50);
+		putNoisy(group, 1, timestamp, 2.f, 75);
+		putNoisy(group, 2, timestamp, 3.f, 25);
+
+		// WHEN: voting
+		best = group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: the highest priority is selected and its data returned
+	EXPECT_EQ(best_index, 1);
+	ASSERT_NE(best, nullptr);
+	EXPECT_NEAR(best[0], 2.f, 0.01f);
+	EXPECT_EQ(group.failover_count(), 0u);
+	EXPECT_EQ(group.get_sensor_state(0), (uint32_t)DataValidator::ERROR_FLAG_NO_ERROR);
+	EXPECT_EQ(group.get_sensor_state(3), UINT32_MAX);
+}
+
+TEST(DataValidatorGroupTest, GroupIsLimited)
+{
+	// GIVEN: a full group
+	DataValidatorGroup group{DataValidatorGroup::MAX_SIBLINGS};
+
+	// THEN: no more instances can be added
+	EXPECT_FALSE(group.add_new_validator());
+}
+
+TEST(DataValidatorGroupTest, FailoverOnTimeout)
+{
+	// GIVEN: two healthy instances
+	DataValidatorGroup group{2};
+	group.set_timeout(20000);
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+
+	for (int n = 0; n < 100; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 75);
+		putNoisy(group, 1, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	EXPECT_EQ(best_index, 0);
+
+	// WHEN: the selected instance stops publishing
+	for (int n = 0; n < 10; n++) {
+		timestamp += DT;
+		putNoisy(group, 1, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: the other instance is selected and the failover is reported
+	EXPECT_EQ(best_index, 1);
+	EXPECT_EQ(group.failover_count(), 1u);
+	EXPECT_EQ(group.failover_index(), 0);
+	EXPECT_EQ(group.failover_state(), (uint32_t)DataValidator::ERROR_FLAG_TIMEOUT);
+}
+
+TEST(DataValidatorGroupTest, StaleData)
+{
+	// GIVEN: an instance publishing the exact same value
+	DataValidatorGroup group{2};
+	group.set_equal_value_threshold(50);
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+	const float val[3] {1.f, 2.f, 3.f};
+
+	for (int n = 0; n < 100; n++) {
+		timestamp += DT;
+
+		// WHEN: it is also queued multiple times per vote
+		group.put(0, timestamp, val, 0, 75);
+		group.put(0, timestamp - 1, val, 0, 75);
+		putNoisy(group, 1, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: it is flagged as stale
+	EXPECT_EQ(best_index, 1);
+	EXPECT_EQ(group.get_sensor_state(0), (uint32_t)DataValidator::ERROR_FLAG_STALE_DATA);
+}
+
+TEST(DataValidatorGroupTest, ErrorDensity)
+{
+	// GIVEN: two instances
+	DataValidatorGroup group{2};
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+
+	// WHEN: the preferred one reports a continuously increasing error count
+	for (int n = 0; n < 200; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 75, n * 2);
+		putNoisy(group, 1, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: the other instance is selected
+	EXPECT_EQ(best_index, 1);
+	EXPECT_EQ(group.get_sensor_state(0), (uint32_t)DataValidator::ERROR_FLAG_HIGH_ERRDENSITY);
+}
+
+TEST(DataValidatorGroupTest, MedianAndInconsistency)
+{
+	// GIVEN: three instances, one with an offset
+	DataValidatorGroup group{3};
+	group.set_inconsistency_threshold(10.f);
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+
+	for (int n = 0; n < 200; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 50);
+		putNoisy(group, 1, timestamp, 1.5f, 75);
+		putNoisy(group, 2, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: the median ignores the outlier and its inconsistency is the offset
+	EXPECT_NEAR(group.median()[0], 1.f, 0.01f);
+	EXPECT_NEAR(group.median()[1], -1.f, 0.01f);
+	EXPECT_NEAR(group.inconsistency(1), 0.5f * sqrtf(2.f), 0.02f);
+	EXPECT_LT(group.inconsistency(0), 0.02f);
+	EXPECT_LT(group.inconsistency(2), 0.02f);
+
+	// AND: below the threshold the highest priority is still selected
+	EXPECT_EQ(best_index, 1);
+	EXPECT_EQ(group.failover_count(), 0u);
+}
+
+TEST(DataValidatorGroupTest, MedianVoting)
+{
+	// GIVEN: three instances with median voting
+	DataValidatorGroup group{3};
+	group.set_inconsistency_threshold(0.3f);
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+
+	for (int n = 0; n < 100; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 50);
+		putNoisy(group, 1, timestamp, 1.f, 75);
+		putNoisy(group, 2, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	EXPECT_EQ(best_index, 1);
+
+	// WHEN: the selected instance drifts away from the others
+	for (int n = 0; n < 200; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 50);
+		putNoisy(group, 1, timestamp, 1.f + n * 0.01f, 75);
+		putNoisy(group, 2, timestamp, 1.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: it is voted out
+	EXPECT_NE(best_index, 1);
+	EXPECT_EQ(group.failover_count(), 1u);
+	EXPECT_EQ(group.failover_index(), 1);
+	EXPECT_EQ(group.failover_state(), (uint32_t)DataValidatorGroup::ERROR_FLAG_INCONSISTENT);
+}
+
+TEST(DataValidatorGroupTest, MedianVotingNeedsMajority)
+{
+	// GIVEN: only two instances with median voting
+	DataValidatorGroup group{2};
+	group.set_inconsistency_threshold(0.3f);
+
+	uint64_t timestamp = TIMESTAMP_START;
+	int best_index = -1;
+
+	// WHEN: they disagree
+	for (int n = 0; n < 200; n++) {
+		timestamp += DT;
+		putNoisy(group, 0, timestamp, 1.f, 75);
+		putNoisy(group, 1, timestamp, 3.f, 50);
+		group.get_best(timestamp, &best_index);
+	}
+
+	// THEN: there is no majority to vote against, keep the priority selection
+	EXPECT_EQ(best_index, 0);
+	EXPECT_EQ(group.get_sensor_state(0), (uint32_t)DataValidator::ERROR_FLAG_NO_ERROR);
+	EXPECT_EQ(group.get_sensor_state(1), (uint32_t)DataValidator::ERROR_FLAG_NO_ERROR);
+}
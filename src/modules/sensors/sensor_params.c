@@ -222,6 +222,36 @@ PARAM_DEFINE_INT32(SENS_EXT_I2C_PRB, 1);
  */
 PARAM_DEFINE_INT32(SENS_IMU_MODE, 1);
 
+/**
+ * Accelerometer median voting threshold
+ *
+ * With at least 3 valid accelerometers, an instance whose filtered distance
+ * from the per axis median exceeds this threshold is excluded from the vote.
+ * Set to 0 to disable median voting.
+ *
+ * @min 0
+ * @max 20
+ * @unit m/s^2
+ * @decimal 2
+ * @group Sensors
+ */
+PARAM_DEFINE_FLOAT(SENS_ACC_VOTE_TH, 0.0f);
+
+/**
+ * Gyroscope median voting threshold
+ *
+ * With at least 3 valid gyroscopes, an instance whose filtered distance
+ * from the per axis median exceeds this threshold is excluded from the vote.
+ * Set to 0 to disable median voting.
+ *
+ * @min 0
+ * @max 5
+ * @unit rad/s
+ * @decimal 3
+ * @group Sensors
+ */
+PARAM_DEFINE_FLOAT(SENS_GYR_VOTE_TH, 0.0f);
+
 /**
  * Enable internal barometers
  *
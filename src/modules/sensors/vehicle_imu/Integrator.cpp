@@ -73,6 +73,89 @@ bool Integrator::put(const hrt_abstime &timestamp, const Vector3f &val)
 	return true;
 }
 
+bool Integrator::put_batch(const hrt_abstime &timestamp_sample, const int16_t x[], const int16_t y[],
+			   const int16_t z[], uint8_t samples, float dt, float scale, Vector3f delta_alpha[],
+			   const Vector3f delta_angle[], uint8_t delta_angle_samples)
+{
+	const hrt_abstime batch_interval = roundf((samples - 1) * dt);
+
+	if ((samples == 0) || !(dt > 0.f) || (timestamp_sample <= batch_interval)) {
+		return false;
+	}
+
+	const hrt_abstime timestamp_first = timestamp_sample - batch_interval;
+	const float dt_s = dt * 1e-6f;
+
+	// interval from the previous integration to the first sample of this batch (covers any gap)
+	float dt_first = static_cast<float>(timestamp_first - _last_integration_time) * 1e-6f;
+	int start = 0;
+
+	if ((_last_integration_time == 0) || (timestamp_first <= _last_integration_time)) {
+		/* the first sample of the batch is the first item in the integrator */
+		_last_integration_time = timestamp_first;
+		_last_reset_time = timestamp_first;
+		_last_val = Vector3f{(float)x[0], (float)y[0], (float)z[0]} * scale;
+
+		if (delta_alpha) {
+			delta_alpha[0].zero();
+		}
+
+		dt_first = dt_s;
+		start = 1;
+
+		if (samples == 1) {
+			return false;
+		}
+	}
+
+	// sculling requires a whole number of gyro delta angles per accel sample
+	const int gyro_per_sample = (delta_angle && !_coning_comp_on && (delta_angle_samples % samples == 0)) ?
+				    delta_angle_samples / samples : 0;
+
+	for (int i = start; i < samples; i++) {
+		const Vector3f val{scale * x[i], scale * y[i], scale * z[i]};
+
+		// trapezoidal integration
+		const Vector3f delta = (val + _last_val) * (0.5f * ((i == 0) ? dt_first : dt_s));
+		_last_val = val;
+
+		if (delta_alpha) {
+			delta_alpha[i] = delta;
+		}
+
+		if (_coning_comp_on) {
+			// see put() for the coning compensation reference
+			_beta += ((_last_alpha + _last_delta_alpha * (1.f / 6.f)) % delta) * 0.5f;
+			_last_delta_alpha = delta;
+			_last_alpha = _alpha;
+
+		} else if (gyro_per_sample > 0) {
+			// Sculling compensation following:
+			// Savage (1998) Strapdown Inertial Navigation Integration Algorithm Design Part 2: Velocity and Position Algorithms
+			Vector3f delta_theta{};
+
+			for (int k = i * gyro_per_sample; k < (i + 1) * gyro_per_sample; k++) {
+				delta_theta += delta_angle[k];
+			}
+
+			_beta += ((_sculling_theta + _sculling_last_delta_theta * (1.f / 6.f)) % delta
+				  + (_alpha + _last_delta_alpha * (1.f / 6.f)) % delta_theta) * 0.5f;
+
+			_sculling_theta += delta_theta;
+			_sculling_last_delta_theta = delta_theta;
+			_last_delta_alpha = delta;
+		}
+
+		// accumulate delta integrals
+		_alpha += delta;
+	}
+
+	_integrated_samples = math::min(_integrated_samples + samples - start, (int)UINT8_MAX);
+	_last_integration_time = timestamp_sample;
+
+	return true;
+}
+
 bool Integrator::reset(Vector3f &integral, uint32_t &integral_dt)
 {
 	if (integral_ready()) {
@@ -83,12 +166,11 @@ bool Integrator::reset(Vector3f &integral, uint32_t &integral_dt)
 		_last_reset_time = _last_integration_time;
 		_integrated_samples = 0;
 
-		// apply coning corrections if required
-		if (_coning_comp_on) {
-			integral += _beta;
-			_beta.zero();
-			_last_alpha.zero();
-		}
+		// apply coning or sculling corrections if required (zero otherwise)
+		integral += _beta;
+		_beta.zero();
+		_last_alpha.zero();
+		_sculling_theta.zero();
 
 		return true;
 	}
@@ -75,6 +75,41 @@ public:
 		return put(timestamp, val) && reset(integral, integral_dt);
 	}
 
+	/**
+	 * Put a batch of equally spaced raw FIFO samples into the integral in a single pass.
+	 *
+	 * @param timestamp_sample	Timestamp of the last sample in the batch.
+	 * @param x, y, z		Raw samples (oldest first).
+	 * @param samples		Number of samples in the batch.
+	 * @param dt			Interval between samples in us.
+	 * @param scale			Scale factor from raw to SI units.
+	 * @param delta_alpha		Optional output for the per sample delta integrals (size samples), used for sculling.
+	 * @return			true if data was accepted and integrated.
+	 */
+	bool put(const uint64_t &timestamp_sample, const int16_t x[], const int16_t y[], const int16_t z[], uint8_t samples,
+		 float dt, float scale, matrix::Vector3f delta_alpha[] = nullptr)
+	{
+		return put_batch(timestamp_sample, x, y, z, samples, dt, scale, delta_alpha, nullptr, 0);
+	}
+
+	/**
+	 * Put a batch of equally spaced raw accel FIFO samples into the integral applying sculling corrections
+	 * using the matching gyro delta angles. The gyro batch must end at the same sample time and contain an
+	 * integer multiple of the accel samples, otherwise the batch is integrated without sculling corrections.
+	 *
+	 * Only the sculling term is accumulated, the rotation compensation (0.5 * delta angle x delta velocity)
+	 * is left to the consumer as with the uncompensated delta velocity.
+	 *
+	 * @param delta_angle		Per sample gyro delta angles in the same sensor frame.
+	 * @param delta_angle_samples	Number of gyro delta angles.
+	 * @return			true if data was accepted and integrated.
+	 */
+	bool put_sculling(const uint64_t &timestamp_sample, const int16_t x[], const int16_t y[], const int16_t z[],
+			  uint8_t samples, float dt, float scale, const matrix::Vector3f delta_angle[], uint8_t delta_angle_samples)
+	{
+		return put_batch(timestamp_sample, x, y, z, samples, dt, scale, nullptr, delta_angle, delta_angle_samples);
+	}
+
 	/**
 	 * Set reset interval during runtime. This won't reset the integrator.
 	 *
@@ -105,15 +140,22 @@ public:
 	bool reset(matrix::Vector3f &integral, uint32_t &integral_dt);
 
 private:
+	bool put_batch(const uint64_t &timestamp_sample, const int16_t x[], const int16_t y[], const int16_t z[],
+		       uint8_t samples, float dt, float scale, matrix::Vector3f delta_alpha[],
+		       const matrix::Vector3f delta_angle[], uint8_t delta_angle_samples);
+
 	uint64_t _last_integration_time{0}; /**< timestamp of the last integration step */
 	uint64_t _last_reset_time{0};       /**< last auto-announcement of integral value */
 
 	matrix::Vector3f _alpha{0.f, 0.f, 0.f};            /**< integrated value before coning corrections are applied */
 	matrix::Vector3f _last_alpha{0.f, 0.f, 0.f};       /**< previous value of _alpha */
-	matrix::Vector3f _beta{0.f, 0.f, 0.f};             /**< accumulated coning corrections */
+	matrix::Vector3f _beta{0.f, 0.f, 0.f};             /**< accumulated coning or sculling corrections */
 	matrix::Vector3f _last_val{0.f, 0.f, 0.f};         /**< previous input */
 	matrix::Vector3f _last_delta_alpha{0.f, 0.f, 0.f}; /**< integral from previous previous sampling interval */
 
+	matrix::Vector3f _sculling_theta{0.f, 0.f, 0.f};            /**< gyro delta angle accumulated since the last reset */
+	matrix::Vector3f _sculling_last_delta_theta{0.f, 0.f, 0.f}; /**< gyro delta angle from the previous sampling interval */
+
 	uint32_t _reset_interval_min{1}; /**< the interval after which the content will be published and the integrator reset */
 
 	uint8_t _integrated_samples{0};
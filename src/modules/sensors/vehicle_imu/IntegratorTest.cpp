@@ -0,0 +1,267 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Test code for the IMU integrator
+ * Run this test only using make tests TESTFILTER=Integrator
+ */
+
+#include <gtest/gtest.h>
+#include <drivers/drv_hrt.h>
+#include <matrix/math.hpp>
+
+#include "Integrator.hpp"
+
+using matrix::Dcmf;
+using matrix::Eulerf;
+using matrix::Vector3f;
+
+static constexpr float GYRO_SCALE = 1e-4f;  // rad/s per LSB
+static constexpr float ACCEL_SCALE = 1e-3f; // m/s^2 per LSB
+static constexpr float GYRO_DT = 125.f;     // 8 kHz gyro
+static constexpr uint8_t FIFO_SAMPLES = 8;  // 1 kHz FIFO reads
+static constexpr uint8_t INTEGRAL_SAMPLES = 40; // 200 Hz IMU_INTEG_RATE
+
+// sculling motion: angular oscillation about X in phase with a linear acceleration along Y
+static constexpr double FREQUENCY = 2. * M_PI * 250.;
+static constexpr double AMPLITUDE_ANGLE = 0.002; // rad
+static constexpr double AMPLITUDE_ACCEL = 10.;  // m/s^2
+
+static double angle(double t) { return AMPLITUDE_ANGLE * sin(FREQUENCY * t); }
+
+static Vector3f angularVelocity(double t) { return Vector3f(AMPLITUDE_ANGLE * FREQUENCY * cos(FREQUENCY * t), 0.f, 0.f); }
+
+static Vector3f specificForce(double t) { return Vector3f(0.f, AMPLITUDE_ACCEL * sin(FREQUENCY * t), 0.f); }
+
+// true delta velocity between t0 and t1 expressed in the body frame at t0
+static Vector3f trueDeltaVelocity(double t0, double t1)
+{
+	static constexpr int STEPS = 1000;
+	const double h = (t1 - t0) / STEPS;
+	Vector3f delta_velocity{};
+
+	for (int i = 0; i < STEPS; i++) {
+		const double t = t0 + (i + 0.5) * h;
+		const Dcmf rotation{Eulerf(angle(t) - angle(t0), 0.f, 0.f)};
+		delta_velocity += rotation * specificForce(t) * h;
+	}
+
+	return delta_velocity;
+}
+
+static void fillFifo(Vector3f(*signal)(double), float scale, hrt_abstime timestamp_sample, uint8_t samples, float dt,
+		     int16_t x[], int16_t y[], int16_t z[])
+{
+	for (int i = 0; i < samples; i++) {
+		const Vector3f val = signal((timestamp_sample - (samples - 1 - i) * (double)dt) * 1e-6) / scale;
+		x[i] = roundf(val(0));
+		y[i] = roundf(val(1));
+		z[i] = roundf(val(2));
+	}
+}
+
+// mean delta velocity sculling error over 1 second of sculling motion
+static float scullingError(uint8_t accel_decimation, bool sculling_compensation)
+{
+	Integrator gyro_integrator{true};
+	Integrator accel_integrator{};
+	gyro_integrator.set_reset_samples(INTEGRAL_SAMPLES);
+	accel_integrator.set_reset_samples(1);
+
+	const float accel_dt = GYRO_DT * accel_decimation;
+	const uint8_t accel_samples = FIFO_SAMPLES / accel_decimation;
+
+	hrt_abstime timestamp_sample = 10000;
+	float error_sum = 0.f;
+	int error_count = 0;
+
+	for (int n = 0; n < 1000; n++) {
+		timestamp_sample += FIFO_SAMPLES * GYRO_DT;
+
+		int16_t x[FIFO_SAMPLES], y[FIFO_SAMPLES], z[FIFO_SAMPLES];
+		Vector3f delta_angles[FIFO_SAMPLES];
+
+		fillFifo(angularVelocity, GYRO_SCALE, timestamp_sample, FIFO_SAMPLES, GYRO_DT, x, y, z);
+		EXPECT_TRUE(gyro_integrator.put(timestamp_sample, x, y, z, FIFO_SAMPLES, GYRO_DT, GYRO_SCALE, delta_angles));
+
+		fillFifo(specificForce, ACCEL_SCALE, timestamp_sample, accel_samples, accel_dt, x, y, z);
+
+		if (sculling_compensation) {
+			accel_integrator.put_sculling(timestamp_sample, x, y, z, accel_samples, accel_dt, ACCEL_SCALE,
+						      delta_angles, FIFO_SAMPLES);
+
+		} else {
+			accel_integrator.put(timestamp_sample, x, y, z, accel_samples, accel_dt, ACCEL_SCALE);
+		}
+
+		if (gyro_integrator.integral_ready()) {
+			Vector3f delta_angle;
+			Vector3f delta_velocity;
+			uint32_t gyro_integral_dt;
+			uint32_t accel_integral_dt;
+			EXPECT_TRUE(gyro_integrator.reset(delta_angle, gyro_integral_dt));
+			EXPECT_TRUE(accel_integrator.reset(delta_velocity, accel_integral_dt));
+
+			// rotation compensation is left to the consumer
+			delta_velocity += (delta_angle % delta_velocity) * 0.5f;
+
+			const Vector3f truth = trueDeltaVelocity((timestamp_sample - accel_integral_dt) * 1e-6, timestamp_sample * 1e-6);
+			// sculling rectifies into Z, orthogonal to the rotation and acceleration axes
+			error_sum += fabsf(delta_velocity(2) - truth(2));
+			error_count++;
+		}
+	}
+
+	EXPECT_GT(error_count, 150);
+
+	return error_sum / error_count;
+}
+
+TEST(IntegratorTest, BatchMatchesSequential)
+{
+	// GIVEN: a batch and a sequential coning integrator resetting at 200 Hz
+	Integrator batch{true};
+	Integrator sequential{true};
+	batch.set_reset_samples(INTEGRAL_SAMPLES);
+	sequential.set_reset_samples(INTEGRAL_SAMPLES);
+
+	hrt_abstime timestamp_sample = 10000;
+
+	for (int n = 0; n < 100; n++) {
+		timestamp_sample += FIFO_SAMPLES * GYRO_DT;
+
+		// WHEN: putting a FIFO batch at once or sample by sample
+		int16_t x[FIFO_SAMPLES], y[FIFO_SAMPLES], z[FIFO_SAMPLES];
+		fillFifo(angularVelocity, GYRO_SCALE, timestamp_sample, FIFO_SAMPLES, GYRO_DT, x, y, z);
+
+		// add some off axis motion so the coning corrections are non zero
+		for (int i = 0; i < FIFO_SAMPLES; i++) {
+			y[i] = x[(i + 2) % FIFO_SAMPLES] / 2;
+			z[i] = -x[(i + 5) % FIFO_SAMPLES] / 3;
+		}
+
+		batch.put(timestamp_sample, x, y, z, FIFO_SAMPLES, GYRO_DT, GYRO_SCALE);
+
+		for (int i = 0; i < FIFO_SAMPLES; i++) {
+			const hrt_abstime t = timestamp_sample - (FIFO_SAMPLES - 1 - i) * GYRO_DT;
+			sequential.put(t, Vector3f{(float)x[i], (float)y[i], (float)z[i]} * GYRO_SCALE);
+		}
+
+		// THEN: both produce the same delta angle
+		EXPECT_EQ(batch.integral_ready(), sequential.integral_ready());
+
+		if (batch.integral_ready()) {
+			Vector3f integral_batch;
+			Vector3f integral_sequential;
+			uint32_t dt_batch;
+			uint32_t dt_sequential;
+			EXPECT_TRUE(batch.reset(integral_batch, dt_batch));
+			EXPECT_TRUE(sequential.reset(integral_sequential, dt_sequential));
+			EXPECT_EQ(dt_batch, dt_sequential);
+			EXPECT_LT((integral_batch - integral_sequential).norm(), 1e-6f);
+		}
+	}
+}
+
+TEST(IntegratorTest, BatchDataGap)
+{
+	// GIVEN: an integrator fed with constant data
+	Integrator integrator{};
+	integrator.set_reset_interval(100000);
+
+	int16_t x[FIFO_SAMPLES], y[FIFO_SAMPLES], z[FIFO_SAMPLES];
+
+	for (int i = 0; i < FIFO_SAMPLES; i++) {
+		x[i] = 1000;
+		y[i] = -2000;
+		z[i] = 0;
+	}
+
+	// WHEN: a FIFO batch is missing
+	const hrt_abstime t0 = 10000;
+	integrator.put(t0, x, y, z, FIFO_SAMPLES, GYRO_DT, GYRO_SCALE);
+	integrator.put(t0 + 2 * FIFO_SAMPLES * GYRO_DT, x, y, z, FIFO_SAMPLES, GYRO_DT, GYRO_SCALE);
+
+	// THEN: the gap is still integrated over
+	Vector3f integral;
+	uint32_t integral_dt;
+	EXPECT_TRUE(integrator.reset(integral, integral_dt));
+	EXPECT_EQ(integral_dt, (3 * FIFO_SAMPLES - 1) * GYRO_DT);
+	EXPECT_NEAR(integral(0), 1000 * GYRO_SCALE * integral_dt * 1e-6f, 1e-6f);
+	EXPECT_NEAR(integral(1), -2000 * GYRO_SCALE * integral_dt * 1e-6f, 1e-6f);
+	EXPECT_FLOAT_EQ(integral(2), 0.f);
+}
+
+TEST(IntegratorTest, ScullingCompensation)
+{
+	// GIVEN: sculling motion with the accel sampled at the gyro rate and at half the gyro rate
+	for (uint8_t accel_decimation : {1, 2}) {
+		// WHEN: integrating with and without sculling compensation
+		const float error_uncompensated = scullingError(accel_decimation, false);
+		const float error_compensated = scullingError(accel_decimation, true);
+
+		// THEN: the sculling corrections remove most of the delta velocity error
+		EXPECT_LT(error_compensated, 0.1f * error_uncompensated);
+	}
+}
+
+TEST(IntegratorTest, ScullingMismatchedBatch)
+{
+	// GIVEN: gyro delta angles that don't map to whole accel samples
+	Integrator plain{};
+	Integrator sculling{};
+
+	int16_t x[FIFO_SAMPLES], y[FIFO_SAMPLES], z[FIFO_SAMPLES];
+	Vector3f delta_angles[FIFO_SAMPLES];
+
+	for (int i = 0; i < FIFO_SAMPLES; i++) {
+		x[i] = 100 * i;
+		y[i] = 1000;
+		z[i] = -50 * i;
+		delta_angles[i] = Vector3f{0.01f, 0.02f, -0.01f};
+	}
+
+	// WHEN: integrating 3 accel samples against 8 gyro delta angles
+	plain.put(10000, x, y, z, 3, GYRO_DT, ACCEL_SCALE);
+	plain.put(11000, x, y, z, 3, GYRO_DT, ACCEL_SCALE);
+	sculling.put_sculling(10000, x, y, z, 3, GYRO_DT, ACCEL_SCALE, delta_angles, FIFO_SAMPLES);
+	sculling.put_sculling(11000, x, y, z, 3, GYRO_DT, ACCEL_SCALE, delta_angles, FIFO_SAMPLES);
+
+	// THEN: no sculling corrections are applied
+	Vector3f integral_plain;
+	Vector3f integral_sculling;
+	uint32_t integral_dt;
+	EXPECT_TRUE(plain.reset(integral_plain, integral_dt));
+	EXPECT_TRUE(sculling.reset(integral_sculling, integral_dt));
+	EXPECT_EQ(integral_plain, integral_sculling);
+}
@@ -103,6 +103,7 @@ void VehicleIMU::Stop()
 	// clear all registered callbacks
 	_sensor_accel_sub.unregisterCallback();
 	_sensor_gyro_sub.unregisterCallback();
+	_sensor_gyro_fifo_sub.unregisterCallback();
 
 	Deinit();
 }
@@ -207,11 +208,19 @@ void VehicleIMU::Run()
 		return;
 	}
 
+	if (!_fifo_checked) {
+		SelectSensorFifo();
+	}
 
 	bool sensor_data_gap = false;
 	bool update_integrator_config = false;
 	bool publish_status = false;
 
+	// integrate queued FIFO batches, sensor_gyro and sensor_accel only provide metadata in this case
+	if (_fifo_available) {
+		UpdateFifo(sensor_data_gap);
+	}
+
 	// integrate queued gyro
 	sensor_gyro_s gyro;
 
@@ -248,11 +257,13 @@ void VehicleIMU::Run()
 		_gyro_temperature += gyro.temperature;
 		_gyro_sum_count++;
 
-		_gyro_integrator.put(gyro.timestamp_sample, gyro_raw);
-		_last_timestamp_sample_gyro = gyro.timestamp_sample;
+		if (!_fifo_available && _fifo_checked) {
+			_gyro_integrator.put(gyro.timestamp_sample, gyro_raw);
+			_last_timestamp_sample_gyro = gyro.timestamp_sample;
+		}
 
 		// break if interval is configured and we haven't fallen behind
-		if (_intervals_configured && _gyro_integrator.integral_ready()
+		if (!_fifo_available && _intervals_configured && _gyro_integrator.integral_ready()
 		    && (hrt_elapsed_time(&gyro.timestamp) < _imu_integration_interval_us) && !sensor_data_gap) {
 
 			break;
@@ -295,8 +306,10 @@ void VehicleIMU::Run()
 		_accel_temperature += accel.temperature;
 		_accel_sum_count++;
 
-		_accel_integrator.put(accel.timestamp_sample, accel_raw);
-		_last_timestamp_sample_accel = accel.timestamp_sample;
+		if (!_fifo_available && _fifo_checked) {
+			_accel_integrator.put(accel.timestamp_sample, accel_raw);
+			_last_timestamp_sample_accel = accel.timestamp_sample;
+		}
 
 		if (accel.clip_counter[0] > 0 || accel.clip_counter[1] > 0 || accel.clip_counter[2] > 0) {
 
@@ -329,7 +342,7 @@ void VehicleIMU::Run()
 		}
 
 		// break once caught up to gyro
-		if (!sensor_data_gap && _intervals_configured
+		if (!_fifo_available && !sensor_data_gap && _intervals_configured
 		    && (_last_timestamp_sample_accel >= (_last_timestamp_sample_gyro - 0.5f * _accel_interval.update_interval))) {
 
 			break;
@@ -364,6 +377,12 @@ void VehicleIMU::Run()
 		if (_accel_integrator.reset(delta_velocity, accel_integral_dt)
 		    && _gyro_integrator.reset(delta_angle, gyro_integral_dt)) {
 
+			if (_fifo_available) {
+				// FIFO data is integrated in the sensor frame, rotate to the board frame
+				rotate_3f(static_cast<enum Rotation>(_gyro_fifo_rotation), delta_angle(0), delta_angle(1), delta_angle(2));
+				rotate_3f(static_cast<enum Rotation>(_accel_fifo_rotation), delta_velocity(0), delta_velocity(1), delta_velocity(2));
+			}
+
 			if (_accel_calibration.enabled() && _gyro_calibration.enabled()) {
 
 				// delta angle: apply offsets, scale, and board rotation
@@ -429,8 +448,160 @@ void VehicleIMU::Run()
 	}
 }
 
+void VehicleIMU::SelectSensorFifo()
+{
+	// wait until both sensors have published to find their FIFO topics by device id
+	uORB::SubscriptionData<sensor_accel_s> sensor_accel_sub{ORB_ID(sensor_accel), _sensor_accel_sub.get_instance()};
+	uORB::SubscriptionData<sensor_gyro_s> sensor_gyro_sub{ORB_ID(sensor_gyro), _sensor_gyro_sub.get_instance()};
+
+	const uint32_t accel_device_id = sensor_accel_sub.get().device_id;
+	const uint32_t gyro_device_id = sensor_gyro_sub.get().device_id;
+
+	if ((accel_device_id == 0) || (gyro_device_id == 0)) {
+		return;
+	}
+
+	_fifo_checked = true;
+
+	int accel_fifo_instance = -1;
+	int gyro_fifo_instance = -1;
+
+	for (uint8_t i = 0; i < calibration::Gyroscope::MAX_SENSOR_COUNT; i++) {
+		uORB::SubscriptionData<sensor_accel_fifo_s> sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo), i};
+		uORB::SubscriptionData<sensor_gyro_fifo_s> sensor_gyro_fifo_sub{ORB_ID(sensor_gyro_fifo), i};
+
+		if (sensor_accel_fifo_sub.get().device_id == accel_device_id) {
+			accel_fifo_instance = i;
+		}
+
+		if (sensor_gyro_fifo_sub.get().device_id == gyro_device_id) {
+			gyro_fifo_instance = i;
+		}
+	}
+
+	if ((accel_fifo_instance >= 0) && (gyro_fifo_instance >= 0)
+	    && _sensor_accel_fifo_sub.ChangeInstance(accel_fifo_instance)
+	    && _sensor_gyro_fifo_sub.ChangeInstance(gyro_fifo_instance)
+	    && _sensor_gyro_fifo_sub.registerCallback()) {
+
+		// schedule on the gyro FIFO only
+		_sensor_accel_sub.unregisterCallback();
+		_sensor_gyro_sub.unregisterCallback();
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+		_sensor_gyro_fifo_sub.set_required_updates(1);
+#endif // ENABLE_LOCKSTEP_SCHEDULER
+
+		// reset on the configured interval until the raw sample rate is known
+		_gyro_integrator.set_reset_samples(UINT8_MAX);
+
+		_fifo_available = true;
+	}
+}
+
+void VehicleIMU::UpdateFifo(bool &sensor_data_gap)
+{
+	sensor_gyro_fifo_s gyro_fifo;
+
+	while (_sensor_gyro_fifo_sub.update(&gyro_fifo)) {
+		if (_sensor_gyro_fifo_sub.get_last_generation() != _gyro_fifo_last_generation + 1) {
+			sensor_data_gap = true;
+			perf_count(_gyro_generation_gap_perf);
+		}
+
+		_gyro_fifo_last_generation = _sensor_gyro_fifo_sub.get_last_generation();
+
+		uint8_t gyro_samples = 0;
+
+		if ((gyro_fifo.samples > 0) && (gyro_fifo.samples <= FIFO_SIZE_MAX)
+		    && _gyro_integrator.put(gyro_fifo.timestamp_sample, gyro_fifo.x, gyro_fifo.y, gyro_fifo.z, gyro_fifo.samples,
+					    gyro_fifo.dt, gyro_fifo.scale, _gyro_fifo_delta_angle)) {
+
+			gyro_samples = gyro_fifo.samples;
+			_gyro_fifo_rotation = gyro_fifo.rotation;
+			_last_timestamp_sample_gyro = gyro_fifo.timestamp_sample;
+		}
+
+		// integrate accel up to the same sample time, applying sculling corrections when the batches match
+		sensor_accel_fifo_s accel_fifo;
+
+		while (_sensor_accel_fifo_sub.update(&accel_fifo)) {
+			if (_sensor_accel_fifo_sub.get_last_generation() != _accel_fifo_last_generation + 1) {
+				sensor_data_gap = true;
+				perf_count(_accel_generation_gap_perf);
+			}
+
+			_accel_fifo_last_generation = _sensor_accel_fifo_sub.get_last_generation();
+
+			if ((accel_fifo.samples > 0) && (accel_fifo.samples <= FIFO_SIZE_MAX)) {
+				bool integrated = false;
+
+				if ((gyro_samples > 0) && (accel_fifo.timestamp_sample == gyro_fifo.timestamp_sample)
+				    && (accel_fifo.rotation == gyro_fifo.rotation)) {
+
+					integrated = _accel_integrator.put_sculling(accel_fifo.timestamp_sample, accel_fifo.x, accel_fifo.y, accel_fifo.z,
+							accel_fifo.samples, accel_fifo.dt, accel_fifo.scale, _gyro_fifo_delta_angle, gyro_samples);
+
+				} else {
+					integrated = _accel_integrator.put(accel_fifo.timestamp_sample, accel_fifo.x, accel_fifo.y, accel_fifo.z,
+									   accel_fifo.samples, accel_fifo.dt, accel_fifo.scale);
+				}
+
+				if (integrated) {
+					_accel_fifo_rotation = accel_fifo.rotation;
+					_last_timestamp_sample_accel = accel_fifo.timestamp_sample;
+				}
+			}
+
+			if (accel_fifo.timestamp_sample >= gyro_fifo.timestamp_sample) {
+				break;
+			}
+		}
+
+		// break once the integral is ready and we haven't fallen behind
+		if (_gyro_integrator.integral_ready()
+		    && (hrt_elapsed_time(&gyro_fifo.timestamp) < _imu_integration_interval_us) && !sensor_data_gap) {
+
+			break;
+		}
+	}
+}
+
 void VehicleIMU::UpdateIntegratorConfiguration()
 {
+	if (_fifo_available) {
+		if ((_gyro_interval.update_interval > 0) && (_gyro_interval.update_interval_raw > 0)) {
+
+			const float configured_interval_us = 1e6f / _param_imu_integ_rate.get();
+
+			// FIFO data is integrated per raw sample
+			const uint8_t gyro_integral_samples = math::constrain(roundf(configured_interval_us / _gyro_interval.update_interval_raw),
+							      1.f, (float)UINT8_MAX);
+			const uint8_t gyro_integral_publications = math::max(1.f, roundf(configured_interval_us / _gyro_interval.update_interval));
+
+			// accel integrator will be forced to reset when gyro integrator is ready
+			_gyro_integrator.set_reset_samples(gyro_integral_samples);
+			_gyro_integrator.set_reset_interval(roundf((gyro_integral_samples - 0.5f) * _gyro_interval.update_interval_raw));
+			_accel_integrator.set_reset_samples(1);
+
+			// gyro FIFO: find largest integer multiple of gyro_integral_publications
+			for (int n = sensor_gyro_fifo_s::ORB_QUEUE_LENGTH; n > 0; n--) {
+				if (gyro_integral_publications % n == 0) {
+					_sensor_gyro_fifo_sub.set_required_updates(n);
+					break;
+				}
+			}
+
+			_intervals_configured = true; // stop monitoring topic publication rates
+
+			PX4_DEBUG("FIFO accel (%d), gyro (%d), gyro samples: %d, raw interval: %.1f, sub samples: %d",
+				  _accel_calibration.device_id(), _gyro_calibration.device_id(), gyro_integral_samples,
+				  (double)_gyro_interval.update_interval_raw, gyro_integral_publications);
+		}
+
+		return;
+	}
+
 	if ((_accel_interval.update_interval > 0) && (_gyro_interval.update_interval > 0)) {
 
 		const float configured_interval_us = 1e6f / _param_imu_integ_rate.get();
@@ -493,13 +664,15 @@ void VehicleIMU::UpdateGyroVibrationMetrics(const Vector3f &delta_angle)
 void VehicleIMU::PrintStatus()
 {
 	if (_accel_calibration.device_id() == _gyro_calibration.device_id()) {
-		PX4_INFO("%d - IMU ID: %d, accel interval: %.1f us, gyro interval: %.1f us", _instance, _accel_calibration.device_id(),
-			 (double)_accel_interval.update_interval, (double)_gyro_interval.update_interval);
+		PX4_INFO("%d - IMU ID: %d, accel interval: %.1f us, gyro interval: %.1f us %s", _instance,
+			 _accel_calibration.device_id(),
+			 (double)_accel_interval.update_interval, (double)_gyro_interval.update_interval, _fifo_available ? "FIFO" : "");
 
 	} else {
-		PX4_INFO("%d - Accel ID: %d, interval: %.1f us, Gyro ID: %d, interval: %.1f us", _instance,
+		PX4_INFO("%d - Accel ID: %d, interval: %.1f us, Gyro ID: %d, interval: %.1f us %s", _instance,
 			 _accel_calibration.device_id(),
-			 (double)_accel_interval.update_interval, _gyro_calibration.device_id(), (double)_gyro_interval.update_interval);
+			 (double)_accel_interval.update_interval, _gyro_calibration.device_id(), (double)_gyro_interval.update_interval,
+			 _fifo_available ? "FIFO" : "");
 	}
 
 	perf_print_counter(_accel_generation_gap_perf);
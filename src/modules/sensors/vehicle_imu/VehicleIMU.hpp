@@ -49,7 +49,9 @@
 #include <uORB/SubscriptionCallback.hpp>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_accel_fifo.h>
 #include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
 #include <uORB/topics/vehicle_imu.h>
 #include <uORB/topics/vehicle_imu_status.h>
 
@@ -84,6 +86,9 @@ private:
 		float update_interval_raw{0.f};
 	};
 
+	void SelectSensorFifo();
+	void UpdateFifo(bool &sensor_data_gap);
+
 	bool UpdateIntervalAverage(IntervalAverage &intavg, const hrt_abstime &timestamp_sample, uint8_t samples = 1);
 	void UpdateIntegratorConfiguration();
 	void UpdateGyroVibrationMetrics(const matrix::Vector3f &delta_angle);
@@ -97,6 +102,9 @@ private:
 	uORB::SubscriptionCallbackWorkItem _sensor_accel_sub;
 	uORB::SubscriptionCallbackWorkItem _sensor_gyro_sub;
 
+	uORB::Subscription _sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo)};
+	uORB::SubscriptionCallbackWorkItem _sensor_gyro_fifo_sub{this, ORB_ID(sensor_gyro_fifo)};
+
 	calibration::Accelerometer _accel_calibration{};
 	calibration::Gyroscope _gyro_calibration{};
 
@@ -113,6 +121,8 @@ private:
 
 	unsigned _accel_last_generation{0};
 	unsigned _gyro_last_generation{0};
+	unsigned _accel_fifo_last_generation{0};
+	unsigned _gyro_fifo_last_generation{0};
 	unsigned _consecutive_data_gap{0};
 
 	matrix::Vector3f _accel_sum{};
@@ -127,8 +137,17 @@ private:
 
 	vehicle_imu_status_s _status{};
 
+	static constexpr int FIFO_SIZE_MAX = sizeof(sensor_gyro_fifo_s::x) / sizeof(sensor_gyro_fifo_s::x[0]);
+
+	matrix::Vector3f _gyro_fifo_delta_angle[FIFO_SIZE_MAX] {}; // per sample delta angles of the last gyro FIFO batch (sculling)
+
+	uint8_t _accel_fifo_rotation{0};
+	uint8_t _gyro_fifo_rotation{0};
+
 	uint8_t _delta_velocity_clipping{0};
 
+	bool _fifo_checked{false};
+	bool _fifo_available{false};
 	bool _intervals_configured{false};
 
 	const uint8_t _instance;
@@ -82,6 +82,9 @@ void VotedSensorsUpdate::parametersUpdate()
 {
 	updateParams();
 
+	_accel.voter.set_inconsistency_threshold(_param_sens_acc_vote_th.get());
+	_gyro.voter.set_inconsistency_threshold(_param_sens_gyr_vote_th.get());
+
 	// run through all IMUs
 	for (uint8_t uorb_index = 0; uorb_index < MAX_SENSOR_COUNT; uorb_index++) {
 		uORB::SubscriptionData<vehicle_imu_s> imu{ORB_ID(vehicle_imu), uorb_index};
@@ -293,14 +296,15 @@ bool VotedSensorsUpdate::checkFailover(SensorData &sensor, const char *sensor_na
 				const hrt_abstime now = hrt_absolute_time();
 
 				if (now - _last_error_message > 3_s) {
-					mavlink_log_emergency(&_mavlink_log_pub, "%s #%i fail: %s%s%s%s%s!",
+					mavlink_log_emergency(&_mavlink_log_pub, "%s #%i fail: %s%s%s%s%s%s!",
 							      sensor_name,
 							      failover_index,
 							      ((flags & DataValidator::ERROR_FLAG_NO_DATA) ? " OFF" : ""),
 							      ((flags & DataValidator::ERROR_FLAG_STALE_DATA) ? " STALE" : ""),
 							      ((flags & DataValidator::ERROR_FLAG_TIMEOUT) ? " TIMEOUT" : ""),
 							      ((flags & DataValidator::ERROR_FLAG_HIGH_ERRCOUNT) ? " ERR CNT" : ""),
-							      ((flags & DataValidator::ERROR_FLAG_HIGH_ERRDENSITY) ? " ERR DNST" : ""));
+							      ((flags & DataValidator::ERROR_FLAG_HIGH_ERRDENSITY) ? " ERR DNST" : ""),
+							      ((flags & DataValidatorGroup::ERROR_FLAG_INCONSISTENT) ? " INCONSISTENT" : ""));
 					_last_error_message = now;
 				}
 
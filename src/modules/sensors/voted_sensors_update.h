@@ -182,7 +182,9 @@ private:
 	sensor_selection_s _selection {};		/**< struct containing the sensor selection to be published to the uORB */
 
 	DEFINE_PARAMETERS(
-		(ParamBool<px4::params::SENS_IMU_MODE>) _param_sens_imu_mode
+		(ParamBool<px4::params::SENS_IMU_MODE>) _param_sens_imu_mode,
+		(ParamFloat<px4::params::SENS_ACC_VOTE_TH>) _param_sens_acc_vote_th,
+		(ParamFloat<px4::params::SENS_GYR_VOTE_TH>) _param_sens_gyr_vote_th
 	)
 };
 
@@ -44,6 +44,7 @@
 
 #include <px4_platform_common/getopt.h>
 #include <px4_platform_common/log.h>
+#include <px4_platform_common/tasks.h>
 
 #include <drivers/drv_pwm_output.h>         // to get PWM flags
 
@@ -86,14 +87,120 @@ bool Sih::init()
 	}
 
 	// 200 - 2000 Hz
-	int interval_us = math::constrain(int(roundf(1e6f / rate)), 500, 5000);
-	ScheduleOnInterval(interval_us);
+	_interval_us = math::constrain(int(roundf(1e6f / rate)), 500, 5000);
+
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	int task_id = px4_task_spawn_cmd("sih_lockstep",
+					 SCHED_DEFAULT,
+					 SCHED_PRIORITY_MAX,
+					 1500,
+					 (px4_main_t)&Sih::lockstep_loop_trampoline,
+					 nullptr);
+
+	if (task_id < 0) {
+		PX4_ERR("lockstep task start failed");
+		return false;
+	}
+
+	// We want to prevent the rest of the startup script from running until time
+	// is initialized by the lockstep task.
+	while (!_lockstep_initialized.load()) {
+		system_usleep(100);
+	}
+
+#else
+	ScheduleOnInterval(_interval_us);
+#endif // ENABLE_LOCKSTEP_SCHEDULER
 
 	return true;
 }
 
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+int Sih::lockstep_loop_trampoline(int argc, char *argv[])
+{
+	Sih *instance = get_instance();
+
+	if (instance) {
+		instance->lockstep_loop();
+	}
+
+	return 0;
+}
+
+void Sih::lockstep_loop()
+{
+	_lockstep_component = px4_lockstep_register_component();
+
+	// same convention as replay: 1 is real time, 0 runs as fast as the system can follow
+	float speed_factor = 1.f;
+	const char *speedup = getenv("PX4_SIM_SPEED_FACTOR");
+
+	if (speedup) {
+		speed_factor = atof(speedup);
+	}
+
+	PX4_INFO("lockstep simulation, speed factor %.1f", (double)speed_factor);
+
+	// arbitrary epoch, the lockstep clock stays at 0 until it is set here
+	hrt_abstime sim_time = 1_s;
+	float accumulated_delay_us = 0.f;
+
+	struct timespec ts;
+	abstime_to_ts(&ts, sim_time);
+	px4_clock_settime(CLOCK_MONOTONIC, &ts);
+
+	// the constructor ran with the clock still at 0, restart the timers from the epoch
+	// (otherwise the first step integrates over the whole second before it)
+	_last_run = sim_time;
+	_gps_time = sim_time;
+	_serial_time = sim_time;
+	_dist_snsr_time = sim_time;
+
+	_lockstep_initialized.store(true);
+
+	while (!should_exit()) {
+		sim_time += _interval_us;
+		abstime_to_ts(&ts, sim_time);
+		px4_clock_settime(CLOCK_MONOTONIC, &ts);
+
+		// simulation step on the work queue, the published sensor data then triggers the rest of the system
+		ScheduleNow();
+		px4_lockstep_progress(_lockstep_component);
+
+		// advance the time only once all the modules (controllers, estimator, logger) are done
+		px4_lockstep_wait_for_components();
+
+		if (speed_factor > FLT_EPSILON) {
+			// avoid many small usleep calls
+			accumulated_delay_us += _interval_us / speed_factor;
+
+			if (accumulated_delay_us > 3000.f) {
+				system_usleep(accumulated_delay_us);
+				accumulated_delay_us = 0.f;
+			}
+		}
+	}
+
+	px4_lockstep_unregister_component(_lockstep_component);
+
+	// all the scheduled steps are done at this point (see px4_lockstep_wait_for_components())
+	ScheduleClear();
+	exit_and_cleanup();
+}
+#endif // ENABLE_LOCKSTEP_SCHEDULER
+
 void Sih::Run()
 {
+#if !defined(ENABLE_LOCKSTEP_SCHEDULER)
+
+	if (should_exit()) {
+		ScheduleClear();
+		exit_and_cleanup();
+		return;
+	}
+
+#endif // !ENABLE_LOCKSTEP_SCHEDULER
+
 	perf_count(_loop_interval_perf);
 
 	// check for parameter updates
@@ -203,12 +310,21 @@ void Sih::parameters_updated()
 	_distance_snsr_min = _sih_distance_snsr_min.get();
 	_distance_snsr_max = _sih_distance_snsr_max.get();
 	_distance_snsr_override = _sih_distance_snsr_override.get();
+
+	_substeps = math::constrain(_sih_substeps.get(), 1, 20);
 }
 
 // initialization of the variables for the simulator
 void Sih::init_variables()
 {
-	srand(1234);    // initialize the random seed once before calling generate_wgn()
+	// seed the noise generator once before calling generate_wgn(), the sensor noise is then reproducible
+	_rand_state = (uint32_t)_sih_seed.get() * 2654435761u + 1u;
+
+	if (_rand_state == 0) {
+		_rand_state = 1;
+	}
+
+	_wgn_phase = true;
 
 	_p_I = Vector3f(0.0f, 0.0f, 0.0f);
 	_v_I = Vector3f(0.0f, 0.0f, 0.0f);
@@ -297,16 +413,59 @@ void Sih::equations_of_motion()
 		_grounded = true;
 
 	} else {
-		// integration: Euler forward
-		_p_I = _p_I + _p_I_dot * _dt;
-		_v_I = _v_I + _v_I_dot * _dt;
-		_q = _q + _q_dot * _dt; // as given in attitude_estimator_q_main.cpp
-		_q.normalize();
-		_w_B = _w_B + _w_B_dot * _dt;
+		integrate_rk4(_dt);
 		_grounded = false;
 	}
 }
 
+// right hand side of the equations of motion, the actuator forces and moments are held constant over a step
+Sih::State Sih::state_derivative(const State &x) const
+{
+	const Dcmf C_IB(x.q);
+
+	State x_dot;
+	x_dot.p_I = x.v_I;
+	x_dot.v_I = (_W_I - _KDV * x.v_I + C_IB * _T_B) / _MASS;
+	x_dot.q = x.q.derivative1(x.w_B);
+	x_dot.w_B = _Im1 * (_Mt_B - _KDW * x.w_B - x.w_B.cross(_I * x.w_B));
+	return x_dot;
+}
+
+// fixed-step Runge-Kutta 4 integration over dt, split into SIH_SUBSTEPS steps
+void Sih::integrate_rk4(float dt)
+{
+	const float h = dt / _substeps;
+
+	auto add_scaled = [](const State & x, const State & dx, float scale) {
+		State y;
+		y.p_I = x.p_I + dx.p_I * scale;
+		y.v_I = x.v_I + dx.v_I * scale;
+		y.q = x.q + dx.q * scale;
+		y.w_B = x.w_B + dx.w_B * scale;
+		return y;
+	};
+
+	State x{_p_I, _v_I, _q, _w_B};
+
+	for (int i = 0; i < _substeps; i++) {
+		const State k1 = state_derivative(x);
+		const State k2 = state_derivative(add_scaled(x, k1, 0.5f * h));
+		const State k3 = state_derivative(add_scaled(x, k2, 0.5f * h));
+		const State k4 = state_derivative(add_scaled(x, k3, h));
+
+		x = add_scaled(x, k1, h / 6.f);
+		x = add_scaled(x, k2, h / 3.f);
+		x = add_scaled(x, k3, h / 3.f);
+		x = add_scaled(x, k4, h / 6.f);
+		x.q.normalize();
+	}
+
+	_p_I = x.p_I;
+	_v_I = x.v_I;
+	_q = x.q;
+	_w_B = x.w_B;
+}
+
 // reconstruct the noisy sensor signals
 void Sih::reconstruct_sensors_signals()
 {
@@ -418,32 +577,38 @@ void Sih::publish_sih()
 	_gpos_gt_pub.publish(_gpos_gt);
 }
 
+float Sih::generate_uniform()   // xorshift32, independent from the global rand() state
+{
+	_rand_state ^= _rand_state << 13;
+	_rand_state ^= _rand_state >> 17;
+	_rand_state ^= _rand_state << 5;
+	return (_rand_state >> 8) * (1.f / 16777216.f);
+}
+
 float Sih::generate_wgn()   // generate white Gaussian noise sample with std=1
 {
 	// algorithm 1:
 	// float temp=((float)(rand()+1))/(((float)RAND_MAX+1.0f));
 	// return sqrtf(-2.0f*logf(temp))*cosf(2.0f*M_PI_F*rand()/RAND_MAX);
 	// algorithm 2: from BlockRandGauss.hpp
-	static float V1, V2, S;
-	static bool phase = true;
 	float X;
 
-	if (phase) {
+	if (_wgn_phase) {
 		do {
-			float U1 = (float)rand() / RAND_MAX;
-			float U2 = (float)rand() / RAND_MAX;
-			V1 = 2.0f * U1 - 1.0f;
-			V2 = 2.0f * U2 - 1.0f;
-			S = V1 * V1 + V2 * V2;
-		} while (S >= 1.0f || fabsf(S) < 1e-8f);
+			float U1 = generate_uniform();
+			float U2 = generate_uniform();
+			_wgn_v1 = 2.0f * U1 - 1.0f;
+			_wgn_v2 = 2.0f * U2 - 1.0f;
+			_wgn_s = _wgn_v1 * _wgn_v1 + _wgn_v2 * _wgn_v2;
+		} while (_wgn_s >= 1.0f || fabsf(_wgn_s) < 1e-8f);
 
-		X = V1 * float(sqrtf(-2.0f * float(logf(S)) / S));
+		X = _wgn_v1 * float(sqrtf(-2.0f * float(logf(_wgn_s)) / _wgn_s));
 
 	} else {
-		X = V2 * float(sqrtf(-2.0f * float(logf(S)) / S));
+		X = _wgn_v2 * float(sqrtf(-2.0f * float(logf(_wgn_s)) / _wgn_s));
 	}
 
-	phase = !phase;
+	_wgn_phase = !_wgn_phase;
 	return X;
 }
 
@@ -502,9 +667,15 @@ in order to incorporate the state estimator in the loop.
 ### Implementation
 The simulator implements the equations of motion using matrix algebra.
 Quaternion representation is used for the attitude.
-Forward Euler is used for integration.
+A fixed-step Runge-Kutta 4 scheme is used for integration, with SIH_SUBSTEPS steps per sensor update.
+The sensor noise is generated from the SIH_SEED seed, so runs are reproducible.
 Most of the variables are declared global in the .hpp file to avoid stack overflow.
 
+On SITL builds with the lockstep scheduler, SIH owns the simulated clock: it advances the time
+by one sensor period as soon as all the modules are done with the previous step. No external simulator
+is needed and the simulation runs as fast as the system can follow.
+The PX4_SIM_SPEED_FACTOR environment variable limits the speed (default 1: real time, 0: unlimited).
+
 
 )DESCR_STR");
 
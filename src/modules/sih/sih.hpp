@@ -33,6 +33,7 @@
 
 #pragma once
 
+#include <px4_platform_common/atomic.h>
 #include <px4_platform_common/module.h>
 #include <px4_platform_common/module_params.h>
 #include <px4_platform_common/posix.h>
@@ -75,16 +76,25 @@ public:
 	/** @see ModuleBase */
 	static int print_usage(const char *reason = nullptr);
 
-	static float generate_wgn();    // generate white Gaussian noise sample
+	float generate_wgn();    // generate white Gaussian noise sample
 
 	// generate white Gaussian noise sample as a 3D vector with specified std
-	static matrix::Vector3f noiseGauss3f(float stdx, float stdy, float stdz);
+	matrix::Vector3f noiseGauss3f(float stdx, float stdy, float stdz);
 
 	bool init();
 
 private:
 	void Run() override;
 
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	// SIH owns the lockstep clock: a dedicated task advances the simulated time step by step
+	static int lockstep_loop_trampoline(int argc, char *argv[]);
+	void lockstep_loop();
+
+	px4::atomic_bool _lockstep_initialized{false};
+	int _lockstep_component{-1};
+#endif // ENABLE_LOCKSTEP_SCHEDULER
+
 	void parameters_updated();
 
 	// simulated sensor instances
@@ -128,6 +138,7 @@ private:
 	void read_motors();
 	void generate_force_and_torques();
 	void equations_of_motion();
+	void integrate_rk4(float dt);
 	void reconstruct_sensors_signals();
 	void send_gps();
 	void send_dist_snsr();
@@ -136,6 +147,22 @@ private:
 	perf_counter_t  _loop_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": cycle")};
 	perf_counter_t  _loop_interval_perf{perf_alloc(PC_INTERVAL, MODULE_NAME": cycle interval")};
 
+	// rigid body state, integrated by integrate_rk4()
+	struct State {
+		matrix::Vector3f p_I;   // inertial position [m]
+		matrix::Vector3f v_I;   // inertial velocity [m/s]
+		matrix::Quatf    q;     // quaternion attitude
+		matrix::Vector3f w_B;   // body rates in body frame [rad/s]
+	};
+
+	State state_derivative(const State &x) const;
+	float generate_uniform();   // uniform sample in [0, 1)
+
+	int         _interval_us{4000}; // simulation step [us]
+	uint32_t    _rand_state{1};     // state of the noise generator, see SIH_SEED
+	float       _wgn_v1{0.f}, _wgn_v2{0.f}, _wgn_s{0.f};
+	bool        _wgn_phase{true};
+
 	hrt_abstime _last_run{0};
 	hrt_abstime _baro_time{0};
 	hrt_abstime _gps_time{0};
@@ -185,6 +212,7 @@ private:
 	int _gps_used;
 	float _baro_offset_m, _mag_offset_x, _mag_offset_y, _mag_offset_z;
 	float _distance_snsr_min, _distance_snsr_max, _distance_snsr_override;
+	int _substeps;
 
 	// parameters defined in sih_params.c
 	DEFINE_PARAMETERS(
@@ -216,6 +244,8 @@ private:
 		(ParamFloat<px4::params::SIH_MAG_OFFSET_Z>) _sih_mag_offset_z,
 		(ParamFloat<px4::params::SIH_DISTSNSR_MIN>) _sih_distance_snsr_min,
 		(ParamFloat<px4::params::SIH_DISTSNSR_MAX>) _sih_distance_snsr_max,
-		(ParamFloat<px4::params::SIH_DISTSNSR_OVR>) _sih_distance_snsr_override
+		(ParamFloat<px4::params::SIH_DISTSNSR_OVR>) _sih_distance_snsr_override,
+		(ParamInt<px4::params::SIH_SUBSTEPS>) _sih_substeps,
+		(ParamInt<px4::params::SIH_SEED>) _sih_seed
 	)
 };
@@ -424,3 +424,26 @@ PARAM_DEFINE_FLOAT(SIH_DISTSNSR_MAX, 100.0f);
  * @group Simulation In Hardware
  */
 PARAM_DEFINE_FLOAT(SIH_DISTSNSR_OVR, -1.0f);
+
+/**
+ * Number of integration sub-steps
+ *
+ * The equations of motion are integrated with a fixed-step Runge-Kutta 4 scheme,
+ * this sets the number of steps per sensor update.
+ *
+ * @min 1
+ * @max 20
+ * @group Simulation In Hardware
+ */
+PARAM_DEFINE_INT32(SIH_SUBSTEPS, 1);
+
+/**
+ * Seed of the sensor noise generator
+ *
+ * Runs with the same seed produce the same sensor noise sequence.
+ * Change it between runs for Monte-Carlo testing.
+ *
+ * @reboot_required true
+ * @group Simulation In Hardware
+ */
+PARAM_DEFINE_INT32(SIH_SEED, 1234);
@@ -0,0 +1,525 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file sim_shm_standin.cpp
+ *
+ * Minimal stand-in simulator for the simulator module, used to benchmark the HIL
+ * transport in lockstep. It runs a vertical-only point mass quadrotor, sends
+ * HIL_SENSOR every step and HIL_GPS at 10 Hz, waits for HIL_ACTUATOR_CONTROLS
+ * and reports the achieved steps per second.
+ *
+ * Usage: sim_shm_standin [-i instance] [-c tcp_port] [-n steps] [-r rate_hz]
+ *  -i  shared memory instance (PX4: simulator start -s instance), default 0
+ *  -c  use MAVLink over TCP instead (PX4: simulator start -c tcp_port)
+ *  -n  stop after this many steps and print a summary
+ *  -r  simulation rate, default 250 Hz
+ */
+
+#include "simulator_shm_layout.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+static volatile sig_atomic_t g_should_exit = 0;
+
+static void sigint_handler(int)
+{
+	g_should_exit = 1;
+}
+
+static uint64_t wall_time_us()
+{
+	return sim_shm::monotonic_time_us();
+}
+
+class Transport
+{
+public:
+	virtual ~Transport() = default;
+
+	virtual bool connect() = 0;
+	virtual void send_hil_sensor(const mavlink_hil_sensor_t &hil_sensor) = 0;
+	virtual void send_hil_gps(const mavlink_hil_gps_t &hil_gps) = 0;
+
+	/**
+	 * Wait for the next HIL_ACTUATOR_CONTROLS, other messages are dropped.
+	 * @return false on timeout
+	 */
+	virtual bool receive_controls(mavlink_hil_actuator_controls_t &controls, uint32_t timeout_us) = 0;
+};
+
+class ShmTransport : public Transport
+{
+public:
+	explicit ShmTransport(unsigned instance) : _instance(instance) {}
+
+	~ShmTransport() override
+	{
+		if (_segment) {
+			munmap(_segment, sizeof(sim_shm::Segment));
+		}
+	}
+
+	bool connect() override
+	{
+		char name[32];
+		sim_shm::segment_name(name, sizeof(name), _instance);
+		printf("waiting for PX4 on shared memory %s\n", name);
+
+		while (!g_should_exit) {
+			int fd = shm_open(name, O_RDWR, 0);
+
+			if (fd >= 0) {
+				void *segment = mmap(nullptr, sizeof(sim_shm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				close(fd);
+
+				if (segment != MAP_FAILED) {
+					sim_shm::Segment *s = static_cast<sim_shm::Segment *>(segment);
+
+					if (s->header.magic.load(std::memory_order_acquire) == sim_shm::MAGIC
+					    && s->header.version == sim_shm::VERSION
+					    && s->header.segment_size == sizeof(sim_shm::Segment)) {
+						_segment = s;
+						return true;
+					}
+
+					munmap(segment, sizeof(sim_shm::Segment));
+				}
+			}
+
+			usleep(100000);
+		}
+
+		return false;
+	}
+
+	void send_hil_sensor(const mavlink_hil_sensor_t &hil_sensor) override
+	{
+		sim_shm::Entry *entry = push_begin();
+
+		if (entry) {
+			entry->type = sim_shm::HIL_SENSOR;
+			entry->hil_sensor = hil_sensor;
+			sim_shm::push_end(_segment->to_px4);
+		}
+	}
+
+	void send_hil_gps(const mavlink_hil_gps_t &hil_gps) override
+	{
+		sim_shm::Entry *entry = push_begin();
+
+		if (entry) {
+			entry->type = sim_shm::HIL_GPS;
+			entry->hil_gps = hil_gps;
+			sim_shm::push_end(_segment->to_px4);
+		}
+	}
+
+	bool receive_controls(mavlink_hil_actuator_controls_t &controls, uint32_t timeout_us) override
+	{
+		const uint64_t deadline = wall_time_us() + timeout_us;
+
+		while (true) {
+			const sim_shm::Entry *entry;
+
+			while ((entry = sim_shm::pop_begin(_segment->to_sim)) != nullptr) {
+				const bool is_controls = (entry->type == sim_shm::HIL_ACTUATOR_CONTROLS);
+
+				if (is_controls) {
+					controls = entry->hil_actuator_controls;
+				}
+
+				sim_shm::pop_end(_segment->to_sim);
+
+				if (is_controls) {
+					return true;
+				}
+			}
+
+			const uint64_t now = wall_time_us();
+
+			if (now >= deadline || !sim_shm::wait_readable(_segment->to_sim, deadline - now)) {
+				return false;
+			}
+		}
+	}
+
+private:
+	sim_shm::Entry *push_begin()
+	{
+		if (!sim_shm::wait_writable(_segment->to_px4, 1000000)) {
+			fprintf(stderr, "PX4 is not reading, dropping message\n");
+			return nullptr;
+		}
+
+		return sim_shm::push_begin(_segment->to_px4);
+	}
+
+	const unsigned _instance;
+	sim_shm::Segment *_segment{nullptr};
+};
+
+class TcpTransport : public Transport
+{
+public:
+	explicit TcpTransport(unsigned port) : _port(port) {}
+
+	~TcpTransport() override
+	{
+		if (_fd >= 0) {
+			close(_fd);
+		}
+	}
+
+	bool connect() override
+	{
+		int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+
+		if (listen_fd < 0) {
+			fprintf(stderr, "socket failed: %s\n", strerror(errno));
+			return false;
+		}
+
+		int yes = 1;
+		setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+		struct sockaddr_in addr {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(_port);
+
+		if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 1) < 0) {
+			fprintf(stderr, "bind/listen on TCP port %u failed: %s\n", _port, strerror(errno));
+			close(listen_fd);
+			return false;
+		}
+
+		printf("waiting for PX4 on TCP port %u\n", _port);
+		_fd = accept(listen_fd, nullptr, nullptr);
+		close(listen_fd);
+
+		if (_fd < 0) {
+			return false;
+		}
+
+		setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+		return true;
+	}
+
+	void send_hil_sensor(const mavlink_hil_sensor_t &hil_sensor) override
+	{
+		mavlink_message_t message{};
+		mavlink_msg_hil_sensor_encode(1, 200, &message, &hil_sensor);
+		send_message(message);
+	}
+
+	void send_hil_gps(const mavlink_hil_gps_t &hil_gps) override
+	{
+		mavlink_message_t message{};
+		mavlink_msg_hil_gps_encode(1, 200, &message, &hil_gps);
+		send_message(message);
+	}
+
+	bool receive_controls(mavlink_hil_actuator_controls_t &controls, uint32_t timeout_us) override
+	{
+		const uint64_t deadline = wall_time_us() + timeout_us;
+
+		while (true) {
+			// parse what is left from the previous read first
+			while (_buf_pos < _buf_len) {
+				mavlink_message_t message;
+
+				if (mavlink_parse_char(MAVLINK_COMM_0, _buf[_buf_pos++], &message, &_status)
+				    && message.msgid == MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS) {
+					mavlink_msg_hil_actuator_controls_decode(&message, &controls);
+					return true;
+				}
+			}
+
+			const uint64_t now = wall_time_us();
+
+			if (now >= deadline) {
+				return false;
+			}
+
+			struct pollfd fds[1] {};
+			fds[0].fd = _fd;
+			fds[0].events = POLLIN;
+
+			if (poll(fds, 1, (int)((deadline - now + 999) / 1000)) <= 0) {
+				return false;
+			}
+
+			const ssize_t len = recv(_fd, _buf, sizeof(_buf), 0);
+
+			if (len <= 0) {
+				return false;
+			}
+
+			_buf_len = len;
+			_buf_pos = 0;
+		}
+	}
+
+private:
+	void send_message(const mavlink_message_t &message)
+	{
+		uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+		const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+
+		if (send(_fd, buf, len, 0) != len) {
+			fprintf(stderr, "send failed: %s\n", strerror(errno));
+		}
+	}
+
+	const unsigned _port;
+	int _fd{-1};
+
+	uint8_t _buf[2048];
+	ssize_t _buf_len{0};
+	ssize_t _buf_pos{0};
+	mavlink_status_t _status{};
+};
+
+/**
+ * Vertical-only quadrotor on the ground at the default PX4 home position.
+ */
+class PointMass
+{
+public:
+	void update(float dt, const mavlink_hil_actuator_controls_t &controls)
+	{
+		float thrust = 0.f;
+
+		// multicopter motors are sent in [0, 1], only armed outputs produce thrust
+		if ((controls.mode & 128) != 0) {
+			for (int i = 0; i < 4; i++) {
+				thrust += fmaxf(controls.controls[i], 0.f) * MOTOR_THRUST_MAX;
+			}
+		}
+
+		_specific_force_z = -thrust / MASS;
+
+		// NED, positive down
+		_vel_d += (_specific_force_z + G) * dt;
+		_pos_d += _vel_d * dt;
+
+		if (_pos_d > 0.f) {
+			// on ground
+			_pos_d = 0.f;
+			_vel_d = fminf(_vel_d, 0.f);
+			_specific_force_z = -G;
+		}
+	}
+
+	void hil_sensor(uint64_t time_usec, mavlink_hil_sensor_t &hil_sensor) const
+	{
+		const float alt = HOME_ALT - _pos_d;
+
+		hil_sensor = {};
+		hil_sensor.time_usec = time_usec;
+		hil_sensor.zacc = _specific_force_z;
+		hil_sensor.xmag = 0.21523f;
+		hil_sensor.ymag = 0.00771f;
+		hil_sensor.zmag = 0.42741f;
+		hil_sensor.abs_pressure = 1013.25f * powf(1.f - 2.25577e-5f * alt, 5.25588f); // hPa
+		hil_sensor.pressure_alt = alt;
+		hil_sensor.temperature = 20.f;
+		hil_sensor.fields_updated = 0x1fff; // all sensors
+	}
+
+	void hil_gps(uint64_t time_usec, mavlink_hil_gps_t &hil_gps) const
+	{
+		hil_gps = {};
+		hil_gps.time_usec = time_usec;
+		hil_gps.fix_type = 3;
+		hil_gps.lat = 473977420;
+		hil_gps.lon = 85455940;
+		hil_gps.alt = (int32_t)((HOME_ALT - _pos_d) * 1000.f);
+		hil_gps.eph = 30;
+		hil_gps.epv = 40;
+		hil_gps.vel = (uint16_t)(fabsf(_vel_d) * 100.f);
+		hil_gps.vd = (int16_t)(_vel_d * 100.f);
+		hil_gps.cog = UINT16_MAX;
+		hil_gps.satellites_visible = 10;
+	}
+
+private:
+	static constexpr float G = 9.80665f;
+	static constexpr float MASS = 1.5f;             // kg
+	static constexpr float MOTOR_THRUST_MAX = 7.5f; // N
+	static constexpr float HOME_ALT = 488.f;        // m AMSL
+
+	float _pos_d{0.f};
+	float _vel_d{0.f};
+	float _specific_force_z{-G};
+};
+
+static void usage()
+{
+	printf("Usage: sim_shm_standin [-i instance] [-c tcp_port] [-n steps] [-r rate_hz]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned instance = 0;
+	unsigned tcp_port = 0;
+	uint64_t max_steps = 0;
+	unsigned rate_hz = 250;
+
+	int ch;
+
+	while ((ch = getopt(argc, argv, "i:c:n:r:h")) != -1) {
+		switch (ch) {
+		case 'i':
+			instance = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'c':
+			tcp_port = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'n':
+			max_steps = strtoull(optarg, nullptr, 10);
+			break;
+
+		case 'r':
+			rate_hz = strtoul(optarg, nullptr, 10);
+			break;
+
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (rate_hz == 0) {
+		usage();
+		return 1;
+	}
+
+	signal(SIGINT, sigint_handler);
+	signal(SIGTERM, sigint_handler);
+
+	Transport *transport = (tcp_port != 0) ? static_cast<Transport *>(new TcpTransport(tcp_port))
+			       : static_cast<Transport *>(new ShmTransport(instance));
+
+	if (!transport->connect()) {
+		delete transport;
+		return 1;
+	}
+
+	printf("connected, stepping at %u Hz (%s)\n", rate_hz, (tcp_port != 0) ? "MAVLink over TCP" : "shared memory");
+
+	const uint32_t dt_us = 1000000 / rate_hz;
+	const uint64_t gps_interval_us = 100000;
+
+	PointMass vehicle;
+	mavlink_hil_actuator_controls_t controls{};
+	mavlink_hil_sensor_t hil_sensor;
+	mavlink_hil_gps_t hil_gps;
+
+	uint64_t sim_time_us = 0;
+	uint64_t last_gps_us = 0;
+	uint64_t steps = 0;
+	uint64_t lockstep_steps = 0;
+	bool lockstep = false;
+
+	const uint64_t start_us = wall_time_us();
+	uint64_t report_us = start_us;
+	uint64_t report_steps = 0;
+	uint64_t report_sim_time_us = 0;
+
+	while (!g_should_exit && (max_steps == 0 || steps < max_steps)) {
+		sim_time_us += dt_us;
+		vehicle.update(dt_us * 1e-6f, controls);
+
+		if (sim_time_us - last_gps_us >= gps_interval_us) {
+			vehicle.hil_gps(sim_time_us, hil_gps);
+			transport->send_hil_gps(hil_gps);
+			last_gps_us = sim_time_us;
+		}
+
+		vehicle.hil_sensor(sim_time_us, hil_sensor);
+		transport->send_hil_sensor(hil_sensor);
+
+		if (lockstep) {
+			// PX4 answers every HIL_SENSOR once its control loop ran
+			if (!transport->receive_controls(controls, 1000000)) {
+				fprintf(stderr, "no HIL_ACTUATOR_CONTROLS for 1 s\n");
+			}
+
+			lockstep_steps++;
+
+		} else {
+			// until PX4 outputs run, step in real time
+			if (transport->receive_controls(controls, dt_us)) {
+				lockstep = true;
+				report_us = wall_time_us();
+				report_steps = steps;
+				report_sim_time_us = sim_time_us;
+			}
+		}
+
+		steps++;
+
+		const uint64_t now = wall_time_us();
+
+		if (lockstep && now - report_us >= 5000000) {
+			const double elapsed = (now - report_us) * 1e-6;
+			printf("%.0f steps/s, %.1fx real time\n", (steps - report_steps) / elapsed,
+			       (sim_time_us - report_sim_time_us) * 1e-6 / elapsed);
+			report_us = now;
+			report_steps = steps;
+			report_sim_time_us = sim_time_us;
+		}
+	}
+
+	const double elapsed = (wall_time_us() - start_us) * 1e-6;
+	printf("%llu steps (%llu in lockstep) in %.2f s: %.0f steps/s, %.1fx real time\n",
+	       (unsigned long long)steps, (unsigned long long)lockstep_steps, elapsed, steps / elapsed,
+	       sim_time_us * 1e-6 / elapsed);
+
+	delete transport;
+	return 0;
+}
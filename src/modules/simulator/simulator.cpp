@@ -79,6 +79,10 @@ int Simulator::start(int argc, char *argv[])
 			_instance->set_port(atoi(argv[4]));
 		}
 
+		if (argc >= 4 && strcmp(argv[3], "-s") == 0) {
+			_instance->set_shm_instance(argc == 5 ? atoi(argv[4]) : 0);
+		}
+
 		if (argc == 6 && strcmp(argv[3], "-t") == 0) {
 			_instance->set_ip(InternetProtocol::TCP);
 			_instance->set_tcp_remote_ipaddr(argv[4]);
@@ -97,11 +101,12 @@ int Simulator::start(int argc, char *argv[])
 
 static void usage()
 {
-	PX4_INFO("Usage: simulator {start -[spt] [-u udp_port / -c tcp_port] |stop|status}");
+	PX4_INFO("Usage: simulator {start -[spt] [-u udp_port / -c tcp_port / -s instance] |stop|status}");
 	PX4_INFO("Start simulator:     simulator start");
 	PX4_INFO("Connect using UDP: simulator start -u udp_port");
 	PX4_INFO("Connect using TCP: simulator start -c tcp_port");
 	PX4_INFO("Connect to a remote server using TCP: simulator start -t ip_addr tcp_port");
+	PX4_INFO("Connect to a local simulator using shared memory: simulator start -s instance");
 }
 
 __BEGIN_DECLS
@@ -147,6 +152,11 @@ int simulator_main(int argc, char *argv[])
 		} else {
 			px4_task_delete(g_sim_task);
 			g_sim_task = -1;
+
+			// the simulator may not have connected yet
+			if (Simulator::getInstance()) {
+				Simulator::getInstance()->shm_remove();
+			}
 		}
 
 	} else if (argc == 2 && strcmp(argv[1], "status") == 0) {
@@ -74,6 +74,7 @@
 #include <uORB/topics/vehicle_command.h>
 #include <uORB/topics/vehicle_command_ack.h>
 
+#include <pthread.h>
 #include <random>
 
 #include <v2.0/common/mavlink.h>
@@ -81,6 +82,12 @@
 
 using namespace time_literals;
 
+namespace sim_shm
+{
+struct Entry;
+struct Segment;
+}
+
 //! Enumeration to use on the bitmask in HIL_SENSOR
 enum class SensorSource {
 	ACCEL		= 0b111,
@@ -124,6 +131,12 @@ public:
 	void set_ip(InternetProtocol ip) { _ip = ip; }
 	void set_port(unsigned port) { _port = port; }
 	void set_tcp_remote_ipaddr(char *tcp_remote_ipaddr) { _tcp_remote_ipaddr = tcp_remote_ipaddr; }
+	void set_shm_instance(unsigned instance) { _use_shm = true; _shm_instance = instance; }
+
+	/**
+	 * Unlink the shared memory segment (if used), the simulator can no longer attach afterwards.
+	 */
+	void shm_remove();
 
 #if defined(ENABLE_LOCKSTEP_SCHEDULER)
 	bool has_initialized() { return _has_initialized.load(); }
@@ -208,6 +221,12 @@ private:
 
 	char *_tcp_remote_ipaddr{nullptr};
 
+	// shared-memory transport (simulator_shm.cpp)
+	bool _use_shm{false};
+	unsigned _shm_instance{0};
+	sim_shm::Segment *_shm{nullptr};
+	pthread_mutex_t _shm_send_mutex = PTHREAD_MUTEX_INITIALIZER; // serializes the send and receive threads, the to_sim ring has a single producer
+
 	double _realtime_factor{1.0};		///< How fast the simulation runs in comparison to real system time
 
 	hrt_abstime _last_sim_timestamp{0};
@@ -215,6 +234,8 @@ private:
 
 
 	void run();
+	void run_shm();
+	void start_sender_thread();
 	void handle_message(const mavlink_message_t *msg);
 	void handle_message_distance_sensor(const mavlink_message_t *msg);
 	void handle_message_hil_gps(const mavlink_message_t *msg);
@@ -226,6 +247,9 @@ private:
 	void handle_message_rc_channels(const mavlink_message_t *msg);
 	void handle_message_vision_position_estimate(const mavlink_message_t *msg);
 
+	void handle_hil_gps(const mavlink_hil_gps_t &hil_gps);
+	void handle_hil_sensor(const mavlink_hil_sensor_t &imu);
+
 	void parameters_update(bool force);
 	void poll_for_MAVLink_messages();
 	void request_hil_state_quaternion();
@@ -233,6 +257,10 @@ private:
 	void send_controls();
 	void send_heartbeat();
 	void send_mavlink_message(const mavlink_message_t &aMsg);
+
+	bool shm_create();
+	sim_shm::Entry *shm_send_begin();
+	void shm_send_end();
 	void update_sensors(const hrt_abstime &time, const mavlink_hil_sensor_t &sensors);
 
 	static void *sending_trampoline(void *);
@@ -34,6 +34,7 @@
  ****************************************************************************/
 
 #include "simulator.h"
+#include "simulator_shm_layout.h"
 #include <simulator_config.h>
 
 #include <px4_platform_common/log.h>
@@ -180,6 +181,19 @@ void Simulator::send_controls()
 	orb_copy(ORB_ID(actuator_outputs), _actuator_outputs_sub, &_actuator_outputs);
 
 	if (_actuator_outputs.timestamp > 0) {
+		if (_shm) {
+			// hand over the payload directly, no MAVLink framing needed
+			sim_shm::Entry *entry = shm_send_begin();
+
+			if (entry) {
+				entry->type = sim_shm::HIL_ACTUATOR_CONTROLS;
+				actuator_controls_from_outputs(&entry->hil_actuator_controls);
+				shm_send_end();
+			}
+
+			return;
+		}
+
 		mavlink_hil_actuator_controls_t hil_act_control;
 		actuator_controls_from_outputs(&hil_act_control);
 
@@ -379,7 +393,11 @@ void Simulator::handle_message_hil_gps(const mavlink_message_t *msg)
 {
 	mavlink_hil_gps_t hil_gps;
 	mavlink_msg_hil_gps_decode(msg, &hil_gps);
+	handle_hil_gps(hil_gps);
+}
 
+void Simulator::handle_hil_gps(const mavlink_hil_gps_t &hil_gps)
+{
 	if (!_gps_blocked) {
 		sensor_gps_s gps{};
 
@@ -418,14 +436,18 @@ void Simulator::handle_message_hil_gps(const mavlink_message_t *msg)
 }
 
 void Simulator::handle_message_hil_sensor(const mavlink_message_t *msg)
+{
+	mavlink_hil_sensor_t imu;
+	mavlink_msg_hil_sensor_decode(msg, &imu);
+	handle_hil_sensor(imu);
+}
+
+void Simulator::handle_hil_sensor(const mavlink_hil_sensor_t &imu)
 {
 	if (_lockstep_component == -1) {
 		_lockstep_component = px4_lockstep_register_component();
 	}
 
-	mavlink_hil_sensor_t imu;
-	mavlink_msg_hil_sensor_decode(msg, &imu);
-
 	struct timespec ts;
 	abstime_to_ts(&ts, imu.time_usec);
 	px4_clock_settime(CLOCK_MONOTONIC, &ts);
@@ -617,6 +639,18 @@ void Simulator::handle_message_vision_position_estimate(const mavlink_message_t
 
 void Simulator::send_mavlink_message(const mavlink_message_t &aMsg)
 {
+	if (_shm) {
+		sim_shm::Entry *entry = shm_send_begin();
+
+		if (entry) {
+			entry->type = sim_shm::MAVLINK;
+			entry->mavlink = aMsg;
+			shm_send_end();
+		}
+
+		return;
+	}
+
 	uint8_t  buf[MAVLINK_MAX_PACKET_LEN];
 	uint16_t bufLen = 0;
 
@@ -716,6 +750,27 @@ void Simulator::send_heartbeat()
 	send_mavlink_message(message);
 }
 
+void Simulator::start_sender_thread()
+{
+	// Create a thread for sending data to the simulator.
+	pthread_t sender_thread;
+
+	pthread_attr_t sender_thread_attr;
+	pthread_attr_init(&sender_thread_attr);
+	pthread_attr_setstacksize(&sender_thread_attr, PX4_STACK_ADJUSTED(8000));
+
+	struct sched_param param;
+	(void)pthread_attr_getschedparam(&sender_thread_attr, &param);
+
+	// sender thread should run immediately after new outputs are available
+	//  to send the lockstep update to the simulation
+	param.sched_priority = SCHED_PRIORITY_ACTUATOR_OUTPUTS + 1;
+	(void)pthread_attr_setschedparam(&sender_thread_attr, &param);
+
+	pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, nullptr);
+	pthread_attr_destroy(&sender_thread_attr);
+}
+
 void Simulator::run()
 {
 #ifdef __PX4_DARWIN
@@ -724,6 +779,11 @@ void Simulator::run()
 	pthread_setname_np(pthread_self(), "sim_rcv");
 #endif
 
+	if (_use_shm) {
+		run_shm();
+		return;
+	}
+
 	struct sockaddr_in _myaddr {};
 	_myaddr.sin_family = AF_INET;
 	_myaddr.sin_addr.s_addr = htonl(INADDR_ANY);
@@ -796,21 +856,6 @@ void Simulator::run()
 
 	}
 
-	// Create a thread for sending data to the simulator.
-	pthread_t sender_thread;
-
-	pthread_attr_t sender_thread_attr;
-	pthread_attr_init(&sender_thread_attr);
-	pthread_attr_setstacksize(&sender_thread_attr, PX4_STACK_ADJUSTED(8000));
-
-	struct sched_param param;
-	(void)pthread_attr_getschedparam(&sender_thread_attr, &param);
-
-	// sender thread should run immediately after new outputs are available
-	//  to send the lockstep update to the simulation
-	param.sched_priority = SCHED_PRIORITY_ACTUATOR_OUTPUTS + 1;
-	(void)pthread_attr_setschedparam(&sender_thread_attr, &param);
-
 	struct pollfd fds[2] = {};
 	unsigned fd_count = 1;
 	fds[0].fd = _fd;
@@ -836,8 +881,7 @@ void Simulator::run()
 #endif
 
 	// got data from simulator, now activate the sending thread
-	pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, nullptr);
-	pthread_attr_destroy(&sender_thread_attr);
+	start_sender_thread();
 
 	mavlink_status_t mavlink_status = {};
 
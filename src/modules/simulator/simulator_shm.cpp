@@ -0,0 +1,176 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file simulator_shm.cpp
+ *
+ * Shared-memory transport for a simulator on the same host (see simulator_shm_layout.h).
+ */
+
+#include "simulator.h"
+#include "simulator_shm_layout.h"
+
+#include <px4_platform_common/log.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+bool Simulator::shm_create()
+{
+	char name[32];
+	sim_shm::segment_name(name, sizeof(name), _shm_instance);
+
+	// start from a clean segment, a previous run may have left its rings behind
+	shm_unlink(name);
+
+	// only the simulator running as the same user may attach
+	int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+
+	if (fd < 0) {
+		PX4_ERR("shm_open %s failed (%i)", name, errno);
+		return false;
+	}
+
+	if (ftruncate(fd, sizeof(sim_shm::Segment)) != 0) {
+		PX4_ERR("ftruncate failed (%i)", errno);
+		::close(fd);
+		return false;
+	}
+
+	void *segment = mmap(nullptr, sizeof(sim_shm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (segment == MAP_FAILED) {
+		PX4_ERR("mmap failed (%i)", errno);
+		return false;
+	}
+
+	// the new segment is zero filled, which is the empty state of both rings
+	_shm = static_cast<sim_shm::Segment *>(segment);
+	_shm->header.version = sim_shm::VERSION;
+	_shm->header.segment_size = sizeof(sim_shm::Segment);
+	_shm->header.magic.store(sim_shm::MAGIC, std::memory_order_release);
+
+	return true;
+}
+
+void Simulator::shm_remove()
+{
+	if (_use_shm) {
+		char name[32];
+		sim_shm::segment_name(name, sizeof(name), _shm_instance);
+
+		// existing mappings stay valid, only the name is removed
+		shm_unlink(name);
+	}
+}
+
+sim_shm::Entry *Simulator::shm_send_begin()
+{
+	pthread_mutex_lock(&_shm_send_mutex);
+
+	// the simulator drains to_sim every step, a full ring means it stopped reading
+	if (!sim_shm::wait_writable(_shm->to_sim, 100000)) {
+		pthread_mutex_unlock(&_shm_send_mutex);
+		PX4_WARN("Failed sending to simulator: ring full");
+		return nullptr;
+	}
+
+	return sim_shm::push_begin(_shm->to_sim);
+}
+
+void Simulator::shm_send_end()
+{
+	sim_shm::push_end(_shm->to_sim);
+	pthread_mutex_unlock(&_shm_send_mutex);
+}
+
+void Simulator::run_shm()
+{
+	if (!shm_create()) {
+		return;
+	}
+
+	char name[32];
+	sim_shm::segment_name(name, sizeof(name), _shm_instance);
+
+	PX4_INFO("Waiting for simulator to connect on shared memory %s", name);
+
+	// Once we receive something, we're most probably good and can carry on.
+	while (!sim_shm::wait_readable(_shm->to_px4, 1000000)) {}
+
+	PX4_INFO("Simulator connected on shared memory %s.", name);
+
+	// the simulator has mapped the segment, don't leave the name behind after exit
+	shm_remove();
+
+	// got data from simulator, now activate the sending thread
+	start_sender_thread();
+
+	// Request HIL_STATE_QUATERNION for ground truth.
+	request_hil_state_quaternion();
+
+	while (true) {
+
+		if (!sim_shm::wait_readable(_shm->to_px4, 1000000)) {
+			PX4_ERR("shared memory timeout");
+			continue;
+		}
+
+		const sim_shm::Entry *entry;
+
+		// entries are handled in place, the simulator cannot reuse them before pop_end()
+		while ((entry = sim_shm::pop_begin(_shm->to_px4)) != nullptr) {
+			switch (entry->type) {
+			case sim_shm::HIL_SENSOR:
+				handle_hil_sensor(entry->hil_sensor);
+				break;
+
+			case sim_shm::HIL_GPS:
+				handle_hil_gps(entry->hil_gps);
+				break;
+
+			case sim_shm::MAVLINK:
+				handle_message(&entry->mavlink);
+				break;
+
+			default:
+				PX4_ERR("unknown shared memory entry type %u", (unsigned)entry->type);
+				break;
+			}
+
+			sim_shm::pop_end(_shm->to_px4);
+		}
+	}
+}
@@ -0,0 +1,292 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file simulator_shm_layout.h
+ *
+ * Binary layout of the shared-memory HIL transport between the simulator module
+ * and a simulator running on the same host. Apart from the MAVLink message
+ * definitions this header has no PX4 dependencies, so a simulator can include it
+ * to map the segment.
+ *
+ * Segment: [Header][Ring to_px4][Ring to_sim]
+ *
+ * Each ring is single producer, single consumer. The producer fills
+ * entries[head % RING_LEN] and then increments head, the consumer reads
+ * entries[tail % RING_LEN] and then increments tail. A side that finds its ring
+ * empty (or full) sleeps on the head (or tail) word with a futex; the other side
+ * only issues the wake syscall if somebody registered as waiting.
+ *
+ * The hot lockstep messages (HIL_SENSOR, HIL_GPS, HIL_ACTUATOR_CONTROLS) are
+ * exchanged as decoded MAVLink payloads, everything else as a full
+ * mavlink_message_t that is handed to the regular message handler.
+ *
+ * PX4 creates the segment and writes the magic last; the simulator attaches once
+ * the magic and version match.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <v2.0/common/mavlink.h>
+
+namespace sim_shm
+{
+
+static constexpr char SEGMENT_NAME_PREFIX[] = "/px4_sim_shm_";
+
+static constexpr uint32_t MAGIC = 0x4d485358; // 'XSHM'
+static constexpr uint32_t VERSION = 1;
+
+static constexpr uint32_t RING_LEN = 16;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32 bit integers");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "shared memory transport requires lock-free 32 bit atomics");
+
+enum MessageType : uint32_t {
+	HIL_SENSOR            = 1, // simulator -> PX4
+	HIL_GPS               = 2, // simulator -> PX4
+	HIL_ACTUATOR_CONTROLS = 3, // PX4 -> simulator
+	MAVLINK               = 4, // any direction, full message
+};
+
+struct Entry {
+	uint32_t type;
+	union {
+		mavlink_hil_sensor_t hil_sensor;
+		mavlink_hil_gps_t hil_gps;
+		mavlink_hil_actuator_controls_t hil_actuator_controls;
+		mavlink_message_t mavlink;
+	};
+};
+
+struct Ring {
+	alignas(64) std::atomic<uint32_t> head;    // written by the producer
+	std::atomic<uint32_t> head_waiters;        // consumers sleeping on head
+	alignas(64) std::atomic<uint32_t> tail;    // written by the consumer
+	std::atomic<uint32_t> tail_waiters;        // producers sleeping on tail
+	alignas(64) Entry entries[RING_LEN];
+};
+
+struct Header {
+	std::atomic<uint32_t> magic; // stored last by PX4 once the segment is initialized
+	uint32_t version;
+	uint32_t segment_size;
+};
+
+struct Segment {
+	Header header;
+	Ring to_px4;
+	Ring to_sim;
+};
+
+/**
+ * Segment name of a PX4 instance, e.g. /px4_sim_shm_0
+ */
+inline void segment_name(char *buf, size_t len, unsigned instance)
+{
+	snprintf(buf, len, "%s%u", SEGMENT_NAME_PREFIX, instance);
+}
+
+inline void futex_wait(std::atomic<uint32_t> &word, uint32_t expected, uint32_t timeout_us)
+{
+#if defined(__linux__)
+	struct timespec timeout;
+	timeout.tv_sec = timeout_us / 1000000;
+	timeout.tv_nsec = (timeout_us % 1000000) * 1000;
+
+	// the segment is mapped by two processes, so this cannot be a FUTEX_PRIVATE_FLAG futex
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+	// no futex, poll instead
+	(void)word;
+	(void)expected;
+	usleep(timeout_us < 50 ? timeout_us : 50);
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t> &word)
+{
+#if defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+	(void)word;
+#endif
+}
+
+inline uint64_t monotonic_time_us()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Sleep until the ring has an entry to pop.
+ * @return false on timeout
+ */
+inline bool wait_readable(Ring &ring, uint32_t timeout_us)
+{
+	// a short spin covers the typical lockstep round trip without a syscall
+	for (int i = 0; i < 64; i++) {
+		if (ring.head.load(std::memory_order_acquire) != ring.tail.load(std::memory_order_relaxed)) {
+			return true;
+		}
+	}
+
+	uint64_t now = monotonic_time_us();
+	const uint64_t deadline = now + timeout_us;
+
+	// a wake can be left over from an earlier wait, so loop until the deadline
+	do {
+		ring.head_waiters.fetch_add(1, std::memory_order_seq_cst);
+		const uint32_t head = ring.head.load(std::memory_order_seq_cst);
+
+		if (head == ring.tail.load(std::memory_order_relaxed)) {
+			futex_wait(ring.head, head, (uint32_t)(deadline - now));
+		}
+
+		ring.head_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+		if (ring.head.load(std::memory_order_acquire) != ring.tail.load(std::memory_order_relaxed)) {
+			return true;
+		}
+
+		now = monotonic_time_us();
+
+	} while (now < deadline);
+
+	return false;
+}
+
+/**
+ * Sleep until the ring has a free entry.
+ * @return false on timeout
+ */
+inline bool wait_writable(Ring &ring, uint32_t timeout_us)
+{
+	if (ring.head.load(std::memory_order_relaxed) - ring.tail.load(std::memory_order_acquire) < RING_LEN) {
+		return true;
+	}
+
+	uint64_t now = monotonic_time_us();
+	const uint64_t deadline = now + timeout_us;
+
+	do {
+		ring.tail_waiters.fetch_add(1, std::memory_order_seq_cst);
+		const uint32_t tail = ring.tail.load(std::memory_order_seq_cst);
+
+		if (ring.head.load(std::memory_order_relaxed) - tail >= RING_LEN) {
+			futex_wait(ring.tail, tail, (uint32_t)(deadline - now));
+		}
+
+		ring.tail_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+		if (ring.head.load(std::memory_order_relaxed) - ring.tail.load(std::memory_order_acquire) < RING_LEN) {
+			return true;
+		}
+
+		now = monotonic_time_us();
+
+	} while (now < deadline);
+
+	return false;
+}
+
+/**
+ * Reserve the next entry for writing (single producer).
+ * @return nullptr if the ring is full
+ */
+inline Entry *push_begin(Ring &ring)
+{
+	const uint32_t head = ring.head.load(std::memory_order_relaxed);
+
+	if (head - ring.tail.load(std::memory_order_acquire) >= RING_LEN) {
+		return nullptr;
+	}
+
+	return &ring.entries[head % RING_LEN];
+}
+
+/**
+ * Publish the entry returned by push_begin() and wake a sleeping consumer.
+ */
+inline void push_end(Ring &ring)
+{
+	ring.head.fetch_add(1, std::memory_order_seq_cst);
+
+	if (ring.head_waiters.load(std::memory_order_seq_cst) > 0) {
+		futex_wake(ring.head);
+	}
+}
+
+/**
+ * Get the oldest entry (single consumer).
+ * @return nullptr if the ring is empty
+ */
+inline const Entry *pop_begin(Ring &ring)
+{
+	const uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+
+	if (ring.head.load(std::memory_order_acquire) == tail) {
+		return nullptr;
+	}
+
+	return &ring.entries[tail % RING_LEN];
+}
+
+/**
+ * Release the entry returned by pop_begin() and wake a sleeping producer.
+ */
+inline void pop_end(Ring &ring)
+{
+	ring.tail.fetch_add(1, std::memory_order_seq_cst);
+
+	if (ring.tail_waiters.load(std::memory_order_seq_cst) > 0) {
+		futex_wake(ring.tail);
+	}
+}
+
+} // namespace sim_shm
@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file OnlineTemperatureCalibration.cpp
+ *
+ * Online learning of the 3-axis thermal offset polynomials
+ */
+
+#include "OnlineTemperatureCalibration.hpp"
+
+#include <px4_platform_common/log.h>
+#include <lib/parameters/param.h>
+
+namespace temperature_compensation
+{
+
+OnlineTemperatureCalibration::OnlineTemperatureCalibration(const char *param_prefix, const char *enable_param_name) :
+	_param_prefix(param_prefix),
+	_enable_param_name(enable_param_name)
+{
+}
+
+int OnlineTemperatureCalibration::find_parameter_index(uint32_t device_id, int topic_instance)
+{
+	char str[30] {};
+
+	for (int i = 0; i < SENSOR_COUNT_MAX; i++) {
+		int32_t id = 0;
+		sprintf(str, "%s%d_ID", _param_prefix, i);
+
+		if ((param_get(param_find(str), &id) == PX4_OK) && ((uint32_t)id == device_id)) {
+			return i;
+		}
+	}
+
+	// same as the soak calibration: a new device gets the parameters of its topic instance
+	return topic_instance;
+}
+
+void OnlineTemperatureCalibration::update(int topic_instance, uint32_t device_id, float temperature,
+		const matrix::Vector3f &offset)
+{
+	if ((topic_instance < 0) || (topic_instance >= SENSOR_COUNT_MAX) || (device_id == 0)
+	    || !PX4_ISFINITE(temperature) || !PX4_ISFINITE(offset(0)) || !PX4_ISFINITE(offset(1)) || !PX4_ISFINITE(offset(2))) {
+		return;
+	}
+
+	PerSensorData &data = _data[topic_instance];
+
+	if (data.device_id != device_id) {
+		data = PerSensorData{};
+		data.device_id = device_id;
+		data.ref_temp = temperature;
+		data.min_temp = temperature;
+		data.max_temp = temperature;
+
+		// temperature range covered by the parameters currently stored for this device
+		const int index = find_parameter_index(device_id, topic_instance);
+		char str[30] {};
+		int32_t id = 0;
+		float min_temp = 0.f;
+		float max_temp = 0.f;
+
+		sprintf(str, "%s%d_ID", _param_prefix, index);
+		param_get(param_find(str), &id);
+		sprintf(str, "%s%d_TMIN", _param_prefix, index);
+		param_get(param_find(str), &min_temp);
+		sprintf(str, "%s%d_TMAX", _param_prefix, index);
+		param_get(param_find(str), &max_temp);
+
+		if ((uint32_t)id == device_id) {
+			data.stored_span = max_temp - min_temp;
+		}
+	}
+
+	const double relative_temperature = (double)temperature - (double)data.ref_temp;
+
+	for (int axis = 0; axis < 3; axis++) {
+		data.P[axis].update(relative_temperature, (double)offset(axis));
+	}
+
+	data.min_temp = math::min(data.min_temp, temperature);
+	data.max_temp = math::max(data.max_temp, temperature);
+	data.samples++;
+}
+
+int OnlineTemperatureCalibration::save()
+{
+	int saved = 0;
+
+	for (int topic_instance = 0; topic_instance < SENSOR_COUNT_MAX; topic_instance++) {
+		PerSensorData &data = _data[topic_instance];
+		const float span = data.max_temp - data.min_temp;
+
+		if ((data.device_id != 0) && (data.samples >= MIN_SAMPLES) && (span >= MIN_TEMPERATURE_SPAN)
+		    && (span >= data.stored_span + MIN_SPAN_IMPROVEMENT)) {
+
+			if (save_instance(data, topic_instance) == PX4_OK) {
+				data.stored_span = span;
+				saved++;
+			}
+		}
+	}
+
+	if (saved > 0) {
+		int32_t enabled = 1;
+
+		if (param_set_no_notification(param_find(_enable_param_name), &enabled) != PX4_OK) {
+			PX4_ERR("unable to set %s", _enable_param_name);
+		}
+	}
+
+	return saved;
+}
+
+int OnlineTemperatureCalibration::save_instance(PerSensorData &data, int topic_instance)
+{
+	double res[3][4] {};
+
+	for (int axis = 0; axis < 3; axis++) {
+		data.P[axis].fit(res[axis]);
+
+		for (int coef_index = 0; coef_index <= 3; coef_index++) {
+			if (!PX4_ISFINITE(res[axis][coef_index])) {
+				PX4_WARN("%s: fit of instance %d failed", _param_prefix, topic_instance);
+				return PX4_ERROR;
+			}
+		}
+	}
+
+	const int index = find_parameter_index(data.device_id, topic_instance);
+	char str[30] {};
+	int result = PX4_OK;
+
+	sprintf(str, "%s%d_ID", _param_prefix, index);
+	int32_t device_id = data.device_id;
+	result |= param_set_no_notification(param_find(str), &device_id);
+
+	for (int axis = 0; axis < 3; axis++) {
+		for (int coef_index = 0; coef_index <= 3; coef_index++) {
+			sprintf(str, "%s%d_X%d_%d", _param_prefix, index, 3 - coef_index, axis);
+			float param = (float)res[axis][coef_index];
+			result |= param_set_no_notification(param_find(str), &param);
+		}
+	}
+
+	sprintf(str, "%s%d_TMIN", _param_prefix, index);
+	result |= param_set_no_notification(param_find(str), &data.min_temp);
+	sprintf(str, "%s%d_TMAX", _param_prefix, index);
+	result |= param_set_no_notification(param_find(str), &data.max_temp);
+	sprintf(str, "%s%d_TREF", _param_prefix, index);
+	result |= param_set_no_notification(param_find(str), &data.ref_temp);
+
+	if (result != PX4_OK) {
+		PX4_ERR("%s: unable to set parameters of instance %d", _param_prefix, topic_instance);
+		return PX4_ERROR;
+	}
+
+	PX4_INFO("%s%d: learnt device %u from %.1f to %.1f deg C (%u samples)", _param_prefix, index,
+		 data.device_id, (double)data.min_temp, (double)data.max_temp, data.samples);
+
+	return PX4_OK;
+}
+
+void OnlineTemperatureCalibration::print_status()
+{
+	for (int topic_instance = 0; topic_instance < SENSOR_COUNT_MAX; topic_instance++) {
+		const PerSensorData &data = _data[topic_instance];
+
+		if (data.device_id != 0) {
+			PX4_INFO("  learning device ID %u for topic instance %i: %u samples, %.1f to %.1f deg C (stored span %.1f)",
+				 data.device_id, topic_instance, data.samples, (double)data.min_temp, (double)data.max_temp,
+				 (double)data.stored_span);
+		}
+	}
+}
+
+} // namespace temperature_compensation
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file OnlineTemperatureCalibration.hpp
+ *
+ * Learns the 3-axis thermal offset polynomials of gyros or accels during normal operation.
+ */
+
+#pragma once
+
+#include <matrix/math.hpp>
+
+#include "TemperatureCompensation.h"
+#include "temperature_calibration/polyfit.hpp"
+
+namespace temperature_compensation
+{
+
+/**
+ ** class OnlineTemperatureCalibration
+ * Accumulates the normal equations of the 3rd order offset polynomial per axis (see polyfit.hpp) from
+ * offset observations at the current sensor temperature, e.g. the applied thermal offset plus the in-run
+ * bias estimated by the EKF. Memory does not grow with the number of samples, so this can run during every
+ * flight and ground run. Once the temperature range covered is wide enough, and wider than the one of the
+ * stored coefficients, the TC_* parameters of the sensor are replaced.
+ */
+class OnlineTemperatureCalibration
+{
+public:
+	static constexpr float MIN_TEMPERATURE_SPAN = 10.f;	///< minimum temperature range covered before saving (deg C)
+	static constexpr float MIN_SPAN_IMPROVEMENT = 2.f;	///< required increase over the stored temperature range (deg C)
+	static constexpr unsigned MIN_SAMPLES = 600;		///< minimum number of observations before saving
+
+	/**
+	 * @param param_prefix parameter prefix of the sensor type, "TC_G" or "TC_A"
+	 * @param enable_param_name name of the enable parameter set when saving, "TC_G_ENABLE" or "TC_A_ENABLE"
+	 */
+	OnlineTemperatureCalibration(const char *param_prefix, const char *enable_param_name);
+	~OnlineTemperatureCalibration() = default;
+
+	/**
+	 * add an offset observation, restarts learning if the device of this topic instance changed
+	 * @param topic_instance uORB topic instance
+	 * @param device_id sensor device ID
+	 * @param temperature sensor temperature (deg C)
+	 * @param offset total thermal offset of the raw sensor data in sensor frame
+	 */
+	void update(int topic_instance, uint32_t device_id, float temperature, const matrix::Vector3f &offset);
+
+	/**
+	 * fit and write the parameters of every instance that learnt enough, without system notification
+	 * @return number of instances saved
+	 */
+	int save();
+
+	void print_status();
+
+private:
+
+	struct PerSensorData {
+		polyfitter<4> P[3];
+		uint32_t device_id{0};
+		unsigned samples{0};
+		float ref_temp{0.f};	///< temperature of the first observation (deg C)
+		float min_temp{0.f};
+		float max_temp{0.f};
+		float stored_span{0.f};	///< temperature range covered by the stored parameters (deg C)
+	};
+
+	/**
+	 * @return index of the TC_* parameter set to write for this device
+	 */
+	int find_parameter_index(uint32_t device_id, int topic_instance);
+
+	int save_instance(PerSensorData &data, int topic_instance);
+
+	PerSensorData _data[SENSOR_COUNT_MAX] {};
+
+	const char *_param_prefix;
+	const char *_enable_param_name;
+};
+
+} // namespace temperature_compensation
@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file OnlineTemperatureCalibrationTest.cpp
+ *
+ * Learns synthetic gyro offset curves over temperature sweeps and checks the
+ * saved TC_G* parameters and when they are (not) replaced.
+ *
+ * to run: make tests TESTFILTER=OnlineTemperatureCalibration
+ */
+
+#include <gtest/gtest.h>
+
+#include "OnlineTemperatureCalibration.hpp"
+
+#include <lib/parameters/param.h>
+
+#include <math.h>
+#include <stdio.h>
+
+using namespace temperature_compensation;
+using matrix::Vector3f;
+
+namespace
+{
+
+static constexpr uint32_t DEVICE_ID = 2293768;
+
+// offset polynomial per axis in the relative temperature, coefficients x0 to x3
+static constexpr float COEFFICIENTS[3][4] {
+	{0.01f, 1.2e-3f, -4.e-5f, 1.e-6f},
+	{-0.02f, -8.e-4f, 2.e-5f, 0.f},
+	{0.005f, 3.e-4f, 0.f, -5.e-7f},
+};
+
+Vector3f trueOffset(float relative_temperature)
+{
+	Vector3f offset;
+
+	for (int axis = 0; axis < 3; axis++) {
+		const float *x = COEFFICIENTS[axis];
+		offset(axis) = x[0] + relative_temperature * (x[1] + relative_temperature * (x[2] + relative_temperature * x[3]));
+	}
+
+	return offset;
+}
+
+// linear sweep from start_temp to end_temp, the offsets relative to the first temperature with some deterministic noise
+void sweep(OnlineTemperatureCalibration &calibration, int topic_instance, uint32_t device_id, float start_temp,
+	   float end_temp, unsigned samples, float ref_temp)
+{
+	for (unsigned i = 0; i < samples; i++) {
+		const float temperature = start_temp + (end_temp - start_temp) * i / (samples - 1);
+		const float noise = 1.e-4f * sinf(i * 1.7f);
+		calibration.update(topic_instance, device_id, temperature, trueOffset(temperature - ref_temp) + Vector3f(noise, -noise,
+				   noise));
+	}
+}
+
+float getFloat(const char *format, int index, int axis = 0)
+{
+	char name[20];
+	snprintf(name, sizeof(name), format, index, axis);
+	float value = NAN;
+	param_get(param_find(name), &value);
+	return value;
+}
+
+int32_t getInt(const char *name)
+{
+	int32_t value = -1;
+	param_get(param_find(name), &value);
+	return value;
+}
+
+} // namespace
+
+class OnlineTemperatureCalibrationTest : public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		param_control_autosave(false);
+		param_reset_all();
+	}
+
+	OnlineTemperatureCalibration _calibration{"TC_G", "TC_G_ENABLE"};
+};
+
+TEST_F(OnlineTemperatureCalibrationTest, fitsSweep)
+{
+	// GIVEN: a warm up from 20 to 45 deg C
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 45.f, 1000, 20.f);
+
+	// WHEN: the learnt coefficients are saved
+	EXPECT_EQ(_calibration.save(), 1);
+
+	// THEN: the parameters of the instance are set and enabled
+	EXPECT_EQ(getInt("TC_G0_ID"), (int32_t)DEVICE_ID);
+	EXPECT_EQ(getInt("TC_G_ENABLE"), 1);
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TREF", 0), 20.f);
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TMIN", 0), 20.f);
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TMAX", 0), 45.f);
+
+	// AND: the polynomial evaluated as by TemperatureCompensation matches the true offsets
+	for (float temperature = 20.f; temperature <= 45.f; temperature += 2.5f) {
+		const float dt = temperature - getFloat("TC_G%d_TREF", 0);
+		const Vector3f expected = trueOffset(temperature - 20.f);
+
+		for (int axis = 0; axis < 3; axis++) {
+			const float offset = getFloat("TC_G%d_X0_%d", 0, axis) + getFloat("TC_G%d_X1_%d", 0, axis) * dt
+					     + getFloat("TC_G%d_X2_%d", 0, axis) * dt * dt + getFloat("TC_G%d_X3_%d", 0, axis) * dt * dt * dt;
+			EXPECT_NEAR(offset, expected(axis), 2.e-4f) << "axis " << axis << " at " << temperature << " deg C";
+		}
+	}
+}
+
+TEST_F(OnlineTemperatureCalibrationTest, rejectsNarrowSweep)
+{
+	// GIVEN: a sweep covering less than the minimum temperature span
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 20.f + OnlineTemperatureCalibration::MIN_TEMPERATURE_SPAN - 1.f, 1000, 20.f);
+
+	// THEN: nothing is saved
+	EXPECT_EQ(_calibration.save(), 0);
+	EXPECT_EQ(getInt("TC_G0_ID"), 0);
+	EXPECT_EQ(getInt("TC_G_ENABLE"), 0);
+}
+
+TEST_F(OnlineTemperatureCalibrationTest, rejectsTooFewSamples)
+{
+	// GIVEN: a wide sweep with too few observations
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 45.f, OnlineTemperatureCalibration::MIN_SAMPLES - 1, 20.f);
+
+	// THEN: nothing is saved
+	EXPECT_EQ(_calibration.save(), 0);
+	EXPECT_EQ(getInt("TC_G0_ID"), 0);
+}
+
+TEST_F(OnlineTemperatureCalibrationTest, replacesOnlyWiderRange)
+{
+	// GIVEN: saved coefficients learnt from 20 to 35 deg C
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 35.f, 1000, 20.f);
+	ASSERT_EQ(_calibration.save(), 1);
+
+	// WHEN: learning continues within less than the required improvement
+	sweep(_calibration, 0, DEVICE_ID, 35.f, 35.f + OnlineTemperatureCalibration::MIN_SPAN_IMPROVEMENT - 0.5f, 100, 20.f);
+
+	// THEN: the stored coefficients are kept
+	EXPECT_EQ(_calibration.save(), 0);
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TMAX", 0), 35.f);
+
+	// WHEN: the range widens enough
+	sweep(_calibration, 0, DEVICE_ID, 35.f, 40.f, 100, 20.f);
+
+	// THEN: they are replaced
+	EXPECT_EQ(_calibration.save(), 1);
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TMAX", 0), 40.f);
+}
+
+TEST_F(OnlineTemperatureCalibrationTest, keepsWiderStoredCalibration)
+{
+	// GIVEN: stored parameters of a soak calibration from 10 to 50 deg C for this device
+	int32_t device_id = DEVICE_ID;
+	float min_temp = 10.f;
+	float max_temp = 50.f;
+	param_set(param_find("TC_G0_ID"), &device_id);
+	param_set(param_find("TC_G0_TMIN"), &min_temp);
+	param_set(param_find("TC_G0_TMAX"), &max_temp);
+
+	// WHEN: a narrower range is learnt
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 45.f, 1000, 20.f);
+
+	// THEN: the soak calibration is kept
+	EXPECT_EQ(_calibration.save(), 0);
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TMIN", 0), 10.f);
+}
+
+TEST_F(OnlineTemperatureCalibrationTest, restartsOnDeviceChange)
+{
+	// GIVEN: a wide sweep of one device, then a narrow one of a new device on the same topic instance
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 45.f, 1000, 20.f);
+	sweep(_calibration, 0, DEVICE_ID + 1, 30.f, 35.f, 1000, 30.f);
+
+	// THEN: only the new device's observations count
+	EXPECT_EQ(_calibration.save(), 0);
+	EXPECT_EQ(getInt("TC_G0_ID"), 0);
+}
+
+TEST_F(OnlineTemperatureCalibrationTest, writesParametersOfMatchingDevice)
+{
+	// GIVEN: the device already has the parameter set 2, covering a narrow range
+	int32_t device_id = DEVICE_ID;
+	float min_temp = 25.f;
+	float max_temp = 30.f;
+	param_set(param_find("TC_G2_ID"), &device_id);
+	param_set(param_find("TC_G2_TMIN"), &min_temp);
+	param_set(param_find("TC_G2_TMAX"), &max_temp);
+
+	// WHEN: it is learnt on topic instance 0
+	sweep(_calibration, 0, DEVICE_ID, 20.f, 45.f, 1000, 20.f);
+	EXPECT_EQ(_calibration.save(), 1);
+
+	// THEN: parameter set 2 is updated, set 0 untouched
+	EXPECT_FLOAT_EQ(getFloat("TC_G%d_TMAX", 2), 45.f);
+	EXPECT_EQ(getInt("TC_G0_ID"), 0);
+}
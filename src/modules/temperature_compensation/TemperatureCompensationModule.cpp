@@ -41,6 +41,7 @@
 #include <systemlib/mavlink_log.h>
 
 using namespace temperature_compensation;
+using matrix::Vector3f;
 
 TemperatureCompensationModule::TemperatureCompensationModule() :
 	ModuleParams(nullptr),
@@ -56,8 +57,18 @@ TemperatureCompensationModule::~TemperatureCompensationModule()
 
 void TemperatureCompensationModule::parameters_update()
 {
+	updateParams();
+
 	_temperature_compensation.parameters_update();
 
+	for (auto &calibration : _gyro_calibration) {
+		calibration.ParametersUpdate();
+	}
+
+	for (auto &calibration : _accel_calibration) {
+		calibration.ParametersUpdate();
+	}
+
 	// Gyro
 	for (uint8_t uorb_index = 0; uorb_index < GYRO_COUNT_MAX; uorb_index++) {
 		sensor_gyro_s report;
@@ -120,6 +131,12 @@ void TemperatureCompensationModule::accelPoll()
 
 		// Grab temperature from report
 		if (_accel_subs[uorb_index].update(&report)) {
+			_accel_temperature[uorb_index] = report.temperature;
+
+			if (_accel_calibration[uorb_index].device_id() != report.device_id) {
+				_accel_calibration[uorb_index].set_device_id(report.device_id);
+			}
+
 			if (PX4_ISFINITE(report.temperature)) {
 				// Update the offsets and mark for publication if they've changed
 				if (_temperature_compensation.update_offsets_accel(uorb_index, report.temperature, offsets[uorb_index]) == 2) {
@@ -142,6 +159,12 @@ void TemperatureCompensationModule::gyroPoll()
 
 		// Grab temperature from report
 		if (_gyro_subs[uorb_index].update(&report)) {
+			_gyro_temperature[uorb_index] = report.temperature;
+
+			if (_gyro_calibration[uorb_index].device_id() != report.device_id) {
+				_gyro_calibration[uorb_index].set_device_id(report.device_id);
+			}
+
 			if (PX4_ISFINITE(report.temperature)) {
 				// Update the offsets and mark for publication if they've changed
 				if (_temperature_compensation.update_offsets_gyro(uorb_index, report.temperature, offsets[uorb_index]) == 2) {
@@ -176,6 +199,64 @@ void TemperatureCompensationModule::baroPoll()
 	}
 }
 
+void TemperatureCompensationModule::learnPoll()
+{
+	if (!_param_tc_g_learn.get() && !_param_tc_a_learn.get()) {
+		return;
+	}
+
+	const float *gyro_offsets[] = {_corrections.gyro_offset_0, _corrections.gyro_offset_1, _corrections.gyro_offset_2, _corrections.gyro_offset_3 };
+	const float *accel_offsets[] = {_corrections.accel_offset_0, _corrections.accel_offset_1, _corrections.accel_offset_2, _corrections.accel_offset_3 };
+
+	for (auto &estimator_sensor_bias_sub : _estimator_sensor_bias_subs) {
+		estimator_sensor_bias_s bias;
+
+		if (!estimator_sensor_bias_sub.update(&bias)) {
+			continue;
+		}
+
+		// the thermal offset of the raw data is the applied one plus the remaining in-run bias,
+		// rotated back from body to sensor frame
+		for (uint8_t uorb_index = 0; uorb_index < GYRO_COUNT_MAX; uorb_index++) {
+			const calibration::Gyroscope &calibration = _gyro_calibration[uorb_index];
+
+			if (_param_tc_g_learn.get() && bias.gyro_bias_valid && (calibration.device_id() != 0)
+			    && (calibration.device_id() == bias.gyro_device_id)) {
+
+				const Vector3f in_run_bias{calibration.rotation().transpose() * Vector3f{bias.gyro_bias}};
+				_gyro_learning.update(uorb_index, bias.gyro_device_id, _gyro_temperature[uorb_index],
+						      Vector3f{gyro_offsets[uorb_index]} + in_run_bias);
+			}
+		}
+
+		for (uint8_t uorb_index = 0; uorb_index < ACCEL_COUNT_MAX; uorb_index++) {
+			const calibration::Accelerometer &calibration = _accel_calibration[uorb_index];
+
+			if (_param_tc_a_learn.get() && bias.accel_bias_valid && (calibration.device_id() != 0)
+			    && (calibration.device_id() == bias.accel_device_id)) {
+
+				const Vector3f in_run_bias_sensor{calibration.rotation().transpose() * Vector3f{bias.accel_bias}};
+				const Vector3f in_run_bias{in_run_bias_sensor.edivide(calibration.scale())};
+				_accel_learning.update(uorb_index, bias.accel_device_id, _accel_temperature[uorb_index],
+						       Vector3f{accel_offsets[uorb_index]} + in_run_bias);
+			}
+		}
+	}
+
+	// only change the compensation while disarmed
+	actuator_armed_s armed{};
+	_actuator_armed_sub.copy(&armed);
+
+	if (!armed.armed) {
+		const int saved = _gyro_learning.save() + _accel_learning.save();
+
+		if (saved > 0) {
+			mavlink_log_info(&_mavlink_log_pub, "Thermal compensation updated for %d sensors", saved);
+			param_notify_changes();
+		}
+	}
+}
+
 void TemperatureCompensationModule::Run()
 {
 	perf_begin(_loop_perf);
@@ -243,6 +324,7 @@ void TemperatureCompensationModule::Run()
 	accelPoll();
 	gyroPoll();
 	baroPoll();
+	learnPoll();
 
 	// publish sensor corrections if necessary
 	if (_corrections_changed) {
@@ -359,6 +441,16 @@ int TemperatureCompensationModule::print_status()
 {
 	_temperature_compensation.print_status();
 
+	if (_param_tc_g_learn.get()) {
+		PX4_INFO(" gyro learning:");
+		_gyro_learning.print_status();
+	}
+
+	if (_param_tc_a_learn.get()) {
+		PX4_INFO(" accel learning:");
+		_accel_learning.print_status();
+	}
+
 	return PX4_OK;
 }
 
@@ -37,6 +37,8 @@
 #include <lib/mathlib/mathlib.h>
 #include <lib/parameters/param.h>
 #include <lib/perf/perf_counter.h>
+#include <lib/sensor_calibration/Accelerometer.hpp>
+#include <lib/sensor_calibration/Gyroscope.hpp>
 #include <px4_platform_common/atomic.h>
 #include <px4_platform_common/getopt.h>
 #include <px4_platform_common/module.h>
@@ -49,6 +51,9 @@
 #include <uORB/Publication.hpp>
 #include <uORB/Subscription.hpp>
 #include <uORB/SubscriptionInterval.hpp>
+#include <uORB/SubscriptionMultiArray.hpp>
+#include <uORB/topics/actuator_armed.h>
+#include <uORB/topics/estimator_sensor_bias.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_accel.h>
 #include <uORB/topics/sensor_baro.h>
@@ -57,6 +62,7 @@
 #include <uORB/topics/vehicle_command.h>
 #include <uORB/topics/vehicle_command_ack.h>
 
+#include "OnlineTemperatureCalibration.hpp"
 #include "TemperatureCompensation.h"
 
 using namespace time_literals;
@@ -99,6 +105,11 @@ private:
 	void gyroPoll();
 	void baroPoll();
 
+	/**
+	 * learn the gyro and accel thermal offsets from the estimator in-run bias and save them when disarmed
+	 */
+	void learnPoll();
+
 	/**
 	 * call this whenever parameters got updated. Make sure to have initialize_sensors() called at least
 	 * once before calling this.
@@ -130,6 +141,9 @@ private:
 
 	uORB::Subscription _vehicle_command_sub{ORB_ID(vehicle_command)};
 
+	uORB::Subscription _actuator_armed_sub{ORB_ID(actuator_armed)};
+	uORB::SubscriptionMultiArray<estimator_sensor_bias_s> _estimator_sensor_bias_subs{ORB_ID::estimator_sensor_bias};
+
 	perf_counter_t _loop_perf;			/**< loop performance counter */
 
 	orb_advert_t _mavlink_log_pub{nullptr};
@@ -141,6 +155,21 @@ private:
 	uORB::Publication<sensor_correction_s> _sensor_correction_pub{ORB_ID(sensor_correction)};
 
 	bool _corrections_changed{true};
+
+	/* online learning of the thermal compensation */
+	OnlineTemperatureCalibration _gyro_learning{"TC_G", "TC_G_ENABLE"};
+	OnlineTemperatureCalibration _accel_learning{"TC_A", "TC_A_ENABLE"};
+
+	calibration::Gyroscope _gyro_calibration[GYRO_COUNT_MAX] {};
+	calibration::Accelerometer _accel_calibration[ACCEL_COUNT_MAX] {};
+
+	float _gyro_temperature[GYRO_COUNT_MAX] {NAN, NAN, NAN, NAN};
+	float _accel_temperature[ACCEL_COUNT_MAX] {NAN, NAN, NAN, NAN};
+
+	DEFINE_PARAMETERS(
+		(ParamBool<px4::params::TC_G_LEARN>) _param_tc_g_learn,
+		(ParamBool<px4::params::TC_A_LEARN>) _param_tc_a_learn
+	)
 };
 
 } // namespace temperature_compensation
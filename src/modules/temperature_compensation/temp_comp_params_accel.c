@@ -39,3 +39,15 @@
  * @boolean
  */
 PARAM_DEFINE_INT32(TC_A_ENABLE, 0);
+
+/**
+ * Learn the accelerometer thermal compensation in flight.
+ *
+ * Fits the accelerometer thermal offsets online to the in-run bias estimated by the EKF, during every flight and
+ * ground run. When the temperature range covered is wider than the one of the current TC_A* parameters,
+ * they are replaced while disarmed and TC_A_ENABLE is set.
+ *
+ * @group Thermal Compensation
+ * @boolean
+ */
+PARAM_DEFINE_INT32(TC_A_LEARN, 0);
@@ -51,10 +51,15 @@ static void print_usage(void)
 	PRINT_MODULE_USAGE_NAME_SIMPLE("perf", "command");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Reset all counters");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("latency", "Print HRT timer latency histogram");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("histogram", "Print latency histograms of all histogram counters");
 
 	PRINT_MODULE_USAGE_PARAM_COMMENT("Prints all performance counters if no arguments given");
 }
 
+static void print_histogram(perf_counter_t handle, void *user)
+{
+	perf_print_histogram(1 /* stdout */, handle);
+}
 
 int perf_main(int argc, char *argv[])
 {
@@ -67,6 +72,11 @@ int perf_main(int argc, char *argv[])
 			perf_print_latency(1 /* stdout */);
 			fflush(stdout);
 			return 0;
+
+		} else if (strcmp(argv[1], "histogram") == 0) {
+			perf_iterate_all(print_histogram, NULL);
+			fflush(stdout);
+			return 0;
 		}
 
 		print_usage();
@@ -0,0 +1,680 @@
+/****************************************************************************
+ *
+ *  Copyright (C) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_microbench_algorithms.cpp
+ * Microbenchmarks of the flight stack algorithms (mixing, allocation, sensor processing, geofence).
+ *
+ * Modules that are not part of the build are skipped (see CMakeLists.txt).
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <parameters/param.h>
+#include <perf/perf_counter.h>
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/micro_hal.h>
+
+#include <mathlib/mathlib.h>
+#include <matrix/math.hpp>
+
+#include <lib/collision_prevention/CollisionPrevention.hpp>
+#include <lib/mixer/MultirotorMixer/MultirotorMixer.hpp>
+
+#if defined(MICROBENCH_SENSORS)
+#include <modules/sensors/data_validator/DataValidatorGroup.hpp>
+#include <modules/sensors/vehicle_imu/Integrator.hpp>
+#endif
+
+#if defined(MICROBENCH_CONTROL_ALLOCATION)
+#include <ControlAllocationActiveSet.hpp>
+#include <ControlAllocationPseudoInverse.hpp>
+#include <ControlAllocationSequentialDesaturation.hpp>
+#endif
+
+#if defined(MICROBENCH_NAVIGATOR)
+#include <modules/navigator/geofence.h>
+#include <modules/navigator/navigation.h>
+#endif
+
+#if defined(MICROBENCH_COMMANDER)
+#include <modules/commander/ellipsoid_fit.hpp>
+#endif
+
+namespace MicroBenchAlgorithms
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+#define PERF(name, op, count) do { \
+		px4_usleep(1000); \
+		reset(); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			px4_usleep(1); \
+			lock(); \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+			unlock(); \
+			reset(); \
+		} \
+		perf_print_counter(p); \
+		perf_free(p); \
+	} while (0)
+
+template<typename T>
+T random(T min, T max)
+{
+	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
+	return min + scale * (max - min);      /* [min, max] */
+}
+
+static constexpr MultirotorMixer::Rotor quad_x[] {
+	{-0.707107f,  0.707107f,  1.f, 1.f},
+	{ 0.707107f, -0.707107f,  1.f, 1.f},
+	{ 0.707107f,  0.707107f, -1.f, 1.f},
+	{-0.707107f, -0.707107f, -1.f, 1.f},
+};
+
+static constexpr MultirotorMixer::Rotor hex_x[] {
+	{-1.f,  0.f,       -1.f, 1.f},
+	{ 1.f,  0.f,        1.f, 1.f},
+	{ 0.5f,  0.866025f, -1.f, 1.f},
+	{-0.5f, -0.866025f,  1.f, 1.f},
+	{-0.5f,  0.866025f,  1.f, 1.f},
+	{ 0.5f, -0.866025f, -1.f, 1.f},
+};
+
+static int mixer_control_cb(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control)
+{
+	control = reinterpret_cast<const float *>(handle)[control_index];
+	return 0;
+}
+
+// exposes the obstacle map update without the uORB interface
+class TestCollisionPrevention : public CollisionPrevention
+{
+public:
+	TestCollisionPrevention() : CollisionPrevention(nullptr) {}
+
+	void addObstacleSensorData(const obstacle_distance_s &obstacle, const matrix::Quatf &attitude)
+	{
+		_addObstacleSensorData(obstacle, attitude);
+	}
+
+	void adaptSetpointDirection(matrix::Vector2f &setpoint_dir, float yaw)
+	{
+		int setpoint_index = 0;
+		_adaptSetpointDirection(setpoint_dir, setpoint_index, yaw);
+	}
+};
+
+#if defined(MICROBENCH_NAVIGATOR)
+// checks against a fence built in RAM, without dataman
+class TestGeofence : public Geofence
+{
+public:
+	using Geofence::Vertex;
+
+	TestGeofence() : Geofence(nullptr) {}
+
+	void setPolygon(const Vertex *polygon, int vertex_count)
+	{
+		_clearCache();
+
+		_polygons = new PolygonInfo[1];
+		_vertices = new Vertex[vertex_count];
+		memcpy(_vertices, polygon, sizeof(Vertex) * vertex_count);
+
+		PolygonInfo &info = _polygons[0];
+		info.fence_type = NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION;
+		info.dataman_index = 0;
+		info.vertex_count = vertex_count;
+		info.vertex_index = 0;
+		info.valid = true;
+		_num_polygons = 1;
+		_num_vertices = vertex_count;
+
+		_buildIndex();
+	}
+
+	bool check(double lat, double lon) { return checkPolygons(lat, lon, 0.f); }
+};
+
+// PNPOLY over all edges, as the geofence did before the edge index
+static bool insidePolygonLinear(const TestGeofence::Vertex *polygon, int vertex_count, double lat, double lon)
+{
+	bool c = false;
+
+	for (int i = 0, j = vertex_count - 1; i < vertex_count; j = i++) {
+		if ((polygon[i].lon >= lon) != (polygon[j].lon >= lon) &&
+		    (lat <= (polygon[j].lat - polygon[i].lat) * (lon - polygon[i].lon) /
+		     (polygon[j].lon - polygon[i].lon) + polygon[i].lat)) {
+			c = !c;
+		}
+	}
+
+	return c;
+}
+#endif
+
+class MicroBenchAlgorithms : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+
+	bool time_mixer_multirotor();
+	bool time_collision_prevention();
+#if defined(MICROBENCH_SENSORS)
+	bool time_integrator();
+	bool time_data_validator();
+#endif
+#if defined(MICROBENCH_CONTROL_ALLOCATION)
+	bool time_control_allocation();
+	bool time_control_allocation_worst_case();
+#endif
+#if defined(MICROBENCH_NAVIGATOR)
+	bool time_geofence();
+#endif
+#if defined(MICROBENCH_COMMANDER)
+	bool time_mag_fit();
+#endif
+
+	void reset();
+
+	static constexpr int FIFO_SAMPLES = 32;
+	static constexpr uint32_t FIFO_INTERVAL_US = 125; // 8 kHz
+
+	float _controls[4] {};
+	float _outputs[16] {};
+
+	obstacle_distance_s _obstacle{};
+	matrix::Quatf _attitude;
+	matrix::Vector2f _setpoint_dir;
+
+	uint64_t _timestamp{1000000};
+
+#if defined(MICROBENCH_SENSORS)
+	void integrateBatch(Integrator &integrator);
+	void integrateSamples(Integrator &integrator);
+	void voteGroup(DataValidatorGroup &group, unsigned instances);
+	void validateIndividually(DataValidator validators[], unsigned instances);
+
+	int16_t _fifo[3][FIFO_SAMPLES] {};
+	float _sensor_data[DataValidatorGroup::MAX_SIBLINGS][3] {};
+#endif
+
+#if defined(MICROBENCH_CONTROL_ALLOCATION)
+	template<class T>
+	void configure(T &method, int num_actuators);
+
+	matrix::Matrix<float, 6, 16> _effectiveness;
+	matrix::Vector<float, 6> _control_sp;
+
+	ControlAllocationPseudoInverse _pseudo_inverse;
+	ControlAllocationSequentialDesaturation _sequential_desaturation;
+	ControlAllocationActiveSet _active_set;
+#endif
+
+#if defined(MICROBENCH_NAVIGATOR)
+	static constexpr int POLYGON_VERTICES = 500;
+
+	TestGeofence::Vertex _polygon[POLYGON_VERTICES];
+	double _lat{0.};
+	double _lon{0.};
+#endif
+
+#if defined(MICROBENCH_COMMANDER)
+	static constexpr int MAG_SAMPLES = 240;
+
+	void fitStreaming(EllipsoidFit &fit);
+	void fitBatch();
+
+	float _mag_x[MAG_SAMPLES];
+	float _mag_y[MAG_SAMPLES];
+	float _mag_z[MAG_SAMPLES];
+#endif
+};
+
+bool MicroBenchAlgorithms::run_tests()
+{
+	ut_run_test(time_mixer_multirotor);
+	ut_run_test(time_collision_prevention);
+#if defined(MICROBENCH_SENSORS)
+	ut_run_test(time_integrator);
+	ut_run_test(time_data_validator);
+#endif
+#if defined(MICROBENCH_CONTROL_ALLOCATION)
+	ut_run_test(time_control_allocation);
+	ut_run_test(time_control_allocation_worst_case);
+#endif
+#if defined(MICROBENCH_NAVIGATOR)
+	ut_run_test(time_geofence);
+#endif
+#if defined(MICROBENCH_COMMANDER)
+	ut_run_test(time_mag_fit);
+#endif
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchAlgorithms::reset()
+{
+	srand(time(nullptr));
+
+	// saturating roll, pitch and yaw
+	_controls[0] = random(-1.f, 1.f);
+	_controls[1] = random(-1.f, 1.f);
+	_controls[2] = random(-1.f, 1.f);
+	_controls[3] = random(0.f, 1.f);
+
+	_attitude = matrix::Quatf(matrix::Eulerf(random(-0.3f, 0.3f), random(-0.3f, 0.3f), random(-M_PI_F, M_PI_F)));
+	_setpoint_dir = matrix::Vector2f(random(-1.f, 1.f), random(-1.f, 1.f)).unit_or_zero();
+
+#if defined(MICROBENCH_SENSORS)
+
+	for (int axis = 0; axis < 3; axis++) {
+		for (int n = 0; n < FIFO_SAMPLES; n++) {
+			_fifo[axis][n] = (int16_t)random(-2000.f, 2000.f);
+		}
+	}
+
+	for (auto &instance : _sensor_data) {
+		for (auto &value : instance) {
+			value = random(-0.1f, 0.1f);
+		}
+	}
+
+#endif
+
+#if defined(MICROBENCH_CONTROL_ALLOCATION)
+	_control_sp(0) = random(-0.6f, 0.6f);
+	_control_sp(1) = random(-0.6f, 0.6f);
+	_control_sp(2) = random(-0.3f, 0.3f);
+	_control_sp(5) = random(-1.f, 0.f);
+#endif
+
+#if defined(MICROBENCH_NAVIGATOR)
+	_lat = random(47.38, 47.42);
+	_lon = random(8.53, 8.57);
+#endif
+}
+
+bool MicroBenchAlgorithms::time_mixer_multirotor()
+{
+	const uintptr_t handle = reinterpret_cast<uintptr_t>(_controls);
+
+	MultirotorMixer mixer_quad(mixer_control_cb, handle, quad_x, sizeof(quad_x) / sizeof(quad_x[0]));
+	MultirotorMixer mixer_hex(mixer_control_cb, handle, hex_x, sizeof(hex_x) / sizeof(hex_x[0]));
+
+	PERF("MultirotorMixer quad x mix (airmode disabled)", mixer_quad.mix(_outputs, 16), 1000);
+	PERF("MultirotorMixer hex x mix (airmode disabled)", mixer_hex.mix(_outputs, 16), 1000);
+
+	mixer_quad.set_airmode(Mixer::Airmode::roll_pitch);
+	mixer_hex.set_airmode(Mixer::Airmode::roll_pitch);
+	PERF("MultirotorMixer quad x mix (airmode roll/pitch)", mixer_quad.mix(_outputs, 16), 1000);
+	PERF("MultirotorMixer hex x mix (airmode roll/pitch)", mixer_hex.mix(_outputs, 16), 1000);
+
+	mixer_quad.set_airmode(Mixer::Airmode::roll_pitch_yaw);
+	mixer_hex.set_airmode(Mixer::Airmode::roll_pitch_yaw);
+	PERF("MultirotorMixer quad x mix (airmode roll/pitch/yaw)", mixer_quad.mix(_outputs, 16), 1000);
+	PERF("MultirotorMixer hex x mix (airmode roll/pitch/yaw)", mixer_hex.mix(_outputs, 16), 1000);
+
+	return true;
+}
+
+bool MicroBenchAlgorithms::time_collision_prevention()
+{
+	TestCollisionPrevention cp;
+
+	_obstacle.timestamp = hrt_absolute_time();
+	_obstacle.frame = obstacle_distance_s::MAV_FRAME_GLOBAL;
+	_obstacle.min_distance = 20;
+	_obstacle.max_distance = 2000;
+	_obstacle.angle_offset = 0.f;
+
+	const int bins = sizeof(_obstacle.distances) / sizeof(_obstacle.distances[0]);
+	_obstacle.increment = 360.f / bins;
+
+	for (int i = 0; i < bins; i++) {
+		_obstacle.distances[i] = (i < bins / 2) ? 500 : UINT16_MAX;
+	}
+
+	PERF("CollisionPrevention add obstacle distance (north aligned)", cp.addObstacleSensorData(_obstacle, _attitude), 1000);
+
+	_obstacle.frame = obstacle_distance_s::MAV_FRAME_BODY_FRD;
+	PERF("CollisionPrevention add obstacle distance (body frame)", cp.addObstacleSensorData(_obstacle, _attitude), 1000);
+
+	PERF("CollisionPrevention adapt setpoint direction", cp.adaptSetpointDirection(_setpoint_dir, 0.f), 1000);
+
+	return true;
+}
+
+#if defined(MICROBENCH_SENSORS)
+void MicroBenchAlgorithms::integrateBatch(Integrator &integrator)
+{
+	_timestamp += FIFO_SAMPLES * FIFO_INTERVAL_US;
+	integrator.put(_timestamp, _fifo[0], _fifo[1], _fifo[2], FIFO_SAMPLES, FIFO_INTERVAL_US, 0.001f);
+
+	matrix::Vector3f integral;
+	uint32_t integral_dt;
+	integrator.reset(integral, integral_dt);
+}
+
+void MicroBenchAlgorithms::integrateSamples(Integrator &integrator)
+{
+	for (int n = 0; n < FIFO_SAMPLES; n++) {
+		_timestamp += FIFO_INTERVAL_US;
+		integrator.put(_timestamp, matrix::Vector3f(_fifo[0][n], _fifo[1][n], _fifo[2][n]) * 0.001f);
+	}
+
+	matrix::Vector3f integral;
+	uint32_t integral_dt;
+	integrator.reset(integral, integral_dt);
+}
+
+bool MicroBenchAlgorithms::time_integrator()
+{
+	Integrator integrator;
+	Integrator integrator_coning{true};
+
+	PERF("Integrator put 32 sample FIFO batch", integrateBatch(integrator), 1000);
+	PERF("Integrator put 32 samples individually", integrateSamples(integrator), 1000);
+	PERF("Integrator put 32 samples individually (coning)", integrateSamples(integrator_coning), 1000);
+
+	return true;
+}
+
+void MicroBenchAlgorithms::voteGroup(DataValidatorGroup &group, unsigned instances)
+{
+	_timestamp += 4000;
+
+	for (unsigned i = 0; i < instances; i++) {
+		group.put(i, _timestamp, _sensor_data[i], 0, 50);
+	}
+
+	int best_index = -1;
+	group.get_best(_timestamp, &best_index);
+}
+
+void MicroBenchAlgorithms::validateIndividually(DataValidator validators[], unsigned instances)
+{
+	_timestamp += 4000;
+
+	for (unsigned i = 0; i < instances; i++) {
+		validators[i].put(_timestamp, _sensor_data[i], 0, 50);
+		validators[i].confidence(_timestamp);
+	}
+}
+
+bool MicroBenchAlgorithms::time_data_validator()
+{
+	DataValidatorGroup group1{1};
+	DataValidatorGroup group3{3};
+	DataValidator validators[3];
+
+	PERF("DataValidatorGroup put and vote (1 instance)", voteGroup(group1, 1), 1000);
+	PERF("DataValidatorGroup put and vote (3 instances)", voteGroup(group3, 3), 1000);
+	PERF("DataValidator put and confidence (3 instances)", validateIndividually(validators, 3), 1000);
+
+	return true;
+}
+#endif
+
+#if defined(MICROBENCH_CONTROL_ALLOCATION)
+template<class T>
+void MicroBenchAlgorithms::configure(T &method, int num_actuators)
+{
+	matrix::Vector<float, 16> actuator_min;
+	matrix::Vector<float, 16> actuator_max;
+
+	for (int i = 0; i < num_actuators; i++) {
+		actuator_max(i) = 1.f;
+	}
+
+	method.setActuatorMin(actuator_min);
+	method.setActuatorMax(actuator_max);
+	method.setEffectivenessMatrix(_effectiveness, matrix::Vector<float, 16>(), num_actuators);
+}
+
+bool MicroBenchAlgorithms::time_control_allocation()
+{
+	// quad x
+	_effectiveness.setZero();
+
+	for (int i = 0; i < 4; i++) {
+		_effectiveness(0, i) = quad_x[i].roll_scale * 0.707107f;
+		_effectiveness(1, i) = quad_x[i].pitch_scale * 0.707107f;
+		_effectiveness(2, i) = quad_x[i].yaw_scale * 0.25f;
+		_effectiveness(5, i) = -0.25f;
+	}
+
+	configure(_pseudo_inverse, 4);
+	configure(_sequential_desaturation, 4);
+	configure(_active_set, 4);
+
+	PERF("ControlAllocation pseudo-inverse allocate (quad x)",
+	     _pseudo_inverse.setControlSetpoint(_control_sp); _pseudo_inverse.allocate(), 1000);
+	PERF("ControlAllocation sequential desaturation allocate (quad x)",
+	     _sequential_desaturation.setControlSetpoint(_control_sp); _sequential_desaturation.allocate(), 1000);
+	PERF("ControlAllocation active set allocate (quad x)",
+	     _active_set.setControlSetpoint(_control_sp); _active_set.allocate(), 1000);
+
+	// unchanged effectiveness: the cached pseudo-inverse is used
+	PERF("ControlAllocation pseudo-inverse update (cached)",
+	     configure(_pseudo_inverse, 4); _pseudo_inverse.allocate(), 1000);
+
+	// changing effectiveness (e.g. during a transition): the pseudo-inverse is recomputed every time
+	PERF("ControlAllocation pseudo-inverse update (changed)",
+	     _effectiveness(5, 0) = random(-0.3f, -0.2f); configure(_pseudo_inverse, 4); _pseudo_inverse.allocate(), 1000);
+
+	return true;
+}
+
+bool MicroBenchAlgorithms::time_control_allocation_worst_case()
+{
+	// 16 actuators with saturating setpoints that flip the working set on every call
+	static constexpr int num_actuators = 16;
+
+	_effectiveness.setZero();
+
+	for (int i = 0; i < num_actuators; i++) {
+		const float angle = 2.f * M_PI_F * i / num_actuators;
+		_effectiveness(0, i) = -0.1f * sinf(angle);
+		_effectiveness(1, i) = 0.1f * cosf(angle);
+		_effectiveness(2, i) = (i % 2 == 0) ? 0.03f : -0.03f;
+		_effectiveness(5, i) = -1.f / num_actuators;
+	}
+
+	configure(_active_set, num_actuators);
+
+	int32_t max_time_us = 0;
+	param_get(param_find("CA_AS_MAX_TIME"), &max_time_us);
+
+	perf_counter_t p = perf_alloc(PC_ELAPSED, "ControlAllocation active set allocate (16 actuators, worst case)");
+	hrt_abstime worst = 0;
+	hrt_abstime worst_iteration = 0;
+	int max_iterations = 0;
+	int limited = 0;
+
+	for (int n = 0; n < 1000; n++) {
+		const float sign = (n % 2 == 0) ? 1.f : -1.f;
+		_control_sp(0) = sign * random(0.3f, 0.6f);
+		_control_sp(1) = -sign * random(0.3f, 0.6f);
+		_control_sp(2) = sign * random(0.1f, 0.3f);
+		_control_sp(5) = random(-1.f, -0.5f);
+		_active_set.setControlSetpoint(_control_sp);
+
+		px4_usleep(1);
+		lock();
+		perf_begin(p);
+		hrt_abstime start = hrt_absolute_time();
+		_active_set.allocate();
+		const hrt_abstime elapsed = hrt_elapsed_time(&start);
+		perf_end(p);
+		unlock();
+
+		worst = math::max(worst, elapsed);
+		max_iterations = math::max(max_iterations, _active_set.lastIterations());
+		limited += _active_set.lastLimited() ? 1 : 0;
+
+		// once converged from the warm start, the same setpoint takes a single iteration
+		for (int i = 0; (i < 10) && _active_set.lastLimited(); i++) {
+			_active_set.allocate();
+		}
+
+		lock();
+		start = hrt_absolute_time();
+		_active_set.allocate();
+		const hrt_abstime elapsed_iteration = hrt_elapsed_time(&start);
+		unlock();
+
+		if (_active_set.lastIterations() == 1) {
+			worst_iteration = math::max(worst_iteration, elapsed_iteration);
+		}
+	}
+
+	perf_print_counter(p);
+	perf_free(p);
+
+	PX4_INFO("active set 16 actuators: worst %u us, %d iterations, %d of 1000 stopped by the limit,"
+		 " CA_AS_MAX_TIME %d us, single iteration %u us",
+		 (unsigned)worst, max_iterations, limited, (int)max_time_us, (unsigned)worst_iteration);
+
+#ifdef __PX4_NUTTX
+	// only meaningful with interrupts disabled during the allocation.
+	// The time limit is checked between iterations, so it can be exceeded by at most one iteration.
+	static constexpr int loop_budget_us = 1000; // 1 kHz rate loop
+
+	ut_less_than("active set worst case exceeds CA_AS_MAX_TIME", (int)worst, max_time_us + (int)worst_iteration + 1);
+	ut_less_than("active set worst case exceeds the 1 kHz budget", (int)worst, loop_budget_us);
+#endif
+
+	return true;
+}
+#endif
+
+#if defined(MICROBENCH_NAVIGATOR)
+bool MicroBenchAlgorithms::time_geofence()
+{
+	// star shaped (concave) polygon with alternating inner and outer radius
+	for (int i = 0; i < POLYGON_VERTICES; i++) {
+		const double angle = 2.0 * M_PI * i / POLYGON_VERTICES;
+		const double radius = (i % 2 == 0) ? 0.02 : 0.012;
+		_polygon[i].lat = 47.4 + radius * cos(angle);
+		_polygon[i].lon = 8.55 + radius * sin(angle);
+	}
+
+	TestGeofence geofence;
+	geofence.setPolygon(_polygon, POLYGON_VERTICES);
+
+	PERF("Geofence 500 vertex polygon (edge index)", geofence.check(_lat, _lon), 1000);
+	PERF("Geofence 500 vertex polygon (all edges)", insidePolygonLinear(_polygon, POLYGON_VERTICES, _lat, _lon), 1000);
+
+	return true;
+}
+#endif
+
+#if defined(MICROBENCH_COMMANDER)
+void MicroBenchAlgorithms::fitStreaming(EllipsoidFit &fit)
+{
+	sphere_params params;
+	float fitness;
+
+	fit.reset();
+
+	// the sphere is solved after each sample as done during the calibration
+	for (int k = 0; k < MAG_SAMPLES; k++) {
+		fit.update(matrix::Vector3f(_mag_x[k], _mag_y[k], _mag_z[k]));
+		fit.fitSphere(params, fitness);
+	}
+
+	fit.fitEllipsoid(params, fitness);
+}
+
+void MicroBenchAlgorithms::fitBatch()
+{
+	sphere_params params;
+	lm_mag_fit(_mag_x, _mag_y, _mag_z, MAG_SAMPLES, params, false);
+	lm_mag_fit(_mag_x, _mag_y, _mag_z, MAG_SAMPLES, params, true);
+}
+
+bool MicroBenchAlgorithms::time_mag_fit()
+{
+	// samples on a slightly distorted sphere with a hard iron offset
+	for (int k = 0; k < MAG_SAMPLES; k++) {
+		const float theta = acosf(1.f - 2.f * (k + 0.5f) / MAG_SAMPLES);
+		const float phi = k * 2.39996f; // golden angle
+
+		_mag_x[k] = 0.1f + 0.45f * sinf(theta) * cosf(phi);
+		_mag_y[k] = -0.05f + 0.4f * sinf(theta) * sinf(phi);
+		_mag_z[k] = 0.2f + 0.42f * cosf(theta);
+	}
+
+	EllipsoidFit fit;
+
+	PERF("Mag calibration streaming ellipsoid fit (240 samples)", fitStreaming(fit), 10);
+	PERF("Mag calibration batch ellipsoid fit (240 samples)", fitBatch(), 10);
+
+	return true;
+}
+#endif
+
+ut_declare_test_c(test_microbench_algorithms, MicroBenchAlgorithms)
+
+} // namespace MicroBenchAlgorithms
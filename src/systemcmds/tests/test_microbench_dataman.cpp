@@ -0,0 +1,177 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_microbench_dataman.cpp
+ * Tests for the microbench dataman single and range access.
+ */
+
+#include <unit_test.h>
+
+#include <string.h>
+
+#include <dataman/dataman.h>
+#include <drivers/drv_hrt.h>
+#include <navigator/navigation.h>
+#include <perf/perf_counter.h>
+#include <px4_platform_common/px4_config.h>
+
+namespace MicroBenchDataman
+{
+
+// dataman requests block on the worker thread, so unlike the other microbenchmarks this can't run in a critical section
+#define PERF(name, op, count) do { \
+		px4_usleep(1000); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+		} \
+		perf_print_counter(p); \
+		perf_free(p); \
+	} while (0)
+
+class MicroBenchDataman : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	static constexpr unsigned NUM_ITEMS = 32;
+	static constexpr dm_item_t ITEM = DM_KEY_WAYPOINTS_OFFBOARD_1;
+
+	bool time_dataman_read();
+	bool time_dataman_write();
+
+	bool readSingle();
+	bool readRange();
+	bool writeSingle();
+	bool writeRange();
+
+	void reset();
+
+	mission_item_s _items[NUM_ITEMS] {};
+	mission_item_s _items_out[NUM_ITEMS] {};
+};
+
+bool MicroBenchDataman::run_tests()
+{
+	ut_run_test(time_dataman_write);
+	ut_run_test(time_dataman_read);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchDataman::reset()
+{
+	for (unsigned i = 0; i < NUM_ITEMS; i++) {
+		_items[i].lat = 47.397742 + i * 1e-5;
+		_items[i].lon = 8.545594 + i * 1e-5;
+		_items[i].altitude = 10.f + i;
+		_items[i].nav_cmd = NAV_CMD_WAYPOINT;
+	}
+
+	memset(_items_out, 0, sizeof(_items_out));
+}
+
+bool MicroBenchDataman::readSingle()
+{
+	for (unsigned i = 0; i < NUM_ITEMS; i++) {
+		if (dm_read(ITEM, i, &_items_out[i], sizeof(mission_item_s)) != sizeof(mission_item_s)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MicroBenchDataman::readRange()
+{
+	return dm_read_range(ITEM, 0, NUM_ITEMS, _items_out, sizeof(mission_item_s)) == (ssize_t)NUM_ITEMS;
+}
+
+bool MicroBenchDataman::writeSingle()
+{
+	for (unsigned i = 0; i < NUM_ITEMS; i++) {
+		if (dm_write(ITEM, i, DM_PERSIST_POWER_ON_RESET, &_items[i], sizeof(mission_item_s)) != sizeof(mission_item_s)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MicroBenchDataman::writeRange()
+{
+	return dm_write_range(ITEM, 0, NUM_ITEMS, DM_PERSIST_POWER_ON_RESET, _items, sizeof(mission_item_s)) == (ssize_t)NUM_ITEMS;
+}
+
+ut_declare_test_c(test_microbench_dataman, MicroBenchDataman)
+
+bool MicroBenchDataman::time_dataman_write()
+{
+	reset();
+
+	bool ret = true;
+
+	PERF("dm_write x32", ret = ret && writeSingle(), 20);
+	ut_assert_true(ret);
+
+	PERF("dm_write_range x32", ret = ret && writeRange(), 20);
+	ut_assert_true(ret);
+
+	return true;
+}
+
+bool MicroBenchDataman::time_dataman_read()
+{
+	reset();
+	ut_assert_true(writeRange());
+
+	bool ret = true;
+
+	PERF("dm_read x32", ret = ret && readSingle(), 20);
+	ut_assert_true(ret);
+	ut_assert_true(memcmp(_items, _items_out, sizeof(_items)) == 0);
+
+	memset(_items_out, 0, sizeof(_items_out));
+
+	PERF("dm_read_range x32", ret = ret && readRange(), 20);
+	ut_assert_true(ret);
+	ut_assert_true(memcmp(_items, _items_out, sizeof(_items)) == 0);
+
+	return true;
+}
+
+} // namespace MicroBenchDataman
@@ -48,8 +48,9 @@ test_perf(int argc, char *argv[])
 {
 	perf_counter_t cc = perf_alloc(PC_COUNT, "test_count");
 	perf_counter_t ec = perf_alloc(PC_ELAPSED, "test_elapsed");
+	perf_counter_t hc = perf_alloc(PC_ELAPSED_HISTOGRAM, "test_histogram");
 
-	if ((cc == NULL) || (ec == NULL)) {
+	if ((cc == NULL) || (ec == NULL) || (hc == NULL)) {
 		printf("perf: counter alloc failed\n");
 		return 1;
 	}
@@ -65,8 +66,26 @@ test_perf(int argc, char *argv[])
 	printf("perf: expect count of 1\n");
 	perf_print_counter(ec);
 
+	for (int i = 0; i < 100; i++) {
+		perf_set_elapsed(hc, (i < 98) ? 10 : 1000);
+	}
+
+	if ((perf_event_count(hc) != 100) || (perf_percentile(hc, 0.5f) > 11) || (perf_percentile(hc, 0.99f) != 1000)) {
+		printf("perf: histogram percentiles wrong\n");
+		perf_print_histogram(1, hc);
+		return 1;
+	}
+
+	perf_reset(hc);
+
+	if (perf_event_count(hc) != 0) {
+		printf("perf: histogram reset failed\n");
+		return 1;
+	}
+
 	perf_free(cc);
 	perf_free(ec);
+	perf_free(hc);
 
 	return OK;
 }
@@ -64,7 +64,9 @@ extern int test_IntrusiveSortedList(int argc, char *argv[]);
 extern int test_List(int argc, char *argv[]);
 extern int test_mathlib(int argc, char *argv[]);
 extern int test_matrix(int argc, char *argv[]);
+extern int test_microbench_algorithms(int argc, char *argv[]);
 extern int test_microbench_atomic(int argc, char *argv[]);
+extern int test_microbench_dataman(int argc, char *argv[]);
 extern int test_microbench_hrt(int argc, char *argv[]);
 extern int test_microbench_math(int argc, char *argv[]);
 extern int test_microbench_matrix(int argc, char *argv[]);
@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/module.h>
+#include <px4_platform_common/getopt.h>
+#include <px4_platform_common/trace.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static void	usage();
+
+extern "C" {
+	__EXPORT int trace_main(int argc, char *argv[]);
+}
+
+int
+trace_main(int argc, char *argv[])
+{
+#if defined(PX4_TRACE_SUPPORTED)
+
+	if (argc < 2) {
+		usage();
+		return 1;
+	}
+
+	if (!strcmp(argv[1], "start")) {
+		const char *path = PX4_STORAGEDIR "/trace.px4t";
+		uint32_t ring_size = 65536;
+
+		int myoptind = 1;
+		int ch;
+		const char *myoptarg = nullptr;
+
+		while ((ch = px4_getopt(argc, argv, "f:n:", &myoptind, &myoptarg)) != EOF) {
+			switch (ch) {
+			case 'f':
+				path = myoptarg;
+				break;
+
+			case 'n':
+				ring_size = strtoul(myoptarg, nullptr, 10);
+				break;
+
+			default:
+				usage();
+				return 1;
+			}
+		}
+
+		return px4::trace::start(path, ring_size) ? 0 : 1;
+
+	} else if (!strcmp(argv[1], "stop")) {
+		px4::trace::stop();
+		return 0;
+
+	} else if (!strcmp(argv[1], "status")) {
+		px4::trace::print_status();
+		return 0;
+	}
+
+	usage();
+	return 1;
+#else
+	PX4_ERR("tracing is not supported on this platform");
+	return 1;
+#endif // PX4_TRACE_SUPPORTED
+}
+
+static void
+usage()
+{
+
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+
+Trace uORB publications and WorkItem scheduling and execution into a file.
+
+Every publication, WorkItem schedule and WorkItem Run() start/end is recorded with
+its timestamp and thread. Use `Tools/px4trace.py` to convert the file into a
+Chrome/Perfetto trace (open in https://ui.perfetto.dev) or to compute end-to-end
+latencies between two topics.
+
+### Example
+
+$ trace start -f trace.px4t
+$ trace stop
+
+Then on the host:
+
+$ Tools/px4trace.py trace.px4t -o trace.json
+$ Tools/px4trace.py trace.px4t --latency sensor_gyro actuator_outputs
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("trace", "system");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("start", "Start tracing");
+	PRINT_MODULE_USAGE_PARAM_STRING('f', PX4_STORAGEDIR "/trace.px4t", nullptr, "Output file", true);
+	PRINT_MODULE_USAGE_PARAM_INT('n', 65536, 1024, 16777216, "Number of buffered events", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("stop", "Stop tracing and close the file");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print trace status");
+}